@@ -0,0 +1,452 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "cancapture.h"
+#include "vbytearray.h"
+
+#include <QDateTime>
+#include <QtEndian>
+
+namespace {
+const char binaryMagic[] = "VCAN";
+const quint8 binaryVersion = 1;
+const int binaryHeaderLen = 4 + 1 + 8;
+
+const quint8 flagTimeSync = 0x80;
+const quint8 flagExtended = 0x40;
+const quint8 flagLenMask = 0x0F;
+
+// Frames emitted per timer tick at maximum replay speed
+const int maxSpeedBatch = 20000;
+
+void setError(QString *errorStr, QString msg)
+{
+    if (errorStr) {
+        *errorStr = msg;
+    }
+}
+
+bool readBinary(const QByteArray &in, QVector<CanCapture::Frame> &frames, QString *errorStr)
+{
+    if (in.size() < binaryHeaderLen || !in.startsWith(binaryMagic)) {
+        setError(errorStr, "Not a VESC CAN capture file");
+        return false;
+    }
+
+    const uchar *d = reinterpret_cast<const uchar*>(in.constData());
+    int pos = 4;
+
+    if (d[pos++] != binaryVersion) {
+        setError(errorStr, "Unsupported capture file version");
+        return false;
+    }
+
+    pos += 8; // Start time, only used for text export
+
+    qint64 timeUs = 0;
+
+    while (pos < in.size()) {
+        quint8 flags = d[pos++];
+
+        if (flags & flagTimeSync) {
+            if ((pos + 8) > in.size()) {
+                break;
+            }
+
+            timeUs = qint64(qFromBigEndian<quint64>(d + pos));
+            pos += 8;
+            continue;
+        }
+
+        int len = flags & flagLenMask;
+        bool ext = flags & flagExtended;
+        int recLen = 4 + (ext ? 4 : 2) + len;
+
+        if (len > 8 || (pos + recLen) > in.size()) {
+            // Truncated last record, e.g. when the capture was not closed
+            break;
+        }
+
+        timeUs += qFromBigEndian<quint32>(d + pos);
+        pos += 4;
+
+        CanCapture::Frame f;
+        f.timeUs = timeUs;
+        f.isExtended = ext;
+
+        if (ext) {
+            f.id = qFromBigEndian<quint32>(d + pos);
+            pos += 4;
+        } else {
+            f.id = qFromBigEndian<quint16>(d + pos);
+            pos += 2;
+        }
+
+        f.data = in.mid(pos, len);
+        pos += len;
+
+        frames.append(f);
+    }
+
+    return true;
+}
+
+bool readCandump(QFile &file, QVector<CanCapture::Frame> &frames, QString *errorStr)
+{
+    qint64 firstUs = -1;
+    int lineNum = 0;
+
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        lineNum++;
+
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QList<QByteArray> parts = line.split(' ');
+        if (parts.size() < 3 || !parts.at(0).startsWith('(') || !parts.at(0).endsWith(')')) {
+            setError(errorStr, QString("Invalid candump line %1").arg(lineNum));
+            return false;
+        }
+
+        // CAN FD frames (id##flags data) are not used by VESC
+        if (parts.at(2).contains("##")) {
+            continue;
+        }
+
+        QList<QByteArray> ts = parts.at(0).mid(1, parts.at(0).size() - 2).split('.');
+        QList<QByteArray> frame = parts.at(2).split('#');
+
+        if (ts.size() != 2 || frame.size() != 2) {
+            setError(errorStr, QString("Invalid candump line %1").arg(lineNum));
+            return false;
+        }
+
+        // Neither are remote frames
+        if (frame.at(1).startsWith('R')) {
+            continue;
+        }
+
+        bool ok1 = false, ok2 = false, ok3 = false;
+        qint64 timeUs = ts.at(0).toLongLong(&ok1) * 1000000 + ts.at(1).toLongLong(&ok2);
+
+        CanCapture::Frame f;
+        f.id = frame.at(0).toUInt(&ok3, 16);
+        f.isExtended = frame.at(0).size() > 3;
+        f.data = QByteArray::fromHex(frame.at(1));
+
+        if (!ok1 || !ok2 || !ok3 || f.data.size() > 8) {
+            setError(errorStr, QString("Invalid candump line %1").arg(lineNum));
+            return false;
+        }
+
+        if (firstUs < 0) {
+            firstUs = timeUs;
+        }
+
+        f.timeUs = timeUs - firstUs;
+        frames.append(f);
+    }
+
+    return true;
+}
+}
+
+CanCapture::Format CanCapture::formatFromFileName(QString fileName)
+{
+    if (fileName.endsWith(".log", Qt::CaseInsensitive) ||
+            fileName.endsWith(".txt", Qt::CaseInsensitive)) {
+        return FormatCandump;
+    }
+
+    return FormatBinary;
+}
+
+/**
+ * @brief CanCapture::readFile
+ * Read a capture file. The format is detected from the file contents.
+ *
+ * @param fileName
+ * The file to read.
+ *
+ * @param frames
+ * The frames are appended here, with timestamps relative to the start of the
+ * capture.
+ *
+ * @param errorStr
+ * Set to a description of the problem if reading fails.
+ *
+ * @return
+ * True on success.
+ */
+bool CanCapture::readFile(QString fileName, QVector<Frame> &frames, QString *errorStr)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(errorStr, file.errorString());
+        return false;
+    }
+
+    if (file.peek(4) == QByteArray(binaryMagic)) {
+        return readBinary(file.readAll(), frames, errorStr);
+    } else {
+        return readCandump(file, frames, errorStr);
+    }
+}
+
+CanCaptureWriter::CanCaptureWriter()
+{
+    mFormat = CanCapture::FormatBinary;
+    mStartMsEpoch = 0;
+    mLastTimeUs = 0;
+    mFramesWritten = 0;
+    mBytesWritten = 0;
+    mInterfaceName = "can0";
+}
+
+CanCaptureWriter::~CanCaptureWriter()
+{
+    close();
+}
+
+bool CanCaptureWriter::open(QString fileName, CanCapture::Format format)
+{
+    close();
+
+    mFile.setFileName(fileName);
+    if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    mFormat = format;
+    mStartMsEpoch = QDateTime::currentMSecsSinceEpoch();
+    mLastTimeUs = 0;
+    mFramesWritten = 0;
+    mBytesWritten = 0;
+    mBuffer.clear();
+    mTime.start();
+    mFlushTimer.start();
+
+    if (mFormat == CanCapture::FormatBinary) {
+        VByteArray vb;
+        vb.append(binaryMagic);
+        vb.vbAppendUint8(binaryVersion);
+        vb.vbAppendUint64(quint64(mStartMsEpoch));
+        mBuffer.append(vb);
+    }
+
+    return true;
+}
+
+void CanCaptureWriter::close()
+{
+    if (mFile.isOpen()) {
+        flush();
+        mFile.close();
+    }
+}
+
+bool CanCaptureWriter::isOpen() const
+{
+    return mFile.isOpen();
+}
+
+QString CanCaptureWriter::errorString() const
+{
+    return mFile.errorString();
+}
+
+/**
+ * @brief CanCaptureWriter::writeFrame
+ * Timestamp a frame and append it to the capture. The frames are written to
+ * the file in blocks.
+ */
+void CanCaptureWriter::writeFrame(const QByteArray &data, quint32 id, bool isExtended)
+{
+    if (!mFile.isOpen()) {
+        return;
+    }
+
+    qint64 timeUs = mTime.nsecsElapsed() / 1000;
+    int len = qMin(data.size(), 8);
+
+    if (mFormat == CanCapture::FormatBinary) {
+        VByteArray vb;
+        qint64 diff = timeUs - mLastTimeUs;
+
+        if (diff > qint64(0xFFFFFFFF)) {
+            vb.vbAppendUint8(flagTimeSync);
+            vb.vbAppendUint64(quint64(timeUs));
+            diff = 0;
+        }
+
+        // Standard IDs are 11 bits and use 16 bits on disk
+        bool ext = isExtended || id > 0xFFFF;
+
+        vb.vbAppendUint8(quint8(len) | (ext ? flagExtended : 0));
+        vb.vbAppendUint32(quint32(diff));
+
+        if (ext) {
+            vb.vbAppendUint32(id);
+        } else {
+            vb.vbAppendUint16(quint16(id));
+        }
+
+        vb.append(data.constData(), len);
+        mBuffer.append(vb);
+        mLastTimeUs = timeUs;
+    } else {
+        qint64 t = mStartMsEpoch * 1000 + timeUs;
+        mBuffer.append(QString("(%1.%2) %3 %4#%5\n").
+                       arg(t / 1000000).
+                       arg(t % 1000000, 6, 10, QLatin1Char('0')).
+                       arg(mInterfaceName).
+                       arg(QString("%1").arg(id, isExtended ? 8 : 3, 16, QLatin1Char('0')).toUpper()).
+                       arg(QString(data.left(len).toHex().toUpper())).toLatin1());
+    }
+
+    mFramesWritten++;
+
+    if (mBuffer.size() > 65536 || mFlushTimer.elapsed() > 1000) {
+        flush();
+    }
+}
+
+void CanCaptureWriter::flush()
+{
+    if (mFile.isOpen() && !mBuffer.isEmpty()) {
+        mBytesWritten += mFile.write(mBuffer);
+        mFile.flush();
+        mBuffer.clear();
+    }
+
+    mFlushTimer.restart();
+}
+
+quint64 CanCaptureWriter::framesWritten() const
+{
+    return mFramesWritten;
+}
+
+qint64 CanCaptureWriter::bytesWritten() const
+{
+    return mBytesWritten + mBuffer.size();
+}
+
+CanReplay::CanReplay(QObject *parent) : QObject(parent)
+{
+    mPos = 0;
+    mSpeed = 1.0;
+
+    mTimer = new QTimer(this);
+    mTimer->setTimerType(Qt::PreciseTimer);
+    connect(mTimer, SIGNAL(timeout()), this, SLOT(timerSlot()));
+}
+
+bool CanReplay::loadFile(QString fileName, QString *errorStr)
+{
+    QVector<CanCapture::Frame> frames;
+    if (!CanCapture::readFile(fileName, frames, errorStr)) {
+        return false;
+    }
+
+    setFrames(frames);
+    return true;
+}
+
+void CanReplay::setFrames(const QVector<CanCapture::Frame> &frames)
+{
+    stop();
+    mFrames = frames;
+    mPos = 0;
+}
+
+int CanReplay::frameCount() const
+{
+    return mFrames.size();
+}
+
+int CanReplay::framesReplayed() const
+{
+    return mPos;
+}
+
+/**
+ * @brief CanReplay::setSpeed
+ * Set the replay speed.
+ *
+ * @param speed
+ * Factor relative to the captured timing, e.g. 1.0 for the original speed.
+ * 0 replays the frames as fast as possible, which can be used to measure the
+ * throughput of the code the frames are fed to.
+ */
+void CanReplay::setSpeed(double speed)
+{
+    mSpeed = qMax(speed, 0.0);
+}
+
+double CanReplay::speed() const
+{
+    return mSpeed;
+}
+
+void CanReplay::start()
+{
+    mPos = 0;
+    mElapsed.start();
+    mTimer->start(mSpeed > 0.0 ? 1 : 0);
+}
+
+void CanReplay::stop()
+{
+    mTimer->stop();
+}
+
+bool CanReplay::isRunning() const
+{
+    return mTimer->isActive();
+}
+
+void CanReplay::timerSlot()
+{
+    // The frames are always emitted in capture order. The speed only affects
+    // how many of them are emitted per tick.
+    if (mSpeed > 0.0) {
+        qint64 firstUs = mFrames.isEmpty() ? 0 : mFrames.first().timeUs;
+        double nowUs = double(mElapsed.nsecsElapsed()) / 1000.0 * mSpeed;
+
+        while (mPos < mFrames.size() &&
+               double(mFrames.at(mPos).timeUs - firstUs) <= nowUs) {
+            const CanCapture::Frame &f = mFrames.at(mPos++);
+            emit frameReplayed(f.data, f.id, f.isExtended);
+        }
+    } else {
+        int end = qMin(mPos + maxSpeedBatch, mFrames.size());
+        while (mPos < end) {
+            const CanCapture::Frame &f = mFrames.at(mPos++);
+            emit frameReplayed(f.data, f.id, f.isExtended);
+        }
+    }
+
+    if (mPos >= mFrames.size()) {
+        mTimer->stop();
+        emit finished(mPos, double(mElapsed.nsecsElapsed()) / 1e9);
+    }
+}
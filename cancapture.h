@@ -0,0 +1,130 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef CANCAPTURE_H
+#define CANCAPTURE_H
+
+#include <QObject>
+#include <QFile>
+#include <QTimer>
+#include <QVector>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+/*
+ * Capture files
+ *
+ * Binary (.vcan):
+ *   Header:  "VCAN", uint8 version, uint64 start time in ms since epoch
+ *   Records: uint8 flags, then
+ *            - flags bit 7 set: uint64 time in us since start (time sync)
+ *            - otherwise: uint32 time in us since the previous record,
+ *              uint32 ID if flags bit 6 (extended) is set, else uint16 ID,
+ *              and flags bits 0-3 bytes of data
+ *   All numbers are big endian.
+ *
+ * Text (.log): candump -l compatible, one "(sec.usec) iface ID#DATA" line per frame.
+ */
+namespace CanCapture
+{
+typedef enum {
+    FormatBinary = 0,
+    FormatCandump
+} Format;
+
+struct Frame {
+    qint64 timeUs;
+    quint32 id;
+    bool isExtended;
+    QByteArray data;
+};
+
+Format formatFromFileName(QString fileName);
+bool readFile(QString fileName, QVector<Frame> &frames, QString *errorStr = nullptr);
+}
+
+class CanCaptureWriter
+{
+public:
+    CanCaptureWriter();
+    ~CanCaptureWriter();
+
+    bool open(QString fileName, CanCapture::Format format);
+    bool open(QString fileName) {
+        return open(fileName, CanCapture::formatFromFileName(fileName));
+    }
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+
+    void writeFrame(const QByteArray &data, quint32 id, bool isExtended);
+    void flush();
+
+    quint64 framesWritten() const;
+    qint64 bytesWritten() const;
+
+private:
+    QFile mFile;
+    CanCapture::Format mFormat;
+    QByteArray mBuffer;
+    QElapsedTimer mTime;
+    QElapsedTimer mFlushTimer;
+    qint64 mStartMsEpoch;
+    qint64 mLastTimeUs;
+    quint64 mFramesWritten;
+    qint64 mBytesWritten;
+    QString mInterfaceName;
+
+};
+
+class CanReplay : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CanReplay(QObject *parent = nullptr);
+
+    bool loadFile(QString fileName, QString *errorStr = nullptr);
+    void setFrames(const QVector<CanCapture::Frame> &frames);
+    int frameCount() const;
+    int framesReplayed() const;
+
+    void setSpeed(double speed);
+    double speed() const;
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+signals:
+    void frameReplayed(QByteArray data, quint32 id, bool isExtended);
+    void finished(int frames, double seconds);
+
+private slots:
+    void timerSlot();
+
+private:
+    QVector<CanCapture::Frame> mFrames;
+    int mPos;
+    double mSpeed;
+    QTimer *mTimer;
+    QElapsedTimer mElapsed;
+
+};
+
+#endif // CANCAPTURE_H
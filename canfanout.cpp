@@ -0,0 +1,329 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "canfanout.h"
+#include "vescinterface.h"
+#include "utility.h"
+
+#include <QDebug>
+#include <QEventLoop>
+#include <QTimer>
+#include <QElapsedTimer>
+
+namespace {
+// Time to let late acks arrive before writing to the next device one at a time
+const int ackDrainMs = 50;
+}
+
+CanFanout::CanFanout(VescInterface *vesc)
+{
+    mVesc = vesc;
+}
+
+CanFanout::~CanFanout()
+{
+    restoreCan();
+}
+
+/**
+ * @brief CanFanout::restoreCan
+ * Go back to the CAN-forwarding state from before the first operation. Done
+ * automatically when the object is destroyed.
+ */
+void CanFanout::restoreCan()
+{
+    mVesc->canTmpOverrideEnd();
+}
+
+/**
+ * @brief CanFanout::probe
+ * Read the firmware version of the local device and the devices on the
+ * CAN-bus, and select the motor controllers among them as targets.
+ *
+ * @param canIds
+ * CAN-IDs of the devices, e.g. from VescInterface::scanCan.
+ *
+ * @param includeLocal
+ * Include the local device.
+ *
+ * @param requireSupportedFw
+ * Fail devices whose firmware is not supported by this version of VESC Tool.
+ *
+ * @return
+ * The number of targets that passed.
+ */
+int CanFanout::probe(QVector<int> canIds, bool includeLocal, bool requireSupportedFw)
+{
+    mNodes.clear();
+
+    QVector<int> ids;
+    if (includeLocal) {
+        ids.append(-1);
+    }
+    ids.append(canIds);
+
+    for (int id: ids) {
+        Node node;
+        node.canId = id;
+        node.ok = true;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        select(id);
+        bool rx = Utility::getFwVersionBlocking(mVesc, &node.fw);
+        node.timeMs = timer.elapsed();
+
+        if (!rx) {
+            fail(node, "No response when reading firmware version");
+        } else if (node.fw.hwType != HW_TYPE_VESC) {
+            continue;
+        } else if (requireSupportedFw &&
+                   !mVesc->getSupportedFirmwarePairs().contains(qMakePair(node.fw.major, node.fw.minor))) {
+            fail(node, QString("Firmware %1.%2 is not supported").
+                 arg(node.fw.major).arg(node.fw.minor, 2, 10, QLatin1Char('0')));
+        }
+
+        mNodes.append(node);
+    }
+
+    return targets().size();
+}
+
+QVector<int> CanFanout::targets() const
+{
+    QVector<int> res;
+    for (const auto &n: mNodes) {
+        if (n.ok) {
+            res.append(n.canId);
+        }
+    }
+    return res;
+}
+
+const QVector<CanFanout::Node> &CanFanout::nodes() const
+{
+    return mNodes;
+}
+
+bool CanFanout::allOk() const
+{
+    for (const auto &n: mNodes) {
+        if (!n.ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief CanFanout::forEach
+ * Run an operation on one target at a time, with CAN-forwarding set up for
+ * that target. Use this for everything that reads from the devices.
+ *
+ * @param op
+ * The operation. Returns false on failure, and can set node.error to say why.
+ *
+ * @param stopOnError
+ * Skip the remaining targets after the first failure.
+ *
+ * @return
+ * True if all nodes are ok afterwards.
+ */
+bool CanFanout::forEach(std::function<bool (Node &)> op, bool stopOnError)
+{
+    for (auto &n: mNodes) {
+        if (!n.ok) {
+            continue;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        select(n.canId);
+        bool res = op(n);
+        n.timeMs += timer.elapsed();
+
+        if (!res) {
+            fail(n, n.error.isEmpty() ? "Failed" : n.error);
+
+            if (stopOnError) {
+                break;
+            }
+        }
+    }
+
+    return allOk();
+}
+
+/**
+ * @brief CanFanout::writeAll
+ * Send a write to all targets back to back and wait until every target has
+ * acked it. If acks are missing, the write is repeated on one target at a
+ * time so that the targets that fail can be reported.
+ *
+ * @param send
+ * Sends the write to the node. CAN-forwarding is already set up.
+ *
+ * @param ack
+ * The ackReceived message of the write.
+ *
+ * @param timeoutMs
+ * Timeout per target.
+ *
+ * @return
+ * True if all nodes are ok afterwards.
+ */
+bool CanFanout::writeAll(std::function<void (const Node &)> send, QString ack, int timeoutMs)
+{
+    QVector<Node*> pending;
+    for (auto &n: mNodes) {
+        if (n.ok) {
+            pending.append(&n);
+        }
+    }
+
+    if (pending.isEmpty()) {
+        return allOk();
+    }
+
+    int acks = 0;
+    QEventLoop loop;
+    QTimer timeoutTimer;
+    timeoutTimer.setSingleShot(true);
+
+    auto conn1 = QObject::connect(mVesc->commands(), &Commands::ackReceived, [&](QString msg) {
+        if (msg == ack && ++acks >= pending.size()) {
+            loop.quit();
+        }
+    });
+    auto conn2 = QObject::connect(&timeoutTimer, SIGNAL(timeout()), &loop, SLOT(quit()));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (auto n: pending) {
+        select(n->canId);
+        send(*n);
+    }
+
+    // Never waits longer than sending the writes one at a time would
+    if (acks < pending.size()) {
+        timeoutTimer.start(timeoutMs * pending.size());
+        loop.exec();
+    }
+
+    QObject::disconnect(conn2);
+
+    // Acks that were on the way when the first round timed out still count
+    // for it. Whatever arrives after this is dropped before each retry.
+    if (acks < pending.size()) {
+        Utility::sleepWithEventLoop(ackDrainMs);
+    }
+
+    QObject::disconnect(conn1);
+
+    qint64 elapsed = timer.elapsed();
+
+    if (acks >= pending.size()) {
+        for (auto n: pending) {
+            n->timeMs += elapsed;
+        }
+        return allOk();
+    }
+
+    qWarning() << "CAN fan-out:" << acks << "of" << pending.size() <<
+                  "acks received, writing one device at a time";
+
+    bool armed = false;
+    bool gotAck = false;
+    auto conn3 = QObject::connect(mVesc->commands(), &Commands::ackReceived, [&](QString msg) {
+        if (armed && msg == ack) {
+            gotAck = true;
+            loop.quit();
+        }
+    });
+    auto conn4 = QObject::connect(&timeoutTimer, SIGNAL(timeout()), &loop, SLOT(quit()));
+
+    for (auto n: pending) {
+        QElapsedTimer nodeTimer;
+        nodeTimer.start();
+
+        // Drop late acks from the first round and from the previous device
+        // before sending, so that they are not taken as the ack of this write.
+        armed = false;
+        Utility::sleepWithEventLoop(ackDrainMs);
+
+        select(n->canId);
+        armed = true;
+        gotAck = false;
+        send(*n);
+
+        if (!gotAck) {
+            timeoutTimer.start(timeoutMs);
+            loop.exec();
+            timeoutTimer.stop();
+        }
+
+        armed = false;
+
+        if (!gotAck) {
+            fail(*n, "No response when writing");
+        }
+
+        n->timeMs += elapsed + nodeTimer.elapsed();
+    }
+
+    QObject::disconnect(conn3);
+    QObject::disconnect(conn4);
+
+    return allOk();
+}
+
+/**
+ * @brief CanFanout::report
+ * One line per node with the result and the time spent on it.
+ */
+QString CanFanout::report() const
+{
+    QString res;
+    for (const auto &n: mNodes) {
+        res += QString("%1: %2 (%3 ms)\n").
+                arg(nodeName(n.canId)).
+                arg(n.ok ? QString("OK") : n.error).
+                arg(n.timeMs);
+    }
+    return res;
+}
+
+QString CanFanout::nodeName(int canId)
+{
+    return canId < 0 ? QString("Local") : QString("CAN %1").arg(canId);
+}
+
+void CanFanout::select(int canId)
+{
+    mVesc->canTmpOverride(canId >= 0, canId);
+}
+
+void CanFanout::fail(Node &node, QString error)
+{
+    node.ok = false;
+    node.error = error;
+}
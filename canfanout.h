@@ -0,0 +1,82 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef CANFANOUT_H
+#define CANFANOUT_H
+
+#include <QVector>
+#include <QString>
+#include <functional>
+#include "datatypes.h"
+
+class VescInterface;
+
+/**
+ * @brief The CanFanout class
+ *
+ * Runs one operation on a set of devices on the CAN-bus, including the local
+ * device, and collects the result of every device in one report.
+ *
+ * Replies that are forwarded over CAN do not say which device they come from,
+ * and the local device only has one buffer for multi-frame replies, so
+ * requests that read something are sent to one device at a time. Writes only
+ * reply with a one-frame ack, so they are sent to all devices back to back and
+ * the acks are counted. This way the devices store their configuration at the
+ * same time instead of one after the other. If acks are missing, the writes
+ * are repeated one device at a time to find out which device failed.
+ *
+ * The firmware of every device is read once in probe(), and the operations
+ * only run on the devices that passed.
+ */
+class CanFanout
+{
+public:
+    struct Node {
+        int canId; // -1 for the local device
+        FW_RX_PARAMS fw;
+        bool ok;
+        QString error;
+        qint64 timeMs;
+    };
+
+    explicit CanFanout(VescInterface *vesc);
+    ~CanFanout();
+    void restoreCan();
+
+    int probe(QVector<int> canIds, bool includeLocal, bool requireSupportedFw = true);
+    QVector<int> targets() const;
+    const QVector<Node> &nodes() const;
+    bool allOk() const;
+
+    bool forEach(std::function<bool(Node &node)> op, bool stopOnError = true);
+    bool writeAll(std::function<void(const Node &node)> send, QString ack, int timeoutMs = 4000);
+
+    QString report() const;
+    static QString nodeName(int canId);
+
+private:
+    VescInterface *mVesc;
+    QVector<Node> mNodes;
+
+    void select(int canId);
+    void fail(Node &node, QString error);
+
+};
+
+#endif // CANFANOUT_H
@@ -0,0 +1,348 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "chunkfetch.h"
+
+namespace {
+// The first request only needs the total size
+const int firstChunkLen = 10;
+}
+
+ChunkFetch::ChunkFetch(std::function<void (int, int)> request, QObject *parent) :
+    QObject(parent), mRequest(request)
+{
+    mChunkSize = 400;
+    mWindow = 4;
+    mTries = 5;
+    mTimeoutMs = 1500;
+
+    mTotal = -1;
+    mReceived = 0;
+    mInFlight = 0;
+    mFinished = false;
+    mOk = false;
+    mAborted = false;
+    mLoop = nullptr;
+
+    mTimer = new QTimer(this);
+    mTimer->setInterval(50);
+    connect(mTimer, SIGNAL(timeout()), this, SLOT(timerSlot()));
+}
+
+void ChunkFetch::setChunkSize(int bytes)
+{
+    mChunkSize = qMax(bytes, firstChunkLen);
+}
+
+int ChunkFetch::chunkSize() const
+{
+    return mChunkSize;
+}
+
+/**
+ * @brief ChunkFetch::setWindow
+ * Set how many chunks can be requested at the same time. 1 waits for every
+ * chunk before requesting the next one.
+ */
+void ChunkFetch::setWindow(int chunks)
+{
+    mWindow = qMax(chunks, 1);
+}
+
+int ChunkFetch::window() const
+{
+    return mWindow;
+}
+
+/**
+ * @brief ChunkFetch::setRetries
+ * Set how many times a chunk is requested before giving up.
+ *
+ * @param tries
+ * Number of requests per chunk.
+ *
+ * @param timeoutMs
+ * Time to wait for a chunk before requesting it again.
+ */
+void ChunkFetch::setRetries(int tries, int timeoutMs)
+{
+    mTries = qMax(tries, 1);
+    mTimeoutMs = timeoutMs;
+}
+
+/**
+ * @brief ChunkFetch::start
+ * Start reading the blob. finished() is emitted when all chunks have arrived,
+ * a chunk has timed out on all tries or abort() is called.
+ */
+void ChunkFetch::start()
+{
+    mChunks.clear();
+    mData.clear();
+    mTotal = -1;
+    mReceived = 0;
+    mInFlight = 0;
+    mFinished = false;
+    mOk = false;
+    mAborted = false;
+
+    Chunk c;
+    c.len = firstChunkLen;
+    c.tries = 0;
+    c.state = ChunkPending;
+    mChunks.insert(0, c);
+
+    mTimer->start();
+    pump();
+}
+
+/**
+ * @brief ChunkFetch::fetch
+ * Read the whole blob. Runs an event loop until the fetch is finished.
+ *
+ * @return
+ * True if the whole blob was read.
+ */
+bool ChunkFetch::fetch()
+{
+    start();
+
+    if (!mFinished) {
+        QEventLoop loop;
+        mLoop = &loop;
+        loop.exec();
+        mLoop = nullptr;
+    }
+
+    return mOk;
+}
+
+bool ChunkFetch::isFinished() const
+{
+    return mFinished;
+}
+
+bool ChunkFetch::isOk() const
+{
+    return mOk;
+}
+
+QByteArray ChunkFetch::data() const
+{
+    return mData;
+}
+
+int ChunkFetch::totalSize() const
+{
+    return mTotal;
+}
+
+bool ChunkFetch::wasAborted() const
+{
+    return mAborted;
+}
+
+/**
+ * @brief ChunkFetch::fetchAll
+ * Start several fetches and run an event loop until all of them are finished.
+ * The fetches must have different reply signals.
+ *
+ * @return
+ * True if all blobs were read.
+ */
+bool ChunkFetch::fetchAll(const QVector<ChunkFetch *> &fetches)
+{
+    QEventLoop loop;
+
+    auto allFinished = [&fetches]() {
+        for (auto f: fetches) {
+            if (!f->isFinished()) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    QVector<QMetaObject::Connection> conns;
+    for (auto f: fetches) {
+        conns.append(connect(f, &ChunkFetch::finished, [&loop, &allFinished]() {
+            if (allFinished()) {
+                loop.quit();
+            }
+        }));
+    }
+
+    for (auto f: fetches) {
+        f->start();
+    }
+
+    if (!allFinished()) {
+        loop.exec();
+    }
+
+    for (auto c: conns) {
+        disconnect(c);
+    }
+
+    bool res = true;
+    for (auto f: fetches) {
+        res = res && f->isOk();
+    }
+    return res;
+}
+
+void ChunkFetch::chunkReceived(int totalLen, int offset, QByteArray data)
+{
+    if (mFinished || !mChunks.contains(offset)) {
+        return;
+    }
+
+    Chunk &chunk = mChunks[offset];
+
+    if (mTotal < 0) {
+        if (totalLen < 0) {
+            return;
+        }
+
+        mTotal = totalLen;
+        mData = QByteArray(mTotal, '\0');
+
+        for (int ofs = firstChunkLen;ofs < mTotal;ofs += mChunkSize) {
+            Chunk c;
+            c.len = qMin(mChunkSize, mTotal - ofs);
+            c.tries = 0;
+            c.state = ChunkPending;
+            mChunks.insert(ofs, c);
+        }
+    }
+
+    // Duplicates from retries and replies that do not fit are dropped
+    int len = qMin(chunk.len, mTotal - offset);
+    if (chunk.state == ChunkDone || totalLen != mTotal || data.size() != qMax(len, 0)) {
+        return;
+    }
+
+    if (chunk.state == ChunkInFlight) {
+        mInFlight--;
+    }
+
+    chunk.state = ChunkDone;
+    mData.replace(offset, data.size(), data);
+    mReceived += data.size();
+
+    emit progress(mReceived, mTotal);
+
+    if (mReceived >= mTotal) {
+        finish(true);
+    } else {
+        pump();
+    }
+}
+
+void ChunkFetch::abort()
+{
+    if (!mFinished) {
+        mAborted = true;
+        finish(false);
+    }
+}
+
+void ChunkFetch::timerSlot()
+{
+    if (mFinished) {
+        return;
+    }
+
+    QVector<int> timedOut;
+    for (auto it = mChunks.constBegin();it != mChunks.constEnd();++it) {
+        if (it.value().state == ChunkInFlight && it.value().sent.elapsed() >= mTimeoutMs) {
+            timedOut.append(it.key());
+        }
+    }
+
+    for (int ofs: timedOut) {
+        if (mFinished) {
+            break;
+        }
+
+        Chunk &c = mChunks[ofs];
+        if (c.state != ChunkInFlight) {
+            continue;
+        }
+
+        if (c.tries >= mTries) {
+            finish(false);
+            return;
+        }
+
+        send(ofs, c);
+    }
+}
+
+void ChunkFetch::send(int offset, Chunk &chunk)
+{
+    if (chunk.state != ChunkInFlight) {
+        chunk.state = ChunkInFlight;
+        mInFlight++;
+    }
+
+    chunk.tries++;
+    chunk.sent.start();
+    mRequest(chunk.len, offset);
+}
+
+void ChunkFetch::pump()
+{
+    // Until the total size is known only the first chunk exists. The
+    // offsets are collected first, as a reply can arrive while sending.
+    QVector<int> toSend;
+    for (auto it = mChunks.constBegin();it != mChunks.constEnd();++it) {
+        if (toSend.size() >= (mWindow - mInFlight)) {
+            break;
+        }
+
+        if (it.value().state == ChunkPending) {
+            toSend.append(it.key());
+        }
+    }
+
+    for (int ofs: toSend) {
+        if (mFinished) {
+            break;
+        }
+
+        Chunk &c = mChunks[ofs];
+        if (c.state == ChunkPending) {
+            send(ofs, c);
+        }
+    }
+}
+
+void ChunkFetch::finish(bool ok)
+{
+    mFinished = true;
+    mOk = ok;
+    mTimer->stop();
+
+    if (mLoop) {
+        mLoop->quit();
+    }
+
+    emit finished(ok);
+}
@@ -0,0 +1,117 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef CHUNKFETCH_H
+#define CHUNKFETCH_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QMap>
+#include <QVector>
+#include <QTimer>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <functional>
+
+/**
+ * @brief The ChunkFetch class
+ *
+ * Reads a blob that the firmware sends in chunks, such as the custom config
+ * XML, the QML UIs and the Lisp code. Every reply carries the total size and
+ * the offset of the chunk. Instead of waiting for each chunk before asking for
+ * the next one, up to window() chunks are requested at the same time and put
+ * in place as they arrive, in any order. Chunks that do not arrive in time
+ * are requested again.
+ *
+ * The reply signal of the blob has to be connected to chunkReceived(). Blobs
+ * with different reply signals can be fetched at the same time with
+ * fetchAll().
+ */
+class ChunkFetch : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ChunkFetch(std::function<void(int len, int offset)> request, QObject *parent = nullptr);
+
+    void setChunkSize(int bytes);
+    int chunkSize() const;
+    void setWindow(int chunks);
+    int window() const;
+    void setRetries(int tries, int timeoutMs);
+
+    void start();
+    bool fetch();
+    bool isFinished() const;
+    bool isOk() const;
+    QByteArray data() const;
+    int totalSize() const;
+    bool wasAborted() const;
+
+    static bool fetchAll(const QVector<ChunkFetch*> &fetches);
+
+signals:
+    void progress(int received, int total);
+    void finished(bool ok);
+
+public slots:
+    void chunkReceived(int totalLen, int offset, QByteArray data);
+    void abort();
+
+private slots:
+    void timerSlot();
+
+private:
+    typedef enum {
+        ChunkPending = 0,
+        ChunkInFlight,
+        ChunkDone
+    } ChunkState;
+
+    struct Chunk {
+        int len;
+        int tries;
+        ChunkState state;
+        QElapsedTimer sent;
+    };
+
+    std::function<void(int len, int offset)> mRequest;
+    int mChunkSize;
+    int mWindow;
+    int mTries;
+    int mTimeoutMs;
+
+    QMap<int, Chunk> mChunks;
+    QByteArray mData;
+    int mTotal;
+    int mReceived;
+    int mInFlight;
+    bool mFinished;
+    bool mOk;
+    bool mAborted;
+
+    QTimer *mTimer;
+    QEventLoop *mLoop;
+
+    void send(int offset, Chunk &chunk);
+    void pump();
+    void finish(bool ok);
+
+};
+
+#endif // CHUNKFETCH_H
@@ -20,6 +20,7 @@
 #include "codeloader.h"
 #include "qqmlcontext.h"
 #include "utility.h"
+#include "chunkfetch.h"
 #include <QEventLoop>
 #include <QFileDialog>
 #include <QMessageBox>
@@ -543,136 +544,115 @@ QString CodeLoader::lispRead(QWidget *parent, QString &lispPath)
         return "";
     }
 
-    QByteArray lispData;
-    int lenLispLast = 0;
-    auto conn = connect(mVesc->commands(), &Commands::lispReadCodeRx,
-                        [&](int lenLisp, int ofsLisp, QByteArray data) {
-        if (lispData.size() <= ofsLisp) {
-            lispData.append(data);
-        }
-        lenLispLast = lenLisp;
+    ChunkFetch fetch([this](int len, int offset) {
+        mVesc->commands()->lispReadCode(len, offset);
     });
 
-    auto getLispChunk = [&](int size, int offset, int tries, int timeout) {
-        bool res = false;
+    auto conn = connect(mVesc->commands(), &Commands::lispReadCodeRx, &fetch, &ChunkFetch::chunkReceived);
+    connect(&fetch, &ChunkFetch::progress, [this, &fetch](int received, int total) {
+        emit lispUploadProgress(received, total);
 
-        for (int j = 0;j < tries;j++) {
-            mVesc->commands()->lispReadCode(size, offset);
-            res = Utility::waitSignal(mVesc->commands(), SIGNAL(lispReadCodeRx(int,int,QByteArray)), timeout);
-            if (res) {
-                break;
-            }
+        if (mAbortDownloadUpload) {
+            fetch.abort();
         }
-        return res;
-    };
+    });
 
     QString res = "";
     mAbortDownloadUpload = false;
 
-    if (getLispChunk(10, 0, 5, 1500)) {
-        while (lispData.size() < lenLispLast && !mAbortDownloadUpload) {
-            int dataLeft = lenLispLast - lispData.size();
-            if (!getLispChunk(dataLeft > 400 ? 400 : dataLeft, lispData.size(), 5, 1500)) {
-                break;
-            }
+    bool fetchOk = fetch.fetch();
+    disconnect(conn);
 
-            emit lispUploadProgress(lispData.size(), lenLispLast);
-        }
+    if (fetch.wasAborted()) {
+        return res;
+    }
 
-        if (mAbortDownloadUpload) {
-            disconnect(conn);
-            return res;
-        }
+    if (fetchOk) {
+        QByteArray lispData = fetch.data();
+        auto unpacked = lispUnpackImports(lispData);
 
-        if (lispData.size() == lenLispLast) {
-            auto unpacked = lispUnpackImports(lispData);
-
-            res = unpacked.first;
-            auto num_imports = unpacked.second.length();
-
-            if (num_imports > 0) {
-                auto reply = QMessageBox::warning(parent,
-                                                  tr("Imports"),
-                                                  tr("%1 imports found. Do you want to save them as files?").arg(num_imports),
-                                                  QMessageBox::Yes | QMessageBox::No);
-
-                QMap<QString, QString> importPaths;
-                foreach (auto line, res.split('\n')) {
-                    QString path;
-                    QString tag;
-                    bool isInvalid;
-                    if (getImportFromLine(line, path, tag, isInvalid)) {
-                        if (!isInvalid) {
-                            importPaths.insert(tag, path);
-                        }
+        res = unpacked.first;
+        auto num_imports = unpacked.second.length();
+
+        if (num_imports > 0) {
+            auto reply = QMessageBox::warning(parent,
+                                              tr("Imports"),
+                                              tr("%1 imports found. Do you want to save them as files?").arg(num_imports),
+                                              QMessageBox::Yes | QMessageBox::No);
+
+            QMap<QString, QString> importPaths;
+            foreach (auto line, res.split('\n')) {
+                QString path;
+                QString tag;
+                bool isInvalid;
+                if (getImportFromLine(line, path, tag, isInvalid)) {
+                    if (!isInvalid) {
+                        importPaths.insert(tag, path);
                     }
                 }
+            }
 
-                if (reply == QMessageBox::Yes) {
-                    QString dirName = QFileDialog::getExistingDirectory(parent, tr("Choose Directory"));
+            if (reply == QMessageBox::Yes) {
+                QString dirName = QFileDialog::getExistingDirectory(parent, tr("Choose Directory"));
 
-                    if (!dirName.isEmpty()) {
-                        QFile fileLisp(dirName + "/From VESC.lbm");
-                        if (!fileLisp.exists()) {
-                            if (fileLisp.open(QIODevice::WriteOnly)) {
-                                fileLisp.write(res.toUtf8());
-                                fileLisp.close();
-                                lispPath = QFileInfo(fileLisp).canonicalFilePath();
-                            }
+                if (!dirName.isEmpty()) {
+                    QFile fileLisp(dirName + "/From VESC.lbm");
+                    if (!fileLisp.exists()) {
+                        if (fileLisp.open(QIODevice::WriteOnly)) {
+                            fileLisp.write(res.toUtf8());
+                            fileLisp.close();
+                            lispPath = QFileInfo(fileLisp).canonicalFilePath();
                         }
+                    }
 
-                        foreach (auto i, unpacked.second) {
-                            QString fileName = dirName + "/" + i.first + ".bin";
+                    foreach (auto i, unpacked.second) {
+                        QString fileName = dirName + "/" + i.first + ".bin";
 
-                            if (importPaths.contains(i.first)) {
-                                const auto &path = importPaths[i.first];
+                        if (importPaths.contains(i.first)) {
+                            const auto &path = importPaths[i.first];
 
-                                if (!path.startsWith("/") &&
-                                        !path.startsWith("\\") &&
-                                        !path.startsWith("pkg::") &&
-                                        !path.startsWith("pkg@")) {
-                                    fileName = dirName + "/" + path;
-                                }
+                            if (!path.startsWith("/") &&
+                                    !path.startsWith("\\") &&
+                                    !path.startsWith("pkg::") &&
+                                    !path.startsWith("pkg@")) {
+                                fileName = dirName + "/" + path;
                             }
+                        }
 
-                            QFile file(fileName);
-                            QFileInfo fi(file);
-                            QDir().mkpath(fi.path());
-
-                            if (file.exists()) {
-                                auto reply = QMessageBox::question(parent,
-                                                                   tr("Replace File"),
-                                                                   tr("File %1 exists. Do you want to replace it?").arg(i.first));
+                        QFile file(fileName);
+                        QFileInfo fi(file);
+                        QDir().mkpath(fi.path());
 
-                                if (reply != QMessageBox::Yes) {
-                                    continue;
-                                }
-                            }
+                        if (file.exists()) {
+                            auto reply = QMessageBox::question(parent,
+                                                               tr("Replace File"),
+                                                               tr("File %1 exists. Do you want to replace it?").arg(i.first));
 
-                            if (!file.open(QIODevice::WriteOnly)) {
-                                QMessageBox::critical(parent, tr("Save Import"),
-                                                      "Could not open\n" + file.fileName() + "\nfor writing");
-                                disconnect(conn);
-                                return QByteArray();
+                            if (reply != QMessageBox::Yes) {
+                                continue;
                             }
+                        }
 
-                            file.write(i.second);
-                            file.close();
+                        if (!file.open(QIODevice::WriteOnly)) {
+                            QMessageBox::critical(parent, tr("Save Import"),
+                                                  "Could not open\n" + file.fileName() + "\nfor writing");
+                            return QByteArray();
                         }
+
+                        file.write(i.second);
+                        file.close();
                     }
                 }
             }
-
-            return res;
         }
+
+        return res;
     }
 
     mVesc->emitMessageDialog(tr("Get LispBM"),
                              tr("Could not read LispBM code"),
                              false);
 
-    disconnect(conn);
-
     return "";
 }
 
@@ -1437,6 +1437,14 @@ void Commands::setMcconf(bool check)
     }
 }
 
+void Commands::setMcconfFrom(ConfigParams *conf)
+{
+    VByteArray vb;
+    vb.vbAppendInt8(COMM_SET_MCCONF);
+    conf->serialize(vb);
+    emitData(vb);
+}
+
 void Commands::getAppConf()
 {
     if (mTimeoutAppconf > 0) {
@@ -1473,6 +1481,14 @@ void Commands::setAppConf()
     }
 }
 
+void Commands::setAppConfFrom(ConfigParams *conf)
+{
+    VByteArray vb;
+    vb.vbAppendInt8(COMM_SET_APPCONF);
+    conf->serialize(vb);
+    emitData(vb);
+}
+
 void Commands::setAppConfNoStore()
 {
     if (mAppConfig) {
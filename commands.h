@@ -197,9 +197,11 @@ public slots:
     void getMcconf();
     void getMcconfDefault();
     void setMcconf(bool check = true);
+    void setMcconfFrom(ConfigParams *conf);
     void getAppConf();
     void getAppConfDefault();
     void setAppConf();
+    void setAppConfFrom(ConfigParams *conf);
     void setAppConfNoStore();
     void detectMotorParam(double current, double min_rpm, double low_duty);
     void reboot();
@@ -0,0 +1,565 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "configbackupstore.h"
+#include "lzokay/lzokay.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+const char blobFull = 'F';
+const char blobDelta = 'D';
+const int hashLen = 40;
+const int indexVersion = 1;
+
+// Deltas are always written against a full blob, so a valid store never
+// needs more than one level. The limit stops corrupt or cyclic bases.
+const int maxDeltaDepth = 4;
+
+// Backups kept per device. The oldest ones are removed first, together with
+// the blobs that no other backup uses.
+const int maxBackupsPerDevice = 50;
+
+const quint8 opCopy = 0;
+const quint8 opInsert = 1;
+
+const char *confKeys[3] = {"mcconf", "appconf", "customconf"};
+
+QByteArray hashOf(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+}
+
+/*
+ * Line based delta: runs of lines copied from the base and lines that are
+ * inserted as they are. Configurations of the same device only differ in a
+ * few values, so this is mostly a handful of long copies.
+ */
+QByteArray makeDelta(const QByteArray &base, const QByteArray &target)
+{
+    QList<QByteArray> baseLines = base.split('\n');
+    QList<QByteArray> targetLines = target.split('\n');
+
+    QHash<QByteArray, int> firstPos;
+    for (int i = baseLines.size() - 1;i >= 0;i--) {
+        firstPos.insert(baseLines.at(i), i);
+    }
+
+    QByteArray ops;
+    QDataStream out(&ops, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    int copyStart = 0;
+    int copyLen = 0;
+    int pos = 0;
+
+    auto flushCopy = [&]() {
+        if (copyLen > 0) {
+            out << opCopy << quint32(copyStart) << quint32(copyLen);
+            copyLen = 0;
+        }
+    };
+
+    for (const auto &line: targetLines) {
+        bool next = pos < baseLines.size() && baseLines.at(pos) == line;
+
+        if (next && copyLen > 0) {
+            copyLen++;
+            pos++;
+            continue;
+        }
+
+        flushCopy();
+
+        int found = next ? pos : firstPos.value(line, -1);
+        if (found >= 0) {
+            copyStart = found;
+            copyLen = 1;
+            pos = found + 1;
+        } else {
+            out << opInsert << line;
+        }
+    }
+
+    flushCopy();
+    return ops;
+}
+
+bool applyDelta(const QByteArray &base, const QByteArray &ops, QByteArray &res)
+{
+    QList<QByteArray> baseLines = base.split('\n');
+    QList<QByteArray> lines;
+
+    QDataStream in(ops);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    while (!in.atEnd()) {
+        quint8 op = 0;
+        in >> op;
+
+        if (op == opCopy) {
+            quint32 start = 0, len = 0;
+            in >> start >> len;
+
+            if (qint64(start) + qint64(len) > baseLines.size()) {
+                return false;
+            }
+
+            for (quint32 i = 0;i < len;i++) {
+                lines.append(baseLines.at(int(start + i)));
+            }
+        } else if (op == opInsert) {
+            QByteArray line;
+            in >> line;
+            lines.append(line);
+        } else {
+            return false;
+        }
+
+        if (in.status() != QDataStream::Ok) {
+            return false;
+        }
+    }
+
+    res = lines.join('\n');
+    return true;
+}
+}
+
+ConfigBackupStore::ConfigBackupStore()
+{
+
+}
+
+/**
+ * @brief ConfigBackupStore::open
+ * Open or create a store. Only the index is read.
+ *
+ * @param dir
+ * Directory of the store.
+ *
+ * @return
+ * True on success.
+ */
+bool ConfigBackupStore::open(QString dir)
+{
+    mDir.clear();
+    mIndex.clear();
+
+    if (!QDir().mkpath(dir + "/objects")) {
+        qWarning() << "Could not create backup directory" << dir;
+        return false;
+    }
+
+    mDir = dir;
+
+    QFile file(mDir + "/index.json");
+    if (!file.exists()) {
+        return true;
+    }
+
+    // Stay closed when the index cannot be read, so that it is not
+    // overwritten and the blobs it refers to are not pruned.
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not read backup index:" << file.errorString();
+        mDir.clear();
+        return false;
+    }
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != indexVersion) {
+        qWarning() << "Unsupported backup index version";
+        mDir.clear();
+        return false;
+    }
+
+    for (const auto &v: root.value("backups").toArray()) {
+        QJsonObject o = v.toObject();
+        Entry e;
+        e.uuid = o.value("uuid").toString();
+        e.name = o.value("name").toString();
+        e.timeMs = qint64(o.value("time").toDouble());
+        for (int i = 0;i < 3;i++) {
+            e.hash[i] = o.value(confKeys[i]).toString().toLatin1();
+        }
+        mIndex[e.uuid].append(e);
+    }
+
+    for (auto &h: mIndex) {
+        std::stable_sort(h.begin(), h.end(), [](const Entry &a, const Entry &b) {
+            return a.timeMs < b.timeMs;
+        });
+    }
+
+    return true;
+}
+
+bool ConfigBackupStore::isOpen() const
+{
+    return !mDir.isEmpty();
+}
+
+/**
+ * @brief ConfigBackupStore::addBackup
+ * Store a new backup for a device. Blobs that are already stored are reused,
+ * and changed blobs are stored as a delta to the previous backup of the same
+ * device when that is smaller.
+ *
+ * @param uuid
+ * UUID of the device.
+ *
+ * @param name
+ * Name of the backup.
+ *
+ * @param mcXml
+ * Motor configuration XML.
+ *
+ * @param appXml
+ * App configuration XML.
+ *
+ * @param customXml
+ * Custom configuration XML, empty if the device has none.
+ *
+ * @param timeMs
+ * Time of the backup in ms since epoch, -1 for now.
+ *
+ * @return
+ * True on success.
+ */
+bool ConfigBackupStore::addBackup(QString uuid, QString name, const QByteArray &mcXml,
+                                  const QByteArray &appXml, const QByteArray &customXml,
+                                  qint64 timeMs)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    Entry e;
+    e.uuid = uuid;
+    e.name = name;
+    e.timeMs = timeMs >= 0 ? timeMs : QDateTime::currentMSecsSinceEpoch();
+
+    Entry prev;
+    bool hasPrev = hasBackup(uuid);
+    if (hasPrev) {
+        prev = latest(uuid);
+    }
+
+    const QByteArray *data[3] = {&mcXml, &appXml, &customXml};
+    for (int i = 0;i < 3;i++) {
+        if (data[i]->isEmpty()) {
+            continue;
+        }
+
+        e.hash[i] = writeBlob(*data[i], hasPrev ? prev.hash[i] : QByteArray());
+        if (e.hash[i].isEmpty()) {
+            return false;
+        }
+    }
+
+    QVector<Entry> historyBefore = mIndex.value(uuid);
+    QVector<Entry> &h = mIndex[uuid];
+    h.append(e);
+
+    bool dropped = false;
+    while (h.size() > maxBackupsPerDevice) {
+        h.removeFirst();
+        dropped = true;
+    }
+
+    if (!saveIndex()) {
+        // Keep the index in memory the same as on disk, and remove the
+        // blobs that were written for this backup.
+        if (historyBefore.isEmpty()) {
+            mIndex.remove(uuid);
+        } else {
+            mIndex[uuid] = historyBefore;
+        }
+        pruneObjects();
+        return false;
+    }
+
+    if (dropped) {
+        pruneObjects();
+    }
+
+    return true;
+}
+
+bool ConfigBackupStore::hasBackup(QString uuid) const
+{
+    return mIndex.contains(uuid) && !mIndex.value(uuid).isEmpty();
+}
+
+QStringList ConfigBackupStore::uuids() const
+{
+    return mIndex.keys();
+}
+
+/**
+ * @brief ConfigBackupStore::history
+ * All backups of a device, the oldest first.
+ */
+QVector<ConfigBackupStore::Entry> ConfigBackupStore::history(QString uuid) const
+{
+    return mIndex.value(uuid);
+}
+
+ConfigBackupStore::Entry ConfigBackupStore::latest(QString uuid) const
+{
+    Entry e;
+    e.timeMs = -1;
+
+    if (hasBackup(uuid)) {
+        e = mIndex.value(uuid).last();
+    }
+
+    return e;
+}
+
+/**
+ * @brief ConfigBackupStore::readConf
+ * Read one of the configurations of a backup from disk.
+ *
+ * @return
+ * The XML, or an empty array if the backup does not have this configuration
+ * or if it could not be read.
+ */
+QByteArray ConfigBackupStore::readConf(const Entry &entry, ConfType type) const
+{
+    if (entry.hash[type].isEmpty()) {
+        return QByteArray();
+    }
+
+    return readBlob(entry.hash[type]);
+}
+
+void ConfigBackupStore::clear()
+{
+    mIndex.clear();
+
+    if (isOpen()) {
+        QDir(mDir + "/objects").removeRecursively();
+        QDir().mkpath(mDir + "/objects");
+        saveIndex();
+    }
+}
+
+/**
+ * @brief ConfigBackupStore::xmlFromLegacy
+ * Decode a configuration from ConfigParams::saveCompressed, which is how
+ * backups were stored in the settings before.
+ */
+QByteArray ConfigBackupStore::xmlFromLegacy(QString lzoBase64)
+{
+    QByteArray in = QByteArray::fromBase64(lzoBase64.toLocal8Bit());
+
+    if (in.isEmpty()) {
+        return QByteArray();
+    }
+
+    std::size_t outMaxSize = 2 * 1024 * 1024;
+    QByteArray out(int(outMaxSize), 0);
+    std::size_t outLen = 0;
+
+    lzokay::EResult error = lzokay::decompress((const uint8_t*)in.constData(), in.size(),
+                                               (uint8_t*)out.data(), outMaxSize, outLen);
+
+    if (error != lzokay::EResult::Success) {
+        return QByteArray();
+    }
+
+    out.truncate(int(outLen));
+    return out;
+}
+
+QString ConfigBackupStore::objectPath(const QByteArray &hash) const
+{
+    return mDir + "/objects/" + QString::fromLatin1(hash);
+}
+
+QByteArray ConfigBackupStore::fullBaseOf(const QByteArray &hash) const
+{
+    QFile file(objectPath(hash));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QByteArray head = file.read(1 + hashLen);
+    if (head.startsWith(blobFull)) {
+        return hash;
+    } else if (head.startsWith(blobDelta) && head.size() == 1 + hashLen) {
+        return head.mid(1);
+    }
+
+    return QByteArray();
+}
+
+QByteArray ConfigBackupStore::readBlob(const QByteArray &hash, int depth) const
+{
+    if (depth > maxDeltaDepth) {
+        qWarning() << "Backup blob delta chain too deep:" << hash;
+        return QByteArray();
+    }
+
+    QFile file(objectPath(hash));
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Backup blob missing:" << hash;
+        return QByteArray();
+    }
+
+    QByteArray blob = file.readAll();
+    QByteArray res;
+
+    if (blob.startsWith(blobFull)) {
+        res = qUncompress(blob.mid(1));
+    } else if (blob.startsWith(blobDelta) && blob.size() > 1 + hashLen) {
+        QByteArray base = readBlob(blob.mid(1, hashLen), depth + 1);
+        if (base.isEmpty() || !applyDelta(base, qUncompress(blob.mid(1 + hashLen)), res)) {
+            res.clear();
+        }
+    }
+
+    if (res.isEmpty() || hashOf(res) != hash) {
+        qWarning() << "Corrupt backup blob:" << hash;
+        return QByteArray();
+    }
+
+    return res;
+}
+
+QByteArray ConfigBackupStore::writeBlob(const QByteArray &data, const QByteArray &prevHash)
+{
+    QByteArray hash = hashOf(data);
+
+    if (QFileInfo::exists(objectPath(hash))) {
+        return hash;
+    }
+
+    QByteArray blob;
+    blob.append(blobFull);
+    blob.append(qCompress(data, 9));
+
+    // Deltas are always relative to a full blob, so reading a backup
+    // never needs more than two blobs.
+    if (!prevHash.isEmpty()) {
+        QByteArray baseHash = fullBaseOf(prevHash);
+        QByteArray base = baseHash.isEmpty() ? QByteArray() : readBlob(baseHash);
+
+        if (!base.isEmpty()) {
+            QByteArray delta;
+            delta.append(blobDelta);
+            delta.append(baseHash);
+            delta.append(qCompress(makeDelta(base, data), 9));
+
+            if (delta.size() < blob.size()) {
+                blob = delta;
+            }
+        }
+    }
+
+    QSaveFile file(objectPath(hash));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write backup blob:" << file.errorString();
+        return QByteArray();
+    }
+
+    file.write(blob);
+    if (!file.commit()) {
+        qWarning() << "Could not write backup blob:" << file.errorString();
+        return QByteArray();
+    }
+
+    return hash;
+}
+
+/**
+ * @brief ConfigBackupStore::pruneObjects
+ * Remove the blobs that no backup in the index uses, either directly or as
+ * the base of a delta.
+ */
+void ConfigBackupStore::pruneObjects() const
+{
+    QSet<QByteArray> used;
+    for (const auto &h: mIndex) {
+        for (const auto &e: h) {
+            for (int i = 0;i < 3;i++) {
+                if (e.hash[i].isEmpty() || used.contains(e.hash[i])) {
+                    continue;
+                }
+
+                used.insert(e.hash[i]);
+                QByteArray base = fullBaseOf(e.hash[i]);
+                if (!base.isEmpty()) {
+                    used.insert(base);
+                }
+            }
+        }
+    }
+
+    QDir objects(mDir + "/objects");
+    for (const auto &name: objects.entryList(QDir::Files)) {
+        if (!used.contains(name.toLatin1())) {
+            objects.remove(name);
+        }
+    }
+}
+
+bool ConfigBackupStore::saveIndex() const
+{
+    QJsonArray backups;
+    for (const auto &h: mIndex) {
+        for (const auto &e: h) {
+            QJsonObject o;
+            o.insert("uuid", e.uuid);
+            o.insert("name", e.name);
+            o.insert("time", double(e.timeMs));
+            for (int i = 0;i < 3;i++) {
+                o.insert(confKeys[i], QString::fromLatin1(e.hash[i]));
+            }
+            backups.append(o);
+        }
+    }
+
+    QJsonObject root;
+    root.insert("version", indexVersion);
+    root.insert("backups", backups);
+
+    QSaveFile file(mDir + "/index.json");
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write backup index:" << file.errorString();
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
@@ -0,0 +1,93 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef CONFIGBACKUPSTORE_H
+#define CONFIGBACKUPSTORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
+#include <QMap>
+
+/*
+ * Configuration backups on disk
+ *
+ * dir/index.json:   One entry per backup with the UUID, name, time and the
+ *                   hashes of the mcconf, appconf and custom config XML.
+ * dir/objects/HASH: The XML, addressed by the hex SHA-1 of its content, so
+ *                   identical configurations are only stored once. Starts
+ *                   with one byte:
+ *                   - 'F': the qCompress:ed content.
+ *                   - 'D': the 40 character hash of a full blob, followed by
+ *                     qCompress:ed line operations that rebuild the content
+ *                     from it. Used when a device is backed up again and the
+ *                     new XML is close to the previous one.
+ *
+ * Only the index is read when the store is opened; the blobs are read when
+ * a backup is restored. Each device keeps a limited number of backups, and
+ * blobs that no backup refers to anymore are removed.
+ */
+class ConfigBackupStore
+{
+public:
+    typedef enum {
+        ConfMc = 0,
+        ConfApp,
+        ConfCustom
+    } ConfType;
+
+    struct Entry {
+        QString uuid;
+        QString name;
+        qint64 timeMs;
+        QByteArray hash[3];
+    };
+
+    ConfigBackupStore();
+
+    bool open(QString dir);
+    bool isOpen() const;
+
+    bool addBackup(QString uuid, QString name, const QByteArray &mcXml,
+                   const QByteArray &appXml, const QByteArray &customXml,
+                   qint64 timeMs = -1);
+    bool hasBackup(QString uuid) const;
+    QStringList uuids() const;
+    QVector<Entry> history(QString uuid) const;
+    Entry latest(QString uuid) const;
+    QByteArray readConf(const Entry &entry, ConfType type) const;
+    void clear();
+
+    static QByteArray xmlFromLegacy(QString lzoBase64);
+
+private:
+    QString mDir;
+    QMap<QString, QVector<Entry> > mIndex;
+
+    QString objectPath(const QByteArray &hash) const;
+    QByteArray fullBaseOf(const QByteArray &hash) const;
+    QByteArray readBlob(const QByteArray &hash, int depth = 0) const;
+    QByteArray writeBlob(const QByteArray &data, const QByteArray &prevHash);
+    bool saveIndex() const;
+    void pruneObjects() const;
+
+};
+
+#endif // CONFIGBACKUPSTORE_H
@@ -28,10 +28,42 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QBuffer>
+#include <QDataStream>
 #include <cmath>
+#include <algorithm>
 #include "utility.h"
 #include "lzokay/lzokay.hpp"
 
+namespace {
+// Binary parameter files, see getParamsBinary
+const char binaryMagic[] = "VCFB";
+const quint8 binaryVersion = 1;
+const int binaryHeaderLen = 4 + 1;
+
+class StringTable {
+public:
+    quint32 add(const QString &str) {
+        auto it = mIndex.constFind(str);
+        if (it != mIndex.constEnd()) {
+            return it.value();
+        }
+
+        quint32 ind = quint32(mStrings.size());
+        mStrings.append(str);
+        mIndex.insert(str, ind);
+        return ind;
+    }
+
+    const QStringList &strings() const {
+        return mStrings;
+    }
+
+private:
+    QStringList mStrings;
+    QHash<QString, quint32> mIndex;
+};
+}
+
 ConfigParams::ConfigParams(QObject *parent) : QObject(parent)
 {
     mUpdateOnlyName.clear();
@@ -40,13 +72,22 @@ ConfigParams::ConfigParams(QObject *parent) : QObject(parent)
     mConfigVersion = -1;
     mStoreConfigVersion = true;
     mUpdateCnt = 0;
+    mSerialSignature = 0;
+    mSerialFixedSize = 0;
+    mSerialPlanValid = false;
+    mBatchDepth = 0;
 }
 
 void ConfigParams::addParam(const QString &name, ConfigParam param)
 {
-    if (!mParams.contains(name)) {
-        mParams.insert(name, param);
+    if (!mParamIds.contains(name)) {
+        syncExposed();
+        mParamIds.insert(name, mParams.size());
+        mParams.append(param);
+        mValues.append(valueFromParam(param));
+        mParamNames.append(name);
         mParamList.append(name);
+        mSerialPlanValid = false;
     } else {
         qWarning() << name << "already present.";
     }
@@ -54,7 +95,18 @@ void ConfigParams::addParam(const QString &name, ConfigParam param)
 
 void ConfigParams::deleteParam(const QString &name)
 {
-    mParams.remove(name);
+    int id = mParamIds.value(name, -1);
+
+    if (id >= 0) {
+        // Keep the slot, so that the IDs of the other parameters stay valid
+        syncExposed();
+        mParamIds.remove(name);
+        mParams[id] = ConfigParam();
+        mValues[id] = valueFromParam(mParams.at(id));
+        mParamNames[id].clear();
+        mSerialPlanValid = false;
+    }
+
     for (int i = 0;i < mParamList.size();i++) {
         if (mParamList.at(i) == name) {
             mParamList.removeAt(i);
@@ -93,7 +145,17 @@ void ConfigParams::setUpdatesEnabled(bool updatesEnabled)
 void ConfigParams::clearParams()
 {
     mParams.clear();
+    mParamNames.clear();
+    mParamIds.clear();
     mParamList.clear();
+    mValues.clear();
+    mExposedIds.clear();
+    mSerialPlanValid = false;
+
+    // Pending changes refer to the old IDs
+    mBatchIds.clear();
+    mBatchSrcs.clear();
+    mBatchPos.clear();
 }
 
 void ConfigParams::clearAll()
@@ -104,15 +166,47 @@ void ConfigParams::clearAll()
 
 bool ConfigParams::hasParam(const QString &name)
 {
-    return mParams.contains(name);
+    return mParamIds.contains(name);
+}
+
+/**
+ * @brief ConfigParams::paramId
+ * Look up the ID of a parameter. The ID can be used instead of the name
+ * in code that accesses the same parameters often, which avoids hashing the
+ * name on every access.
+ *
+ * IDs are assigned when the parameters are added and stay valid until they
+ * are cleared, e.g. when the parameter definitions are reloaded. Copies of
+ * the configuration use the same IDs.
+ *
+ * @param name
+ * The name of the parameter.
+ *
+ * @return
+ * The ID, or -1 if there is no parameter with that name.
+ */
+int ConfigParams::paramId(const QString &name) const
+{
+    return mParamIds.value(name, -1);
+}
+
+QString ConfigParams::paramName(int id) const
+{
+    return (id >= 0 && id < mParamNames.size()) ? mParamNames.at(id) : QString();
+}
+
+bool ConfigParams::hasParam(int id) const
+{
+    return id >= 0 && id < mParamNames.size() && !mParamNames.at(id).isEmpty();
 }
 
 ConfigParam *ConfigParams::getParam(const QString &name)
 {
     ConfigParam *retVal = nullptr;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        retVal = &mParams[name];
+    if (id >= 0) {
+        retVal = getParam(id);
     } else {
         qWarning() << name << "not found";
     }
@@ -120,12 +214,44 @@ ConfigParam *ConfigParams::getParam(const QString &name)
     return retVal;
 }
 
+ConfigParam *ConfigParams::getParam(int id)
+{
+    ConfigParam *retVal = nullptr;
+
+    if (hasParam(id)) {
+        // The caller can change the type and TX settings
+        mSerialPlanValid = false;
+
+        // The values live in mValues. Copy them to the parameter, and take
+        // them back from it on the next value access in case the caller
+        // changes them through the pointer. This detaches the metadata from
+        // copies of this configuration.
+        syncExposed();
+        ConfigParam &p = mParams[id];
+        const ParamValue &v = mValues.at(id);
+        p.valDouble = v.valDouble;
+        p.valInt = v.valInt;
+        p.valString = v.valString;
+        mExposedIds.append(id);
+        retVal = &p;
+    } else {
+        qWarning() << "parameter" << id << "not found";
+    }
+
+    return retVal;
+}
+
 ConfigParam ConfigParams::getParamCopy(const QString &name) const
 {
     ConfigParam retVal;
-
-    if (mParams.contains(name)) {
-        retVal = mParams.value(name);
+    int id = mParamIds.value(name, -1);
+
+    if (id >= 0) {
+        retVal = mParams.at(id);
+        const ParamValue &v = value(id);
+        retVal.valDouble = v.valDouble;
+        retVal.valInt = v.valInt;
+        retVal.valString = v.valString;
     } else {
         qWarning() << name << "not found";
     }
@@ -133,9 +259,51 @@ ConfigParam ConfigParams::getParamCopy(const QString &name) const
     return retVal;
 }
 
+ConfigParams::ParamValue ConfigParams::valueFromParam(const ConfigParam &param)
+{
+    ParamValue v;
+    v.valDouble = param.valDouble;
+    v.valInt = param.valInt;
+    v.valString = param.valString;
+    return v;
+}
+
+const ConfigParams::ParamValue &ConfigParams::value(int id) const
+{
+    syncExposed();
+    return mValues.at(id);
+}
+
+ConfigParams::ParamValue &ConfigParams::valueRef(int id)
+{
+    syncExposed();
+    return mValues[id];
+}
+
+/**
+ * @brief ConfigParams::syncExposed
+ * Take back the values of parameters handed out with getParam, as they
+ * might have been changed through the pointer.
+ */
+void ConfigParams::syncExposed() const
+{
+    if (mExposedIds.isEmpty()) {
+        return;
+    }
+
+    for (int id: mExposedIds) {
+        if (id < mParams.size()) {
+            mValues[id] = valueFromParam(mParams.at(id));
+        }
+    }
+
+    mExposedIds.clear();
+}
+
 bool ConfigParams::isParamDouble(const QString &name)
 {
-    if (mParams.contains(name) && mParams[name].type == CFG_T_DOUBLE) {
+    int id = mParamIds.value(name, -1);
+    if (id >= 0 && mParams.at(id).type == CFG_T_DOUBLE) {
         return true;
     } else {
         return false;
@@ -144,7 +312,8 @@ bool ConfigParams::isParamDouble(const QString &name)
 
 bool ConfigParams::isParamInt(const QString &name)
 {
-    if (mParams.contains(name) && mParams[name].type == CFG_T_INT) {
+    int id = mParamIds.value(name, -1);
+    if (id >= 0 && mParams.at(id).type == CFG_T_INT) {
         return true;
     } else {
         return false;
@@ -153,7 +322,8 @@ bool ConfigParams::isParamInt(const QString &name)
 
 bool ConfigParams::isParamEnum(const QString &name)
 {
-    if (mParams.contains(name) && mParams[name].type == CFG_T_ENUM) {
+    int id = mParamIds.value(name, -1);
+    if (id >= 0 && mParams.at(id).type == CFG_T_ENUM) {
         return true;
     } else {
         return false;
@@ -162,7 +332,8 @@ bool ConfigParams::isParamEnum(const QString &name)
 
 bool ConfigParams::isParamQString(const QString &name)
 {
-    if (mParams.contains(name) && mParams[name].type == CFG_T_QSTRING) {
+    int id = mParamIds.value(name, -1);
+    if (id >= 0 && mParams.at(id).type == CFG_T_QSTRING) {
         return true;
     } else {
         return false;
@@ -171,7 +342,8 @@ bool ConfigParams::isParamQString(const QString &name)
 
 bool ConfigParams::isParamBool(const QString &name)
 {
-    if (mParams.contains(name) && mParams[name].type == CFG_T_BOOL) {
+    int id = mParamIds.value(name, -1);
+    if (id >= 0 && mParams.at(id).type == CFG_T_BOOL) {
         return true;
     } else {
         return false;
@@ -180,7 +352,8 @@ bool ConfigParams::isParamBool(const QString &name)
 
 bool ConfigParams::isParamBitfield(const QString &name)
 {
-    if (mParams.contains(name) && mParams[name].type == CFG_T_BITFIELD) {
+    int id = mParamIds.value(name, -1);
+    if (id >= 0 && mParams.at(id).type == CFG_T_BITFIELD) {
         return true;
     } else {
         return false;
@@ -188,99 +361,164 @@ bool ConfigParams::isParamBitfield(const QString &name)
 }
 
 double ConfigParams::getParamDouble(const QString &name)
+{
+    int id = mParamIds.value(name, -1);
+
+    if (id < 0) {
+        qWarning() << name << "not found";
+        return 0.0;
+    }
+
+    return getParamDouble(id);
+}
+
+double ConfigParams::getParamDouble(int id)
 {
     double retVal = 0.0;
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (hasParam(id)) {
+        const ConfigParam &p = mParams.at(id);
+        const ParamValue &v = value(id);
 
         if (p.type == CFG_T_DOUBLE) {
-            retVal = p.valDouble;
+            retVal = v.valDouble;
         } else if (p.type == CFG_T_INT) {
-            retVal = double(p.valInt);
+            retVal = double(v.valInt);
         } else {
-            qWarning() << name << "wrong type";
+            qWarning() << mParamNames.at(id) << "wrong type";
         }
     } else {
-        qWarning() << name << "not found";
+        qWarning() << "parameter" << id << "not found";
     }
 
     return retVal;
 }
 
 int ConfigParams::getParamInt(const QString &name)
+{
+    int id = mParamIds.value(name, -1);
+
+    if (id < 0) {
+        qWarning() << name << "not found";
+        return 0;
+    }
+
+    return getParamInt(id);
+}
+
+int ConfigParams::getParamInt(int id)
 {
     int retVal = 0;
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (hasParam(id)) {
+        const ConfigParam &p = mParams.at(id);
+        const ParamValue &v = value(id);
 
         if (p.type == CFG_T_INT || p.type == CFG_T_BITFIELD) {
-            retVal = p.valInt;
+            retVal = v.valInt;
         } else if (p.type == CFG_T_DOUBLE) {
-            retVal = int(p.valDouble);
+            retVal = int(v.valDouble);
         } else {
-            qWarning() << name << "wrong type";
+            qWarning() << mParamNames.at(id) << "wrong type";
         }
     } else {
-        qWarning() << name << "not found";
+        qWarning() << "parameter" << id << "not found";
     }
 
     return retVal;
 }
 
 int ConfigParams::getParamEnum(const QString &name)
+{
+    int id = mParamIds.value(name, -1);
+
+    if (id < 0) {
+        qWarning() << name << "not found";
+        return 0;
+    }
+
+    return getParamEnum(id);
+}
+
+int ConfigParams::getParamEnum(int id)
 {
     int retVal = 0;
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (hasParam(id)) {
+        const ConfigParam &p = mParams.at(id);
+        const ParamValue &v = value(id);
 
         if (p.type == CFG_T_ENUM) {
-            retVal = p.valInt;
+            retVal = v.valInt;
         } else {
-            qWarning() << name << "wrong type";
+            qWarning() << mParamNames.at(id) << "wrong type";
         }
     } else {
-        qWarning() << name << "not found";
+        qWarning() << "parameter" << id << "not found";
     }
 
     return retVal;
 }
 
 QString ConfigParams::getParamQString(const QString &name)
+{
+    int id = mParamIds.value(name, -1);
+
+    if (id < 0) {
+        qWarning() << name << "not found";
+        return "";
+    }
+
+    return getParamQString(id);
+}
+
+QString ConfigParams::getParamQString(int id)
 {
     QString retVal = "";
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (hasParam(id)) {
+        const ConfigParam &p = mParams.at(id);
+        const ParamValue &v = value(id);
 
         if (p.type == CFG_T_QSTRING) {
-            retVal = p.valString;
+            retVal = v.valString;
         } else {
-            qWarning() << name << "wrong type";
+            qWarning() << mParamNames.at(id) << "wrong type";
         }
     } else {
-        qWarning() << name << "not found";
+        qWarning() << "parameter" << id << "not found";
     }
 
     return retVal;
 }
 
 bool ConfigParams::getParamBool(const QString &name)
+{
+    int id = mParamIds.value(name, -1);
+
+    if (id < 0) {
+        qWarning() << name << "not found";
+        return false;
+    }
+
+    return getParamBool(id);
+}
+
+bool ConfigParams::getParamBool(int id)
 {
     bool retVal = false;
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (hasParam(id)) {
+        const ConfigParam &p = mParams.at(id);
+        const ParamValue &v = value(id);
 
         if (p.type == CFG_T_BOOL) {
-            retVal = p.valInt;
+            retVal = v.valInt;
         } else {
-            qWarning() << name << "wrong type";
+            qWarning() << mParamNames.at(id) << "wrong type";
         }
     } else {
-        qWarning() << name << "not found";
+        qWarning() << "parameter" << id << "not found";
     }
 
     return retVal;
@@ -289,9 +527,10 @@ bool ConfigParams::getParamBool(const QString &name)
 QString ConfigParams::getLongName(const QString &name)
 {
     QString retVal = "";
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        retVal = mParams[name].longName;
+    if (id >= 0) {
+        retVal = mParams.at(id).longName;
     } else {
         qWarning() << name << "not found";
     }
@@ -302,9 +541,10 @@ QString ConfigParams::getLongName(const QString &name)
 QString ConfigParams::getDescription(const QString &name)
 {
     QString retVal = "";
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        retVal = mParams[name].description;
+    if (id >= 0) {
+        retVal = mParams.at(id).description;
     } else {
         qWarning() << name << "not found";
     }
@@ -315,9 +555,10 @@ QString ConfigParams::getDescription(const QString &name)
 double ConfigParams::getParamMaxDouble(const QString &name)
 {
     double retVal = 0.0;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (id >= 0) {
+        const ConfigParam &p = mParams.at(id);
 
         if (p.type == CFG_T_DOUBLE) {
             retVal = p.maxDouble;
@@ -334,9 +575,10 @@ double ConfigParams::getParamMaxDouble(const QString &name)
 double ConfigParams::getParamMinDouble(const QString &name)
 {
     double retVal = 0.0;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (id >= 0) {
+        const ConfigParam &p = mParams.at(id);
 
         if (p.type == CFG_T_DOUBLE) {
             retVal = p.minDouble;
@@ -353,9 +595,10 @@ double ConfigParams::getParamMinDouble(const QString &name)
 double ConfigParams::getParamStepDouble(const QString &name)
 {
     double retVal = 0.0;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (id >= 0) {
+        const ConfigParam &p = mParams.at(id);
 
         if (p.type == CFG_T_DOUBLE) {
             retVal = p.stepDouble;
@@ -372,9 +615,10 @@ double ConfigParams::getParamStepDouble(const QString &name)
 int ConfigParams::getParamDecimalsDouble(const QString &name)
 {
     int retVal = 0;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (id >= 0) {
+        const ConfigParam &p = mParams.at(id);
 
         if (p.type == CFG_T_DOUBLE) {
             retVal = p.editorDecimalsDouble;
@@ -391,9 +635,10 @@ int ConfigParams::getParamDecimalsDouble(const QString &name)
 int ConfigParams::getParamMaxInt(const QString &name)
 {
     int retVal = 0;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (id >= 0) {
+        const ConfigParam &p = mParams.at(id);
 
         if (p.type == CFG_T_INT) {
             retVal = p.maxInt;
@@ -410,9 +655,10 @@ int ConfigParams::getParamMaxInt(const QString &name)
 int ConfigParams::getParamMinInt(const QString &name)
 {
     int retVal = 0;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (id >= 0) {
+        const ConfigParam &p = mParams.at(id);
 
         if (p.type == CFG_T_INT) {
             retVal = p.minInt;
@@ -429,9 +675,10 @@ int ConfigParams::getParamMinInt(const QString &name)
 int ConfigParams::getParamStepInt(const QString &name)
 {
     int retVal = 0;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (id >= 0) {
+        const ConfigParam &p = mParams.at(id);
 
         if (p.type == CFG_T_INT) {
             retVal = p.stepInt;
@@ -448,9 +695,10 @@ int ConfigParams::getParamStepInt(const QString &name)
 int ConfigParams::getParamMaxLen(const QString &name)
 {
     int retVal = 0;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (id >= 0) {
+        const ConfigParam &p = mParams.at(id);
 
         if (p.type == CFG_T_QSTRING) {
             retVal = p.maxLen;
@@ -467,9 +715,10 @@ int ConfigParams::getParamMaxLen(const QString &name)
 QStringList ConfigParams::getParamEnumNames(const QString &name)
 {
     QStringList retVal;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (id >= 0) {
+        const ConfigParam &p = mParams.at(id);
 
         if (p.type == CFG_T_ENUM || p.type == CFG_T_BITFIELD) {
             retVal = p.enumNames;
@@ -486,9 +735,10 @@ QStringList ConfigParams::getParamEnumNames(const QString &name)
 double ConfigParams::getParamEditorScale(const QString &name)
 {
     double retVal = 0.0;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        retVal = mParams[name].editorScale;
+    if (id >= 0) {
+        retVal = mParams.at(id).editorScale;
     } else {
         qWarning() << name << "not found";
     }
@@ -499,9 +749,10 @@ double ConfigParams::getParamEditorScale(const QString &name)
 QString ConfigParams::getParamSuffix(const QString &name)
 {
     QString retVal = "";
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        retVal = mParams[name].suffix;
+    if (id >= 0) {
+        retVal = mParams.at(id).suffix;
     } else {
         qWarning() << name << "not found";
     }
@@ -512,9 +763,10 @@ QString ConfigParams::getParamSuffix(const QString &name)
 bool ConfigParams::getParamEditAsPercentage(const QString &name)
 {
     bool retVal = false;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        retVal = mParams[name].editAsPercentage;
+    if (id >= 0) {
+        retVal = mParams.at(id).editAsPercentage;
     } else {
         qWarning() << name << "not found";
     }
@@ -525,9 +777,10 @@ bool ConfigParams::getParamEditAsPercentage(const QString &name)
 bool ConfigParams::getParamShowDisplay(const QString &name)
 {
     bool retVal = false;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        retVal = mParams[name].showDisplay;
+    if (id >= 0) {
+        retVal = mParams.at(id).showDisplay;
     } else {
         qWarning() << name << "not found";
     }
@@ -538,9 +791,10 @@ bool ConfigParams::getParamShowDisplay(const QString &name)
 bool ConfigParams::getParamTransmittable(const QString &name)
 {
     bool retVal = false;
+    int id = mParamIds.value(name, -1);
 
-    if (mParams.contains(name)) {
-        retVal = mParams[name].transmittable;
+    if (id >= 0) {
+        retVal = mParams.at(id).transmittable;
     } else {
         qWarning() << name << "not found";
     }
@@ -563,8 +817,10 @@ QWidget *ConfigParams::getEditor(const QString &name, QWidget *parent)
 {
     QWidget *retVal = 0;
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    int id = mParamIds.value(name, -1);
+
+    if (id >= 0) {
+        const ConfigParam &p = mParams.at(id);
 
         switch (p.type) {
         case CFG_T_DOUBLE: {
@@ -630,277 +886,407 @@ QWidget *ConfigParams::getEditor(const QString &name, QWidget *parent)
 
 void ConfigParams::getParamSerial(VByteArray &vb, const QString &name)
 {
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    int id = mParamIds.value(name, -1);
 
-        switch (p.type) {
-        case CFG_T_UNDEFINED:
-            qWarning() << name << ": type not defined.";
-            break;
-
-        case CFG_T_DOUBLE:
-            if (p.vTx == VESC_TX_DOUBLE16) {
-                vb.vbAppendDouble16(p.valDouble, p.vTxDoubleScale);
-            } else if (p.vTx == VESC_TX_DOUBLE32) {
-                vb.vbAppendDouble32(p.valDouble, p.vTxDoubleScale);
-            } else if (p.vTx == VESC_TX_DOUBLE32_AUTO) {
-                vb.vbAppendDouble32Auto(p.valDouble);
-            } else {
-                qWarning() << name << ": wrong tx type set.";
-            }
-            break;
+    if (id >= 0) {
+        getParamSerial(vb, id);
+    } else {
+        qWarning() << name << "not found";
+    }
+}
 
-        case CFG_T_INT:
-            if (p.vTx == VESC_TX_UINT8) {
-                vb.vbAppendUint8(p.valInt);
-            } else if (p.vTx == VESC_TX_INT8) {
-                vb.vbAppendInt8(p.valInt);
-            } else if (p.vTx == VESC_TX_UINT16) {
-                vb.vbAppendUint16(p.valInt);
-            } else if (p.vTx == VESC_TX_INT16) {
-                vb.vbAppendInt16(p.valInt);
-            } else if (p.vTx == VESC_TX_UINT32) {
-                vb.vbAppendUint32(p.valInt);
-            } else if (p.vTx == VESC_TX_INT32) {
-                vb.vbAppendInt32(p.valInt);
-            } else {
-                qWarning() << name << ": wrong tx type set.";
-            }
-            break;
+void ConfigParams::getParamSerial(VByteArray &vb, int id)
+{
+    if (hasParam(id)) {
+        appendSerial(vb, serialEntry(id));
+    } else {
+        qWarning() << "parameter" << id << "not found";
+    }
+}
 
-        case CFG_T_QSTRING:
-            vb.vbAppendString(p.valString);
-            break;
+void ConfigParams::setParamSerial(VByteArray &vb, const QString &name, QObject *src)
+{
+    int id = mParamIds.value(name, -1);
 
-        case CFG_T_ENUM:
-        case CFG_T_BOOL:
-        case CFG_T_BITFIELD:
-            vb.vbAppendInt8(p.valInt);
-            break;
-        }
+    if (id >= 0) {
+        setParamSerial(vb, id, src);
     } else {
         qWarning() << name << "not found";
     }
 }
 
-void ConfigParams::setParamSerial(VByteArray &vb, const QString &name, QObject *src)
+void ConfigParams::setParamSerial(VByteArray &vb, int id, QObject *src)
 {
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
+    if (hasParam(id)) {
+        const QString &name = mParamNames.at(id);
+        bool update = mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name);
+        popSerial(vb, serialEntry(id), update, src);
+    } else {
+        qWarning() << "parameter" << id << "not found";
+    }
+}
 
-        switch (p.type) {
-        case CFG_T_UNDEFINED:
-            qWarning() << name << ": type not defined.";
-            break;
+/**
+ * @brief ConfigParams::serialEntry
+ * The type and TX settings of a parameter, as used by the serialization.
+ */
+ConfigParams::SerialEntry ConfigParams::serialEntry(int id) const
+{
+    SerialEntry e;
+    e.id = id;
+    e.type = CFG_T_UNDEFINED;
+    e.vTx = VESC_TX_UNDEFINED;
+    e.scale = 1.0;
 
-        case CFG_T_DOUBLE: {
-            double val = 0.0;
-            if (p.vTx == VESC_TX_DOUBLE16) {
-                val = vb.vbPopFrontDouble16(p.vTxDoubleScale);
-            } else if (p.vTx == VESC_TX_DOUBLE32) {
-                val = vb.vbPopFrontDouble32(p.vTxDoubleScale);
-            } else if (p.vTx == VESC_TX_DOUBLE32_AUTO) {
-                val = vb.vbPopFrontDouble32Auto();
-            } else {
-                qWarning() << name << ": wrong tx type set.";
-            }
+    if (hasParam(id)) {
+        const ConfigParam &p = mParams.at(id);
+        e.type = p.type;
+        e.vTx = p.vTx;
+        e.scale = p.vTxDoubleScale;
+    }
 
-            if (mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name)) {
-                if (p.valDouble != val) {
-                    p.valDouble = val;
-                    emit paramChangedDouble(src, name, val);
-                }
-            }
-        } break;
+    return e;
+}
 
-        case CFG_T_INT:
-        case CFG_T_BITFIELD: {
-            int val = 0;
-
-            if (p.vTx == VESC_TX_UINT8 || p.type == CFG_T_BITFIELD) {
-                val = vb.vbPopFrontUint8();
-            } else if (p.vTx == VESC_TX_INT8) {
-                val = vb.vbPopFrontInt8();
-            } else if (p.vTx == VESC_TX_UINT16) {
-                val = vb.vbPopFrontUint16();
-            } else if (p.vTx == VESC_TX_INT16) {
-                val = vb.vbPopFrontInt16();
-            } else if (p.vTx == VESC_TX_UINT32) {
-                val = vb.vbPopFrontUint32();
-            } else if (p.vTx == VESC_TX_INT32) {
-                val = vb.vbPopFrontInt32();
-            } else {
-                qWarning() << name << ": wrong tx type set.";
-            }
+void ConfigParams::appendSerial(VByteArray &vb, const SerialEntry &e) const
+{
+    const ParamValue &v = value(e.id);
 
-            if (mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name)) {
-                if (p.valInt != val) {
-                    p.valInt = val;
-                    emit paramChangedInt(src, name, val);
-                }
-            }
-        } break;
+    switch (e.type) {
+    case CFG_T_UNDEFINED:
+        qWarning() << mParamNames.at(e.id) << ": type not defined.";
+        break;
 
-        case CFG_T_QSTRING: {
-            QString val = vb.vbPopFrontString();
+    case CFG_T_DOUBLE:
+        if (e.vTx == VESC_TX_DOUBLE16) {
+            vb.vbAppendDouble16(v.valDouble, e.scale);
+        } else if (e.vTx == VESC_TX_DOUBLE32) {
+            vb.vbAppendDouble32(v.valDouble, e.scale);
+        } else if (e.vTx == VESC_TX_DOUBLE32_AUTO) {
+            vb.vbAppendDouble32Auto(v.valDouble);
+        } else {
+            qWarning() << mParamNames.at(e.id) << ": wrong tx type set.";
+        }
+        break;
 
-            if (mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name)) {
-                if (p.valString != val) {
-                    p.valString = val;
-                    emit paramChangedQString(src, name, val);
-                }
-            }
-        } break;
+    case CFG_T_INT:
+        if (e.vTx == VESC_TX_UINT8) {
+            vb.vbAppendUint8(v.valInt);
+        } else if (e.vTx == VESC_TX_INT8) {
+            vb.vbAppendInt8(v.valInt);
+        } else if (e.vTx == VESC_TX_UINT16) {
+            vb.vbAppendUint16(v.valInt);
+        } else if (e.vTx == VESC_TX_INT16) {
+            vb.vbAppendInt16(v.valInt);
+        } else if (e.vTx == VESC_TX_UINT32) {
+            vb.vbAppendUint32(v.valInt);
+        } else if (e.vTx == VESC_TX_INT32) {
+            vb.vbAppendInt32(v.valInt);
+        } else {
+            qWarning() << mParamNames.at(e.id) << ": wrong tx type set.";
+        }
+        break;
 
-        case CFG_T_ENUM:
-        case CFG_T_BOOL: {
-            int val = vb.vbPopFrontInt8();
+    case CFG_T_QSTRING:
+        vb.vbAppendString(v.valString);
+        break;
 
-            if (mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name)) {
-                if (p.valInt != val) {
-                    p.valInt = val;
-                    if (p.type == CFG_T_BOOL) {
-                        emit paramChangedBool(src, name, val);
-                    } else {
-                        emit paramChangedEnum(src, name, val);
-                    }
-                }
-            }
-        } break;
+    case CFG_T_ENUM:
+    case CFG_T_BOOL:
+    case CFG_T_BITFIELD:
+        vb.vbAppendInt8(v.valInt);
+        break;
+    }
+}
+
+void ConfigParams::popSerial(VByteArray &vb, const SerialEntry &e, bool update, QObject *src)
+{
+    const QString &name = mParamNames.at(e.id);
+
+    switch (e.type) {
+    case CFG_T_UNDEFINED:
+        qWarning() << name << ": type not defined.";
+        break;
+
+    case CFG_T_DOUBLE: {
+        double val = 0.0;
+        if (e.vTx == VESC_TX_DOUBLE16) {
+            val = vb.vbPopFrontDouble16(e.scale);
+        } else if (e.vTx == VESC_TX_DOUBLE32) {
+            val = vb.vbPopFrontDouble32(e.scale);
+        } else if (e.vTx == VESC_TX_DOUBLE32_AUTO) {
+            val = vb.vbPopFrontDouble32Auto();
+        } else {
+            qWarning() << name << ": wrong tx type set.";
         }
-    } else {
-        qWarning() << name << "not found";
+
+        if (update && value(e.id).valDouble != val) {
+            valueRef(e.id).valDouble = val;
+            paramChanged(e.id, src);
+        }
+    } break;
+
+    case CFG_T_INT:
+    case CFG_T_BITFIELD: {
+        int val = 0;
+
+        if (e.vTx == VESC_TX_UINT8 || e.type == CFG_T_BITFIELD) {
+            val = vb.vbPopFrontUint8();
+        } else if (e.vTx == VESC_TX_INT8) {
+            val = vb.vbPopFrontInt8();
+        } else if (e.vTx == VESC_TX_UINT16) {
+            val = vb.vbPopFrontUint16();
+        } else if (e.vTx == VESC_TX_INT16) {
+            val = vb.vbPopFrontInt16();
+        } else if (e.vTx == VESC_TX_UINT32) {
+            val = vb.vbPopFrontUint32();
+        } else if (e.vTx == VESC_TX_INT32) {
+            val = vb.vbPopFrontInt32();
+        } else {
+            qWarning() << name << ": wrong tx type set.";
+        }
+
+        if (update && value(e.id).valInt != val) {
+            valueRef(e.id).valInt = val;
+            paramChanged(e.id, src);
+        }
+    } break;
+
+    case CFG_T_QSTRING: {
+        QString val = vb.vbPopFrontString();
+
+        if (update && value(e.id).valString != val) {
+            valueRef(e.id).valString = val;
+            paramChanged(e.id, src);
+        }
+    } break;
+
+    case CFG_T_ENUM:
+    case CFG_T_BOOL: {
+        int val = vb.vbPopFrontInt8();
+
+        if (update && value(e.id).valInt != val) {
+            valueRef(e.id).valInt = val;
+            paramChanged(e.id, src);
+        }
+    } break;
     }
 }
 
 void ConfigParams::updateParamDouble(QString name, double param, QObject *src)
 {
+    int id = mParamIds.value(name, -1);
+
+    if (id >= 0) {
+        updateParamDouble(id, param, src);
+    } else if (mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name)) {
+        qWarning() << name << "not found";
+    }
+}
+
+void ConfigParams::updateParamDouble(int id, double param, QObject *src)
+{
+    if (!hasParam(id)) {
+        qWarning() << "parameter" << id << "not found";
+        return;
+    }
+
+    const QString &name = mParamNames.at(id);
+
     if (!mUpdatesEnabled || (!mUpdateOnlyName.isEmpty() && mUpdateOnlyName != name)) {
         return;
     }
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
-        if (p.type == CFG_T_DOUBLE) {
-            if (p.valDouble != param) {
-                p.valDouble = param;
-                emit paramChangedDouble(src, name, param);
-            }
-        } else {
-            qWarning() << name << "wrong type";
+    const ConfigParam &p = mParams.at(id);
+    ParamValue &v = valueRef(id);
+    if (p.type == CFG_T_DOUBLE) {
+        if (v.valDouble != param) {
+            v.valDouble = param;
+            paramChanged(id, src);
         }
     } else {
-        qWarning() << name << "not found";
+        qWarning() << name << "wrong type";
     }
 }
 
 void ConfigParams::updateParamInt(QString name, int param, QObject *src)
 {
+    int id = mParamIds.value(name, -1);
+
+    if (id >= 0) {
+        updateParamInt(id, param, src);
+    } else if (mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name)) {
+        qWarning() << name << "not found";
+    }
+}
+
+void ConfigParams::updateParamInt(int id, int param, QObject *src)
+{
+    if (!hasParam(id)) {
+        qWarning() << "parameter" << id << "not found";
+        return;
+    }
+
+    const QString &name = mParamNames.at(id);
+
     if (!mUpdatesEnabled || (!mUpdateOnlyName.isEmpty() && mUpdateOnlyName != name)) {
         return;
     }
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
-        if (p.type == CFG_T_INT || p.type == CFG_T_BITFIELD) {
-            if (p.valInt != param) {
-                p.valInt = param;
-                emit paramChangedInt(src, name, param);
-            }
-        } else {
-            qWarning() << name << "wrong type";
+    const ConfigParam &p = mParams.at(id);
+    ParamValue &v = valueRef(id);
+    if (p.type == CFG_T_INT || p.type == CFG_T_BITFIELD) {
+        if (v.valInt != param) {
+            v.valInt = param;
+            paramChanged(id, src);
         }
     } else {
-        qWarning() << name << "not found";
+        qWarning() << name << "wrong type";
     }
 }
 
 void ConfigParams::updateParamEnum(QString name, int param, QObject *src)
 {
+    int id = mParamIds.value(name, -1);
+
+    if (id >= 0) {
+        updateParamEnum(id, param, src);
+    } else if (mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name)) {
+        qWarning() << name << "not found";
+    }
+}
+
+void ConfigParams::updateParamEnum(int id, int param, QObject *src)
+{
+    if (!hasParam(id)) {
+        qWarning() << "parameter" << id << "not found";
+        return;
+    }
+
+    const QString &name = mParamNames.at(id);
+
     if (!mUpdatesEnabled || (!mUpdateOnlyName.isEmpty() && mUpdateOnlyName != name)) {
         return;
     }
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
-        if (p.type == CFG_T_ENUM) {
-            if (p.valInt != param) {
-                p.valInt = param;
-                emit paramChangedEnum(src, name, param);
-            }
-        } else {
-            qWarning() << name << "wrong type";
+    const ConfigParam &p = mParams.at(id);
+    ParamValue &v = valueRef(id);
+    if (p.type == CFG_T_ENUM) {
+        if (v.valInt != param) {
+            v.valInt = param;
+            paramChanged(id, src);
         }
     } else {
+        qWarning() << name << "wrong type";
+    }
+}
+
+void ConfigParams::updateParamString(QString name, QString param, QObject *src)
+{
+    int id = mParamIds.value(name, -1);
+
+    if (id >= 0) {
+        updateParamString(id, param, src);
+    } else if (mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name)) {
         qWarning() << name << "not found";
     }
 }
 
-void ConfigParams::updateParamString(QString name, QString param, QObject *src)
-{
+void ConfigParams::updateParamString(int id, QString param, QObject *src)
+{
+    if (!hasParam(id)) {
+        qWarning() << "parameter" << id << "not found";
+        return;
+    }
+
+    const QString &name = mParamNames.at(id);
+
     if (!mUpdatesEnabled || (!mUpdateOnlyName.isEmpty() && mUpdateOnlyName != name)) {
         return;
     }
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
-        if (p.type == CFG_T_QSTRING) {
-            param.truncate(p.maxLen);
-            if (p.valString != param) {
-                p.valString = param;
-                emit paramChangedQString(src, name, param);
-            }
-        } else {
-            qWarning() << name << "wrong type";
+    const ConfigParam &p = mParams.at(id);
+    ParamValue &v = valueRef(id);
+    if (p.type == CFG_T_QSTRING) {
+        param.truncate(p.maxLen);
+        if (v.valString != param) {
+            v.valString = param;
+            paramChanged(id, src);
         }
     } else {
-        qWarning() << name << "not found";
+        qWarning() << name << "wrong type";
     }
 }
 
 void ConfigParams::updateParamBool(QString name, bool param, QObject *src)
 {
+    int id = mParamIds.value(name, -1);
+
+    if (id >= 0) {
+        updateParamBool(id, param, src);
+    } else if (mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name)) {
+        qWarning() << name << "not found";
+    }
+}
+
+void ConfigParams::updateParamBool(int id, bool param, QObject *src)
+{
+    if (!hasParam(id)) {
+        qWarning() << "parameter" << id << "not found";
+        return;
+    }
+
+    const QString &name = mParamNames.at(id);
+
     if (!mUpdatesEnabled || (!mUpdateOnlyName.isEmpty() && mUpdateOnlyName != name)) {
         return;
     }
 
-    if (mParams.contains(name)) {
-        ConfigParam &p = mParams[name];
-        if (p.type == CFG_T_BOOL) {
-            if (p.valInt != param) {
-                p.valInt = param;
-                emit paramChangedBool(src, name, param);
-            }
-        } else {
-            qWarning() << name << "wrong type";
+    const ConfigParam &p = mParams.at(id);
+    ParamValue &v = valueRef(id);
+    if (p.type == CFG_T_BOOL) {
+        if (v.valInt != param) {
+            v.valInt = param;
+            paramChanged(id, src);
         }
     } else {
-        qWarning() << name << "not found";
+        qWarning() << name << "wrong type";
     }
 }
 
 void ConfigParams::updateParamFromOther(QString name, const ConfigParam &other, QObject *src)
+{
+    int id = mParamIds.value(name, -1);
+
+    if (id >= 0) {
+        updateParamFromOther(id, other, src);
+    } else if (mUpdatesEnabled && (mUpdateOnlyName.isEmpty() || mUpdateOnlyName == name)) {
+        qWarning() << name << "not found";
+    }
+}
+
+void ConfigParams::updateParamFromOther(int id, const ConfigParam &other, QObject *src)
 {
     switch (other.type) {
     case CFG_T_DOUBLE: {
-        updateParamDouble(name, other.valDouble, src);
+        updateParamDouble(id, other.valDouble, src);
     } break;
 
     case CFG_T_INT:
     case CFG_T_BITFIELD: {
-        updateParamInt(name, other.valInt, src);
+        updateParamInt(id, other.valInt, src);
     } break;
 
     case CFG_T_ENUM: {
-        updateParamEnum(name, other.valInt, src);
+        updateParamEnum(id, other.valInt, src);
     } break;
 
     case CFG_T_QSTRING: {
-        updateParamString(name, other.valString, src);
+        updateParamString(id, other.valString, src);
     } break;
 
     case CFG_T_BOOL: {
-        updateParamBool(name, other.valInt, src);
+        updateParamBool(id, other.valInt, src);
     } break;
 
     default:
@@ -908,6 +1294,124 @@ void ConfigParams::updateParamFromOther(QString name, const ConfigParam &other,
     }
 }
 
+/**
+ * @brief ConfigParams::beginUpdate
+ * Start a batch of parameter changes. Until the matching endUpdate, changes
+ * are collected instead of being announced one by one. Calls can be nested;
+ * the changes are announced when the outermost batch ends.
+ */
+void ConfigParams::beginUpdate()
+{
+    mBatchDepth++;
+}
+
+/**
+ * @brief ConfigParams::endUpdate
+ * End a batch of parameter changes started with beginUpdate. The
+ * per-parameter change signals are emitted for all parameters that changed,
+ * with their final values, followed by one paramChangeSet per source.
+ */
+void ConfigParams::endUpdate()
+{
+    if (mBatchDepth <= 0) {
+        qWarning() << "endUpdate without beginUpdate";
+        return;
+    }
+
+    mBatchDepth--;
+    if (mBatchDepth > 0 || mBatchIds.isEmpty()) {
+        return;
+    }
+
+    QVector<int> ids = mBatchIds;
+    QVector<QObject*> srcs = mBatchSrcs;
+    mBatchIds.clear();
+    mBatchSrcs.clear();
+    mBatchPos.clear();
+
+    for (int i = 0;i < ids.size();i++) {
+        emitParamChanged(ids.at(i), srcs.at(i));
+    }
+
+    // Almost always there is only one source, so this is cheap
+    QVector<QObject*> srcsDone;
+    for (auto src: srcs) {
+        if (srcsDone.contains(src)) {
+            continue;
+        }
+        srcsDone.append(src);
+
+        QVector<int> srcIds;
+        for (int i = 0;i < ids.size();i++) {
+            if (srcs.at(i) == src) {
+                srcIds.append(ids.at(i));
+            }
+        }
+
+        std::sort(srcIds.begin(), srcIds.end());
+        emit paramChangeSet(src, srcIds);
+    }
+}
+
+bool ConfigParams::isUpdating() const
+{
+    return mBatchDepth > 0;
+}
+
+void ConfigParams::paramChanged(int id, QObject *src)
+{
+    if (mBatchDepth > 0) {
+        int pos = mBatchPos.value(id, -1);
+        if (pos >= 0) {
+            mBatchSrcs[pos] = src;
+        } else {
+            mBatchPos.insert(id, mBatchIds.size());
+            mBatchIds.append(id);
+            mBatchSrcs.append(src);
+        }
+    } else {
+        emitParamChanged(id, src);
+        emit paramChangeSet(src, QVector<int>() << id);
+    }
+}
+
+void ConfigParams::emitParamChanged(int id, QObject *src)
+{
+    if (!hasParam(id)) {
+        return;
+    }
+
+    const ConfigParam &p = mParams.at(id);
+    const ParamValue &v = value(id);
+    const QString &name = mParamNames.at(id);
+
+    switch (p.type) {
+    case CFG_T_DOUBLE:
+        emit paramChangedDouble(src, name, v.valDouble);
+        break;
+
+    case CFG_T_INT:
+    case CFG_T_BITFIELD:
+        emit paramChangedInt(src, name, v.valInt);
+        break;
+
+    case CFG_T_ENUM:
+        emit paramChangedEnum(src, name, v.valInt);
+        break;
+
+    case CFG_T_QSTRING:
+        emit paramChangedQString(src, name, v.valString);
+        break;
+
+    case CFG_T_BOOL:
+        emit paramChangedBool(src, name, v.valInt);
+        break;
+
+    default:
+        break;
+    }
+}
+
 void ConfigParams::requestUpdate()
 {
     emit updateRequested();
@@ -986,34 +1490,118 @@ QStringList ConfigParams::getSerializeOrder() const
 void ConfigParams::setSerializeOrder(const QStringList &serializeOrder)
 {
     mSerializeOrder = serializeOrder;
+    mSerialPlanValid = false;
 }
 
 void ConfigParams::clearSerializeOrder()
 {
     mSerializeOrder.clear();
+    mSerialPlanValid = false;
 }
 
-void ConfigParams::serialize(VByteArray &vb)
+/**
+ * @brief ConfigParams::serialPlan
+ * The serialization order resolved to parameter IDs and TX settings. The
+ * signature and the size of the fixed-size fields are calculated at the same
+ * time. Everything is rebuilt only after the parameters or the order have
+ * changed, so serializing and deserializing is a loop over this list.
+ */
+const QVector<ConfigParams::SerialEntry> &ConfigParams::serialPlan()
 {
-    vb.vbAppendUint32(getSignature());
+    if (mSerialPlanValid) {
+        return mSerialPlan;
+    }
 
+    mSerialPlan.resize(mSerializeOrder.size());
+    mSerialFixedSize = 4;
+
+    QString sigStr;
     for (int i = 0;i < mSerializeOrder.size();i++) {
-        getParamSerial(vb, mSerializeOrder.at(i));
+        const QString &s = mSerializeOrder.at(i);
+        SerialEntry e = serialEntry(mParamIds.value(s, -1));
+        mSerialPlan[i] = e;
+
+        sigStr.append(s);
+
+        if (e.id < 0) {
+            qWarning() << s << "not found";
+            continue;
+        }
+
+        sigStr.append(QString("%1").arg(int(e.type)));
+        sigStr.append(QString("%1").arg(int(e.vTx)));
+        for (auto n: mParams.at(e.id).enumNames) {
+            sigStr.append(n);
+        }
+
+        switch (e.type) {
+        case CFG_T_DOUBLE:
+            mSerialFixedSize += e.vTx == VESC_TX_DOUBLE16 ? 2 : 4;
+            break;
+
+        case CFG_T_INT:
+            if (e.vTx == VESC_TX_UINT8 || e.vTx == VESC_TX_INT8) {
+                mSerialFixedSize += 1;
+            } else if (e.vTx == VESC_TX_UINT16 || e.vTx == VESC_TX_INT16) {
+                mSerialFixedSize += 2;
+            } else {
+                mSerialFixedSize += 4;
+            }
+            break;
+
+        case CFG_T_ENUM:
+        case CFG_T_BOOL:
+        case CFG_T_BITFIELD:
+            mSerialFixedSize += 1;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    QByteArray bytes = sigStr.toUtf8();
+    mSerialSignature = Utility::crc32c((uint8_t*)bytes.data(), bytes.size());
+    mSerialPlanValid = true;
+
+    return mSerialPlan;
+}
+
+void ConfigParams::serialize(VByteArray &vb)
+{
+    const QVector<SerialEntry> &plan = serialPlan();
+
+    vb.reserve(vb.size() + mSerialFixedSize);
+    vb.vbAppendUint32(mSerialSignature);
+
+    for (const auto &e: plan) {
+        if (e.id >= 0) {
+            appendSerial(vb, e);
+        }
     }
 }
 
 bool ConfigParams::deSerialize(VByteArray &vb)
 {
+    const QVector<SerialEntry> &plan = serialPlan();
     auto signature = vb.vbPopFrontUint32();
 
-    if (signature != getSignature()) {
+    if (signature != mSerialSignature) {
         qWarning() << "Invalid signature";
         return false;
     }
 
-    for (int i = 0;i < mSerializeOrder.size();i++) {
-        setParamSerial(vb, mSerializeOrder.at(i));
+    // Resolve the update filter once instead of comparing names per parameter
+    int onlyId = mUpdateOnlyName.isEmpty() ? -1 : mParamIds.value(mUpdateOnlyName, -2);
+
+    beginUpdate();
+    for (const auto &e: plan) {
+        if (e.id >= 0) {
+            bool update = mUpdatesEnabled && (onlyId == -1 || onlyId == e.id);
+            popSerial(vb, e, update, nullptr);
+        }
     }
+    endUpdate();
 
     mConfigVersion = VT_CONFIG_VERSION;
 
@@ -1030,7 +1618,13 @@ void ConfigParams::getXML(QXmlStreamWriter &stream, QString configName)
     }
 
     for (QString s: mParamList) {
-        const ConfigParam p = mParams[s];
+        int id = mParamIds.value(s, -1);
+        if (id < 0) {
+            continue;
+        }
+
+        const ConfigParam &p = mParams.at(id);
+        const ParamValue &v = value(id);
         QString name = s;
 
         switch (p.type) {
@@ -1038,15 +1632,15 @@ void ConfigParams::getXML(QXmlStreamWriter &stream, QString configName)
         case CFG_T_ENUM:
         case CFG_T_INT:
         case CFG_T_BITFIELD:
-            stream.writeTextElement(name, QString::number(p.valInt));
+            stream.writeTextElement(name, QString::number(v.valInt));
             break;
 
         case CFG_T_DOUBLE:
-            stream.writeTextElement(name, QString::number(p.valDouble));
+            stream.writeTextElement(name, QString::number(v.valDouble));
             break;
 
         case CFG_T_QSTRING:
-            stream.writeTextElement(name, p.valString);
+            stream.writeTextElement(name, v.valString);
             break;
 
         case CFG_T_UNDEFINED:
@@ -1070,52 +1664,55 @@ bool ConfigParams::setXML(QXmlStreamReader &stream, QString configName)
 
     if (nameFound) {
         mConfigVersion = -1;
+        beginUpdate();
 
         while (stream.readNextStartElement()) {
             QString name = stream.name().toString();
+            int id = mParamIds.value(name, -1);
 
             if (name == "ConfigVersion") {
                 mConfigVersion = stream.readElementText().toInt();
-            } else if (mParams.contains(name)) {
-                ConfigParam &p = mParams[name];
+            } else if (id >= 0) {
+                const ConfigParam &p = mParams.at(id);
+                ParamValue &v = valueRef(id);
                 QString text = stream.readElementText();
                 int valInt = text.toInt();
                 double valDouble = text.toDouble();
 
                 switch (p.type) {
                 case CFG_T_BOOL:
-                    if (valInt != p.valInt) {
-                        p.valInt = valInt;
-                        emit paramChangedBool(nullptr, name, valInt);
+                    if (valInt != v.valInt) {
+                        v.valInt = valInt;
+                        paramChanged(id, nullptr);
                     }
                     break;
 
                 case CFG_T_ENUM:
-                    if (valInt != p.valInt) {
-                        p.valInt = valInt;
-                        emit paramChangedEnum(nullptr, name, valInt);
+                    if (valInt != v.valInt) {
+                        v.valInt = valInt;
+                        paramChanged(id, nullptr);
                     }
                     break;
 
                 case CFG_T_INT:
                 case CFG_T_BITFIELD:
-                    if (valInt != p.valInt) {
-                        p.valInt = valInt;
-                        emit paramChangedInt(nullptr, name, valInt);
+                    if (valInt != v.valInt) {
+                        v.valInt = valInt;
+                        paramChanged(id, nullptr);
                     }
                     break;
 
                 case CFG_T_DOUBLE:
-                    if (valDouble != p.valDouble) {
-                        p.valDouble = valDouble;
-                        emit paramChangedDouble(nullptr, name, valDouble);
+                    if (valDouble != v.valDouble) {
+                        v.valDouble = valDouble;
+                        paramChanged(id, nullptr);
                     }
                     break;
 
                 case CFG_T_QSTRING:
-                    if (text != p.valString) {
-                        p.valString = text;
-                        emit paramChangedQString(nullptr, name, text);
+                    if (text != v.valString) {
+                        v.valString = text;
+                        paramChanged(id, nullptr);
                     }
                     break;
 
@@ -1134,6 +1731,7 @@ bool ConfigParams::setXML(QXmlStreamReader &stream, QString configName)
             }
         }
 
+        endUpdate();
         mXmlStatus = tr("OK");
         emit updated();
         return true;
@@ -1195,15 +1793,27 @@ QString ConfigParams::xmlStatus()
     return mXmlStatus;
 }
 
-QString ConfigParams::saveCompressed(QString configName)
+QByteArray ConfigParams::getXmlData(QString configName)
 {
-    QString result;
-
     QByteArray data;
     QXmlStreamWriter stream(&data);
     stream.setCodec("UTF-8");
     stream.setAutoFormatting(true);
     getXML(stream, configName);
+    return data;
+}
+
+bool ConfigParams::setXmlData(const QByteArray &data, QString configName)
+{
+    QXmlStreamReader stream(data);
+    return setXML(stream, configName);
+}
+
+QString ConfigParams::saveCompressed(QString configName)
+{
+    QString result;
+
+    QByteArray data = getXmlData(configName);
 
     std::size_t outMaxSize = lzokay::compress_worst_size(data.size());
     unsigned char *out = new unsigned char[outMaxSize];
@@ -1237,8 +1847,7 @@ bool ConfigParams::loadCompressed(QString data, QString configName)
     delete[] out;
 
     if (error == lzokay::EResult::Success) {
-        QXmlStreamReader stream(xmlData);
-        res = setXML(stream, configName);
+        res = setXmlData(xmlData, configName);
     }
 
     return res;
@@ -1252,7 +1861,9 @@ void ConfigParams::getParamsXML(QXmlStreamWriter &stream)
 
     for (int i = 0;i < mParamList.size();i++) {
         QString paramName = mParamList.at(i);
-        ConfigParam *p = getParam(paramName);
+        int id = paramId(paramName);
+        const ConfigParam *p = &mParams.at(id);
+        const ParamValue &v = value(id);
 
         stream.writeStartElement(paramName);
 
@@ -1271,7 +1882,7 @@ void ConfigParams::getParamsXML(QXmlStreamWriter &stream)
             stream.writeTextElement("minDouble", QString::number(p->minDouble));
             stream.writeTextElement("showDisplay", QString::number(p->showDisplay));
             stream.writeTextElement("stepDouble", QString::number(p->stepDouble));
-            stream.writeTextElement("valDouble", QString::number(p->valDouble));
+            stream.writeTextElement("valDouble", QString::number(v.valDouble));
             stream.writeTextElement("vTxDoubleScale", QString::number(p->vTxDoubleScale));
             stream.writeTextElement("suffix", p->suffix);
             stream.writeTextElement("vTx", QString::number(p->vTx));
@@ -1284,26 +1895,26 @@ void ConfigParams::getParamsXML(QXmlStreamWriter &stream)
             stream.writeTextElement("minInt", QString::number(p->minInt));
             stream.writeTextElement("showDisplay", QString::number(p->showDisplay));
             stream.writeTextElement("stepInt", QString::number(p->stepInt));
-            stream.writeTextElement("valInt", QString::number(p->valInt));
+            stream.writeTextElement("valInt", QString::number(v.valInt));
             stream.writeTextElement("suffix", p->suffix);
             stream.writeTextElement("vTx", QString::number(p->vTx));
             break;
 
         case CFG_T_QSTRING:
-            stream.writeTextElement("valString", p->valString);
+            stream.writeTextElement("valString", v.valString);
             stream.writeTextElement("maxLen", QString::number(p->maxLen));
             break;
 
         case CFG_T_ENUM:
         case CFG_T_BITFIELD:
-            stream.writeTextElement("valInt", QString::number(p->valInt));
+            stream.writeTextElement("valInt", QString::number(v.valInt));
             for (int j = 0;j < p->enumNames.size();j++) {
                 stream.writeTextElement("enumNames", p->enumNames.at(j));
             }
             break;
 
         case CFG_T_BOOL:
-            stream.writeTextElement("valInt", QString::number(p->valInt));
+            stream.writeTextElement("valInt", QString::number(v.valInt));
             break;
 
         default:
@@ -1431,6 +2042,7 @@ bool ConfigParams::setParamsXML(QXmlStreamReader &stream)
                 }
             } else if (nameFirst == "SerOrder") {
                 mSerializeOrder.clear();
+                mSerialPlanValid = false;
                 while (stream.readNextStartElement()) {
                     QString name = stream.name().toString();
 
@@ -1567,6 +2179,264 @@ bool ConfigParams::loadCompressedParamsXml(QByteArray data)
     return res;
 }
 
+/**
+ * @brief ConfigParams::getParamsBinary
+ * Get the parameter definitions in a compact binary format with the same
+ * content as getParamsXML. All strings are stored once in a string table
+ * and referred to by index, and the result is compressed. Loading this is
+ * much faster than parsing the XML.
+ *
+ * @return
+ * The binary parameter definitions.
+ */
+QByteArray ConfigParams::getParamsBinary()
+{
+    StringTable st;
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    out << quint32(mParamList.size());
+    for (const auto &name: mParamList) {
+        int id = paramId(name);
+        const ConfigParam &p = mParams.at(id);
+        const ParamValue &v = value(id);
+
+        out << st.add(name) << qint8(p.type) << qint8(p.vTx);
+        out << st.add(p.longName) << st.add(p.description) << st.add(p.cDefine);
+        out << st.add(v.valString) << st.add(p.suffix);
+        out << v.valDouble << p.maxDouble << p.minDouble << p.stepDouble;
+        out << p.vTxDoubleScale << p.editorScale;
+        out << qint32(v.valInt) << qint32(p.maxInt) << qint32(p.minInt) << qint32(p.stepInt);
+        out << qint32(p.maxLen) << qint32(p.editorDecimalsDouble);
+        out << p.editAsPercentage << p.showDisplay << p.transmittable;
+
+        out << quint32(p.enumNames.size());
+        for (const auto &e: p.enumNames) {
+            out << st.add(e);
+        }
+    }
+
+    out << quint32(mSerializeOrder.size());
+    for (const auto &s: mSerializeOrder) {
+        out << st.add(s);
+    }
+
+    out << quint32(mParamGrouping.size());
+    for (const auto &g: mParamGrouping) {
+        out << st.add(g.first) << quint32(g.second.size());
+        for (const auto &sg: g.second) {
+            out << st.add(sg.first) << quint32(sg.second.size());
+            for (const auto &n: sg.second) {
+                out << st.add(n);
+            }
+        }
+    }
+
+    QByteArray payload;
+    QDataStream outPayload(&payload, QIODevice::WriteOnly);
+    outPayload.setVersion(QDataStream::Qt_5_0);
+    outPayload << st.strings();
+    payload.append(body);
+
+    QByteArray res(binaryMagic);
+    res.append(char(binaryVersion));
+    res.append(qCompress(payload, 9));
+    return res;
+}
+
+/**
+ * @brief ConfigParams::setParamsBinary
+ * Load parameter definitions created by getParamsBinary.
+ *
+ * @param data
+ * The binary parameter definitions.
+ *
+ * @return
+ * True on success.
+ */
+bool ConfigParams::setParamsBinary(const QByteArray &data)
+{
+    if (data.size() < binaryHeaderLen || !data.startsWith(binaryMagic)) {
+        mXmlStatus = tr("Not a binary parameter file");
+        qWarning() << mXmlStatus;
+        return false;
+    }
+
+    if (quint8(data.at(4)) != binaryVersion) {
+        mXmlStatus = tr("Unsupported binary parameter file version");
+        qWarning() << mXmlStatus;
+        return false;
+    }
+
+    QByteArray payload = qUncompress(data.mid(binaryHeaderLen));
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    QStringList strings;
+    in >> strings;
+
+    bool ok = true;
+    auto str = [&in, &strings, &ok]() {
+        quint32 ind = 0;
+        in >> ind;
+        if (ind >= quint32(strings.size())) {
+            ok = false;
+            return QString();
+        }
+        return strings.at(int(ind));
+    };
+
+    auto count = [&in]() {
+        quint32 c = 0;
+        in >> c;
+        return c;
+    };
+
+    clearParams();
+
+    quint32 paramCnt = count();
+    for (quint32 i = 0;i < paramCnt && ok && in.status() == QDataStream::Ok;i++) {
+        QString name = str();
+        ConfigParam p;
+        qint8 type, vTx;
+        qint32 valInt, maxInt, minInt, stepInt, maxLen, decimals;
+
+        in >> type >> vTx;
+        p.type = CFG_T(type);
+        p.vTx = VESC_TX_T(vTx);
+        p.longName = str();
+        p.description = str();
+        p.cDefine = str();
+        p.valString = str();
+        p.suffix = str();
+        in >> p.valDouble >> p.maxDouble >> p.minDouble >> p.stepDouble;
+        in >> p.vTxDoubleScale >> p.editorScale;
+        in >> valInt >> maxInt >> minInt >> stepInt >> maxLen >> decimals;
+        in >> p.editAsPercentage >> p.showDisplay >> p.transmittable;
+        p.valInt = valInt;
+        p.maxInt = maxInt;
+        p.minInt = minInt;
+        p.stepInt = stepInt;
+        p.maxLen = maxLen;
+        p.editorDecimalsDouble = decimals;
+
+        quint32 enumCnt = count();
+        for (quint32 j = 0;j < enumCnt && ok;j++) {
+            p.enumNames.append(str());
+        }
+
+        addParam(name, p);
+    }
+
+    mSerializeOrder.clear();
+    mSerialPlanValid = false;
+    quint32 serCnt = count();
+    for (quint32 i = 0;i < serCnt && ok;i++) {
+        mSerializeOrder.append(str());
+    }
+
+    mParamGrouping.clear();
+    quint32 groupCnt = count();
+    for (quint32 i = 0;i < groupCnt && ok;i++) {
+        QPair<QString, QList<QPair<QString, QStringList>>> g;
+        g.first = str();
+        quint32 subCnt = count();
+        for (quint32 j = 0;j < subCnt && ok;j++) {
+            QPair<QString, QStringList> sg;
+            sg.first = str();
+            quint32 nameCnt = count();
+            for (quint32 k = 0;k < nameCnt && ok;k++) {
+                sg.second.append(str());
+            }
+            g.second.append(sg);
+        }
+        mParamGrouping.append(g);
+    }
+
+    if (ok && in.status() == QDataStream::Ok) {
+        mXmlStatus = tr("OK");
+        return true;
+    } else {
+        mXmlStatus = tr("Corrupt binary parameter file");
+        qWarning() << mXmlStatus;
+        return false;
+    }
+}
+
+bool ConfigParams::saveParamsBinary(QString fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        mXmlStatus = tr("Could not open %1 for writing").arg(fileName);
+        qWarning() << mXmlStatus;
+        return false;
+    }
+
+    file.write(getParamsBinary());
+    file.close();
+
+    mXmlStatus = tr("OK");
+    return true;
+}
+
+bool ConfigParams::loadParamsBinary(QString fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mXmlStatus = tr("Could not open %1 for reading").arg(fileName);
+        qWarning() << mXmlStatus;
+        return false;
+    }
+
+    bool res = setParamsBinary(file.readAll());
+    file.close();
+
+    return res;
+}
+
+/**
+ * @brief ConfigParams::loadParams
+ * Load parameter definitions from fileName. If there is a binary version of
+ * the file next to it, with the extension .vcb instead of .xml, that one is
+ * loaded instead.
+ *
+ * @param fileName
+ * Path to the XML file.
+ *
+ * @return
+ * True on success.
+ */
+bool ConfigParams::loadParams(QString fileName)
+{
+    QString binName = binaryFileName(fileName);
+    if (binName != fileName && QFileInfo::exists(binName)) {
+        return loadParamsBinary(binName);
+    }
+
+    return loadParamsXml(fileName);
+}
+
+/**
+ * @brief ConfigParams::paramsExist
+ * Check if the parameter definitions in fileName, or the binary version of
+ * them, exist. See loadParams.
+ */
+bool ConfigParams::paramsExist(QString fileName)
+{
+    return QFileInfo::exists(fileName) || QFileInfo::exists(binaryFileName(fileName));
+}
+
+QString ConfigParams::binaryFileName(QString xmlFileName)
+{
+    if (xmlFileName.endsWith(".xml", Qt::CaseInsensitive)) {
+        xmlFileName.chop(4);
+        xmlFileName.append(".vcb");
+    }
+
+    return xmlFileName;
+}
+
 bool ConfigParams::saveCDefines(const QString &fileName, bool wrapIfdef)
 {
     QFile file(fileName);
@@ -1588,9 +2458,11 @@ bool ConfigParams::saveCDefines(const QString &fileName, bool wrapIfdef)
 
     for (int i = 0;i < mSerializeOrder.size();i++) {
         QString name = mSerializeOrder.at(i);
+        int id = mParamIds.value(name, -1);
 
-        if (mParams.contains(name)) {
-            ConfigParam &p = mParams[name];
+        if (id >= 0) {
+            const ConfigParam &p = mParams.at(id);
+            const ParamValue &v = value(id);
 
             if (!p.cDefine.isEmpty()) {
                 out << "// " + p.longName + "\n";
@@ -1603,15 +2475,15 @@ bool ConfigParams::saveCDefines(const QString &fileName, bool wrapIfdef)
                 case CFG_T_ENUM:
                 case CFG_T_INT:
                 case CFG_T_BITFIELD:
-                    out << "#define " + p.cDefine + " " + QString::number(p.valInt) + "\n";
+                    out << "#define " + p.cDefine + " " + QString::number(v.valInt) + "\n";
                     break;
 
                 case CFG_T_DOUBLE:
-                    out << "#define " + p.cDefine + " " + QString::number(p.valDouble) + "\n";
+                    out << "#define " + p.cDefine + " " + QString::number(v.valDouble) + "\n";
                     break;
 
                 case CFG_T_QSTRING:
-                    out << "#define " + p.cDefine + " \"" + p.valString + "\"\n";
+                    out << "#define " + p.cDefine + " \"" + v.valString + "\"\n";
                     break;
 
                 default:
@@ -1656,8 +2528,12 @@ QStringList ConfigParams::checkDifference(ConfigParams *config)
     QStringList res;
 
     for(QString p: mParamList) {
-        ConfigParam *thisParam = this->getParam(p);
-        ConfigParam *otherParam = config->getParam(p);
+        int thisId = this->paramId(p);
+        int otherId = config->paramId(p);
+        const ConfigParam *thisParam = thisId >= 0 ? &this->mParams.at(thisId) : nullptr;
+        const ConfigParam *otherParam = otherId >= 0 ? &config->mParams.at(otherId) : nullptr;
+        const ParamValue &thisVal = thisParam ? this->value(thisId) : ParamValue();
+        const ParamValue &otherVal = otherParam ? config->value(otherId) : ParamValue();
 
         if (thisParam && otherParam) {
             if (thisParam->type == otherParam->type) {
@@ -1666,7 +2542,7 @@ QStringList ConfigParams::checkDifference(ConfigParams *config)
                 case CFG_T_ENUM:
                 case CFG_T_INT:
                 case CFG_T_BITFIELD:
-                    if (thisParam->valInt != otherParam->valInt) {
+                    if (thisVal.valInt != otherVal.valInt) {
                         res.append(p);
                     }
                     break;
@@ -1678,13 +2554,13 @@ QStringList ConfigParams::checkDifference(ConfigParams *config)
                         eps = 0.01;
                     }
 
-                    if (!almostEqual(thisParam->valDouble, otherParam->valDouble, eps)) {
+                    if (!almostEqual(thisVal.valDouble, otherVal.valDouble, eps)) {
                         res.append(p);
                     }
                 } break;
 
                 case CFG_T_QSTRING:
-                    if (thisParam->valString != otherParam->valString) {
+                    if (thisVal.valString != otherVal.valString) {
                         res.append(p);
                     }
                     break;
@@ -1701,22 +2577,8 @@ QStringList ConfigParams::checkDifference(ConfigParams *config)
 
 quint32 ConfigParams::getSignature()
 {
-    QString sigStr;
-    for (QString s: mSerializeOrder) {
-        sigStr.append(s);
-        ConfigParam *p = getParam(s);
-
-        if (p) {
-            sigStr.append(QString("%1").arg(int(p->type)));
-            sigStr.append(QString("%1").arg(int(p->vTx)));
-            for (auto n: p->enumNames) {
-                sigStr.append(n);
-            }
-        }
-    }
-
-    QByteArray bytes = sigStr.toUtf8();
-    return Utility::crc32c((uint8_t*)bytes.data(), bytes.size());
+    serialPlan();
+    return mSerialSignature;
 }
 
 void ConfigParams::setGrouping(QList<QPair<QString, QList<QPair<QString, QStringList>>>> grouping)
@@ -2048,11 +2910,22 @@ bool ConfigParams::renameSubgroupParam(QString group, QString subgroup, QString
 
 ConfigParams &ConfigParams::operator=(const ConfigParams &other)
 {
+    // The metadata in mParams is implicitly shared with other until one of
+    // the configurations changes it, so this only copies the values.
+    other.syncExposed();
+    syncExposed();
     this->mParams = other.mParams;
+    this->mValues = other.mValues;
+    this->mParamNames = other.mParamNames;
+    this->mParamIds = other.mParamIds;
     this->mParamList = other.mParamList;
     this->mUpdateOnlyName = other.mUpdateOnlyName;
     this->mUpdatesEnabled = other.mUpdatesEnabled;
     this->mSerializeOrder = other.mSerializeOrder;
+    this->mSerialPlan = other.mSerialPlan;
+    this->mSerialSignature = other.mSerialSignature;
+    this->mSerialFixedSize = other.mSerialFixedSize;
+    this->mSerialPlanValid = other.mSerialPlanValid;
     this->mXmlStatus = other.mXmlStatus;
 
     return *this;
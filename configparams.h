@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include <QHash>
+#include <QVector>
 #include <QStringList>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
@@ -44,6 +45,7 @@ public:
 
     Q_INVOKABLE bool hasParam(const QString &name);
     ConfigParam *getParam(const QString &name);
+    ConfigParam *getParam(int id);
     Q_INVOKABLE ConfigParam getParamCopy(const QString &name) const;
 
     Q_INVOKABLE bool isParamDouble(const QString &name);
@@ -58,6 +60,23 @@ public:
     Q_INVOKABLE int getParamEnum(const QString &name);
     Q_INVOKABLE QString getParamQString(const QString &name);
     Q_INVOKABLE bool getParamBool(const QString &name);
+
+    // Access by parameter ID, see paramId
+    Q_INVOKABLE int paramId(const QString &name) const;
+    QString paramName(int id) const;
+    bool hasParam(int id) const;
+    double getParamDouble(int id);
+    int getParamInt(int id);
+    int getParamEnum(int id);
+    QString getParamQString(int id);
+    bool getParamBool(int id);
+    void updateParamDouble(int id, double param, QObject *src = nullptr);
+    void updateParamInt(int id, int param, QObject *src = nullptr);
+    void updateParamEnum(int id, int param, QObject *src = nullptr);
+    void updateParamString(int id, QString param, QObject *src = nullptr);
+    void updateParamBool(int id, bool param, QObject *src = nullptr);
+    void updateParamFromOther(int id, const ConfigParam &other, QObject *src);
+
     Q_INVOKABLE QString getLongName(const QString &name);
     Q_INVOKABLE QString getDescription(const QString &name);
 
@@ -83,6 +102,8 @@ public:
 
     void getParamSerial(VByteArray &vb, const QString &name);
     void setParamSerial(VByteArray &vb, const QString &name, QObject *src = nullptr);
+    void getParamSerial(VByteArray &vb, int id);
+    void setParamSerial(VByteArray &vb, int id, QObject *src = nullptr);
 
     QStringList getSerializeOrder() const;
     void setSerializeOrder(const QStringList &serializeOrder);
@@ -96,6 +117,8 @@ public:
     Q_INVOKABLE bool saveXml(QString fileName, QString configName);
     Q_INVOKABLE bool loadXml(QString fileName, QString configName);
     QString xmlStatus();
+    QByteArray getXmlData(QString configName);
+    bool setXmlData(const QByteArray &data, QString configName);
     QString saveCompressed(QString configName);
     bool loadCompressed(QString data, QString configName);
 
@@ -105,6 +128,13 @@ public:
     bool loadParamsXml(QString fileName);
     QByteArray getCompressedParamsXml();
     bool loadCompressedParamsXml(QByteArray data);
+    QByteArray getParamsBinary();
+    bool setParamsBinary(const QByteArray &data);
+    bool saveParamsBinary(QString fileName);
+    bool loadParamsBinary(QString fileName);
+    bool loadParams(QString fileName);
+    static bool paramsExist(QString fileName);
+    static QString binaryFileName(QString xmlFileName);
 
     bool saveCDefines(const QString &fileName, bool wrapIfdef = false);
 
@@ -146,6 +176,7 @@ public:
     void setStoreConfigVersion(bool storeConfigVersion);
 
     int updateCnt() const;
+    bool isUpdating() const;
 
     Q_INVOKABLE static bool testXml(QString fileName, QString configName);
 
@@ -155,6 +186,9 @@ signals:
     void paramChangedEnum(QObject *src, QString name, int newParam);
     void paramChangedQString(QObject *src, QString name, QString newParam);
     void paramChangedBool(QObject *src, QString name, bool newParam);
+    // IDs of the parameters that changed, sorted. Emitted once per batch, see
+    // beginUpdate, and once per change outside of batches.
+    void paramChangeSet(QObject *src, QVector<int> ids);
     void updateRequested();
     void updateRequestDefault();
     void updated();
@@ -170,13 +204,50 @@ public slots:
     void requestUpdate();
     void requestUpdateDefault();
     void updateDone();
+    void beginUpdate();
+    void endUpdate();
 
 private:
-    QHash<QString, ConfigParam> mParams;
+    struct ParamValue {
+        double valDouble;
+        int valInt;
+        QString valString;
+    };
+
+    // Indexed by parameter ID. Deleted parameters keep their slot with an
+    // empty name, so that the IDs of the other parameters stay valid.
+    // mParams holds the metadata, which is shared between copies of the
+    // configuration, and mValues holds the current values. The val fields
+    // in mParams are only updated for getParam.
+    QVector<ConfigParam> mParams;
+    mutable QVector<ParamValue> mValues;
+    mutable QVector<int> mExposedIds;
+    QStringList mParamNames;
+    QHash<QString, int> mParamIds;
     QStringList mParamList;
     QString mUpdateOnlyName;
     bool mUpdatesEnabled;
     QStringList mSerializeOrder;
+
+    struct SerialEntry {
+        int id;
+        CFG_T type;
+        VESC_TX_T vTx;
+        double scale;
+    };
+
+    // Compiled serialization order, see serialPlan
+    QVector<SerialEntry> mSerialPlan;
+    quint32 mSerialSignature;
+    int mSerialFixedSize;
+    bool mSerialPlanValid;
+
+    // Changes collected between beginUpdate and endUpdate
+    int mBatchDepth;
+    QVector<int> mBatchIds;
+    QVector<QObject*> mBatchSrcs;
+    QHash<int, int> mBatchPos;
+
     QString mXmlStatus;
     QList<QPair<QString, QList<QPair<QString, QStringList>>>> mParamGrouping;
     int mConfigVersion;
@@ -184,6 +255,16 @@ private:
     int mUpdateCnt;
 
     bool almostEqual(float A, float B, float eps);
+    const QVector<SerialEntry> &serialPlan();
+    SerialEntry serialEntry(int id) const;
+    void appendSerial(VByteArray &vb, const SerialEntry &e) const;
+    void popSerial(VByteArray &vb, const SerialEntry &e, bool update, QObject *src);
+    void paramChanged(int id, QObject *src);
+    static ParamValue valueFromParam(const ConfigParam &param);
+    const ParamValue &value(int id) const;
+    ParamValue &valueRef(int id);
+    void syncExposed() const;
+    void emitParamChanged(int id, QObject *src);
 
 };
 
@@ -576,25 +576,6 @@ public:
 
 Q_DECLARE_METATYPE(MCCONF_TEMP)
 
-struct CONFIG_BACKUP {
-    Q_GADGET
-
-    Q_PROPERTY(QString name MEMBER name)
-    Q_PROPERTY(QString vesc_uuid MEMBER vesc_uuid)
-    Q_PROPERTY(QString mcconf_xml_compressed MEMBER mcconf_xml_compressed)
-    Q_PROPERTY(QString appconf_xml_compressed MEMBER appconf_xml_compressed)
-    Q_PROPERTY(QString customconf_xml_compressed MEMBER customconf_xml_compressed)
-
-public:
-    QString name;
-    QString vesc_uuid;
-    QString mcconf_xml_compressed;
-    QString appconf_xml_compressed;
-    QString customconf_xml_compressed;
-};
-
-Q_DECLARE_METATYPE(CONFIG_BACKUP)
-
 struct FW_RX_PARAMS {
     Q_GADGET
 
@@ -18,85 +18,609 @@
     */
 
 #include "digitalfiltering.h"
+#include "utility.h"
 #include <cmath>
 #include <QDebug>
-
-DigitalFiltering::DigitalFiltering()
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+
+namespace {
+// Precomputed tables for a 2^m point transform. They are shared between threads
+// and never modified after they are created.
+struct FftPlan {
+    int m;
+    QVector<int> bitRev;
+    // exp(i * pi * j / l1) for all stages, where the stage with l1 butterflies
+    // per block starts at offset l1 - 1.
+    QVector<double> twRe;
+    QVector<double> twIm;
+    // exp(i * pi * k / n), k = 0..n, for the real-input transform of 2n points
+    QVector<double> realTwRe;
+    QVector<double> realTwIm;
+};
+
+QMutex fftPlanMutex;
+QHash<int, QSharedPointer<const FftPlan> > fftPlans;
+
+QSharedPointer<const FftPlan> fftPlan(int m)
 {
+    QMutexLocker locker(&fftPlanMutex);
+
+    QSharedPointer<const FftPlan> res = fftPlans.value(m);
+    if (res) {
+        return res;
+    }
+
+    QSharedPointer<FftPlan> p(new FftPlan);
+    int n = 1 << m;
+    p->m = m;
+
+    p->bitRev.resize(n);
+    for (int i = 0;i < n;i++) {
+        int r = 0;
+        for (int b = 0;b < m;b++) {
+            if (i & (1 << b)) {
+                r |= 1 << (m - b - 1);
+            }
+        }
+        p->bitRev[i] = r;
+    }
+
+    p->twRe.resize(qMax(n - 1, 1));
+    p->twIm.resize(qMax(n - 1, 1));
+    for (int l1 = 1;l1 < n;l1 <<= 1) {
+        for (int j = 0;j < l1;j++) {
+            double a = M_PI * double(j) / double(l1);
+            p->twRe[l1 - 1 + j] = cos(a);
+            p->twIm[l1 - 1 + j] = sin(a);
+        }
+    }
+
+    p->realTwRe.resize(n + 1);
+    p->realTwIm.resize(n + 1);
+    for (int k = 0;k <= n;k++) {
+        double a = M_PI * double(k) / double(n);
+        p->realTwRe[k] = cos(a);
+        p->realTwIm[k] = sin(a);
+    }
+
+    fftPlans.insert(m, p);
+    return p;
 }
 
-// Found at http://paulbourke.net/miscellaneous//dft/
-// Dir: 0: Forward, != 0: Reverse
-// m: 2^m points
-// real: Real part
-// imag: Imaginary part
-void DigitalFiltering::fft(int dir, int m, double *real, double *imag)
+// In-place complex transform with the kernel exp(sign * i * 2 * pi * k * n / N),
+// without scaling. The butterflies run over contiguous split real/imaginary
+// arrays with precomputed twiddles, so that the compiler can vectorise them.
+void fftPlanned(const FftPlan &p, double sign, double *real, double *imag)
 {
-    long n,i,i1,j,k,i2,l,l1,l2;
-    double c1,c2,tx,ty,t1,t2,u1,u2,z;
-
-    // Calculate the number of points
-    n = 1 << m;
+    const int n = 1 << p.m;
+    const int *rev = p.bitRev.constData();
 
-    // Do the bit reversal
-    i2 = n >> 1;
-    j = 0;
-    for (i=0;i<n-1;i++) {
+    for (int i = 0;i < n;i++) {
+        int j = rev[i];
         if (i < j) {
-            tx = real[i];
-            ty = imag[i];
+            double tx = real[i];
+            double ty = imag[i];
             real[i] = real[j];
             imag[i] = imag[j];
             real[j] = tx;
             imag[j] = ty;
         }
-        k = i2;
-        while (k <= j) {
-            j -= k;
-            k >>= 1;
-        }
-        j += k;
-    }
-
-    // Compute the FFT
-    c1 = -1.0;
-    c2 = 0.0;
-    l2 = 1;
-    for (l=0;l<m;l++) {
-        l1 = l2;
-        l2 <<= 1;
-        u1 = 1.0;
-        u2 = 0.0;
-        for (j=0;j < l1;j++) {
-            for (i=j;i < n;i += l2) {
-                i1 = i + l1;
-                t1 = u1 * real[i1] - u2 * imag[i1];
-                t2 = u1 * imag[i1] + u2 * real[i1];
-                real[i1] = real[i] - t1;
-                imag[i1] = imag[i] - t2;
-                real[i] += t1;
-                imag[i] += t2;
+    }
+
+    for (int l1 = 1;l1 < n;l1 <<= 1) {
+        const int l2 = l1 << 1;
+        const double *wr = p.twRe.constData() + l1 - 1;
+        const double *wi = p.twIm.constData() + l1 - 1;
+
+        for (int i0 = 0;i0 < n;i0 += l2) {
+            double *ar = real + i0;
+            double *ai = imag + i0;
+            double *br = ar + l1;
+            double *bi = ai + l1;
+
+            for (int j = 0;j < l1;j++) {
+                double ur = wr[j];
+                double ui = sign * wi[j];
+                double t1 = ur * br[j] - ui * bi[j];
+                double t2 = ur * bi[j] + ui * br[j];
+                br[j] = ar[j] - t1;
+                bi[j] = ai[j] - t2;
+                ar[j] += t1;
+                ai[j] += t2;
             }
-            z =  u1 * c1 - u2 * c2;
-            u2 = u1 * c2 + u2 * c1;
-            u1 = z;
         }
-        c2 = sqrt((1.0 - c1) / 2.0);
-        if (dir) {
-            c2 = -c2;
+    }
+}
+
+// Filters with fewer taps than this are applied directly
+const int firFftMinTaps = 32;
+
+void correlateDirect(const QVector<double> &taps, const double *x, double *out, int outLen)
+{
+    const int m = taps.size();
+    const double *h = taps.constData();
+
+    for (int i = 0;i < outLen;i++) {
+        double coeff = 0;
+        for (int j = 0;j < m;j++) {
+            coeff += x[i + j] * h[j];
+        }
+        out[i] = coeff;
+    }
+}
+}
+
+/*
+ * Taps of a FIR filter together with the spectrum used for overlap-save
+ * filtering. The spectrum is calculated when it is needed the first time.
+ */
+struct FirKernel {
+    QVector<double> taps;
+    QMutex mutex;
+    int fftBits = 0;
+    QVector<double> re;
+    QVector<double> im;
+};
+
+namespace {
+QSharedPointer<FirKernel> makeFirKernel(const QVector<double> &taps)
+{
+    QSharedPointer<FirKernel> k(new FirKernel);
+    k->taps = taps;
+    return k;
+}
+
+// out[i] = sum_j x[i + j] * taps[j], i = 0..outLen - 1. x must have at least
+// outLen + taps - 1 samples.
+void correlateValid(FirKernel &k, const double *x, int xLen, double *out, int outLen)
+{
+    const int m = k.taps.size();
+
+    // The FFT only pays off for long filters and signals
+    if (m < firFftMinTaps || outLen < m) {
+        correlateDirect(k.taps, x, out, outLen);
+        return;
+    }
+
+    {
+        QMutexLocker locker(&k.mutex);
+        if (k.fftBits == 0) {
+            // Blocks of about 4 filter lengths keep the overhead of the overlap low
+            int bits = DigitalFiltering::whichPowerOfTwo(m) + 2;
+            int f = 1 << bits;
+            QVector<double> re(f, 0.0);
+            QVector<double> im(f, 0.0);
+
+            // Correlation is convolution with the reversed taps. Include the scaling of the
+            // inverse transform in the spectrum.
+            for (int i = 0;i < m;i++) {
+                re[i] = k.taps.at(m - i - 1) / double(f);
+            }
+
+            fftPlanned(*fftPlan(bits), -1.0, re.data(), im.data());
+            k.re = re;
+            k.im = im;
+            k.fftBits = bits;
+        }
+    }
+
+    QSharedPointer<const FftPlan> plan = fftPlan(k.fftBits);
+    const int f = 1 << k.fftBits;
+    const int step = f - m + 1;
+    const double *kr = k.re.constData();
+    const double *ki = k.im.constData();
+
+    QVector<double> reVec(f);
+    QVector<double> imVec(f);
+    double *re = reVec.data();
+    double *im = imVec.data();
+
+    // Overlap-save with two blocks per transform, one in the real part and one in the
+    // imaginary part. The taps are real, so the results end up in the same parts.
+    for (int s = 0;s < outLen;s += 2 * step) {
+        for (int i = 0;i < f;i++) {
+            int i1 = s + i;
+            int i2 = s + step + i;
+            re[i] = i1 < xLen ? x[i1] : 0.0;
+            im[i] = i2 < xLen ? x[i2] : 0.0;
+        }
+
+        fftPlanned(*plan, -1.0, re, im);
+
+        for (int i = 0;i < f;i++) {
+            double r = re[i] * kr[i] - im[i] * ki[i];
+            double c = re[i] * ki[i] + im[i] * kr[i];
+            re[i] = r;
+            im[i] = c;
+        }
+
+        fftPlanned(*plan, 1.0, re, im);
+
+        for (int i = 0;i < step;i++) {
+            int o1 = s + i;
+            int o2 = s + step + i;
+
+            if (o1 < outLen) {
+                out[o1] = re[m - 1 + i];
+            }
+
+            if (o2 < outLen) {
+                out[o2] = im[m - 1 + i];
+            }
         }
-        c1 = sqrt((1.0 + c1) / 2.0);
     }
+}
+
+// The same filter is usually applied to several signals in a row
+QMutex firKernelMutex;
+QSharedPointer<FirKernel> lastFirKernel;
+
+QSharedPointer<FirKernel> firKernel(const QVector<double> &taps)
+{
+    QMutexLocker locker(&firKernelMutex);
+
+    if (!lastFirKernel || lastFirKernel->taps != taps) {
+        lastFirKernel = makeFirKernel(taps);
+    }
+
+    return lastFirKernel;
+}
+}
+
+DigitalFiltering::DigitalFiltering()
+{
+}
+
+// Originally from http://paulbourke.net/miscellaneous//dft/, now using cached
+// bit reversal and twiddle tables.
+// Dir: 0: Forward, != 0: Reverse
+// m: 2^m points
+// real: Real part
+// imag: Imaginary part
+void DigitalFiltering::fft(int dir, int m, double *real, double *imag)
+{
+    QSharedPointer<const FftPlan> plan = fftPlan(m);
+    fftPlanned(*plan, dir ? -1.0 : 1.0, real, imag);
 
     // Scaling for reverse transform
     if (dir) {
-        for (i=0;i < n;i++) {
+        long n = 1 << m;
+        for (long i = 0;i < n;i++) {
             real[i] /= n;
             imag[i] /= n;
         }
     }
 }
 
+/**
+ * @brief DigitalFiltering::rfft
+ * Forward transform of real data, computed with a 2^(m-1) point complex
+ * transform. Only the non-redundant half of the spectrum is calculated, the
+ * rest is the complex conjugate of it.
+ *
+ * @param m
+ * The input has 2^m points.
+ *
+ * @param data
+ * The input.
+ *
+ * @param real
+ * Real part of bin 0 to 2^(m-1). Must have room for 2^(m-1) + 1 values.
+ *
+ * @param imag
+ * Imaginary part of bin 0 to 2^(m-1). Must have room for 2^(m-1) + 1 values.
+ */
+void DigitalFiltering::rfft(int m, const double *data, double *real, double *imag)
+{
+    if (m < 1) {
+        real[0] = data[0];
+        imag[0] = 0.0;
+        return;
+    }
+
+    const int n = 1 << (m - 1);
+    QSharedPointer<const FftPlan> plan = fftPlan(m - 1);
+
+    QVector<double> zr(n);
+    QVector<double> zi(n);
+    for (int k = 0;k < n;k++) {
+        zr[k] = data[2 * k];
+        zi[k] = data[2 * k + 1];
+    }
+
+    fftPlanned(*plan, -1.0, zr.data(), zi.data());
+
+    // Split the transform of the even and odd samples and combine them
+    for (int k = 0;k <= n;k++) {
+        int k1 = k % n;
+        int k2 = (n - k) % n;
+
+        double zkr = zr[k1];
+        double zki = zi[k1];
+        double zcr = zr[k2];
+        double zci = -zi[k2];
+
+        double er = 0.5 * (zkr + zcr);
+        double ei = 0.5 * (zki + zci);
+        double orr = 0.5 * (zki - zci);
+        double oi = -0.5 * (zkr - zcr);
+
+        double wr = plan->realTwRe[k];
+        double wi = -plan->realTwIm[k];
+
+        real[k] = er + wr * orr - wi * oi;
+        imag[k] = ei + wr * oi + wi * orr;
+    }
+}
+
+QVector<double> DigitalFiltering::window(DigitalFiltering::WindowType type, int len)
+{
+    QVector<double> res(len, 1.0);
+    double div = double(qMax(len - 1, 1));
+
+    for (int i = 0;i < len;i++) {
+        double a = 2.0 * M_PI * double(i) / div;
+
+        switch (type) {
+        case WindowHann: res[i] = 0.5 - 0.5 * cos(a); break;
+        case WindowHamming: res[i] = 0.54 - 0.46 * cos(a); break;
+        case WindowBlackman: res[i] = 0.42 - 0.5 * cos(a) + 0.08 * cos(2.0 * a); break;
+        default: break;
+        }
+    }
+
+    return res;
+}
+
+/**
+ * @brief DigitalFiltering::stft
+ * Short-time Fourier transform of a real signal. The frames are transformed
+ * in parallel.
+ *
+ * @param signal
+ * The signal.
+ *
+ * @param windowBits
+ * The frames have 2^windowBits samples.
+ *
+ * @param hop
+ * Samples between the starts of consecutive frames. Use a hop smaller than the
+ * window length for overlapping frames.
+ *
+ * @param window
+ * The window applied to each frame.
+ *
+ * @return
+ * The amplitude spectrum of each frame, with 2^(windowBits-1) + 1 bins from 0 to
+ * half the sampling frequency. The amplitudes are compensated for the gain of
+ * the window, so that a sine with amplitude A gives a peak of about A.
+ */
+QVector<QVector<double> > DigitalFiltering::stft(const QVector<double> &signal, int windowBits, int hop, WindowType window)
+{
+    const int len = 1 << windowBits;
+    const int bins = len / 2 + 1;
+    hop = qMax(hop, 1);
+
+    QVector<QVector<double> > res;
+    if (signal.size() < len) {
+        return res;
+    }
+
+    const int frames = (signal.size() - len) / hop + 1;
+    res.resize(frames);
+
+    const QVector<double> win = DigitalFiltering::window(window, len);
+    double gain = 0.0;
+    for (auto w: win) {
+        gain += w;
+    }
+    gain = 2.0 / gain;
+
+    // Build the plan before the threads use it
+    fftPlan(qMax(windowBits - 1, 0));
+
+    // Several frames per task to keep the scheduling overhead low
+    const int framesPerTask = 16;
+    const int tasks = (frames + framesPerTask - 1) / framesPerTask;
+    QVector<double> *out = res.data();
+
+    Utility::runParallel(tasks, [&](int task) {
+        QVector<double> buf(len);
+        QVector<double> re(bins);
+        QVector<double> im(bins);
+
+        int end = qMin((task + 1) * framesPerTask, frames);
+        for (int f = task * framesPerTask;f < end;f++) {
+            const double *x = signal.constData() + f * hop;
+            for (int i = 0;i < len;i++) {
+                buf[i] = x[i] * win[i];
+            }
+
+            rfft(windowBits, buf.constData(), re.data(), im.data());
+
+            QVector<double> mag(bins);
+            for (int i = 0;i < bins;i++) {
+                mag[i] = sqrt(re[i] * re[i] + im[i] * im[i]) * gain;
+            }
+
+            out[f] = mag;
+        }
+    });
+
+    return res;
+}
+
+/**
+ * @brief DigitalFiltering::selfTest
+ * Check the planned FFT, the real-input FFT, the STFT and the FFT convolution
+ * in filterSignal against straightforward reference implementations, and
+ * measure the time of the filter compared to direct convolution.
+ *
+ * @param report
+ * Errors and timings are written here.
+ *
+ * @return
+ * True if all results are within tolerance.
+ */
+bool DigitalFiltering::selfTest(QString *report)
+{
+    const double tol = 1e-9;
+    bool ok = true;
+    QString res;
+    quint32 seed = 1;
+
+    auto rnd = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return double(seed >> 8) / double(1 << 24) - 0.5;
+    };
+
+    auto check = [&](QString name, double err) {
+        bool pass = err <= tol;
+        ok = ok && pass;
+        res += QString("%1: max error %2 %3\n").arg(name).arg(err, 0, 'g', 3).arg(pass ? "OK" : "FAILED");
+    };
+
+    for (int m = 1;m <= 12;m++) {
+        const int n = 1 << m;
+        QVector<double> x(n), re(n), im(n, 0.0);
+        for (int i = 0;i < n;i++) {
+            x[i] = rnd();
+        }
+        re = x;
+
+        // Reference DFT with the kernel exp(i * 2 * pi * k * n / N), which is
+        // what fft uses in the forward direction. rfft uses exp(-i...).
+        QVector<double> refRe(n), refIm(n);
+        double scale = 1.0;
+        for (int k = 0;k < n;k++) {
+            double sr = 0.0, si = 0.0;
+            for (int i = 0;i < n;i++) {
+                double a = 2.0 * M_PI * double((qint64(k) * i) % n) / double(n);
+                sr += x[i] * cos(a);
+                si += x[i] * sin(a);
+            }
+            refRe[k] = sr;
+            refIm[k] = si;
+            scale = qMax(scale, sqrt(sr * sr + si * si));
+        }
+
+        fft(0, m, re.data(), im.data());
+        double errFft = 0.0;
+        for (int k = 0;k < n;k++) {
+            errFft = qMax(errFft, qMax(fabs(re[k] - refRe[k]), fabs(im[k] - refIm[k])) / scale);
+        }
+
+        QVector<double> rre(n / 2 + 1), rim(n / 2 + 1);
+        rfft(m, x.constData(), rre.data(), rim.data());
+        double errRfft = 0.0;
+        for (int k = 0;k <= n / 2;k++) {
+            errRfft = qMax(errRfft, qMax(fabs(rre[k] - refRe[k]), fabs(rim[k] + refIm[k])) / scale);
+        }
+
+        fft(1, m, re.data(), im.data());
+        double errInv = 0.0;
+        for (int i = 0;i < n;i++) {
+            errInv = qMax(errInv, qMax(fabs(re[i] - x[i]), fabs(im[i])));
+        }
+
+        check(QString("fft %1").arg(n), errFft);
+        check(QString("rfft %1").arg(n), errRfft);
+        check(QString("ifft %1").arg(n), errInv);
+    }
+
+    {
+        // The frames are calculated in parallel, compare with one frame at a time
+        const int bits = 8, len = 1 << bits, hop = 100;
+        QVector<double> x(20000);
+        for (auto &v: x) {
+            v = rnd();
+        }
+
+        auto frames = stft(x, bits, hop, WindowHann);
+        QVector<double> win = window(WindowHann, len);
+        double gain = 0.0;
+        for (auto w: win) {
+            gain += w;
+        }
+        gain = 2.0 / gain;
+
+        double err = 0.0;
+        QVector<double> buf(len), re(len / 2 + 1), im(len / 2 + 1);
+        for (int f = 0;f < frames.size();f++) {
+            for (int i = 0;i < len;i++) {
+                buf[i] = x[f * hop + i] * win[i];
+            }
+            rfft(bits, buf.constData(), re.data(), im.data());
+            for (int i = 0;i <= len / 2;i++) {
+                err = qMax(err, fabs(frames[f][i] - sqrt(re[i] * re[i] + im[i] * im[i]) * gain));
+            }
+        }
+
+        check("stft", frames.size() == (x.size() - len) / hop + 1 ? err : 1.0);
+    }
+
+    for (int taps: {8, 255, 1024}) {
+        QVector<double> x(100000), h(taps);
+        for (auto &v: x) {
+            v = rnd();
+        }
+        for (auto &v: h) {
+            v = rnd() / double(taps);
+        }
+
+        QElapsedTimer t;
+        t.start();
+        QVector<double> y = filterSignal(x, h);
+        qint64 filterNs = t.nsecsElapsed();
+
+        t.restart();
+        QVector<double> ref(x.size() - taps);
+        for (int i = 0;i < ref.size();i++) {
+            double c = 0.0;
+            for (int j = 0;j < taps;j++) {
+                c += x[i + j] * h[j];
+            }
+            ref[i] = c;
+        }
+        qint64 directNs = t.nsecsElapsed();
+
+        double err = y.size() == ref.size() + 2 * (taps / 2) ? 0.0 : 1.0;
+        for (int i = 0;i < ref.size() && err < 1.0;i++) {
+            err = qMax(err, fabs(y[i + 2 * (taps / 2)] - ref[i]));
+        }
+
+        check(QString("filterSignal %1 taps").arg(taps), err);
+
+        // Streaming the same signal in uneven blocks gives the same output
+        FirFilter stream(h);
+        QVector<double> ys;
+        int pos = 0, block = 1;
+        while (pos < x.size()) {
+            ys.append(stream.process(x.mid(pos, block)));
+            pos += block;
+            block = qMin(block * 3 + 1, 4096);
+        }
+
+        double errStream = ys.size() == ref.size() ? 0.0 : 1.0;
+        for (int i = 0;i < ref.size() && errStream < 1.0;i++) {
+            errStream = qMax(errStream, fabs(ys[i] - ref[i]));
+        }
+
+        check(QString("FirFilter %1 taps").arg(taps), errStream);
+        res += QString("filterSignal %1 taps: %2 ms, direct %3 ms\n").arg(taps).
+                arg(double(filterNs) / 1e6, 0, 'f', 2).arg(double(directNs) / 1e6, 0, 'f', 2);
+    }
+
+    if (report) {
+        *report = res;
+    }
+
+    return ok;
+}
+
 // Found at http://paulbourke.net/miscellaneous//dft/
 void DigitalFiltering::dft(int dir, int len, double *real, double *imag) {
     long i,k;
@@ -194,11 +718,31 @@ int DigitalFiltering::whichPowerOfTwo(unsigned int number)
     return exponent;
 }
 
+/**
+ * @brief DigitalFiltering::filterSignal
+ * Apply a FIR filter to a signal. Long filters are applied with overlap-save
+ * FFT convolution, short ones directly.
+ *
+ * @param signal
+ * The signal to filter.
+ *
+ * @param filter
+ * The filter taps.
+ *
+ * @param padAfter
+ * Put half of the zero padding after the filtered signal instead of putting
+ * all of it before, so that the delay of the filter is compensated.
+ *
+ * @return
+ * The filtered signal, with the same length as signal.
+ */
 QVector<double> DigitalFiltering::filterSignal(const QVector<double> &signal, const QVector<double> &filter, bool padAfter)
 {
     QVector<double> result;
     int taps = filter.size();
 
+    result.reserve(signal.size());
+
     for (int i = 0;i < taps / 2;i++) {
         result.append(0.0);
     }
@@ -209,12 +753,12 @@ QVector<double> DigitalFiltering::filterSignal(const QVector<double> &signal, co
         }
     }
 
-    for (int i = 0;i < signal.size() - taps;i++) {
-        double coeff = 0;
-        for (int j = 0;j < taps;j++) {
-            coeff += signal[i + j] * filter[j];
-        }
-        result.append(coeff);
+    int outLen = signal.size() - taps;
+    if (outLen > 0) {
+        int start = result.size();
+        result.resize(start + outLen);
+        correlateValid(*firKernel(filter), signal.constData(), signal.size(),
+                       result.data() + start, outLen);
     }
 
     if (padAfter) {
@@ -226,6 +770,24 @@ QVector<double> DigitalFiltering::filterSignal(const QVector<double> &signal, co
     return result;
 }
 
+/**
+ * @brief DigitalFiltering::filterSignalBatch
+ * Run filterSignal on several signals in parallel.
+ */
+QVector<QVector<double> > DigitalFiltering::filterSignalBatch(const QVector<QVector<double> > &signals, const QVector<double> &filter, bool padAfter)
+{
+    QVector<QVector<double> > results(signals.size());
+
+    // Calculate the spectrum once before the threads use it
+    firKernel(filter);
+
+    Utility::runParallel(signals.size(), [&](int i) {
+        results[i] = filterSignal(signals.at(i), filter, padAfter);
+    });
+
+    return results;
+}
+
 QVector<double> DigitalFiltering::generateFirFilter(double f_break, int bits, bool useHamming)
 {
     int taps = 1 << bits;
@@ -269,8 +831,7 @@ QVector<double> DigitalFiltering::fftWithShift(QVector<double> &signal, int resu
     int taps = signal.size();
     int resultLen = 1 << resultBits;
 
-    double *signal_vector = new double[resultLen];
-    double *imag = new double[resultLen];
+    QVector<double> signal_vector(resultLen);
 
     if (resultLen < taps) {
         int sizeDiffHalf = (taps - resultLen) / 2;
@@ -279,7 +840,6 @@ QVector<double> DigitalFiltering::fftWithShift(QVector<double> &signal, int resu
 
         for(int i = 0;i < resultLen;i++) {
             signal_vector[i] = signal[i];
-            imag[i] = 0;
         }
     } else {
         int sizeDiffHalf = (resultLen - taps) / 2;
@@ -291,20 +851,113 @@ QVector<double> DigitalFiltering::fftWithShift(QVector<double> &signal, int resu
             } else {
                 signal_vector[i] = 0;
             }
-            imag[i] = 0;
         }
     }
 
-    fftshift(signal_vector, resultLen);
-    fft(0, resultBits, signal_vector, imag);
+    fftshift(signal_vector.data(), resultLen);
+
+    int half = resultLen / 2;
+    QVector<double> re(half + 1);
+    QVector<double> im(half + 1);
+    rfft(resultBits, signal_vector.constData(), re.data(), im.data());
 
+    // The real part of the spectrum of a real signal is symmetric
     double div_factor = scaleByLen ? (double)taps : 1.0;
-    for(int i = 0;i < resultLen;i++) {
-        result.append(fabs(signal_vector[i]) / div_factor);
+    result.resize(resultLen);
+    for(int i = 0;i <= half && i < resultLen;i++) {
+        result[i] = fabs(re[i]) / div_factor;
     }
 
-    delete[] signal_vector;
-    delete[] imag;
+    for(int i = half + 1;i < resultLen;i++) {
+        result[i] = result[resultLen - i];
+    }
 
     return result;
 }
+
+/**
+ * @brief DigitalFiltering::fftWithShiftBatch
+ * Run fftWithShift on several signals in parallel.
+ *
+ * @param signals
+ * The signals. They are modified in the same way as by fftWithShift.
+ *
+ * @param resultBits
+ * The transforms have 2^resultBits points.
+ *
+ * @param scaleByLen
+ * Divide the results by the length of the signals.
+ *
+ * @return
+ * The results in the same order as signals.
+ */
+QVector<QVector<double> > DigitalFiltering::fftWithShiftBatch(QVector<QVector<double> > &signals, int resultBits, bool scaleByLen)
+{
+    QVector<QVector<double> > results(signals.size());
+
+    // Detach before the elements are accessed from several threads
+    signals.detach();
+
+    Utility::runParallel(signals.size(), [&](int i) {
+        results[i] = fftWithShift(signals[i], resultBits, scaleByLen);
+    });
+
+    return results;
+}
+
+FirFilter::FirFilter(const QVector<double> &taps)
+{
+    setTaps(taps);
+}
+
+void FirFilter::setTaps(const QVector<double> &taps)
+{
+    mKernel = makeFirKernel(taps);
+    reset();
+}
+
+QVector<double> FirFilter::taps() const
+{
+    return mKernel->taps;
+}
+
+void FirFilter::reset()
+{
+    mHistory.clear();
+}
+
+/**
+ * @brief FirFilter::process
+ * Filter the next block of a stream. The filter state is kept between calls,
+ * so the output is the same as when filtering the whole stream at once.
+ *
+ * @param samples
+ * The new samples.
+ *
+ * @return
+ * One output for every input after the first taps inputs of the stream, so
+ * that a stream of N samples gives the N - taps outputs of filterSignal
+ * without its zero padding. Output n corresponds to the input samples n to
+ * n + taps - 1.
+ */
+QVector<double> FirFilter::process(const QVector<double> &samples)
+{
+    const int m = mKernel->taps.size();
+    QVector<double> out;
+
+    if (m == 0) {
+        out.fill(0.0, samples.size());
+        return out;
+    }
+
+    mHistory.append(samples);
+
+    int outLen = mHistory.size() - m;
+    if (outLen > 0) {
+        out.resize(outLen);
+        correlateValid(*mKernel, mHistory.constData(), mHistory.size(), out.data(), outLen);
+        mHistory.remove(0, outLen);
+    }
+
+    return out;
+}
@@ -21,10 +21,20 @@
 #define DIGITALFILTERING_H
 
 #include <QVector>
+#include <QSharedPointer>
+
+struct FirKernel;
 
 class DigitalFiltering
 {
 public:
+    typedef enum {
+        WindowRectangular = 0,
+        WindowHann,
+        WindowHamming,
+        WindowBlackman
+    } WindowType;
+
     DigitalFiltering();
 
     static void fft(int dir,int m,double *real,double *imag);
@@ -35,8 +45,38 @@ public:
     static int whichPowerOfTwo(unsigned int number);
 
     static QVector<double> filterSignal(const QVector<double> &signal, const QVector<double> &filter, bool padAfter = false);
+    static QVector<QVector<double> > filterSignalBatch(const QVector<QVector<double> > &signals, const QVector<double> &filter, bool padAfter = false);
     static QVector<double> generateFirFilter(double f_break, int bits, bool useHamming);
     static QVector<double> fftWithShift(QVector<double> &signal, int resultBits, bool scaleByLen = false);
+    static QVector<QVector<double> > fftWithShiftBatch(QVector<QVector<double> > &signals, int resultBits, bool scaleByLen = false);
+
+    static void rfft(int m, const double *data, double *real, double *imag);
+    static QVector<double> window(WindowType type, int len);
+    static QVector<QVector<double> > stft(const QVector<double> &signal, int windowBits, int hop, WindowType window);
+    static bool selfTest(QString *report = nullptr);
+};
+
+/**
+ * @brief The FirFilter class
+ *
+ * Streaming FIR filter for applying the same filter to a signal block by block,
+ * e.g. to samples as they arrive. Uses the same direct or overlap-save FFT
+ * convolution as DigitalFiltering::filterSignal.
+ */
+class FirFilter
+{
+public:
+    FirFilter(const QVector<double> &taps = QVector<double>());
+
+    void setTaps(const QVector<double> &taps);
+    QVector<double> taps() const;
+    void reset();
+    QVector<double> process(const QVector<double> &samples);
+
+private:
+    QSharedPointer<FirKernel> mKernel;
+    QVector<double> mHistory;
+
 };
 
 #endif // DIGITALFILTERING_H
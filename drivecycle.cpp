@@ -0,0 +1,436 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "drivecycle.h"
+#include "motormap.h"
+#include "utility.h"
+
+#include <cmath>
+#include <QFile>
+#include <QStringList>
+#include <QRegularExpression>
+
+namespace {
+const double gravity = 9.81;
+
+// Profile steps per task when evaluating the motor in parallel
+const int stepsPerTask = 256;
+
+// Distance over which the grade of a log is calculated, to average out the
+// altitude noise
+const double gradeDistance = 20.0;
+
+void setError(QString *errorStr, QString msg)
+{
+    if (errorStr) {
+        *errorStr = msg;
+    }
+}
+
+bool checkProfile(DriveCycle::Profile &profile, QString *errorStr)
+{
+    if (profile.size() < 2) {
+        setError(errorStr, "The profile needs at least two samples");
+        return false;
+    }
+
+    return true;
+}
+
+// Append a sample, dropping samples that do not move forward in time
+void appendSample(DriveCycle::Profile &profile, double time, double speed, double grade)
+{
+    if (!profile.time.isEmpty() && time <= profile.time.last()) {
+        return;
+    }
+
+    profile.time.append(time);
+    profile.speed.append(speed);
+    profile.grade.append(grade);
+}
+
+// Motor state for one step of the profile
+struct StepResult {
+    double torque;
+    double powerIn;
+    double lossMotor;
+    double lossTot;
+    double current;
+    double batteryCurrent;
+    bool limited;
+    bool reachable;
+};
+
+StepResult evaluateStep(const MotorData &motor, const DriveCycle::Vehicle &vehicle,
+                        double rpm, double torque, double tempRise)
+{
+    MotorData md = motor;
+    md.params.tempInc = motor.params.tempInc + tempRise;
+
+    StepResult res;
+    res.limited = false;
+    res.reachable = MotorMap::evaluate(md, rpm, torque, vehicle.vbus);
+
+    // Scale the torque down until the current limits are met. The current
+    // is not quite proportional to the torque, so this takes a few rounds.
+    const MotorModel &m = md.model;
+    for (int i = 0;i < 5;i++) {
+        double scale = 1.0;
+
+        double iLim = md.iq >= 0.0 ? m.current_max : fabs(m.current_min);
+        if (iLim > 0.0 && md.i_mag > iLim) {
+            scale = iLim / md.i_mag;
+        }
+
+        double ib = md.p_in / vehicle.vbus / md.params.motorNum;
+        double ibLim = ib >= 0.0 ? m.in_current_max : fabs(m.in_current_min);
+        if (ibLim > 0.0 && fabs(ib) > ibLim) {
+            scale = qMin(scale, ibLim / fabs(ib));
+        }
+
+        if (scale > 0.999) {
+            break;
+        }
+
+        res.limited = true;
+        torque *= scale;
+        res.reachable = MotorMap::evaluate(md, rpm, torque, vehicle.vbus);
+    }
+
+    res.torque = md.torque_out;
+    res.powerIn = md.p_in;
+    res.lossMotor = md.loss_motor_tot;
+    res.lossTot = md.loss_tot;
+    res.current = md.i_mag;
+    res.batteryCurrent = md.p_in / vehicle.vbus / md.params.motorNum;
+    return res;
+}
+}
+
+/**
+ * @brief DriveCycle::profileFromCsv
+ * Read a profile from a text file with one sample per line:
+ * time in s, speed in km/h and optionally the grade in %. The columns can be
+ * separated by commas, semicolons or whitespace. Lines that do not start with
+ * a number, such as a header, are skipped.
+ */
+bool DriveCycle::profileFromCsv(const QByteArray &data, Profile &profile, QString *errorStr)
+{
+    profile = Profile();
+    QRegularExpression sep("[,;\\s]+");
+
+    for (auto line: data.split('\n')) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        QStringList tokens = QString::fromLatin1(line).trimmed().split(sep, Qt::SkipEmptyParts);
+#else
+        QStringList tokens = QString::fromLatin1(line).trimmed().split(sep, QString::SkipEmptyParts);
+#endif
+
+        if (tokens.size() < 2) {
+            continue;
+        }
+
+        bool ok1 = false, ok2 = false, ok3 = true;
+        double time = tokens.at(0).toDouble(&ok1);
+        double speed = tokens.at(1).toDouble(&ok2) / 3.6;
+        double grade = 0.0;
+
+        if (tokens.size() > 2) {
+            grade = tokens.at(2).toDouble(&ok3) / 100.0;
+        }
+
+        if (!ok1 || !ok2 || !ok3) {
+            continue;
+        }
+
+        appendSample(profile, time, speed, grade);
+    }
+
+    return checkProfile(profile, errorStr);
+}
+
+/**
+ * @brief DriveCycle::profileFromLog
+ * Read a profile from a log saved by the log analysis page. The speed is taken
+ * from the VESC speed, or from the GNSS speed if that is not available, and the
+ * grade from the GNSS altitude over the travelled distance.
+ */
+bool DriveCycle::profileFromLog(const QByteArray &data, Profile &profile, QString *errorStr)
+{
+    profile = Profile();
+
+    QList<QByteArray> lines = data.split('\n');
+    if (lines.isEmpty()) {
+        setError(errorStr, "Empty log");
+        return false;
+    }
+
+    int indTime = -1, indSpeed = -1, indSpeedGnss = -1, indAlt = -1, indTrip = -1;
+    QList<QByteArray> header = lines.first().trimmed().split(';');
+    for (int i = 0;i < header.size();i++) {
+        QByteArray key = header.at(i).split(':').first();
+        if (key == "t_day") indTime = i;
+        else if (key == "kmh_vesc") indSpeed = i;
+        else if (key == "kmh_gnss") indSpeedGnss = i;
+        else if (key == "gnss_alt") indAlt = i;
+        else if (key == "trip_vesc_abs") indTrip = i;
+    }
+
+    if (indSpeed < 0) {
+        indSpeed = indSpeedGnss;
+    }
+
+    if (indTime < 0 || indSpeed < 0) {
+        setError(errorStr, "The log has no time or speed");
+        return false;
+    }
+
+    QVector<double> alt;
+    QVector<double> trip;
+    QVector<double> last(header.size(), 0.0);
+    double timeFirst = -1.0;
+
+    for (int l = 1;l < lines.size();l++) {
+        QList<QByteArray> tokens = lines.at(l).trimmed().split(';');
+        if (tokens.size() != header.size()) {
+            continue;
+        }
+
+        // Empty fields repeat the previous value
+        for (int i = 0;i < tokens.size();i++) {
+            if (!tokens.at(i).isEmpty()) {
+                last[i] = tokens.at(i).toDouble();
+            }
+        }
+
+        if (timeFirst < 0.0) {
+            timeFirst = last.at(indTime);
+        }
+
+        double time = last.at(indTime) - timeFirst;
+        if (time < 0.0) { // Handle midnight
+            time += 60 * 60 * 24;
+        }
+
+        int sizeBefore = profile.size();
+        appendSample(profile, time, last.at(indSpeed) / 3.6, 0.0);
+
+        if (profile.size() != sizeBefore) {
+            alt.append(indAlt >= 0 ? last.at(indAlt) : 0.0);
+            trip.append(indTrip >= 0 ? last.at(indTrip) : 0.0);
+        }
+    }
+
+    if (indTrip < 0) {
+        // Integrate the speed if the log has no trip counter
+        for (int i = 1;i < trip.size();i++) {
+            trip[i] = trip.at(i - 1) + fabs(profile.speed.at(i)) *
+                    (profile.time.at(i) - profile.time.at(i - 1));
+        }
+    }
+
+    if (indAlt >= 0) {
+        int start = 0;
+        int end = 0;
+        for (int i = 0;i < profile.size();i++) {
+            while (start < i && (trip.at(i) - trip.at(start + 1)) >= (gradeDistance / 2.0)) {
+                start++;
+            }
+
+            end = qMax(end, i);
+            while ((end + 1) < profile.size() && (trip.at(end) - trip.at(i)) < (gradeDistance / 2.0)) {
+                end++;
+            }
+
+            double dist = trip.at(end) - trip.at(start);
+            if (dist > (gradeDistance / 4.0)) {
+                profile.grade[i] = qBound(-0.5, (alt.at(end) - alt.at(start)) / dist, 0.5);
+            }
+        }
+    }
+
+    return checkProfile(profile, errorStr);
+}
+
+/**
+ * @brief DriveCycle::loadProfile
+ * Load a profile from a file. Logs from the log analysis page are detected from
+ * their header, other files are read with profileFromCsv.
+ */
+bool DriveCycle::loadProfile(QString fileName, Profile &profile, QString *errorStr)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(errorStr, file.errorString());
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+    QByteArray firstLine = data.left(data.indexOf('\n'));
+
+    if (firstLine.split(';').first().split(':').size() > 1) {
+        return profileFromLog(data, profile, errorStr);
+    } else {
+        return profileFromCsv(data, profile, errorStr);
+    }
+}
+
+/**
+ * @brief DriveCycle::simulate
+ * Simulate a vehicle driven by motor following a profile.
+ *
+ * The torque needed at the wheel is calculated from the acceleration, the
+ * grade, the rolling resistance and the drag for all steps at once. The motor
+ * is then evaluated at all steps in parallel, with the torque reduced where the
+ * motor or battery current limits of the configuration are exceeded. The
+ * winding temperature is integrated over the cycle with a first-order thermal
+ * model, and the motor is evaluated a second time with the resistance at that
+ * temperature.
+ *
+ * @param motor
+ * Configured MotorData. The output of the gearing is the wheel.
+ *
+ * @param vehicle
+ * Vehicle parameters.
+ *
+ * @param profile
+ * Speed and grade profile.
+ *
+ * @return
+ * The result. valid is false and error is set if the simulation could not run.
+ */
+DriveCycle::Result DriveCycle::simulate(const MotorData &motor, const Vehicle &vehicle, const Profile &profile)
+{
+    Result res;
+    const int n = profile.size();
+
+    if (!motor.model.valid) {
+        res.error = "No motor configuration";
+        return res;
+    }
+
+    if (motor.model.wheel_diam <= 0.0) {
+        res.error = "The wheel diameter is not set in the motor configuration";
+        return res;
+    }
+
+    if (n < 2 || vehicle.vbus <= 0.0) {
+        res.error = "Invalid profile or battery voltage";
+        return res;
+    }
+
+    const double wheelRadius = motor.model.wheel_diam / 2.0;
+    const double *t = profile.time.constData();
+    const double *v = profile.speed.constData();
+
+    QVector<double> dt(n, 0.0);
+    res.torqueDemand.resize(n);
+    res.rpm.resize(n);
+
+    for (int i = 0;i < n;i++) {
+        int i0 = qMax(i - 1, 0);
+        int i1 = qMin(i + 1, n - 1);
+        double accel = (v[i1] - v[i0]) / (t[i1] - t[i0]);
+        double theta = atan(profile.grade.at(i));
+        double dir = v[i] > 0.0 ? 1.0 : (v[i] < 0.0 ? -1.0 : 0.0);
+
+        double force = vehicle.mass * accel +
+                vehicle.mass * gravity * (vehicle.rollingResistance * cos(theta) * dir + sin(theta)) +
+                0.5 * vehicle.airDensity * vehicle.dragArea * v[i] * fabs(v[i]);
+
+        res.torqueDemand[i] = force * wheelRadius;
+        res.rpm[i] = v[i] / (2.0 * M_PI * wheelRadius) * 60.0;
+
+        if (i < (n - 1)) {
+            dt[i] = t[i + 1] - t[i];
+        }
+    }
+
+    QVector<StepResult> steps(n);
+    QVector<double> tempRise(n, 0.0);
+    const int tasks = (n + stepsPerTask - 1) / stepsPerTask;
+
+    auto evaluateAll = [&]() {
+        StepResult *out = steps.data();
+        Utility::runParallel(tasks, [&](int task) {
+            int end = qMin((task + 1) * stepsPerTask, n);
+            for (int i = task * stepsPerTask;i < end;i++) {
+                out[i] = evaluateStep(motor, vehicle, res.rpm.at(i),
+                                      res.torqueDemand.at(i), tempRise.at(i));
+            }
+        });
+    };
+
+    auto integrateTemp = [&]() {
+        double rise = 0.0;
+        double tau = qMax(vehicle.thermalTimeConstant, 1e-3);
+        for (int i = 0;i < n;i++) {
+            tempRise[i] = rise;
+            double riseSteady = steps.at(i).lossMotor / motor.params.motorNum *
+                    vehicle.thermalResistance;
+            rise = riseSteady + (rise - riseSteady) * exp(-dt.at(i) / tau);
+        }
+    };
+
+    evaluateAll();
+    integrateTemp();
+    evaluateAll();
+    integrateTemp();
+
+    res.torque.resize(n);
+    res.powerIn.resize(n);
+    res.lossMotor.resize(n);
+    res.current.resize(n);
+    res.batteryCurrent.resize(n);
+    res.tempRise = tempRise;
+
+    for (int i = 0;i < n;i++) {
+        const StepResult &s = steps.at(i);
+        res.torque[i] = s.torque;
+        res.powerIn[i] = s.powerIn;
+        res.lossMotor[i] = s.lossMotor;
+        res.current[i] = s.current;
+        res.batteryCurrent[i] = s.batteryCurrent;
+
+        double hours = dt.at(i) / 3600.0;
+        res.distance += fabs(v[i]) * dt.at(i);
+        res.energyIn += qMax(s.powerIn, 0.0) * hours;
+        res.energyRegen += qMax(-s.powerIn, 0.0) * hours;
+        res.energyLoss += s.lossTot * hours;
+        res.tempRiseMax = qMax(res.tempRiseMax, tempRise.at(i));
+        res.currentMax = qMax(res.currentMax, s.current);
+        res.batteryCurrentMax = qMax(res.batteryCurrentMax, fabs(s.batteryCurrent));
+
+        if (s.limited) {
+            res.timeLimited += dt.at(i);
+        }
+
+        if (!s.reachable) {
+            res.timeUnreachable += dt.at(i);
+        }
+    }
+
+    res.duration = t[n - 1] - t[0];
+    if (res.distance > 0.0) {
+        res.whKm = (res.energyIn - res.energyRegen) / (res.distance / 1000.0);
+    }
+
+    res.valid = true;
+    return res;
+}
@@ -0,0 +1,112 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef DRIVECYCLE_H
+#define DRIVECYCLE_H
+
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+#include "pages/pagemotorcomparison.h"
+
+/*
+ * Time-stepped simulation of a vehicle following a speed and grade profile,
+ * using the MotorData model for the motor and controller.
+ */
+namespace DriveCycle
+{
+struct Profile {
+    QVector<double> time;  // s
+    QVector<double> speed; // m/s
+    QVector<double> grade; // Rise over run
+
+    int size() const {
+        return time.size();
+    }
+};
+
+struct Vehicle {
+    Vehicle() {
+        mass = 100.0;
+        dragArea = 0.5;
+        rollingResistance = 0.01;
+        airDensity = 1.225;
+        vbus = 48.0;
+        thermalResistance = 0.2;
+        thermalTimeConstant = 600.0;
+    }
+
+    double mass;                // kg, including the rider and load
+    double dragArea;            // Drag coefficient times frontal area in m^2
+    double rollingResistance;   // Rolling resistance coefficient
+    double airDensity;          // kg/m^3
+    double vbus;                // Battery voltage in V
+    double thermalResistance;   // Winding to ambient in K/W
+    double thermalTimeConstant; // s
+};
+
+struct Result {
+    Result() {
+        valid = false;
+        distance = 0.0;
+        duration = 0.0;
+        energyIn = 0.0;
+        energyRegen = 0.0;
+        energyLoss = 0.0;
+        whKm = 0.0;
+        tempRiseMax = 0.0;
+        currentMax = 0.0;
+        batteryCurrentMax = 0.0;
+        timeLimited = 0.0;
+        timeUnreachable = 0.0;
+    }
+
+    bool valid;
+    QString error;
+
+    // One value per profile step
+    QVector<double> torqueDemand;    // Nm at the wheel
+    QVector<double> torque;          // Nm at the wheel after the limits
+    QVector<double> rpm;             // Wheel RPM
+    QVector<double> powerIn;         // W from the battery
+    QVector<double> lossMotor;       // W
+    QVector<double> current;         // A per motor
+    QVector<double> batteryCurrent;  // A per controller
+    QVector<double> tempRise;        // K above ambient
+
+    double distance;          // m
+    double duration;          // s
+    double energyIn;          // Wh taken from the battery
+    double energyRegen;       // Wh put back into the battery
+    double energyLoss;        // Wh lost in the motors and gearing
+    double whKm;              // Net consumption
+    double tempRiseMax;       // K
+    double currentMax;        // A per motor
+    double batteryCurrentMax; // A per controller
+    double timeLimited;       // s where a current limit reduced the torque
+    double timeUnreachable;   // s where the bus voltage was not enough for the speed
+};
+
+bool profileFromCsv(const QByteArray &data, Profile &profile, QString *errorStr = nullptr);
+bool profileFromLog(const QByteArray &data, Profile &profile, QString *errorStr = nullptr);
+bool loadProfile(QString fileName, Profile &profile, QString *errorStr = nullptr);
+Result simulate(const MotorData &motor, const Vehicle &vehicle, const Profile &profile);
+}
+
+#endif // DRIVECYCLE_H
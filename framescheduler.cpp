@@ -0,0 +1,198 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "framescheduler.h"
+#include "widgets/qcustomplot.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <cmath>
+
+FrameScheduler::FrameScheduler(QObject *parent) : QObject(parent)
+{
+    mFrameCostMs = 0.0;
+    mReplotMs = 0.0;
+    mFrameIntervalMin = 16;
+    mFrameIntervalMax = 100;
+
+    mTimer = new QTimer(this);
+    mTimer->setTimerType(Qt::PreciseTimer);
+    mTimer->start(mFrameIntervalMin);
+
+    connect(mTimer, SIGNAL(timeout()), this, SLOT(timerSlot()));
+}
+
+FrameScheduler *FrameScheduler::instance()
+{
+    static QPointer<FrameScheduler> inst;
+
+    if (!inst) {
+        inst = new FrameScheduler(QCoreApplication::instance());
+    }
+
+    return inst;
+}
+
+/**
+ * @brief FrameScheduler::addClient
+ * Run frameFunc on every frame tick while widget is shown. The client is
+ * removed automatically when widget is destroyed.
+ *
+ * @param widget
+ * The widget (usually a page) the frame function updates.
+ *
+ * @param frameFunc
+ * Function that updates the widget, e.g. sets new plot data and requests a
+ * queued replot.
+ */
+void FrameScheduler::addClient(QWidget *widget, std::function<void()> frameFunc)
+{
+    Client c;
+    c.widget = widget;
+    c.frameFunc = frameFunc;
+
+    // Replots are queued, so their time is collected when they happen and
+    // added to the cost of the next frame.
+    for (auto p: widget->findChildren<QCustomPlot*>()) {
+        connect(p, &QCustomPlot::afterReplot, this, [this, p]() {
+            mReplotMs += p->replotTime(false);
+        });
+    }
+
+    mClients.append(c);
+}
+
+void FrameScheduler::addStreamConsumer(QWidget *widget, FrameScheduler::Stream stream)
+{
+    QPointer<QWidget> w = widget;
+    addStreamConsumer(widget, stream, [w]() {
+        return w && isWidgetShown(w);
+    });
+}
+
+void FrameScheduler::addStreamConsumer(QObject *owner, FrameScheduler::Stream stream,
+                                       std::function<bool()> isActive)
+{
+    Consumer c;
+    c.owner = owner;
+    c.stream = stream;
+    c.isActive = isActive;
+    mConsumers.append(c);
+}
+
+/**
+ * @brief FrameScheduler::isStreamNeeded
+ * Check if any consumer of a stream currently needs its data.
+ *
+ * @param stream
+ * The stream to check.
+ *
+ * @return
+ * True if at least one registered consumer of the stream is active.
+ */
+bool FrameScheduler::isStreamNeeded(FrameScheduler::Stream stream)
+{
+    bool res = false;
+
+    for (int i = 0;i < mConsumers.size();i++) {
+        const Consumer &c = mConsumers.at(i);
+
+        if (!c.owner) {
+            mConsumers.removeAt(i);
+            i--;
+            continue;
+        }
+
+        if (c.stream == stream && c.isActive()) {
+            res = true;
+            break;
+        }
+    }
+
+    return res;
+}
+
+bool FrameScheduler::isWidgetShown(QWidget *widget)
+{
+    if (!widget->isVisible()) {
+        return false;
+    }
+
+    QWidget *win = widget->window();
+    return !win->isMinimized() && !widget->visibleRegion().isEmpty();
+}
+
+int FrameScheduler::frameInterval() const
+{
+    return mTimer->interval();
+}
+
+double FrameScheduler::frameCostMs() const
+{
+    return mFrameCostMs;
+}
+
+void FrameScheduler::setFrameIntervalLimits(int minMs, int maxMs)
+{
+    mFrameIntervalMin = minMs;
+    mFrameIntervalMax = qMax(minMs, maxMs);
+    mTimer->setInterval(qBound(mFrameIntervalMin, mTimer->interval(), mFrameIntervalMax));
+}
+
+void FrameScheduler::timerSlot()
+{
+    QElapsedTimer t;
+    t.start();
+
+    // Only the plots that replotted since the last frame
+    double replotMs = mReplotMs;
+    mReplotMs = 0.0;
+    bool anyShown = false;
+
+    for (int i = 0;i < mClients.size();i++) {
+        Client &c = mClients[i];
+
+        if (!c.widget) {
+            mClients.removeAt(i);
+            i--;
+            continue;
+        }
+
+        if (!isWidgetShown(c.widget)) {
+            continue;
+        }
+
+        anyShown = true;
+        c.frameFunc();
+    }
+
+    if (!anyShown) {
+        return;
+    }
+
+    double cost = double(t.nsecsElapsed()) / 1e6 + replotMs;
+    mFrameCostMs = 0.9 * mFrameCostMs + 0.1 * cost;
+
+    // Spend at most about half of the GUI thread time on frames
+    int interval = qBound(mFrameIntervalMin, int(ceil(2.0 * mFrameCostMs)), mFrameIntervalMax);
+    if (interval != mTimer->interval()) {
+        mTimer->setInterval(interval);
+    }
+}
+
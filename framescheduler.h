@@ -0,0 +1,96 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QObject>
+#include <QWidget>
+#include <QTimer>
+#include <QPointer>
+#include <QList>
+#include <functional>
+
+class QCustomPlot;
+
+/*
+ * Shared frame tick for pages that update plots and other realtime views.
+ *
+ * - Pages register a frame function instead of running their own timers. All
+ *   frame functions run from one tick, so the queued replots they request are
+ *   handled together.
+ * - Frame functions of widgets that are not shown are skipped. They run as soon
+ *   as the widget is shown again, so pending data is not lost.
+ * - The tick interval adapts to the measured cost of the frame functions and the
+ *   replots of the plots in the registered widgets.
+ * - Widgets can declare which telemetry streams they consume, so that polling of
+ *   streams without a visible consumer can be paused.
+ */
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    typedef enum {
+        StreamRtData = 0,
+        StreamAppData,
+        StreamImuData,
+        StreamBmsData,
+        StreamNum
+    } Stream;
+
+    explicit FrameScheduler(QObject *parent = nullptr);
+    static FrameScheduler *instance();
+
+    void addClient(QWidget *widget, std::function<void()> frameFunc);
+    void addStreamConsumer(QWidget *widget, Stream stream);
+    void addStreamConsumer(QObject *owner, Stream stream, std::function<bool()> isActive);
+    bool isStreamNeeded(Stream stream);
+    static bool isWidgetShown(QWidget *widget);
+
+    int frameInterval() const;
+    double frameCostMs() const;
+
+    void setFrameIntervalLimits(int minMs, int maxMs);
+
+private slots:
+    void timerSlot();
+
+private:
+    struct Client {
+        QPointer<QWidget> widget;
+        std::function<void()> frameFunc;
+    };
+
+    struct Consumer {
+        QPointer<QObject> owner;
+        Stream stream;
+        std::function<bool()> isActive;
+    };
+
+    QTimer *mTimer;
+    QList<Client> mClients;
+    QList<Consumer> mConsumers;
+    double mFrameCostMs;
+    double mReplotMs;
+    int mFrameIntervalMin;
+    int mFrameIntervalMax;
+
+};
+
+#endif // FRAMESCHEDULER_H
@@ -0,0 +1,181 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "hotplugmonitor.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace {
+// Time from the first event to the snapshot. Several events usually come
+// in a burst when a device is plugged in.
+const int debounceMs = 300;
+const int defaultFallbackMs = 1000;
+}
+
+HotplugMonitor::HotplugMonitor(QObject *parent) : QObject(parent)
+{
+    mSocket = -1;
+    mNotifier = nullptr;
+
+    for (int i = 0;i < SourceNum;i++) {
+        mWatches[i].debounce = new QTimer(this);
+        mWatches[i].debounce->setSingleShot(true);
+        mWatches[i].debounce->setInterval(debounceMs);
+        Source s = Source(i);
+        connect(mWatches[i].debounce, &QTimer::timeout, [this, s]() {
+            check(s);
+        });
+    }
+
+    mFallbackTimer = new QTimer(this);
+    mFallbackTimer->setInterval(defaultFallbackMs);
+    connect(mFallbackTimer, SIGNAL(timeout()), this, SLOT(fallbackSlot()));
+
+    if (!openUevent()) {
+        mFallbackTimer->start();
+    }
+}
+
+HotplugMonitor::~HotplugMonitor()
+{
+#ifdef Q_OS_LINUX
+    if (mSocket >= 0) {
+        close(mSocket);
+    }
+#endif
+}
+
+/**
+ * @brief HotplugMonitor::watch
+ * Start watching a source.
+ *
+ * @param source
+ * The source.
+ *
+ * @param snapshot
+ * Function that lists the devices of the source. It is called once here and
+ * then only after events, or on the fallback timer.
+ */
+void HotplugMonitor::watch(HotplugMonitor::Source source, std::function<QStringList ()> snapshot)
+{
+    mWatches[source].snapshot = snapshot;
+    mWatches[source].last = snapshot ? snapshot() : QStringList();
+}
+
+QStringList HotplugMonitor::devices(HotplugMonitor::Source source) const
+{
+    return mWatches[source].last;
+}
+
+bool HotplugMonitor::isEventDriven() const
+{
+    return mSocket >= 0;
+}
+
+void HotplugMonitor::setFallbackInterval(int ms)
+{
+    mFallbackTimer->setInterval(ms);
+}
+
+void HotplugMonitor::ueventReadable()
+{
+#ifdef Q_OS_LINUX
+    char buf[4096];
+
+    for (;;) {
+        ssize_t len = recv(mSocket, buf, sizeof(buf), MSG_DONTWAIT);
+        if (len <= 0) {
+            break;
+        }
+
+        // "action@devpath", followed by KEY=VALUE fields. All separated by NUL.
+        const QList<QByteArray> fields = QByteArray(buf, int(len)).split('\0');
+        for (const auto &f: fields) {
+            if (f == "SUBSYSTEM=tty") {
+                mWatches[SourceSerial].debounce->start();
+            } else if (f == "SUBSYSTEM=net") {
+                mWatches[SourceCan].debounce->start();
+            }
+        }
+    }
+#endif
+}
+
+void HotplugMonitor::fallbackSlot()
+{
+    for (int i = 0;i < SourceNum;i++) {
+        check(Source(i));
+    }
+}
+
+bool HotplugMonitor::openUevent()
+{
+#ifdef Q_OS_LINUX
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_pid = 0;
+    addr.nl_groups = 1; // Kernel events
+
+    // This is not allowed in some sandboxes, e.g. on Android
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return false;
+    }
+
+    mSocket = fd;
+    mNotifier = new QSocketNotifier(mSocket, QSocketNotifier::Read, this);
+    connect(mNotifier, SIGNAL(activated(int)), this, SLOT(ueventReadable()));
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HotplugMonitor::check(HotplugMonitor::Source source)
+{
+    Watch &w = mWatches[source];
+
+    if (!w.snapshot) {
+        return;
+    }
+
+    QStringList now = w.snapshot();
+    if (now == w.last) {
+        return;
+    }
+
+    w.last = now;
+
+    switch (source) {
+    case SourceSerial: emit serialPortsChanged(); break;
+    case SourceCan: emit canInterfacesChanged(); break;
+    default: break;
+    }
+}
@@ -0,0 +1,84 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef HOTPLUGMONITOR_H
+#define HOTPLUGMONITOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QStringList>
+#include <QSocketNotifier>
+#include <functional>
+
+/**
+ * @brief The HotplugMonitor class
+ *
+ * Notices when serial ports or CAN interfaces appear or disappear. On Linux
+ * the kernel uevents for the tty and net subsystems are read from a netlink
+ * socket, so nothing is polled while the set of devices stays the same. Where
+ * that is not available a slow timer is used instead.
+ *
+ * Each watched source has a snapshot function that lists its devices. Events
+ * are debounced, which also gives udev time to set up the device nodes, and a
+ * change is only signalled when the snapshot is different from the last one.
+ */
+class HotplugMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    typedef enum {
+        SourceSerial = 0,
+        SourceCan,
+        SourceNum
+    } Source;
+
+    explicit HotplugMonitor(QObject *parent = nullptr);
+    ~HotplugMonitor();
+
+    void watch(Source source, std::function<QStringList()> snapshot);
+    QStringList devices(Source source) const;
+    bool isEventDriven() const;
+    void setFallbackInterval(int ms);
+
+signals:
+    void serialPortsChanged();
+    void canInterfacesChanged();
+
+private slots:
+    void ueventReadable();
+    void fallbackSlot();
+
+private:
+    struct Watch {
+        std::function<QStringList()> snapshot;
+        QStringList last;
+        QTimer *debounce;
+    };
+
+    Watch mWatches[SourceNum];
+    int mSocket;
+    QSocketNotifier *mNotifier;
+    QTimer *mFallbackTimer;
+
+    bool openUevent();
+    void check(Source source);
+
+};
+
+#endif // HOTPLUGMONITOR_H
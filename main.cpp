@@ -29,6 +29,7 @@
 #include "codeloader.h"
 #include "configparam.h"
 #include "utility.h"
+#include "digitalfiltering.h"
 #include "heatshrink/heatshrinkif.h"
 #include "minimp3/qminimp3.h"
 
@@ -95,6 +96,8 @@ static void showHelp()
     qDebug() << "--testPkgDesc [hwtype:hwname:optfwname] : Test isCompatible from package QML description after build";
     qDebug() << "--useBoardSetupWindow : Start board setup window instead of the main UI";
     qDebug() << "--xmlConfToCode [xml-file] : Generate C code from XML configuration file (the files are saved in the same directory as the XML)";
+    qDebug() << "--compileConfigs [dir] : Compile the XML parameter files in dir (e.g. res/config) to the binary format and write res_config_bin.qrc";
+    qDebug() << "--selfTestDsp : Check the FFT, STFT and FIR filter implementations against reference implementations and print timings";
     qDebug() << "--vescPort [port] : VESC Port for commands that connect, e.g. /dev/ttyACM0. If this command is left out autoconnect will be used.";
     qDebug() << "--canFwd [canId] : Can ID for CAN forwarding";
     qDebug() << "--getMcConf [confPath] : Connect and read motor configuration and store the XML to confPath.";
@@ -110,6 +113,7 @@ static void showHelp()
     qDebug() << "--uploadFirmware [path] : Upload firmware-file from path.";
     qDebug() << "--uploadBootloaderBuiltin : Upload bootloader from generic included bootloaders.";
     qDebug() << "--queryDeviceFwParams : Connect and print out device fw parameters.";
+    qDebug() << "--connectTimings : Connect and print out how long each phase of the connection took, and the serial link latency and jitter.";
     qDebug() << "--writeFileToSdCard [fileLocal:pathSdcard] : Write file to SD-card.";
     qDebug() << "--packFirmware [fileIn:fileOut] : Pack firmware-file for compatibility with the bootloader. ";
     qDebug() << "--packLisp [fileIn:fileOut] : Pack LispBM file and the included imports.";
@@ -318,6 +322,8 @@ int main(int argc, char *argv[])
     QString pkgDesc = "";
     QStringList pkgDescTests;
     QString xmlCodePath = "";
+    QString compileConfigsDir = "";
+    bool selfTestDsp = false;
     QString vescPort = "";
     int canFwd = -1;
     QString getMcConfPath = "";
@@ -333,6 +339,7 @@ int main(int argc, char *argv[])
     QString firmwarePath = "";
     bool uploadBootloaderBuiltin = false;
     bool queryDeviceFwParams = false;
+    bool connectTimings = false;
     QString fwPackIn = "";
     QString fwPackOut = "";
     QString fileForSdIn = "";
@@ -508,6 +515,23 @@ int main(int argc, char *argv[])
             }
         }
 
+        if (str == "--selfTestDsp") {
+            selfTestDsp = true;
+            found = true;
+        }
+
+        if (str == "--compileConfigs") {
+            if ((i + 1) < args.size()) {
+                i++;
+                compileConfigsDir = args.at(i);
+                found = true;
+            } else {
+                i++;
+                qCritical() << "No path to config directory";
+                return 1;
+            }
+        }
+
         if (str == "--xmlConfToCode") {
             if ((i + 1) < args.size()) {
                 i++;
@@ -660,6 +684,11 @@ int main(int argc, char *argv[])
             found = true;
         }
 
+        if (str == "--connectTimings") {
+            connectTimings = true;
+            found = true;
+        }
+
         if (str == "--debugOutFile") {
             if ((i + 1) < args.size()) {
                 i++;
@@ -804,6 +833,34 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (selfTestDsp) {
+        QString report;
+        bool ok = DigitalFiltering::selfTest(&report);
+        qDebug().noquote() << report.trimmed();
+
+        if (ok) {
+            qDebug() << "All DSP checks passed";
+            return 0;
+        } else {
+            qCritical() << "DSP checks failed";
+            return 2;
+        }
+    }
+
+    if (!compileConfigsDir.isEmpty()) {
+        int compiled = 0;
+        bool ok = Utility::configCompileBinary(compileConfigsDir, &compiled);
+        qDebug() << "Compiled" << compiled << "parameter files";
+
+        if (ok) {
+            qDebug() << "Done!";
+            return 0;
+        } else {
+            qCritical() << "Errors while compiling parameter files.";
+            return 2;
+        }
+    }
+
     if (!fwPackIn.isEmpty()) {
         if (!fwPackIn.endsWith(".bin", Qt::CaseInsensitive)) {
             qWarning() << "Warning: Unexpected file extension for a firmware-file.";
@@ -1092,7 +1149,7 @@ int main(int argc, char *argv[])
 
     if (isMcConf || isAppConf || isCustomConf || !lispPath.isEmpty() ||
             eraseLisp || !firmwarePath.isEmpty() || uploadBootloaderBuiltin ||
-            queryDeviceFwParams || !fileForSdIn.isEmpty() || bridgeAppData) {
+            queryDeviceFwParams || connectTimings || !fileForSdIn.isEmpty() || bridgeAppData) {
         if (offscreen) {
             qputenv("QT_QPA_PLATFORM", "offscreen");
         }
@@ -1103,7 +1160,7 @@ int main(int argc, char *argv[])
         vesc->setShowFwUpdateAvailable(false);
         vesc->setIgnoreTestVersion(true);
 
-        vesc->fwConfig()->loadParamsXml(Utility::configPath("fw.xml"));
+        vesc->fwConfig()->loadParams(Utility::configPath("fw.xml"));
         Utility::configLoadLatest(vesc);
 
         if (bridgeAppData) {
@@ -1259,6 +1316,37 @@ int main(int argc, char *argv[])
                     }
                 }
 
+                if (connectTimings) {
+                    if (!vesc->customConfigRxDone()) {
+                        Utility::waitSignal(vesc, SIGNAL(customConfigLoadDone()), 10000);
+                    }
+
+                    // Nothing reads the configurations during the bring-up without the GUI,
+                    // so read them here to get the first motor and app configuration phases.
+                    if (vesc->fwRx()) {
+                        if (!vesc->connectTimingReport().contains("Motor configuration")) {
+                            vesc->commands()->getMcconf();
+                            Utility::waitSignal(vesc->mcConfig(), SIGNAL(updated()), 4000);
+                        }
+
+                        if (!vesc->connectTimingReport().contains("App configuration")) {
+                            vesc->commands()->getAppConf();
+                            Utility::waitSignal(vesc->appConfig(), SIGNAL(updated()), 4000);
+                        }
+                    }
+
+                    // The serial I/O statistics cover the connection so far
+                    QString report = vesc->connectTimingReport() + vesc->serialIoReport();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+                    auto lines = report.split('\n', Qt::SkipEmptyParts);
+#else
+                    auto lines = report.split('\n', QString::SkipEmptyParts);
+#endif
+                    for (auto line: lines) {
+                        qInfo() << line;
+                    }
+                }
+
                 if (isMcConf || isAppConf || isCustomConf || queryDeviceFwParams) {
                     bool res = vesc->customConfigRxDone();
                     if (!res) {
@@ -1558,7 +1646,7 @@ int main(int argc, char *argv[])
         }
         app = new QCoreApplication(argc, argv);
         vesc = new VescInterface;
-        vesc->fwConfig()->loadParamsXml(Utility::configPath("fw.xml"));
+        vesc->fwConfig()->loadParams(Utility::configPath("fw.xml"));
         Utility::configLoadLatest(vesc);
 
         QTimer::singleShot(10, [&]() {
@@ -1656,7 +1744,7 @@ int main(int argc, char *argv[])
 
         if (!loadQml.isEmpty() || loadQmlVesc) {
             vesc = new VescInterface;
-            vesc->fwConfig()->loadParamsXml(Utility::configPath("fw.xml"));
+            vesc->fwConfig()->loadParams(Utility::configPath("fw.xml"));
             Utility::configLoadLatest(vesc);
 
             if (loadQmlVesc) {
@@ -34,6 +34,7 @@
 #include "widgets/experimentplot.h"
 #include "widgets/helpdialog.h"
 #include "utility.h"
+#include "framescheduler.h"
 #include "widgets/paramdialog.h"
 
 namespace {
@@ -256,7 +257,7 @@ MainWindow::MainWindow(QWidget *parent) :
     // Remove the menu with the option to hide the toolbar
     ui->mainToolBar->setContextMenuPolicy(Qt::PreventContextMenu);
 
-    mVesc->fwConfig()->loadParamsXml(Utility::configPath("fw.xml"));
+    mVesc->fwConfig()->loadParams(Utility::configPath("fw.xml"));
     Utility::configLoadLatest(mVesc);
 
     QMenu *fwMenu = new QMenu(this);
@@ -482,8 +483,13 @@ MainWindow::MainWindow(QWidget *parent) :
     mPollImuTimer.start(int(1000.0 / mSettings.value("poll_rate_imu_data", 50).toDouble()));
     mPollBmsTimer.start(int(1000.0 / mSettings.value("poll_rate_bms_data", 10).toDouble()));
 
+    // Streams are only polled while something that is shown uses them. The realtime
+    // log uses both the realtime and the IMU data.
+    FrameScheduler::instance()->addStreamConsumer(ui->dispCurrent, FrameScheduler::StreamRtData);
+
     connect(&mPollRtTimer, &QTimer::timeout, [this]() {
-        if (ui->actionRtData->isChecked()) {
+        if (ui->actionRtData->isChecked() && (mVesc->isRtLogOpen() ||
+                FrameScheduler::instance()->isStreamNeeded(FrameScheduler::StreamRtData))) {
             mVesc->commands()->getStats(0xFFFFFFFF);
             mVesc->commands()->getValues();
             mVesc->commands()->getValuesSetup();
@@ -492,7 +498,8 @@ MainWindow::MainWindow(QWidget *parent) :
     });
 
     connect(&mPollAppTimer, &QTimer::timeout, [this]() {
-        if (ui->actionRtDataApp->isChecked()) {
+        if (ui->actionRtDataApp->isChecked() &&
+                FrameScheduler::instance()->isStreamNeeded(FrameScheduler::StreamAppData)) {
             mVesc->commands()->getDecodedAdc();
             mVesc->commands()->getDecodedChuk();
             mVesc->commands()->getDecodedPpm();
@@ -501,14 +508,16 @@ MainWindow::MainWindow(QWidget *parent) :
     });
 
     connect(&mPollImuTimer, &QTimer::timeout, [this]() {
-        if (ui->actionIMU->isChecked()) {
+        if (ui->actionIMU->isChecked() && (mVesc->isRtLogOpen() ||
+                FrameScheduler::instance()->isStreamNeeded(FrameScheduler::StreamImuData))) {
             mVesc->commands()->getImuData(0xFFFF);
             mPollImuTimer.setInterval(int(1000.0 / mSettings.value("poll_rate_imu_data", 50).toDouble()));
         }
     });
 
     connect(&mPollBmsTimer, &QTimer::timeout, [this]() {
-        if (ui->actionrtDataBms->isChecked()) {
+        if (ui->actionrtDataBms->isChecked() &&
+                FrameScheduler::instance()->isStreamNeeded(FrameScheduler::StreamBmsData)) {
             mVesc->commands()->bmsGetValues();
             mPollBmsTimer.setInterval(int(1000.0 / mSettings.value("poll_rate_bms_data", 10).toDouble()));
         }
@@ -25,6 +25,7 @@
 #include <QPrintEngine>
 #endif
 #include <QTime>
+#include <functional>
 
 #include "mapwidget.h"
 #include "utility.h"
@@ -170,6 +171,13 @@ MapWidget::MapWidget(QWidget *parent) : QWidget(parent)
     mCameraImageOpacity = 0.8;
     mInteractionMode = InteractionModeDefault;
 
+    for (int i = 0;i < LayerNum;i++) {
+        mLayerDirty[i] = true;
+    }
+    mLayerDpr = 0.0;
+    mInfoSegmentsCached = 0;
+    mInfoPointsCached = 0;
+
     mOsm = new OsmClient(this);
     mDrawOpenStreetmap = true;
     mOsmZoomLevel = 15;
@@ -419,6 +427,7 @@ void MapWidget::addRoutePoint(double px, double py, double speed, qint32 time)
     pos.setSpeed(speed);
     pos.setTime(time);
     mRoutes[mRouteNow].append(pos);
+    invalidateLayer(LayerRoutes);
     update();
 }
 
@@ -444,6 +453,7 @@ QList<QList<LocPoint> > MapWidget::getRoutes()
 void MapWidget::setRoute(const QList<LocPoint> &route)
 {
     mRoutes[mRouteNow] = route;
+    invalidateLayer(LayerRoutes);
     update();
 }
 
@@ -456,6 +466,7 @@ void MapWidget::addRoute(const QList<LocPoint> &route)
     }
 
     mRoutes.append(route);
+    invalidateLayer(LayerRoutes);
     update();
 }
 
@@ -467,6 +478,7 @@ int MapWidget::getRouteNum()
 void MapWidget::clearRoute()
 {
     mRoutes[mRouteNow].clear();
+    invalidateLayer(LayerRoutes);
     update();
 }
 
@@ -476,6 +488,7 @@ void MapWidget::clearAllRoutes()
         mRoutes[i].clear();
     }
 
+    invalidateLayer(LayerRoutes);
     update();
 }
 
@@ -488,6 +501,10 @@ void MapWidget::addInfoPoint(LocPoint &info, bool updateMap)
 {
     mInfoTraces[mInfoTraceNow].append(info);
 
+    if (isInfoTraceCached(mInfoTraceNow)) {
+        invalidateLayer(LayerInfoTraces);
+    }
+
     if (updateMap) {
         update();
     }
@@ -495,6 +512,10 @@ void MapWidget::addInfoPoint(LocPoint &info, bool updateMap)
 
 void MapWidget::clearInfoTrace()
 {
+    if (isInfoTraceCached(mInfoTraceNow)) {
+        invalidateLayer(LayerInfoTraces);
+    }
+
     mInfoTraces[mInfoTraceNow].clear();
     update();
 }
@@ -505,17 +526,20 @@ void MapWidget::clearAllInfoTraces()
         mInfoTraces[i].clear();
     }
 
+    invalidateLayer(LayerInfoTraces);
     update();
 }
 
 void MapWidget::addPerspectivePixmap(PerspectivePixmap map)
 {
     mPerspectivePixmaps.append(map);
+    invalidateLayer(LayerTiles);
 }
 
 void MapWidget::clearPerspectivePixmaps()
 {
     mPerspectivePixmaps.clear();
+    invalidateLayer(LayerTiles);
     update();
 }
 
@@ -530,18 +554,20 @@ QPoint MapWidget::getMousePosRelative()
 void MapWidget::setAntialiasDrawings(bool antialias)
 {
     mAntialiasDrawings = antialias;
-    update();
+    invalidateLayers();
 }
 
 void MapWidget::setAntialiasOsm(bool antialias)
 {
     mAntialiasOsm = antialias;
+    invalidateLayer(LayerTiles);
     update();
 }
 
 void MapWidget::tileReady(OsmTile tile)
 {
     (void)tile;
+    invalidateLayer(LayerTiles);
     update();
 }
 
@@ -648,6 +674,7 @@ void MapWidget::mouseMoveEvent(QMouseEvent *e)
 
     if (mRoutePointSelected >= 0) {
         mRoutes[mRouteNow][mRoutePointSelected].setXY(mousePosMap.getX(), mousePosMap.getY());
+        invalidateLayer(LayerRoutes);
         update();
     }
 
@@ -747,6 +774,7 @@ void MapWidget::mousePressEvent(QMouseEvent *e)
                 }
             }
         }
+        invalidateLayer(LayerRoutes);
         update();
     } else if (shift) {
         if (mAnchorMode) {
@@ -785,6 +813,7 @@ void MapWidget::mousePressEvent(QMouseEvent *e)
                 }
             }
         }
+        invalidateLayer(LayerRoutes);
         update();
     } else if (ctrl_shift) {
         if (e->buttons() & Qt::LeftButton) {
@@ -800,6 +829,7 @@ void MapWidget::mousePressEvent(QMouseEvent *e)
             mRefLat = llh[0];
             mRefLon = llh[1];
             mRefHeight = 0.0;
+            invalidateLayer(LayerTiles);
         }
 
         update();
@@ -1025,6 +1055,15 @@ void MapWidget::removeMapModuleLast()
     }
 }
 
+void MapWidget::invalidateLayers()
+{
+    for (int i = 0;i < LayerNum;i++) {
+        mLayerDirty[i] = true;
+    }
+
+    update();
+}
+
 double MapWidget::getCameraImageOpacity() const
 {
     return mCameraImageOpacity;
@@ -1064,6 +1103,7 @@ bool MapWidget::getDrawRouteText() const
 void MapWidget::setDrawRouteText(bool drawRouteText)
 {
     mDrawRouteText = drawRouteText;
+    invalidateLayer(LayerRoutes);
     update();
 }
 
@@ -1130,6 +1170,7 @@ void MapWidget::setRouteNow(int routeNow)
         }
     }
 
+    invalidateLayer(LayerRoutes);
     update();
 }
 
@@ -1147,6 +1188,11 @@ void MapWidget::setInfoTraceNow(int infoTraceNow)
         QList<LocPoint> l;
         mInfoTraces.append(l);
     }
+
+    if (infoTraceOld != mInfoTraceNow) {
+        invalidateLayer(LayerInfoTraces);
+    }
+
     update();
 
     if (infoTraceOld != mInfoTraceNow) {
@@ -1226,6 +1272,7 @@ void MapWidget::setDrawGrid(bool drawGrid)
     mDrawGrid = drawGrid;
 
     if (drawGridOld != mDrawGrid) {
+        invalidateLayer(LayerTiles);
         update();
     }
 }
@@ -1334,6 +1381,17 @@ void MapWidget::drawCircleFast(QPainter &painter, QPointF center, double radius,
                        int(2.0 * radius), int(2.0 * radius), mPixmaps.at(type));
 }
 
+void MapWidget::invalidateLayer(MapWidget::CachedLayer layer)
+{
+    mLayerDirty[layer] = true;
+}
+
+bool MapWidget::isInfoTraceCached(int trace)
+{
+    // Traces with only a few points are cheap to draw and usually updated often
+    return mInfoTraces.at(trace).size() > 10;
+}
+
 int MapWidget::getOsmZoomLevel() const
 {
     return mOsmZoomLevel;
@@ -1347,6 +1405,7 @@ int MapWidget::getOsmMaxZoomLevel() const
 void MapWidget::setOsmMaxZoomLevel(int osmMaxZoomLevel)
 {
     mOsmMaxZoomLevel = osmMaxZoomLevel;
+    invalidateLayer(LayerTiles);
     update();
 }
 
@@ -1358,6 +1417,7 @@ double MapWidget::getInfoTraceTextZoom() const
 void MapWidget::setInfoTraceTextZoom(double infoTraceTextZoom)
 {
     mInfoTraceTextZoom = infoTraceTextZoom;
+    invalidateLayer(LayerInfoTraces);
     update();
 }
 
@@ -1430,6 +1490,7 @@ void MapWidget::removeLastRoutePoint()
         mRoutes[mRouteNow].removeLast();
     }
     emit lastRoutePointRemoved(pos);
+    invalidateLayer(LayerRoutes);
     update();
 }
 
@@ -1561,6 +1622,7 @@ double MapWidget::getOsmRes() const
 void MapWidget::setOsmRes(double osmRes)
 {
     mOsmRes = osmRes;
+    invalidateLayer(LayerTiles);
     update();
 }
 
@@ -1572,6 +1634,7 @@ bool MapWidget::getDrawOpenStreetmap() const
 void MapWidget::setDrawOpenStreetmap(bool drawOpenStreetmap)
 {
     mDrawOpenStreetmap = drawOpenStreetmap;
+    invalidateLayer(LayerTiles);
     update();
 }
 
@@ -1580,6 +1643,7 @@ void MapWidget::setEnuRef(double lat, double lon, double height)
     mRefLat = lat;
     mRefLon = lon;
     mRefHeight = height;
+    invalidateLayer(LayerTiles);
     update();
 }
 
@@ -1714,180 +1778,56 @@ void MapWidget::paint(QPainter &painter, int width, int height, bool highQuality
     const double xEnd2 = (cx + view_w / 2.0) * 1000.0;
     const double yEnd2 = (cy + view_h / 2.0) * 1000.0;
 
-    // Draw perspective pixmaps first
-    painter.setTransform(drawTrans);
-    for(int i = 0;i < mPerspectivePixmaps.size();i++) {
-        mPerspectivePixmaps[i].drawUsingPainter(painter);
-    }
-
-    // Draw openstreetmap tiles
-    if (mDrawOpenStreetmap) {
-        double i_llh[3];
-        i_llh[0] = mRefLat;
-        i_llh[1] = mRefLon;
-        i_llh[2] = mRefHeight;
-
-        mOsmZoomLevel = int(round(log(mScaleFactor * mOsmRes * 100000000.0 *
-                                        cos(i_llh[0] * M_PI / 180.0)) / log(2.0)));
-        if (mOsmZoomLevel > mOsmMaxZoomLevel) {
-            mOsmZoomLevel = mOsmMaxZoomLevel;
-        } else if (mOsmZoomLevel < 0) {
-            mOsmZoomLevel = 0;
-        }
-
-        int xt = OsmTile::long2tilex(i_llh[1], mOsmZoomLevel);
-        int yt = OsmTile::lat2tiley(i_llh[0], mOsmZoomLevel);
-
-        double llh_t[3];
-        llh_t[0] = OsmTile::tiley2lat(yt, mOsmZoomLevel);
-        llh_t[1] = OsmTile::tilex2long(xt, mOsmZoomLevel);
-        llh_t[2] = 0.0;
-
-        double xyz[3];
-        Utility::llhToEnu(i_llh, llh_t, xyz);
-
-        // Calculate scale at ENU origin
-        double w = OsmTile::lat2width(i_llh[0], mOsmZoomLevel);
-
-        int t_ofs_x = int(ceil(-(cx - view_w / 2.0) / w));
-        int t_ofs_y = int(ceil((cy + view_h / 2.0) / w));
-
-        if (!highQuality) {
-            painter.setRenderHint(QPainter::SmoothPixmapTransform, mAntialiasOsm);
-        }
-
-        QTransform transOld = painter.transform();
-        QTransform trans = painter.transform();
-        trans.scale(1, -1);
-        painter.setTransform(trans);
-
-        for (int j = 0;j < 40;j++) {
-            for (int i = 0;i < 40;i++) {
-                int xt_i = xt + i - t_ofs_x;
-                int yt_i = yt + j - t_ofs_y;
-                double ts_x = xyz[0] + w * i - double(t_ofs_x) * w;
-                double ts_y = -xyz[1] + w * j - double(t_ofs_y) * w;
-
-                // We are outside the view
-                if (ts_x > (cx + view_w / 2.0)) {
-                    break;
-                } else if ((ts_y - w) > (-cy + view_h / 2.0)) {
-                    break;
-                }
-
-                int res;
-                OsmTile t = mOsm->getTile(mOsmZoomLevel, xt_i, yt_i, res);
-
-                if (w < 0.0) {
-                    w = t.getWidthTop();
-                }
-
-                painter.drawPixmap(int(ts_x * 1000.0), int(ts_y * 1000.0),
-                                   int(w * 1000.0), int(w * 1000.0), t.pixmap());
-
-                if (res == 0 && !mOsm->downloadQueueFull()) {
-                    mOsm->downloadTile(mOsmZoomLevel, xt_i, yt_i);
-                }
+    // Static layers (tiles, grid, long info traces and routes) are rendered into
+    // offscreen pixmaps that are only redrawn when the view or their content
+    // changes. Everything else is drawn on top of them on every frame.
+    const bool useLayerCache = !highQuality;
+    const qreal dpr = devicePixelRatioF();
+
+    if (useLayerCache) {
+        if (mLayerTransform != drawTrans || mLayerSize != QSize(width, height) ||
+                !qFuzzyCompare(mLayerDpr, dpr)) {
+            for (int i = 0;i < LayerNum;i++) {
+                mLayerDirty[i] = true;
             }
-        }
-
-        // Restore painter
-        painter.setTransform(transOld);
 
-        if (!highQuality) {
-            painter.setRenderHint(QPainter::SmoothPixmapTransform, mAntialiasDrawings);
+            mLayerTransform = drawTrans;
+            mLayerSize = QSize(width, height);
+            mLayerDpr = dpr;
         }
     }
 
-    if (mDrawGrid) {
-        painter.setTransform(txtTrans);
-
-        // Draw Y-axis segments
-        for (double i = xStart;i < xEnd;i += stepGrid) {
-            if (fabs(i) < 1e-3) {
-                i = 0.0;
-            }
-
-            if (int(i / stepGrid) % 2) {
-                pen.setWidth(0);
-                pen.setColor(firstAxisColor);
-                painter.setPen(pen);
-            } else {
-                txt = QString::asprintf("%.2f m", i / 1000.0);
-
-                pt_txt.setX(i);
-                pt_txt.setY(0);
-                pt_txt = drawTrans.map(pt_txt);
-                pt_txt.setX(pt_txt.x() - 5);
-                pt_txt.setY(height - 10);
-                painter.setPen(QPen(textColor));
-                painter.save();
-                painter.translate(pt_txt);
-                painter.rotate(-90);
-                painter.drawText(0, 0, txt);
-                painter.restore();
-
-                if (fabs(i) < 1e-3) {
-                    pen.setWidthF(zeroAxisWidth);
-                    pen.setColor(zeroAxisColor);
-                } else {
-                    pen.setWidth(0);
-                    pen.setColor(secondAxisColor);
-                }
-                painter.setPen(pen);
-            }
-
-            QPointF pt_start(i, yStart);
-            QPointF pt_end(i, yEnd);
-            pt_start = drawTrans.map(pt_start);
-            pt_end = drawTrans.map(pt_end);
-            painter.drawLine(pt_start, pt_end);
+    auto paintLayer = [&](CachedLayer layer, const std::function<void(QPainter &painter)> &draw) {
+        if (!useLayerCache) {
+            draw(painter);
+            // Bookkeeping such as the visible info points belongs to this view
+            mLayerDirty[layer] = true;
+            return;
         }
 
-        // Draw X-axis segments
-        for (double i = yStart;i < yEnd;i += stepGrid) {
-            if (fabs(i) < 1e-3) {
-                i = 0.0;
-            }
-
-            if (int(i / stepGrid) % 2) {
-                pen.setWidth(0);
-                pen.setColor(firstAxisColor);
-                painter.setPen(pen);
-            } else {
-                txt = QString::asprintf("%.2f m", i / 1000.0);
-                pt_txt.setY(i);
-
-                pt_txt = drawTrans.map(pt_txt);
-                pt_txt.setX(10);
-                pt_txt.setY(pt_txt.y() - 5);
-                painter.setPen(QPen(textColor));
-                painter.drawText(pt_txt, txt);
+        QPixmap &pix = mLayerPixmaps[layer];
 
-                if (fabs(i) < 1e-3) {
-                    pen.setWidthF(zeroAxisWidth);
-                    pen.setColor(zeroAxisColor);
-                } else {
-                    pen.setWidth(0);
-                    pen.setColor(secondAxisColor);
-                }
-                painter.setPen(pen);
+        if (mLayerDirty[layer]) {
+            QSize pixSize(qRound(width * dpr), qRound(height * dpr));
+            if (pix.size() != pixSize) {
+                pix = QPixmap(pixSize);
+                pix.setDevicePixelRatio(dpr);
             }
 
-            QPointF pt_start(xStart, i);
-            QPointF pt_end(xEnd, i);
-            pt_start = drawTrans.map(pt_start);
-            pt_end = drawTrans.map(pt_end);
-            painter.drawLine(pt_start, pt_end);
+            pix.fill(Qt::transparent);
+            QPainter layerPainter(&pix);
+            layerPainter.setRenderHints(painter.renderHints());
+            layerPainter.setFont(painter.font());
+            draw(layerPainter);
+            layerPainter.end();
+            mLayerDirty[layer] = false;
         }
-    }
 
-    // Draw info trace
-    int info_segments = 0;
-    int info_points = 0;
-    mVisibleInfoTracePoints.clear();
+        painter.setTransform(QTransform());
+        painter.drawPixmap(0, 0, pix);
+    };
 
-    for (int in = 0;in < mInfoTraces.size();in++) {
+    auto drawInfoTrace = [&](QPainter &painter, int in, int &segments) -> int {
         QList<LocPoint> &itNow = mInfoTraces[in];
 
         if (mInfoTraceNow == in) {
@@ -1928,7 +1868,7 @@ void MapWidget::paint(QPainter &painter, int width, int height, bool highQuality
                 QPointF p2 = drawTrans.map(itNow[i].getPointMm());
 
                 painter.drawLine(p1, p2);
-                info_segments++;
+                segments++;
             }
 
             last_visible = i;
@@ -1954,14 +1894,296 @@ void MapWidget::paint(QPainter &painter, int width, int height, bool highQuality
             }
         }
 
-        info_points += drawInfoPoints(painter, pts_green, drawTrans, txtTrans,
-                                      xStart2, xEnd2, yStart2, yEnd2, info_min_dist);
-        info_points += drawInfoPoints(painter, pts_other, drawTrans, txtTrans,
-                                      xStart2, xEnd2, yStart2, yEnd2, info_min_dist);
-        info_points += drawInfoPoints(painter, pts_red, drawTrans, txtTrans,
-                                      xStart2, xEnd2, yStart2, yEnd2, info_min_dist);
+        int points = 0;
+        points += drawInfoPoints(painter, pts_green, drawTrans, txtTrans,
+                                 xStart2, xEnd2, yStart2, yEnd2, info_min_dist);
+        points += drawInfoPoints(painter, pts_other, drawTrans, txtTrans,
+                                 xStart2, xEnd2, yStart2, yEnd2, info_min_dist);
+        points += drawInfoPoints(painter, pts_red, drawTrans, txtTrans,
+                                 xStart2, xEnd2, yStart2, yEnd2, info_min_dist);
+        return points;
+    };
+
+    // Draw perspective pixmaps, openstreetmap tiles and grid
+    paintLayer(LayerTiles, [&](QPainter &painter) {
+        painter.setTransform(drawTrans);
+        for(int i = 0;i < mPerspectivePixmaps.size();i++) {
+            mPerspectivePixmaps[i].drawUsingPainter(painter);
+        }
+
+        if (mDrawOpenStreetmap) {
+            double i_llh[3];
+            i_llh[0] = mRefLat;
+            i_llh[1] = mRefLon;
+            i_llh[2] = mRefHeight;
+
+            mOsmZoomLevel = int(round(log(mScaleFactor * mOsmRes * 100000000.0 *
+                                            cos(i_llh[0] * M_PI / 180.0)) / log(2.0)));
+            if (mOsmZoomLevel > mOsmMaxZoomLevel) {
+                mOsmZoomLevel = mOsmMaxZoomLevel;
+            } else if (mOsmZoomLevel < 0) {
+                mOsmZoomLevel = 0;
+            }
+
+            int xt = OsmTile::long2tilex(i_llh[1], mOsmZoomLevel);
+            int yt = OsmTile::lat2tiley(i_llh[0], mOsmZoomLevel);
+
+            double llh_t[3];
+            llh_t[0] = OsmTile::tiley2lat(yt, mOsmZoomLevel);
+            llh_t[1] = OsmTile::tilex2long(xt, mOsmZoomLevel);
+            llh_t[2] = 0.0;
+
+            double xyz[3];
+            Utility::llhToEnu(i_llh, llh_t, xyz);
+
+            // Calculate scale at ENU origin
+            double w = OsmTile::lat2width(i_llh[0], mOsmZoomLevel);
+
+            int t_ofs_x = int(ceil(-(cx - view_w / 2.0) / w));
+            int t_ofs_y = int(ceil((cy + view_h / 2.0) / w));
+
+            if (!highQuality) {
+                painter.setRenderHint(QPainter::SmoothPixmapTransform, mAntialiasOsm);
+            }
+
+            QTransform transOld = painter.transform();
+            QTransform trans = painter.transform();
+            trans.scale(1, -1);
+            painter.setTransform(trans);
+
+            for (int j = 0;j < 40;j++) {
+                for (int i = 0;i < 40;i++) {
+                    int xt_i = xt + i - t_ofs_x;
+                    int yt_i = yt + j - t_ofs_y;
+                    double ts_x = xyz[0] + w * i - double(t_ofs_x) * w;
+                    double ts_y = -xyz[1] + w * j - double(t_ofs_y) * w;
+
+                    // We are outside the view
+                    if (ts_x > (cx + view_w / 2.0)) {
+                        break;
+                    } else if ((ts_y - w) > (-cy + view_h / 2.0)) {
+                        break;
+                    }
+
+                    int res;
+                    OsmTile t = mOsm->getTile(mOsmZoomLevel, xt_i, yt_i, res);
+
+                    if (w < 0.0) {
+                        w = t.getWidthTop();
+                    }
+
+                    painter.drawPixmap(int(ts_x * 1000.0), int(ts_y * 1000.0),
+                                       int(w * 1000.0), int(w * 1000.0), t.pixmap());
+
+                    if (res == 0 && !mOsm->downloadQueueFull()) {
+                        mOsm->downloadTile(mOsmZoomLevel, xt_i, yt_i);
+                    }
+                }
+            }
+
+            // Restore painter
+            painter.setTransform(transOld);
+
+            if (!highQuality) {
+                painter.setRenderHint(QPainter::SmoothPixmapTransform, mAntialiasDrawings);
+            }
+        }
+
+        if (mDrawGrid) {
+            painter.setTransform(txtTrans);
+
+            // Draw Y-axis segments
+            for (double i = xStart;i < xEnd;i += stepGrid) {
+                if (fabs(i) < 1e-3) {
+                    i = 0.0;
+                }
+
+                if (int(i / stepGrid) % 2) {
+                    pen.setWidth(0);
+                    pen.setColor(firstAxisColor);
+                    painter.setPen(pen);
+                } else {
+                    txt = QString::asprintf("%.2f m", i / 1000.0);
+
+                    pt_txt.setX(i);
+                    pt_txt.setY(0);
+                    pt_txt = drawTrans.map(pt_txt);
+                    pt_txt.setX(pt_txt.x() - 5);
+                    pt_txt.setY(height - 10);
+                    painter.setPen(QPen(textColor));
+                    painter.save();
+                    painter.translate(pt_txt);
+                    painter.rotate(-90);
+                    painter.drawText(0, 0, txt);
+                    painter.restore();
+
+                    if (fabs(i) < 1e-3) {
+                        pen.setWidthF(zeroAxisWidth);
+                        pen.setColor(zeroAxisColor);
+                    } else {
+                        pen.setWidth(0);
+                        pen.setColor(secondAxisColor);
+                    }
+                    painter.setPen(pen);
+                }
+
+                QPointF pt_start(i, yStart);
+                QPointF pt_end(i, yEnd);
+                pt_start = drawTrans.map(pt_start);
+                pt_end = drawTrans.map(pt_end);
+                painter.drawLine(pt_start, pt_end);
+            }
+
+            // Draw X-axis segments
+            for (double i = yStart;i < yEnd;i += stepGrid) {
+                if (fabs(i) < 1e-3) {
+                    i = 0.0;
+                }
+
+                if (int(i / stepGrid) % 2) {
+                    pen.setWidth(0);
+                    pen.setColor(firstAxisColor);
+                    painter.setPen(pen);
+                } else {
+                    txt = QString::asprintf("%.2f m", i / 1000.0);
+                    pt_txt.setY(i);
+
+                    pt_txt = drawTrans.map(pt_txt);
+                    pt_txt.setX(10);
+                    pt_txt.setY(pt_txt.y() - 5);
+                    painter.setPen(QPen(textColor));
+                    painter.drawText(pt_txt, txt);
+
+                    if (fabs(i) < 1e-3) {
+                        pen.setWidthF(zeroAxisWidth);
+                        pen.setColor(zeroAxisColor);
+                    } else {
+                        pen.setWidth(0);
+                        pen.setColor(secondAxisColor);
+                    }
+                    painter.setPen(pen);
+                }
+
+                QPointF pt_start(xStart, i);
+                QPointF pt_end(xEnd, i);
+                pt_start = drawTrans.map(pt_start);
+                pt_end = drawTrans.map(pt_end);
+                painter.drawLine(pt_start, pt_end);
+            }
+        }
+    });
+
+    // Draw info traces. Short traces, such as the log playback position, change
+    // often and are drawn directly instead of invalidating the cached layer.
+    paintLayer(LayerInfoTraces, [&](QPainter &painter) {
+        mVisibleInfoTracePoints.clear();
+        mInfoSegmentsCached = 0;
+        mInfoPointsCached = 0;
+
+        for (int in = 0;in < mInfoTraces.size();in++) {
+            if (isInfoTraceCached(in)) {
+                mInfoPointsCached += drawInfoTrace(painter, in, mInfoSegmentsCached);
+            }
+        }
+
+        mVisibleInfoTracePointsCached = mVisibleInfoTracePoints;
+    });
+
+    if (useLayerCache) {
+        mVisibleInfoTracePoints = mVisibleInfoTracePointsCached;
+    }
+
+    int info_segments = mInfoSegmentsCached;
+    int info_points = mInfoPointsCached;
+
+    for (int in = 0;in < mInfoTraces.size();in++) {
+        if (!isInfoTraceCached(in)) {
+            info_points += drawInfoTrace(painter, in, info_segments);
+        }
     }
 
+    // Draw routes
+    paintLayer(LayerRoutes, [&](QPainter &painter) {
+        for (int rn = 0;rn < mRoutes.size();rn++) {
+            QList<LocPoint> &routeNow = mRoutes[rn];
+
+            if (mRouteNow == rn) {
+                pen.setColor(Qt::darkYellow);
+                painter.setBrush(Qt::yellow);
+            } else {
+                pen.setColor(Qt::darkGray);
+                painter.setBrush(Qt::gray);
+            }
+
+            pen.setWidthF(5.0 / mScaleFactor);
+            painter.setPen(pen);
+            painter.setTransform(drawTrans);
+
+            for (int i = 1;i < routeNow.size();i++) {
+                painter.setOpacity(0.7);
+                painter.drawLine(int(routeNow[i - 1].getX() * 1000.0), int(routeNow[i - 1].getY() * 1000.0),
+                        int(routeNow[i].getX() * 1000.0), int(routeNow[i].getY() * 1000.0));
+                painter.setOpacity(1.0);
+            }
+
+            for (int i = 0;i < routeNow.size();i++) {
+                QPointF p = routeNow[i].getPointMm();
+
+                painter.setTransform(drawTrans);
+
+                if (highQuality) {
+                    if (mRouteNow == rn) {
+                        pen.setColor(Qt::darkYellow);
+                        painter.setBrush(Qt::yellow);
+                    } else {
+                        pen.setColor(Qt::darkGray);
+                        painter.setBrush(Qt::gray);
+                    }
+
+                    pen.setWidthF(3.0 / mScaleFactor);
+                    painter.setPen(pen);
+
+                    painter.drawEllipse(p, 10.0 / mScaleFactor,
+                                        10.0 / mScaleFactor);
+                } else {
+                    drawCircleFast(painter, p, 10.0 / mScaleFactor, mRouteNow == rn ? 0 : 1);
+                }
+
+                // Draw text only for selected route
+                if (mRouteNow == rn && mDrawRouteText) {
+                    QTime t = QTime::fromMSecsSinceStartOfDay(routeNow[i].getTime());
+                    txt = QString::asprintf("P: %d\n"
+                                "%.1f km/h\n"
+                                "%02d:%02d:%02d:%03d",
+                                i,
+                                routeNow[i].getSpeed() * 3.6,
+                                t.hour(), t.minute(), t.second(), t.msec());
+
+                    pt_txt.setX(p.x() + 10 / mScaleFactor);
+                    pt_txt.setY(p.y());
+                    painter.setTransform(txtTrans);
+                    pt_txt = drawTrans.map(pt_txt);
+                    pen.setColor(Qt::black);
+                    painter.setPen(pen);
+                    rect_txt.setCoords(pt_txt.x(), pt_txt.y() - 20,
+                                       pt_txt.x() + 150, pt_txt.y() + 25);
+                    painter.drawText(rect_txt, txt);
+                } else {
+                    txt = QString::asprintf("%d", rn);
+                    pt_txt.setX(p.x());
+                    pt_txt.setY(p.y());
+                    painter.setTransform(txtTrans);
+                    pt_txt = drawTrans.map(pt_txt);
+                    pen.setColor(Qt::black);
+                    painter.setPen(pen);
+                    rect_txt.setCoords(pt_txt.x() - 20, pt_txt.y() - 20,
+                                       pt_txt.x() + 20, pt_txt.y() + 20);
+                    painter.drawText(rect_txt, Qt::AlignCenter, txt);
+                }
+            }
+        }
+    });
+
     // Draw point closest to mouse pointer
     if (mClosestInfo.getInfo().size() > 0) {
         QPointF p = mClosestInfo.getPointMm();
@@ -2016,86 +2238,6 @@ void MapWidget::paint(QPainter &painter, int width, int height, bool highQuality
         }
     }
 
-    // Draw routes
-    for (int rn = 0;rn < mRoutes.size();rn++) {
-        QList<LocPoint> &routeNow = mRoutes[rn];
-
-        if (mRouteNow == rn) {
-            pen.setColor(Qt::darkYellow);
-            painter.setBrush(Qt::yellow);
-        } else {
-            pen.setColor(Qt::darkGray);
-            painter.setBrush(Qt::gray);
-        }
-
-        pen.setWidthF(5.0 / mScaleFactor);
-        painter.setPen(pen);
-        painter.setTransform(drawTrans);
-
-        for (int i = 1;i < routeNow.size();i++) {
-            painter.setOpacity(0.7);
-            painter.drawLine(int(routeNow[i - 1].getX() * 1000.0), int(routeNow[i - 1].getY() * 1000.0),
-                    int(routeNow[i].getX() * 1000.0), int(routeNow[i].getY() * 1000.0));
-            painter.setOpacity(1.0);
-        }
-
-        for (int i = 0;i < routeNow.size();i++) {
-            QPointF p = routeNow[i].getPointMm();
-
-            painter.setTransform(drawTrans);
-
-            if (highQuality) {
-                if (mRouteNow == rn) {
-                    pen.setColor(Qt::darkYellow);
-                    painter.setBrush(Qt::yellow);
-                } else {
-                    pen.setColor(Qt::darkGray);
-                    painter.setBrush(Qt::gray);
-                }
-
-                pen.setWidthF(3.0 / mScaleFactor);
-                painter.setPen(pen);
-
-                painter.drawEllipse(p, 10.0 / mScaleFactor,
-                                    10.0 / mScaleFactor);
-            } else {
-                drawCircleFast(painter, p, 10.0 / mScaleFactor, mRouteNow == rn ? 0 : 1);
-            }
-
-            // Draw text only for selected route
-            if (mRouteNow == rn && mDrawRouteText) {
-                QTime t = QTime::fromMSecsSinceStartOfDay(routeNow[i].getTime());
-                txt = QString::asprintf("P: %d\n"
-                            "%.1f km/h\n"
-                            "%02d:%02d:%02d:%03d",
-                            i,
-                            routeNow[i].getSpeed() * 3.6,
-                            t.hour(), t.minute(), t.second(), t.msec());
-
-                pt_txt.setX(p.x() + 10 / mScaleFactor);
-                pt_txt.setY(p.y());
-                painter.setTransform(txtTrans);
-                pt_txt = drawTrans.map(pt_txt);
-                pen.setColor(Qt::black);
-                painter.setPen(pen);
-                rect_txt.setCoords(pt_txt.x(), pt_txt.y() - 20,
-                                   pt_txt.x() + 150, pt_txt.y() + 25);
-                painter.drawText(rect_txt, txt);
-            } else {
-                txt = QString::asprintf("%d", rn);
-                pt_txt.setX(p.x());
-                pt_txt.setY(p.y());
-                painter.setTransform(txtTrans);
-                pt_txt = drawTrans.map(pt_txt);
-                pen.setColor(Qt::black);
-                painter.setPen(pen);
-                rect_txt.setCoords(pt_txt.x() - 20, pt_txt.y() - 20,
-                                   pt_txt.x() + 20, pt_txt.y() + 20);
-                painter.drawText(rect_txt, Qt::AlignCenter, txt);
-            }
-        }
-    }
-
     // Map module painting
     painter.save();
     for (MapModule *m: mMapModules) {
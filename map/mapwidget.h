@@ -174,6 +174,8 @@ public:
     void removeMapModule(MapModule *m);
     void removeMapModuleLast();
 
+    void invalidateLayers();
+
 
 signals:
     void scaleChanged(double newScale);
@@ -198,6 +200,13 @@ protected:
     bool event(QEvent *event) override;
 
 private:
+    typedef enum {
+        LayerTiles = 0,
+        LayerInfoTraces,
+        LayerRoutes,
+        LayerNum
+    } CachedLayer;
+
     QList<CarInfo> mCarInfo;
     QList<CopterInfo> mCopterInfo;
     QVector<LocPoint> mCarTrace;
@@ -254,6 +263,16 @@ private:
     QTimer *mTimer;
     QVector<MapModule*> mMapModules;
 
+    // Render cache for the static layers
+    QPixmap mLayerPixmaps[LayerNum];
+    bool mLayerDirty[LayerNum];
+    QTransform mLayerTransform;
+    QSize mLayerSize;
+    qreal mLayerDpr;
+    QList<LocPoint> mVisibleInfoTracePointsCached;
+    int mInfoSegmentsCached;
+    int mInfoPointsCached;
+
     void updateClosestInfoPoint();
     int drawInfoPoints(QPainter &painter, const QList<LocPoint> &pts,
                         QTransform drawTrans, QTransform txtTrans,
@@ -261,6 +280,8 @@ private:
                        double min_dist);
     int getClosestPoint(LocPoint p, QList<LocPoint> points, double &dist);
     void drawCircleFast(QPainter &painter, QPointF center, double radius, int type = 0);
+    void invalidateLayer(CachedLayer layer);
+    bool isInfoTraceCached(int trace);
 
     void paint(QPainter &painter, int width, int height, bool highQuality = false);
     void updateTraces();
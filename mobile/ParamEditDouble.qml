@@ -29,6 +29,7 @@ Item {
     id: editor
     property string paramName: ""
     property ConfigParams params: null
+    property int paramId: -1
     height: 140
     Layout.fillWidth: true
     property real maxVal: 1.0
@@ -36,6 +37,7 @@ Item {
 
     Component.onCompleted: {
         if (params != null) {
+            paramId = params.paramId(paramName)
             if (Math.abs(params.getParamMaxDouble(paramName)) > params.getParamMinDouble(paramName)) {
                 maxVal = Math.abs(params.getParamMaxDouble(paramName))
             } else {
@@ -198,8 +200,9 @@ Item {
     Connections {
         target: params
 
-        function onParamChangedDouble(src, name, newParam) {
-            if (src !== editor && name === paramName) {
+        function onParamChangeSet(src, ids) {
+            if (src !== editor && ids.indexOf(paramId) >= 0) {
+                var newParam = params.getParamDouble(paramName)
                 valueBox.realValue = newParam * params.getParamEditorScale(paramName)
                 percentageBox.value = Math.round((100.0 * newParam) / maxVal)
             }
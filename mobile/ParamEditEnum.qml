@@ -29,6 +29,7 @@ Item {
     id: editor
     property string paramName: ""
     property ConfigParams params: null
+    property int paramId: -1
     height: 140
     Layout.fillWidth: true
     property real maxVal: 1.0
@@ -36,6 +37,7 @@ Item {
 
     Component.onCompleted: {
         if (params != null) {
+            paramId = params.paramId(paramName)
             nameText.text = params.getLongName(paramName)
             enumBox.model = params.getParamEnumNames(paramName)
             enumBox.currentIndex = params.getParamEnum(paramName)
@@ -150,8 +152,9 @@ Item {
     Connections {
         target: params
 
-        function onParamChangedEnum(src, name, newParam) {
-            if (src !== editor && name === paramName) {
+        function onParamChangeSet(src, ids) {
+            if (src !== editor && ids.indexOf(paramId) >= 0) {
+                var newParam = params.getParamEnum(paramName)
                 enumBox.currentIndex = newParam
             }
         }
@@ -29,12 +29,14 @@ Item {
     id: editor
     property string paramName: ""
     property ConfigParams params: null
+    property int paramId: -1
     height: 140
     Layout.fillWidth: true
     property real maxVal: 1.0
 
     Component.onCompleted: {
         if (params != null) {
+            paramId = params.paramId(paramName)
             nameText.text = params.getLongName(paramName)
             stringInput.text = params.getParamQString(paramName)
 
@@ -153,8 +155,9 @@ Item {
     Connections {
         target: params
 
-        function onParamChangedQString(src, name, newParam) {
-            if (src !== editor && name === paramName) {
+        function onParamChangeSet(src, ids) {
+            if (src !== editor && ids.indexOf(paramId) >= 0) {
+                var newParam = params.getParamQString(paramName)
                 stringInput.text = newParam
             }
         }
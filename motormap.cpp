@@ -0,0 +1,416 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "motormap.h"
+#include "utility.h"
+
+#include <cmath>
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QMutex>
+#include <QDataStream>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
+
+namespace {
+const int maxCachedMaps = 8;
+
+// Number of color levels, so that the maps look like contour plots
+const int mapLevels = 20;
+
+QMutex cacheMutex;
+QList<QPair<QByteArray, QSharedPointer<const MotorMap> > > cache; // Most recently used first
+
+QByteArray cacheKey(const MotorData &md, const MotorMap::Grid &g)
+{
+    QByteArray data;
+    QDataStream ds(&data, QIODevice::WriteOnly);
+
+    // The current limits of the model are left out, as they do not change
+    // the map. Only the drive cycle simulation uses them.
+    const MotorModel &m = md.model;
+    ds << m.valid << m.r << m.ld_lq_diff << m.lq << m.ld << m.lambda <<
+          m.i_nl << m.pole_pairs << m.wheel_diam;
+
+    const MotorDataParams &p = md.params;
+    ds << p.gearing << p.maxRpm << p.gearingEfficiency << p.fwCurrent <<
+          p.motorNum << p.tempInc << p.mtpa;
+
+    ds << g.rpmMin << g.rpmMax << g.rpmPoints << g.torqueMin <<
+          g.torqueMax << g.torquePoints << g.vbus;
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+QCPRange validRange(const QVector<double> &values)
+{
+    QCPRange range(qInf(), -qInf());
+
+    for (auto v: values) {
+        if (!std::isnan(v)) {
+            range.lower = qMin(range.lower, v);
+            range.upper = qMax(range.upper, v);
+        }
+    }
+
+    if (range.lower > range.upper) {
+        return QCPRange(0.0, 1.0);
+    }
+
+    if (range.lower == range.upper) {
+        range.upper += 1.0;
+    }
+
+    return range;
+}
+}
+
+MotorMap::MotorMap()
+{
+    mGenerationTime = 0.0;
+}
+
+/**
+ * @brief MotorMap::generate
+ * Calculate a map, or get it from the cache if the motor and the grid did not
+ * change since it was calculated. The torque rows are calculated in parallel.
+ *
+ * @param base
+ * Configured MotorData for the motor setup.
+ *
+ * @param grid
+ * The torque and RPM points, and the bus voltage limit.
+ *
+ * @return
+ * The map. It is never modified after it is created, so it can be shared.
+ */
+QSharedPointer<const MotorMap> MotorMap::generate(const MotorData &base, const MotorMap::Grid &grid)
+{
+    QByteArray key = cacheKey(base, grid);
+
+    {
+        QMutexLocker locker(&cacheMutex);
+        for (int i = 0;i < cache.size();i++) {
+            if (cache.at(i).first == key) {
+                cache.move(i, 0);
+                return cache.first().second;
+            }
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    MotorMap *map = new MotorMap;
+    map->mGrid = grid;
+    map->mGrid.rpmPoints = qMax(grid.rpmPoints, 1);
+    map->mGrid.torquePoints = qMax(grid.torquePoints, 1);
+
+    const int rpmPoints = map->mGrid.rpmPoints;
+    const int cells = rpmPoints * map->mGrid.torquePoints;
+
+    double *values[QuantityCount];
+    for (int i = 0;i < QuantityCount;i++) {
+        map->mValues[i].fill(qQNaN(), cells);
+        values[i] = map->mValues[i].data();
+    }
+
+    Utility::runParallel(map->mGrid.torquePoints, [&](int ti) {
+        double torque = map->torque(ti);
+
+        for (int ri = 0;ri < rpmPoints;ri++) {
+            MotorData md = base;
+            if (!evaluate(md, map->rpm(ri), torque, grid.vbus)) {
+                continue;
+            }
+
+            int ind = ti * rpmPoints + ri;
+            values[QuantityEfficiency][ind] = md.efficiency * 100.0;
+            values[QuantityLossTot][ind] = md.loss_tot;
+            values[QuantityLossMotor][ind] = md.loss_motor_tot;
+            values[QuantityVbusMin][ind] = md.vbus_min;
+            values[QuantityFwCurrent][ind] = -md.id;
+            values[QuantityCurrent][ind] = md.i_mag;
+            values[QuantityPowerIn][ind] = md.p_in;
+            values[QuantityPowerOut][ind] = md.p_out;
+        }
+    });
+
+    map->mGenerationTime = double(timer.nsecsElapsed()) / 1e9;
+
+    QSharedPointer<const MotorMap> res(map);
+
+    QMutexLocker locker(&cacheMutex);
+    cache.prepend(qMakePair(key, res));
+    while (cache.size() > maxCachedMaps) {
+        cache.removeLast();
+    }
+
+    return res;
+}
+
+/**
+ * @brief MotorMap::evaluate
+ * Update md for one operating point.
+ *
+ * @param md
+ * Configured MotorData to update.
+ *
+ * @param rpm
+ * Output RPM.
+ *
+ * @param torque
+ * Output torque.
+ *
+ * @param vbus
+ * Bus voltage limit. When it is set, field weakening up to the configured
+ * current is used to reach the point. 0 means no limit.
+ *
+ * @return
+ * True if the point can be reached.
+ */
+bool MotorMap::evaluate(MotorData &md, double rpm, double torque, double vbus)
+{
+    bool ok = false;
+
+    if (vbus > 0.0) {
+        ok = md.updateTorqueVBusFW(torque, rpm, vbus);
+
+        // When the available field weakening is not enough updateTorqueVBusFW
+        // lowers the RPM instead, so the point cannot be reached.
+        ok = ok && fabs(md.rpm_out - rpm) <= (fabs(rpm) * 1e-6 + 1e-9) &&
+                md.vbus_min <= (vbus * 1.01);
+    } else {
+        ok = md.update(rpm, torque);
+    }
+
+    return ok && fabs(md.rpm_motor_shaft) <= md.params.maxRpm;
+}
+
+void MotorMap::clearCache()
+{
+    QMutexLocker locker(&cacheMutex);
+    cache.clear();
+}
+
+const MotorMap::Grid &MotorMap::grid() const
+{
+    return mGrid;
+}
+
+double MotorMap::rpm(int rpmInd) const
+{
+    if (mGrid.rpmPoints < 2) {
+        return mGrid.rpmMin;
+    }
+
+    return mGrid.rpmMin + (mGrid.rpmMax - mGrid.rpmMin) *
+            double(rpmInd) / double(mGrid.rpmPoints - 1);
+}
+
+double MotorMap::torque(int torqueInd) const
+{
+    if (mGrid.torquePoints < 2) {
+        return mGrid.torqueMin;
+    }
+
+    return mGrid.torqueMin + (mGrid.torqueMax - mGrid.torqueMin) *
+            double(torqueInd) / double(mGrid.torquePoints - 1);
+}
+
+double MotorMap::value(MotorMap::Quantity q, int rpmInd, int torqueInd) const
+{
+    return mValues[q].at(torqueInd * mGrid.rpmPoints + rpmInd);
+}
+
+/**
+ * @brief MotorMap::generationTime
+ * @return
+ * Time it took to calculate the map in seconds.
+ */
+double MotorMap::generationTime() const
+{
+    return mGenerationTime;
+}
+
+void MotorMap::setupMap(QCPColorMap *map) const
+{
+    QCPColorMapData *d = map->data();
+    d->setSize(mGrid.rpmPoints, mGrid.torquePoints);
+    d->setRange(QCPRange(mGrid.rpmMin, mGrid.rpmMax),
+                QCPRange(mGrid.torqueMin, mGrid.torqueMax));
+    map->setInterpolate(false);
+}
+
+/**
+ * @brief MotorMap::render
+ * Draw one quantity of the map in a color map, with the RPM on the key axis
+ * and the torque on the value axis. Points that cannot be reached are
+ * transparent.
+ */
+void MotorMap::render(QCPColorMap *map, MotorMap::Quantity q) const
+{
+    setupMap(map);
+
+    QCPColorMapData *d = map->data();
+    for (int ti = 0;ti < mGrid.torquePoints;ti++) {
+        for (int ri = 0;ri < mGrid.rpmPoints;ri++) {
+            d->setCell(ri, ti, value(q, ri, ti));
+        }
+    }
+
+    QCPColorGradient gradient(QCPColorGradient::gpJet);
+    gradient.setLevelCount(mapLevels);
+    gradient.setNanHandling(QCPColorGradient::nhTransparent);
+    map->setGradient(gradient);
+
+    QCPRange range = validRange(mValues[q]);
+
+    // Low efficiencies close to zero torque would use most of the scale
+    if (q == QuantityEfficiency) {
+        range.lower = qMin(qMax(range.lower, 50.0), range.upper - 1.0);
+    }
+
+    map->setDataRange(range);
+}
+
+/**
+ * @brief MotorMap::renderDifference
+ * Draw b - a for one quantity. The maps must use the same grid.
+ *
+ * @return
+ * False if the grids are different.
+ */
+bool MotorMap::renderDifference(QCPColorMap *map, const MotorMap &a, const MotorMap &b, MotorMap::Quantity q)
+{
+    if (!(a.mGrid == b.mGrid)) {
+        return false;
+    }
+
+    a.setupMap(map);
+
+    QVector<double> diff(a.mValues[q].size());
+    for (int i = 0;i < diff.size();i++) {
+        diff[i] = b.mValues[q].at(i) - a.mValues[q].at(i);
+    }
+
+    QCPColorMapData *d = map->data();
+    for (int ti = 0;ti < a.mGrid.torquePoints;ti++) {
+        for (int ri = 0;ri < a.mGrid.rpmPoints;ri++) {
+            d->setCell(ri, ti, diff.at(ti * a.mGrid.rpmPoints + ri));
+        }
+    }
+
+    QCPColorGradient gradient(QCPColorGradient::gpPolar);
+    gradient.setLevelCount(mapLevels);
+    gradient.setNanHandling(QCPColorGradient::nhTransparent);
+    map->setGradient(gradient);
+
+    // Symmetric, so that zero is in the middle of the scale
+    QCPRange range = validRange(diff);
+    double max = qMax(fabs(range.lower), fabs(range.upper));
+    map->setDataRange(QCPRange(-max, max));
+
+    return true;
+}
+
+/**
+ * @brief MotorMap::exportCsv
+ * Write all quantities of two maps to a semicolon-separated file, one line
+ * per grid point. Points that cannot be reached are left empty.
+ *
+ * @return
+ * False if the file could not be written or the grids are different.
+ */
+bool MotorMap::exportCsv(QString fileName, const MotorMap &a, const MotorMap &b,
+                         QString nameA, QString nameB)
+{
+    if (!(a.mGrid == b.mGrid)) {
+        return false;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QTextStream os(&file);
+
+    os << "RPM;Torque (Nm)";
+    for (auto name: {nameA, nameB}) {
+        for (int q = 0;q < QuantityCount;q++) {
+            os << ";" << name << " " << quantityName(Quantity(q)) <<
+                  " (" << quantityUnit(Quantity(q)) << ")";
+        }
+    }
+    os << "\n";
+
+    auto number = [](double v) {
+        return std::isnan(v) ? QString() : QString::number(v, 'g', 6);
+    };
+
+    for (int ti = 0;ti < a.mGrid.torquePoints;ti++) {
+        for (int ri = 0;ri < a.mGrid.rpmPoints;ri++) {
+            os << number(a.rpm(ri)) << ";" << number(a.torque(ti));
+
+            for (auto map: {&a, &b}) {
+                for (int q = 0;q < QuantityCount;q++) {
+                    os << ";" << number(map->value(Quantity(q), ri, ti));
+                }
+            }
+
+            os << "\n";
+        }
+    }
+
+    os.flush();
+    return file.error() == QFile::NoError;
+}
+
+QString MotorMap::quantityName(MotorMap::Quantity q)
+{
+    switch (q) {
+    case QuantityEfficiency: return "Efficiency";
+    case QuantityLossTot: return "Total Losses";
+    case QuantityLossMotor: return "Motor Losses";
+    case QuantityVbusMin: return "VBus Min";
+    case QuantityFwCurrent: return "Field Weakening Current";
+    case QuantityCurrent: return "Current";
+    case QuantityPowerIn: return "Power In";
+    case QuantityPowerOut: return "Power Out";
+    default: return "Unknown";
+    }
+}
+
+QString MotorMap::quantityUnit(MotorMap::Quantity q)
+{
+    switch (q) {
+    case QuantityEfficiency: return "%";
+    case QuantityLossTot: return "W";
+    case QuantityLossMotor: return "W";
+    case QuantityVbusMin: return "V";
+    case QuantityFwCurrent: return "A";
+    case QuantityCurrent: return "A";
+    case QuantityPowerIn: return "W";
+    case QuantityPowerOut: return "W";
+    default: return "";
+    }
+}
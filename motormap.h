@@ -0,0 +1,109 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef MOTORMAP_H
+#define MOTORMAP_H
+
+#include <QVector>
+#include <QString>
+#include <QSharedPointer>
+#include "pages/pagemotorcomparison.h"
+
+/**
+ * @brief The MotorMap class
+ *
+ * Operating map of a motor setup over a torque x RPM grid, calculated with the
+ * MotorData model. Points that cannot be reached, because they need more bus
+ * voltage than available or exceed the maximum shaft RPM, are NaN.
+ *
+ * Maps are generated in parallel and cached, keyed by the motor parameters and
+ * the grid, so regenerating a map that did not change is free.
+ */
+class MotorMap
+{
+public:
+    typedef enum {
+        QuantityEfficiency = 0,
+        QuantityLossTot,
+        QuantityLossMotor,
+        QuantityVbusMin,
+        QuantityFwCurrent,
+        QuantityCurrent,
+        QuantityPowerIn,
+        QuantityPowerOut,
+        QuantityCount
+    } Quantity;
+
+    struct Grid {
+        Grid() {
+            rpmMin = 0.0;
+            rpmMax = 5000.0;
+            rpmPoints = 200;
+            torqueMin = 0.0;
+            torqueMax = 10.0;
+            torquePoints = 200;
+            vbus = 0.0;
+        }
+
+        bool operator==(const Grid &other) const {
+            return rpmMin == other.rpmMin && rpmMax == other.rpmMax &&
+                    rpmPoints == other.rpmPoints && torqueMin == other.torqueMin &&
+                    torqueMax == other.torqueMax && torquePoints == other.torquePoints &&
+                    vbus == other.vbus;
+        }
+
+        double rpmMin;
+        double rpmMax;
+        int rpmPoints;
+        double torqueMin;
+        double torqueMax;
+        int torquePoints;
+        double vbus; // Bus voltage limit, 0 for no limit. Uses field weakening if set up.
+    };
+
+    static QSharedPointer<const MotorMap> generate(const MotorData &base, const Grid &grid);
+    static bool evaluate(MotorData &md, double rpm, double torque, double vbus);
+    static void clearCache();
+
+    const Grid &grid() const;
+    double rpm(int rpmInd) const;
+    double torque(int torqueInd) const;
+    double value(Quantity q, int rpmInd, int torqueInd) const;
+    double generationTime() const;
+
+    void render(QCPColorMap *map, Quantity q) const;
+    static bool renderDifference(QCPColorMap *map, const MotorMap &a, const MotorMap &b, Quantity q);
+    static bool exportCsv(QString fileName, const MotorMap &a, const MotorMap &b,
+                          QString nameA, QString nameB);
+
+    static QString quantityName(Quantity q);
+    static QString quantityUnit(Quantity q);
+
+private:
+    MotorMap();
+
+    Grid mGrid;
+    QVector<double> mValues[QuantityCount];
+    double mGenerationTime;
+
+    void setupMap(QCPColorMap *map) const;
+
+};
+
+#endif // MOTORMAP_H
@@ -20,6 +20,7 @@
 #include "pageappimu.h"
 #include "ui_pageappimu.h"
 #include "utility.h"
+#include "framescheduler.h"
 #include <QDateTime>
 #include <QQuickItem>
 #include <cmath>
@@ -31,14 +32,12 @@ PageAppImu::PageAppImu(QWidget *parent) :
     ui->setupUi(this);
     mVesc = nullptr;
 
-    mTimer = new QTimer(this);
-    mTimer->start(20);
     mUpdatePlots = false;
     mSecondCounter = 0.0;
     mLastUpdateTime = 0;
 
-    connect(mTimer, SIGNAL(timeout()),
-            this, SLOT(timerSlot()));
+    FrameScheduler::instance()->addClient(this, [this]() { timerSlot(); });
+    FrameScheduler::instance()->addStreamConsumer(this, FrameScheduler::StreamImuData);
 
     QCustomPlot *plots[3] = {ui->rpyPlot, ui->accelPlot, ui->gyroPlot};
     for(int i = 0; i<3; i++)
@@ -50,7 +50,6 @@ private:
     Ui::PageAppImu *ui;
     VescInterface *mVesc;
 
-    QTimer *mTimer;
 
     bool mUpdatePlots;
 
@@ -20,6 +20,7 @@
 #include "pageappnunchuk.h"
 #include "ui_pageappnunchuk.h"
 #include "utility.h"
+#include "framescheduler.h"
 
 PageAppNunchuk::PageAppNunchuk(QWidget *parent) :
     QWidget(parent),
@@ -60,6 +61,7 @@ void PageAppNunchuk::setVesc(VescInterface *vesc)
 
         connect(mVesc->commands(), SIGNAL(decodedChukReceived(double)),
                 this, SLOT(decodedChukReceived(double)));
+        FrameScheduler::instance()->addStreamConsumer(this, FrameScheduler::StreamAppData);
 
         connect(mVesc->appConfig(), SIGNAL(paramChangedDouble(QObject*,QString,double)),
                 this, SLOT(paramChangedDouble(QObject*,QString,double)));
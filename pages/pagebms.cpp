@@ -20,6 +20,7 @@
 #include "pagebms.h"
 #include "ui_pagebms.h"
 #include "utility.h"
+#include "framescheduler.h"
 
 PageBms::PageBms(QWidget *parent) :
     QWidget(parent),
@@ -59,6 +60,7 @@ void PageBms::setVesc(VescInterface *vesc)
     if (mVesc) {
         connect(mVesc->commands(), SIGNAL(bmsValuesRx(BMS_VALUES)),
                 this, SLOT(bmsValuesRx(BMS_VALUES)));
+        FrameScheduler::instance()->addStreamConsumer(this, FrameScheduler::StreamBmsData);
     }
 }
 
@@ -20,6 +20,10 @@
 #include "pagecananalyzer.h"
 #include "ui_pagecananalyzer.h"
 #include "utility.h"
+#include "framescheduler.h"
+
+#include <QHeaderView>
+#include <QFileDialog>
 
 PageCanAnalyzer::PageCanAnalyzer(QWidget *parent) :
     QWidget(parent),
@@ -31,12 +35,47 @@ PageCanAnalyzer::PageCanAnalyzer(QWidget *parent) :
     ui->sendButton->setIcon(Utility::getIcon("icons/Send File-96.png"));
 
     layout()->setContentsMargins(0, 0, 0, 0);
-    ui->msgTable->setColumnWidth(1, 120);
     mVesc = nullptr;
+
+    mModel = new CanFrameModel(this);
+    ui->msgTable->setModel(mModel);
+    ui->msgTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->msgTable->setColumnWidth(2, 120);
+
+    mReplay = new CanReplay(this);
+    connect(mReplay, SIGNAL(frameReplayed(QByteArray,quint32,bool)),
+            this, SLOT(replayFrame(QByteArray,quint32,bool)));
+    connect(mReplay, SIGNAL(finished(int,double)), this, SLOT(replayFinished(int,double)));
+
+    connect(ui->filterIdEdit, SIGNAL(editingFinished()), this, SLOT(updateFilter()));
+    connect(ui->filterMaskEdit, SIGNAL(editingFinished()), this, SLOT(updateFilter()));
+
+    // Received frames are handed to the table once per frame
+    FrameScheduler::instance()->addClient(this, [this]() {
+        int added = mModel->flush();
+
+        if (added > 0 && ui->autoScrollBox->isChecked() &&
+                mModel->mode() == CanFrameModel::ModeFrames) {
+            ui->msgTable->scrollToBottom();
+        }
+
+        ui->rateLabel->setText(tr("%1 frames/s").arg(mModel->frameRate(), 0, 'f', 0));
+
+        if (mCapture.isOpen()) {
+            ui->captureLabel->setText(tr("Recorded %1 frames (%2 kB)").
+                                      arg(mCapture.framesWritten()).
+                                      arg(double(mCapture.bytesWritten()) / 1024.0, 0, 'f', 1));
+        } else if (mReplay->isRunning()) {
+            ui->captureLabel->setText(tr("Replayed %1/%2 frames").
+                                      arg(mReplay->framesReplayed()).
+                                      arg(mReplay->frameCount()));
+        }
+    });
 }
 
 PageCanAnalyzer::~PageCanAnalyzer()
 {
+    mCapture.close();
     delete ui;
 }
 
@@ -53,6 +92,8 @@ void PageCanAnalyzer::setVesc(VescInterface *vesc)
         reloadParams();
         connect(mVesc->commands(), SIGNAL(canFrameRx(QByteArray,quint32,bool)),
                 this, SLOT(canFrameRx(QByteArray,quint32,bool)));
+        connect(mVesc, SIGNAL(CANbusFrameRx(QByteArray,quint32,bool)),
+                this, SLOT(canFrameRx(QByteArray,quint32,bool)));
     }
 }
 
@@ -67,30 +108,8 @@ void PageCanAnalyzer::reloadParams()
 
 void PageCanAnalyzer::canFrameRx(QByteArray data, quint32 id, bool isExtended)
 {
-    while (ui->msgTable->rowCount() > 3999) {
-        ui->msgTable->removeRow(0);
-    }
-
-    ui->msgTable->setRowCount(ui->msgTable->rowCount() + 1);
-
-    ui->msgTable->setItem(ui->msgTable->rowCount() - 1, 0,
-                          new QTableWidgetItem(QString(isExtended ? "Yes" : "No")));
-    ui->msgTable->setItem(ui->msgTable->rowCount() - 1, 1,
-                          new QTableWidgetItem(QString("0x%1").
-                                               arg(id, 8, 16, QLatin1Char('0'))));
-    ui->msgTable->setItem(ui->msgTable->rowCount() - 1, 2,
-                          new QTableWidgetItem(QString("%1").arg(data.size())));
-
-    for (int i = 0;i < data.size();i++) {
-        ui->msgTable->setItem(ui->msgTable->rowCount() - 1, i + 3,
-                              new QTableWidgetItem(QString("0x%1").
-                                                   arg(quint8(data.at(i)),
-                                                       2, 16, QLatin1Char('0'))));
-    }
-
-    if (ui->autoScrollBox->isChecked()) {
-        ui->msgTable->scrollToBottom();
-    }
+    mModel->addFrame(data, id, isExtended);
+    mCapture.writeFrame(data, id, isExtended);
 }
 
 void PageCanAnalyzer::on_sendButton_clicked()
@@ -116,18 +135,9 @@ void PageCanAnalyzer::on_sendButton_clicked()
             }
         }
 
-        QString idTxt = ui->sendIdEdit->text().toLower().replace(" ", "");
         quint32 id = 0;
-        bool ok = false;
 
-        if (idTxt.startsWith("0x")) {
-            idTxt.remove(0, 2);
-            id = idTxt.toUInt(&ok, 16);
-        } else {
-            id = idTxt.toUInt(&ok, 10);
-        }
-
-        if (ok) {
+        if (parseId(ui->sendIdEdit->text(), id)) {
             mVesc->commands()->forwardCanFrame(vb, id, ui->sendExtBox->currentIndex() == 1);
         } else {
             mVesc->emitMessageDialog("Send CAN",
@@ -140,7 +150,7 @@ void PageCanAnalyzer::on_sendButton_clicked()
 
 void PageCanAnalyzer::on_clearRxButton_clicked()
 {
-    ui->msgTable->setRowCount(0);
+    mModel->clear();
 }
 
 void PageCanAnalyzer::on_updateCanBaudButton_clicked()
@@ -171,3 +181,114 @@ void PageCanAnalyzer::on_updateCanBaudButton_clicked()
     }
 }
 
+
+void PageCanAnalyzer::on_byIdBox_toggled(bool checked)
+{
+    mModel->setMode(checked ? CanFrameModel::ModeById : CanFrameModel::ModeFrames);
+    ui->msgTable->setColumnWidth(checked ? 1 : 2, 120);
+}
+
+void PageCanAnalyzer::on_recordButton_toggled(bool checked)
+{
+    if (!checked) {
+        mCapture.close();
+        ui->captureLabel->setText(tr("Recorded %1 frames").arg(mCapture.framesWritten()));
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    tr("Record CAN Frames"), "",
+                                                    tr("CAN Capture (*.vcan);;candump Log (*.log)"));
+
+    if (fileName.isEmpty()) {
+        ui->recordButton->setChecked(false);
+        return;
+    }
+
+    if (!fileName.endsWith(".vcan", Qt::CaseInsensitive) &&
+            !fileName.endsWith(".log", Qt::CaseInsensitive)) {
+        fileName.append(".vcan");
+    }
+
+    if (!mCapture.open(fileName)) {
+        QMessageBox::critical(this, tr("Record CAN Frames"),
+                              tr("Could not open %1 for writing: %2").
+                              arg(fileName).arg(mCapture.errorString()));
+        ui->recordButton->setChecked(false);
+    }
+}
+
+void PageCanAnalyzer::on_replayButton_clicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(this,
+                                                    tr("Replay CAN Frames"), "",
+                                                    tr("CAN Captures (*.vcan *.log *.txt)"));
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QString err;
+    if (!mReplay->loadFile(fileName, &err)) {
+        QMessageBox::critical(this, tr("Replay CAN Frames"),
+                              tr("Could not read %1: %2").arg(fileName).arg(err));
+        return;
+    }
+
+    mReplay->setSpeed(ui->replaySpeedBox->value());
+    mReplay->start();
+}
+
+void PageCanAnalyzer::on_replayStopButton_clicked()
+{
+    mReplay->stop();
+}
+
+void PageCanAnalyzer::updateFilter()
+{
+    quint32 id = 0;
+    quint32 mask = 0;
+
+    if (!parseId(ui->filterIdEdit->text(), id) || !parseId(ui->filterMaskEdit->text(), mask)) {
+        if (mVesc) {
+            mVesc->emitMessageDialog("CAN Filter",
+                                     "Unable to parse filter. ID and mask must be decimal numbers, or "
+                                     "hexadecimal numbers starting with 0x",
+                                     false);
+        }
+        return;
+    }
+
+    mModel->setFilter(id, mask);
+}
+
+void PageCanAnalyzer::replayFrame(QByteArray data, quint32 id, bool isExtended)
+{
+    mModel->addFrame(data, id, isExtended);
+
+    if (mVesc && ui->replayDecodeBox->isChecked()) {
+        mVesc->processCanFrame(data, id, isExtended);
+    }
+}
+
+void PageCanAnalyzer::replayFinished(int frames, double seconds)
+{
+    ui->captureLabel->setText(tr("Replayed %1 frames in %2 s (%3 frames/s)").
+                              arg(frames).arg(seconds, 0, 'f', 3).
+                              arg(seconds > 0.0 ? double(frames) / seconds : 0.0, 0, 'f', 0));
+}
+
+bool PageCanAnalyzer::parseId(QString txt, quint32 &id)
+{
+    txt = txt.toLower().replace(" ", "");
+    bool ok = false;
+
+    if (txt.startsWith("0x")) {
+        txt.remove(0, 2);
+        id = txt.toUInt(&ok, 16);
+    } else {
+        id = txt.toUInt(&ok, 10);
+    }
+
+    return ok;
+}
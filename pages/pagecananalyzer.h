@@ -23,6 +23,8 @@
 #include <QWidget>
 #include "vescinterface.h"
 #include "widgets/paramtable.h"
+#include "widgets/canframemodel.h"
+#include "cancapture.h"
 
 namespace Ui {
 class PageCanAnalyzer;
@@ -45,10 +47,22 @@ private slots:
     void on_sendButton_clicked();
     void on_clearRxButton_clicked();
     void on_updateCanBaudButton_clicked();
+    void on_byIdBox_toggled(bool checked);
+    void on_recordButton_toggled(bool checked);
+    void on_replayButton_clicked();
+    void on_replayStopButton_clicked();
+    void updateFilter();
+    void replayFrame(QByteArray data, quint32 id, bool isExtended);
+    void replayFinished(int frames, double seconds);
 
 private:
     Ui::PageCanAnalyzer *ui;
     VescInterface *mVesc;
+    CanFrameModel *mModel;
+    CanCaptureWriter mCapture;
+    CanReplay *mReplay;
+
+    bool parseId(QString txt, quint32 &id);
 
 };
 
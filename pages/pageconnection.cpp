@@ -177,8 +177,19 @@ void PageConnection::setVesc(VescInterface *vesc)
             this, SLOT(CANbusNewNode(int)));
     connect(mVesc, SIGNAL(CANbusInterfaceListUpdated()),
             this, SLOT(CANbusInterfaceListUpdated()));
+    connect(mVesc, SIGNAL(serialPortListUpdated()),
+            this, SLOT(on_serialRefreshButton_clicked()));
     connect(mVesc, SIGNAL(pairingListUpdated()),
             this, SLOT(pairingListUpdated()));
+    connect(mVesc, &VescInterface::connectTimingsUpdated, [this]() {
+        QString report = mVesc->connectTimingReport();
+        QString serialIo = mVesc->serialIoReport();
+        if (!report.isEmpty() && !serialIo.isEmpty()) {
+            report += "\nSerial link\n" + serialIo;
+        }
+        ui->statusLabel->setToolTip(report.isEmpty() ? QString() :
+                                                       "Connection bring-up\n" + report.trimmed());
+    });
 
     pairingListUpdated();
     on_serialRefreshButton_clicked();
@@ -356,13 +367,16 @@ void PageConnection::pairingListUpdated()
 void PageConnection::on_serialRefreshButton_clicked()
 {
     if (mVesc) {
+        // Keep the selection when the list is refreshed after a hotplug event
+        QString selected = ui->serialPortBox->currentData().toString();
+
         ui->serialPortBox->clear();
         auto ports = mVesc->listSerialPorts();
         foreach(auto &info, ports) {
             auto port = info.value<VSerialInfo_t>();
             ui->serialPortBox->addItem(port.name, port.systemPath);
         }
-        ui->serialPortBox->setCurrentIndex(0);
+        ui->serialPortBox->setCurrentIndex(qMax(ui->serialPortBox->findData(selected), 0));
     }
 }
 
@@ -468,6 +482,14 @@ void PageConnection::on_canFwdButton_clicked()
 void PageConnection::on_autoConnectButton_clicked()
 {
     Utility::autoconnectBlockingWithProgress(mVesc, this);
+
+    if (mVesc) {
+        QString report = mVesc->getAutoconnectReport().trimmed();
+        ui->autoConnectButton->setToolTip(
+                    tr("Try to automatically connect using the USB connection") +
+                    "\n\n" + tr("Devices found in the last attempt:") + "\n" +
+                    (report.isEmpty() ? tr("None") : report));
+    }
 }
 
 void PageConnection::on_bleScanButton_clicked()
@@ -20,6 +20,7 @@
 #include "pageexperiments.h"
 #include "ui_pageexperiments.h"
 #include "utility.h"
+#include "framescheduler.h"
 
 #include <QDebug>
 #include <QFileDialog>
@@ -140,8 +141,22 @@ PageExperiments::PageExperiments(QWidget *parent) :
             this, SLOT(victronDataAvailable()));
 #endif
 
+    mPlotPending = false;
     plotSamples(false);
     on_victronRefreshButton_clicked();
+
+    FrameScheduler::instance()->addClient(this, [this]() {
+        if (mPlotPending) {
+            mPlotPending = false;
+            plotSamples(false);
+        }
+    });
+
+    // The samples are needed for as long as the experiment runs, also when
+    // the page or the realtime data widgets are not shown.
+    FrameScheduler::instance()->addStreamConsumer(this, FrameScheduler::StreamRtData, [this]() {
+        return mState != EXPERIMENT_OFF;
+    });
 }
 
 PageExperiments::~PageExperiments()
@@ -194,7 +209,7 @@ void PageExperiments::valuesReceived(MC_VALUES values, unsigned int mask)
         mTempMotorVec.append(values.temp_motor);
         mDutyVec.append(values.duty_now * 100.0);
 
-        plotSamples(false);
+        mPlotPending = true;
     }
 }
 
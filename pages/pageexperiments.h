@@ -108,6 +108,7 @@ private:
 
     QTimer *mTimer;
     QElapsedTimer mExperimentTimer;
+    bool mPlotPending;
 
     // Victron Energy BMV700
     QElapsedTimer mVictronTimer;
@@ -20,6 +20,7 @@
 #include "pageimu.h"
 #include "ui_pageimu.h"
 #include "utility.h"
+#include "framescheduler.h"
 
 #include <cmath>
 
@@ -31,14 +32,12 @@ PageImu::PageImu(QWidget *parent) :
     layout()->setContentsMargins(0, 0, 0, 0);
     mVesc = 0;
 
-    mTimer = new QTimer(this);
-    mTimer->start(20);
     mUpdatePlots = false;
     mSecondCounter = 0.0;
     mLastUpdateTime = 0;
 
-    connect(mTimer, SIGNAL(timeout()),
-            this, SLOT(timerSlot()));
+    FrameScheduler::instance()->addClient(this, [this]() { timerSlot(); });
+    FrameScheduler::instance()->addStreamConsumer(this, FrameScheduler::StreamImuData);
 
     QCustomPlot *plots[4] = {ui->rpyPlot, ui->accelPlot, ui->gyroPlot, ui->magPlot };
     for(int i = 0; i<4; i++)
@@ -50,7 +50,6 @@ private:
     Ui::PageImu *ui;
 
     VescInterface *mVesc;
-    QTimer *mTimer;
 
     bool mUpdatePlots;
 
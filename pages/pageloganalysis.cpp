@@ -212,6 +212,20 @@ PageLogAnalysis::PageLogAnalysis(QWidget *parent) :
     ui->plot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignRight|Qt::AlignBottom);
     ui->plot->xAxis->setLabel("Seconds (s)");
 
+    Utility::setPlotColors(ui->specPlot);
+    connect(ui->specSeriesBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this]() { updateSpectrogram(); });
+    connect(ui->specWindowBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this]() { updateSpectrogram(); });
+    connect(ui->specWindowTypeBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this]() { updateSpectrogram(); });
+    connect(ui->specOverlapBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this]() { updateSpectrogram(); });
+    connect(ui->specLogBox, &QCheckBox::toggled,
+            [this]() { updateSpectrogram(); });
+    connect(ui->tabWidget, &QTabWidget::currentChanged,
+            [this]() { updateSpectrogram(); });
+
     mVerticalLine = new QCPCurve(ui->plot->xAxis, ui->plot->yAxis);
     mVerticalLine->removeFromLegend();
     mVerticalLine->setPen(QPen(Utility::getAppQColor("normalText")));
@@ -813,14 +827,14 @@ void PageLogAnalysis::on_tilesHiResButton_toggled(bool checked)
 {
     (void)checked;
     updateTileServers();
-    ui->map->update();
+    ui->map->invalidateLayers();
 }
 
 void PageLogAnalysis::on_tilesOsmButton_toggled(bool checked)
 {
     (void)checked;
     updateTileServers();
-    ui->map->update();
+    ui->map->invalidateLayers();
 }
 
 void PageLogAnalysis::truncateDataAndPlot(bool zoomGraph)
@@ -902,6 +916,7 @@ void PageLogAnalysis::truncateDataAndPlot(bool zoomGraph)
     ui->map->update();
     updateGraphs();
     updateStats();
+    updateSpectrogram();
 }
 
 void PageLogAnalysis::updateGraphs()
@@ -1451,6 +1466,137 @@ void PageLogAnalysis::updateStats()
     ui->statTable->item(13, 1)->setText(QString::number(double(samples) / (double(timeTotMs) / 1000.0), 'f', 2) + " Hz");
 }
 
+/**
+ * @brief PageLogAnalysis::updateSpectrogram
+ * Update the spectrogram tab. The selected series of the whole log is resampled
+ * to a uniform rate and transformed once, so moving the span slider only
+ * changes the visible range and does not recompute the STFT.
+ */
+void PageLogAnalysis::updateSpectrogram()
+{
+    // Keep the series list in sync with the log header
+    QStringList names;
+    for (const auto &e: mLogHeader) {
+        if (!e.isTimeStamp) {
+            names.append(e.name);
+        }
+    }
+
+    QStringList namesNow;
+    for (int i = 0;i < ui->specSeriesBox->count();i++) {
+        namesNow.append(ui->specSeriesBox->itemText(i));
+    }
+
+    if (names != namesNow) {
+        QSignalBlocker blocker(ui->specSeriesBox);
+        QString selected = ui->specSeriesBox->currentText();
+        ui->specSeriesBox->clear();
+        for (int i = 0;i < mLogHeader.size();i++) {
+            if (!mLogHeader.at(i).isTimeStamp) {
+                ui->specSeriesBox->addItem(mLogHeader.at(i).name, i);
+            }
+        }
+
+        int ind = ui->specSeriesBox->findText(selected);
+        if (ind >= 0) {
+            ui->specSeriesBox->setCurrentIndex(ind);
+        }
+    }
+
+    if (!ui->specPlot->isVisible() || mLog.size() < 2 ||
+            ui->specSeriesBox->currentIndex() < 0) {
+        return;
+    }
+
+    int column = ui->specSeriesBox->currentData().toInt();
+    if (column < 0 || column >= mLogHeader.size()) {
+        return;
+    }
+
+    // Sample times relative to the start of the log
+    QVector<double> times;
+    times.reserve(mLog.size());
+    for (int i = 0;i < mLog.size();i++) {
+        double t = double(i);
+        if (mInd_t_day >= 0) {
+            t = mLog.at(i).at(mInd_t_day) - mLog.first().at(mInd_t_day);
+            if (t < 0) { // Handle midnight
+                t += 60 * 60 * 24;
+            }
+        }
+
+        // Samples with the same or earlier timestamp would break the interpolation
+        if (!times.isEmpty() && t <= times.last()) {
+            t = times.last() + 1e-6;
+        }
+
+        times.append(t);
+    }
+
+    double duration = times.last() - times.first();
+    double fs = double(times.size() - 1) / duration;
+
+    // Linear interpolation to a uniform sample rate
+    QVector<double> signal;
+    signal.reserve(times.size());
+    int src = 0;
+    for (int i = 0;i < times.size();i++) {
+        double t = double(i) / fs;
+        while (src < (times.size() - 2) && times.at(src + 1) < t) {
+            src++;
+        }
+
+        double t0 = times.at(src);
+        double t1 = times.at(src + 1);
+        double v0 = mLog.at(src).at(column);
+        double v1 = mLog.at(src + 1).at(column);
+        double prop = qBound(0.0, (t - t0) / (t1 - t0), 1.0);
+        signal.append(v0 + (v1 - v0) * prop);
+    }
+
+    mSpec.setSignal(signal, fs);
+
+    if (!mSpecMap) {
+        mSpecMap = Spectrogram::setupPlot(ui->specPlot);
+    }
+
+    bool logScale = ui->specLogBox->isChecked();
+    mSpec.render(mSpecMap, Spectrogram::paramsFromOverlap(
+                     ui->specWindowBox->currentIndex() + 4,
+                     ui->specOverlapBox->value(),
+                     DigitalFiltering::WindowType(ui->specWindowTypeBox->currentIndex())),
+                 logScale);
+
+    const auto &h = mLogHeader.at(column);
+    QString unit = QString("%1%2").arg(logScale ? "dB" : "").arg(h.unit);
+    if (mSpecMap->colorScale()) {
+        mSpecMap->colorScale()->axis()->setLabel(unit.isEmpty() ?
+                                                     h.name : QString("%1 (%2)").arg(h.name).arg(unit));
+    }
+
+    if (mInd_t_day >= 0) {
+        ui->specPlot->xAxis->setLabel("Seconds (s)");
+        ui->specPlot->yAxis->setLabel("Frequency (Hz)");
+    } else {
+        ui->specPlot->xAxis->setLabel("Sample");
+        ui->specPlot->yAxis->setLabel("Frequency (1/Sample)");
+    }
+
+    // Show the span selected by the slider, with the same time axis as the
+    // main plot
+    int startInd = qBound(0, int(double(ui->spanSlider->alt_value()) / 10000.0 * times.size()), times.size() - 1);
+    int endInd = qBound(startInd, int(double(ui->spanSlider->value()) / 10000.0 * times.size()) - 1, times.size() - 1);
+    double tStart = times.at(startInd);
+
+    QCPColorMapData *d = mSpecMap->data();
+    QCPRange keyRange = d->keyRange();
+    d->setKeyRange(QCPRange(keyRange.lower - tStart, keyRange.upper - tStart));
+
+    ui->specPlot->xAxis->setRange(0.0, qMax(times.at(endInd) - tStart, 1e-3));
+    ui->specPlot->yAxis->setRange(0.0, fs / 2.0);
+    ui->specPlot->replotWhenVisible();
+}
+
 void PageLogAnalysis::updateDataAndPlot(double time)
 {
     if (mLogTruncated.isEmpty()) {
@@ -28,6 +28,7 @@
 #include <vescinterface.h>
 #include "widgets/qcustomplot.h"
 #include "widgets/vesc3dview.h"
+#include "widgets/spectrogram.h"
 
 namespace Ui {
 class PageLogAnalysis;
@@ -131,6 +132,9 @@ private:
     SelectoData mSelection;
     QHash<int, QColor> mGraphRowColors;
 
+    Spectrogram mSpec;
+    QPointer<QCPColorMap> mSpecMap;
+
     void resetInds() {
         mInd_t_day = -1;
         mInd_t_day_pos = -1;
@@ -182,6 +186,7 @@ private:
     void updateSelectedDataItems();
     void updateSelectedDataItemValues();
     void updateStats();
+    void updateSpectrogram();
     void updateDataAndPlot(double time);
     QVector<double> getLogSample(double time);
     void updateTileServers();
@@ -20,11 +20,59 @@
 #include "pagemotorcomparison.h"
 #include "ui_pagemotorcomparison.h"
 #include "utility.h"
+#include "motormap.h"
+#include "drivecycle.h"
+#include <algorithm>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QQmlEngine>
 #include <QQmlContext>
 #include <QQuickItem>
+#include <QJSValue>
+
+namespace {
+// Index of the map tab in tabWidget
+const int mapTabIndex = 2;
+
+// Index of the drive cycle tab in tabWidget
+const int cycleTabIndex = 3;
+
+void updateTable(MotorData &md, QTableWidget *table)
+{
+    int ind = 0;
+    table->item(ind++, 1)->setText(QString::number(md.efficiency * 100.0, 'f', 1) + " %");
+    table->item(ind++, 1)->setText(QString::number(md.loss_motor_tot, 'f', 1) + " W");
+    table->item(ind++, 1)->setText(QString::number(md.loss_motor_res, 'f', 1) + " W");
+    table->item(ind++, 1)->setText(QString::number(md.loss_motor_other, 'f', 1) + " W");
+    table->item(ind++, 1)->setText(QString::number(md.loss_gearing, 'f', 1) + " W");
+    table->item(ind++, 1)->setText(QString::number(md.loss_tot, 'f', 1) + " W");
+    table->item(ind++, 1)->setText(QString::number(md.iq, 'f', 1) + " A");
+    table->item(ind++, 1)->setText(QString::number(md.id, 'f', 1) + " A");
+    table->item(ind++, 1)->setText(QString::number(md.i_mag, 'f', 1) + " A");
+    table->item(ind++, 1)->setText(QString::number(md.p_in, 'f', 1) + " W");
+    table->item(ind++, 1)->setText(QString::number(md.p_out, 'f', 1) + " W");
+    table->item(ind++, 1)->setText(QString::number(md.vq, 'f', 1) + " V");
+    table->item(ind++, 1)->setText(QString::number(md.vd, 'f', 1) + " V");
+    table->item(ind++, 1)->setText(QString::number(md.vbus_min, 'f', 1) + " V");
+    table->item(ind++, 1)->setText(QString::number(md.torque_out, 'f', 3) + " Nm");
+    table->item(ind++, 1)->setText(QString::number(md.torque_motor_shaft, 'f', 3) + " Nm");
+    table->item(ind++, 1)->setText(QString::number(md.rpm_out, 'f', 1));
+    table->item(ind++, 1)->setText(QString::number(md.rpm_motor_shaft, 'f', 1));
+    table->item(ind++, 1)->setText(QString::number(md.power_factor, 'f', 3));
+    table->item(ind++, 1)->setText(QString::number(md.extraVal, 'f', 1));
+    table->item(ind++, 1)->setText(QString::number(md.extraVal2, 'f', 1));
+    table->item(ind++, 1)->setText(QString::number(md.extraVal3, 'f', 1));
+    table->item(ind++, 1)->setText(QString::number(md.extraVal4, 'f', 1));
+    table->item(ind++, 1)->setText(QString::number(md.erpm, 'f', 1));
+    table->item(ind++, 1)->setText(QString::number(md.km_h, 'f', 1) + " km/h");
+    table->item(ind++, 1)->setText(QString::number(md.mph, 'f', 1) + " mph");
+    table->item(ind++, 1)->setText(QString::number(md.wh_km, 'f', 1) + " wh/km");
+    table->item(ind++, 1)->setText(QString::number(md.wh_mi, 'f', 1) + " wh/mi");
+    table->item(ind++, 1)->setText(QString::number(md.kv_bldc, 'f', 1) + " RPM/V");
+    table->item(ind++, 1)->setText(QString::number(md.kv_bldc_noload, 'f', 1) + " RPM/V");
+}
+}
 
 PageMotorComparison::PageMotorComparison(QWidget *parent) :
     QWidget(parent),
@@ -71,6 +119,7 @@ PageMotorComparison::PageMotorComparison(QWidget *parent) :
     mM1ConfigLoaded = false;
     mM2ConfigLoaded = false;
     mRunDone = false;
+    mQmlBatchOk = false;
 
     Utility::setPlotColors(ui->plot);
     ui->plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
@@ -128,6 +177,7 @@ PageMotorComparison::PageMotorComparison(QWidget *parent) :
     ui->m1ConfFileEdit->setText(set.value("pagemotorcomparison/m1confpath", "").toString());
     ui->m2ConfFileEdit->setText(set.value("pagemotorcomparison/m2confpath", "").toString());
     ui->qmlFileEdit->setText(set.value("pagemotorcomparison/qmlpath", "").toString());
+    ui->cycleFileEdit->setText(set.value("pagemotorcomparison/cyclepath", "").toString());
 
     connect(ui->m1ConfFileEdit, &QLineEdit::textChanged, [=]() {
         mM1ConfigLoaded = false;
@@ -293,6 +343,12 @@ PageMotorComparison::PageMotorComparison(QWidget *parent) :
     auto updateMouse = [this](QMouseEvent *event) {
         if (event->buttons() & Qt::RightButton) {
             double vx = ui->plot->xAxis->pixelToCoord(event->x());
+
+            if (mMapPlot) {
+                updateMapPoint(vx, ui->plot->yAxis->pixelToCoord(event->y()));
+                return;
+            }
+
             updateDataAndPlot(vx, ui->plot->yAxis->range().lower, ui->plot->yAxis->range().upper);
         }
     };
@@ -333,6 +389,98 @@ PageMotorComparison::PageMotorComparison(QWidget *parent) :
         addDataItem(name, ui->m2PlotTable, hasScale);
     };
 
+    for (int i = 0;i < MotorMap::QuantityCount;i++) {
+        ui->mapQuantityBox->addItem(MotorMap::quantityName(MotorMap::Quantity(i)));
+    }
+
+    connect(ui->mapQuantityBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this](int index) { (void)index; settingChanged(); });
+    connect(ui->mapShowBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this](int index) { (void)index; settingChanged(); });
+    connect(ui->mapTorqueBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            [this](double value) { (void)value; settingChanged(); });
+    connect(ui->mapRpmBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            [this](double value) { (void)value; settingChanged(); });
+    connect(ui->mapPointsBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this](int value) { (void)value; settingChanged(); });
+    connect(ui->mapVbusBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            [this](double value) { (void)value; settingChanged(); });
+
+    connect(ui->mapRunButton, &QPushButton::clicked, [this]() {
+        on_testRunButton_clicked();
+    });
+
+    connect(ui->mapCsvButton, &QPushButton::clicked, [this]() {
+        if (mMapA.isNull() || mMapB.isNull()) {
+            mVesc->emitMessageDialog("Export Map", "Generate the maps first.", false);
+            return;
+        }
+
+        QString fileName = QFileDialog::getSaveFileName(this,
+                                                        tr("Export Map"), "",
+                                                        tr("CSV files (*.csv)"));
+
+        if (fileName.isEmpty()) {
+            return;
+        }
+
+        if (!fileName.toLower().endsWith(".csv")) {
+            fileName += ".csv";
+        }
+
+        if (MotorMap::exportCsv(fileName, *mMapA, *mMapB,
+                                ui->compAEdit->text(), ui->compBEdit->text())) {
+            mVesc->emitStatusMessage("Map exported", true);
+        } else {
+            mVesc->emitMessageDialog("Export Map", "Could not write " + fileName, false);
+        }
+    });
+
+    // Not on textChanged, as partial paths cannot be loaded
+    connect(ui->cycleFileEdit, &QLineEdit::editingFinished, [this]() { settingChanged(); });
+    connect(ui->cycleShowBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            [this](int index) { (void)index; settingChanged(); });
+    connect(ui->cycleMassBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            [this](double value) { (void)value; settingChanged(); });
+    connect(ui->cycleVbusBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            [this](double value) { (void)value; settingChanged(); });
+    connect(ui->cycleDragBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            [this](double value) { (void)value; settingChanged(); });
+    connect(ui->cycleRollBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            [this](double value) { (void)value; settingChanged(); });
+    connect(ui->cycleRthBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            [this](double value) { (void)value; settingChanged(); });
+    connect(ui->cycleTauBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            [this](double value) { (void)value; settingChanged(); });
+
+    connect(ui->cycleChooseButton, &QPushButton::clicked, [this]() {
+        QString fileName = QFileDialog::getOpenFileName(this,
+                                                        tr("Speed Profile"),
+                                                        QFileInfo(ui->cycleFileEdit->text()).canonicalFilePath(),
+                                                        tr("Logs and CSV files (*.csv *.txt)"));
+
+        if (!fileName.isEmpty()) {
+            ui->cycleFileEdit->setText(fileName);
+            settingChanged();
+        }
+    });
+
+    connect(ui->cycleRunButton, &QPushButton::clicked, [this]() {
+        // Read the profile again, in case the file has changed
+        mCycleProfilePath.clear();
+        on_testRunButton_clicked();
+    });
+
+    connect(ui->tabWidget, &QTabWidget::currentChanged, [this](int index) {
+        if (index != mapTabIndex && mMapPlot) {
+            Utility::plotRemoveColorMaps(ui->plot);
+            ui->plot->legend->setVisible(true);
+            ui->plot->yAxis->setLabel("");
+        }
+
+        settingChanged();
+    });
+
     mSettingUpdateRequired = false;
     mSettingUpdateTimer = new QTimer(this);
     mSettingUpdateTimer->start(20);
@@ -418,6 +566,7 @@ void PageMotorComparison::saveStateToSettings()
     set.setValue("pagemotorcomparison/m1confpath", ui->m1ConfFileEdit->text());
     set.setValue("pagemotorcomparison/m2confpath", ui->m2ConfFileEdit->text());
     set.setValue("pagemotorcomparison/qmlpath", ui->qmlFileEdit->text());
+    set.setValue("pagemotorcomparison/cyclepath", ui->cycleFileEdit->text());
 }
 
 VescInterface *PageMotorComparison::vesc() const
@@ -507,40 +656,6 @@ void PageMotorComparison::updateDataAndPlot(double posx, double yMin, double yMa
     mVerticalLineYLast.first = yMin;
     mVerticalLineYLast.second = yMax;
 
-    auto updateTable = [](MotorData &md, QTableWidget *table) {
-        int ind = 0;
-        table->item(ind++, 1)->setText(QString::number(md.efficiency * 100.0, 'f', 1) + " %");
-        table->item(ind++, 1)->setText(QString::number(md.loss_motor_tot, 'f', 1) + " W");
-        table->item(ind++, 1)->setText(QString::number(md.loss_motor_res, 'f', 1) + " W");
-        table->item(ind++, 1)->setText(QString::number(md.loss_motor_other, 'f', 1) + " W");
-        table->item(ind++, 1)->setText(QString::number(md.loss_gearing, 'f', 1) + " W");
-        table->item(ind++, 1)->setText(QString::number(md.loss_tot, 'f', 1) + " W");
-        table->item(ind++, 1)->setText(QString::number(md.iq, 'f', 1) + " A");
-        table->item(ind++, 1)->setText(QString::number(md.id, 'f', 1) + " A");
-        table->item(ind++, 1)->setText(QString::number(md.i_mag, 'f', 1) + " A");
-        table->item(ind++, 1)->setText(QString::number(md.p_in, 'f', 1) + " W");
-        table->item(ind++, 1)->setText(QString::number(md.p_out, 'f', 1) + " W");
-        table->item(ind++, 1)->setText(QString::number(md.vq, 'f', 1) + " V");
-        table->item(ind++, 1)->setText(QString::number(md.vd, 'f', 1) + " V");
-        table->item(ind++, 1)->setText(QString::number(md.vbus_min, 'f', 1) + " V");
-        table->item(ind++, 1)->setText(QString::number(md.torque_out, 'f', 3) + " Nm");
-        table->item(ind++, 1)->setText(QString::number(md.torque_motor_shaft, 'f', 3) + " Nm");
-        table->item(ind++, 1)->setText(QString::number(md.rpm_out, 'f', 1));
-        table->item(ind++, 1)->setText(QString::number(md.rpm_motor_shaft, 'f', 1));
-        table->item(ind++, 1)->setText(QString::number(md.power_factor, 'f', 3));
-        table->item(ind++, 1)->setText(QString::number(md.extraVal, 'f', 1));
-        table->item(ind++, 1)->setText(QString::number(md.extraVal2, 'f', 1));
-        table->item(ind++, 1)->setText(QString::number(md.extraVal3, 'f', 1));
-        table->item(ind++, 1)->setText(QString::number(md.extraVal4, 'f', 1));
-        table->item(ind++, 1)->setText(QString::number(md.erpm, 'f', 1));
-        table->item(ind++, 1)->setText(QString::number(md.km_h, 'f', 1) + " km/h");
-        table->item(ind++, 1)->setText(QString::number(md.mph, 'f', 1) + " mph");
-        table->item(ind++, 1)->setText(QString::number(md.wh_km, 'f', 1) + " wh/km");
-        table->item(ind++, 1)->setText(QString::number(md.wh_mi, 'f', 1) + " wh/mi");
-        table->item(ind++, 1)->setText(QString::number(md.kv_bldc, 'f', 1) + " RPM/V");
-        table->item(ind++, 1)->setText(QString::number(md.kv_bldc_noload, 'f', 1) + " RPM/V");
-    };
-
     if (!mRunDone || !reloadConfigs()) {
         return;
     }
@@ -563,6 +678,8 @@ void PageMotorComparison::updateDataAndPlot(double posx, double yMin, double yMa
         md.extraVal4 = param.extraM2_4;
         updateTable(md, ui->m2PlotTable);
         setQmlProgressSelected(posx);
+    } else if (ui->tabWidget->currentIndex() == cycleTabIndex) {
+        updateCyclePoint(posx);
     } else  {
         if (ui->testModeTorqueButton->isChecked()) {
             MotorData md;
@@ -668,6 +785,17 @@ void PageMotorComparison::on_testRunButton_clicked()
         return;
     }
 
+    // The MotorData objects in the script hold a copy of the motor parameters,
+    // so they have to be updated when the configurations are reloaded.
+    if (ui->tabWidget->currentIndex() == 1) {
+        setQmlMotorParams();
+    }
+
+    if (ui->tabWidget->currentIndex() == mapTabIndex) {
+        plotMap();
+        return;
+    }
+
     auto updateData = [this](MotorData &md,
             QTableWidget *table,
             QVector<QVector<double> > &yAxes,
@@ -898,14 +1026,49 @@ void PageMotorComparison::on_testRunButton_clicked()
         ui->plot->replotWhenVisible();
     };
 
-    auto plotTorqueSweep = [this, updateData, updateGraphs, plotPoints](QTableWidget *table,
+    // Adds the results up to the first one that exceeds the maximum motor
+    // shaft RPM to the plot.
+    auto plotResults = [this, updateData, updateGraphs](QTableWidget *table,
+            MotorDataParams param, QVector<double> xAxis, QVector<MotorData> &res,
+            bool warnMaxRpm, QString xLabel) {
+        QVector<QVector<double> > yAxes;
+        QVector<QString> names;
+
+        int points = 0;
+        for (auto &md: res) {
+            points++;
+            updateData(md, table, yAxes, names);
+
+            if (md.rpm_motor_shaft >= param.maxRpm) {
+                if (warnMaxRpm) {
+                    mVesc->emitMessageDialog("Max RPM", "Maximum motor shaft RPM exceeded", false);
+                }
+                break;
+            }
+        }
+
+        xAxis.resize(points);
+        ui->plot->xAxis->setLabel(xLabel);
+        updateGraphs(xAxis, yAxes, names);
+    };
+
+    auto runSweep = [plotResults](QTableWidget *table, ConfigParams &config,
+            MotorDataParams param, const QVector<double> &xAxis,
+            const QVector<MotorSweepPoint> &points, MotorSweepMode mode,
+            bool warnMaxRpm, QString xLabel) {
+        MotorData base;
+        base.configure(&config, param);
+        auto res = MotorData::updateBatch(base, points, mode);
+        plotResults(table, param, xAxis, res, warnMaxRpm, xLabel);
+    };
+
+    auto plotTorqueSweep = [this, runSweep, plotPoints](QTableWidget *table,
             ConfigParams &config, MotorDataParams param) {
         double torque = fabs(ui->testTorqueBox->value());
         double rpm = ui->testRpmBox->value();
 
         QVector<double> xAxis;
-        QVector<QVector<double> > yAxes;
-        QVector<QString> names;
+        QVector<MotorSweepPoint> points;
 
         double torque_start = -torque;
         if (!ui->testNegativeBox->isChecked()) {
@@ -913,30 +1076,21 @@ void PageMotorComparison::on_testRunButton_clicked()
         }
 
         for (double t = torque_start;t < torque;t += (torque / plotPoints)) {
-            MotorData md;
-            md.configure(&config, param);
-            md.update(rpm, t);
             xAxis.append(t);
-            updateData(md, table, yAxes, names);
-
-            if (md.rpm_motor_shaft >= param.maxRpm) {
-                mVesc->emitMessageDialog("Max RPM", "Maximum motor shaft RPM exceeded", false);
-                break;
-            }
+            points.append(MotorSweepPoint(rpm, t));
         }
 
-        ui->plot->xAxis->setLabel("Torque (Nm)");
-        updateGraphs(xAxis, yAxes, names);
+        runSweep(table, config, param, xAxis, points,
+                 MOTOR_SWEEP_RPM_TORQUE, true, "Torque (Nm)");
     };
 
-    auto plotRpmSweep = [this, updateData, updateGraphs, plotPoints](QTableWidget *table,
+    auto plotRpmSweep = [this, runSweep, plotPoints](QTableWidget *table,
             ConfigParams &config, MotorDataParams param) {
         double torque = ui->testTorqueBox->value();
         double rpm = ui->testRpmBox->value();
 
         QVector<double> xAxis;
-        QVector<QVector<double> > yAxes;
-        QVector<QString> names;
+        QVector<MotorSweepPoint> points;
 
         double rpm_start = -rpm;
         if (!ui->testNegativeBox->isChecked()) {
@@ -944,51 +1098,36 @@ void PageMotorComparison::on_testRunButton_clicked()
         }
 
         for (double r = rpm_start;r < rpm;r += (rpm / plotPoints)) {
-            MotorData md;
-            md.configure(&config, param);
-            md.update(r, torque);
             xAxis.append(r);
-            updateData(md, table, yAxes, names);
-
-            if (md.rpm_motor_shaft >= param.maxRpm) {
-                break;
-            }
+            points.append(MotorSweepPoint(r, torque));
         }
 
-        ui->plot->xAxis->setLabel("RPM");
-        updateGraphs(xAxis, yAxes, names);
+        runSweep(table, config, param, xAxis, points,
+                 MOTOR_SWEEP_RPM_TORQUE, false, "RPM");
     };
 
-    auto plotPowerSweep = [this, updateData, updateGraphs, plotPoints](QTableWidget *table,
+    auto plotPowerSweep = [this, runSweep, plotPoints](QTableWidget *table,
             ConfigParams &config, MotorDataParams param) {
         double rpm = ui->testRpmBox->value();
         double rpm_start = ui->testRpmStartBox->value();
         double power = ui->testPowerBox->value();
 
         QVector<double> xAxis;
-        QVector<QVector<double> > yAxes;
-        QVector<QString> names;
+        QVector<MotorSweepPoint> points;
 
         for (double r = rpm_start;r < rpm;r += (rpm / plotPoints)) {
             double rps = r * 2.0 * M_PI / 60.0;
             double torque = power / rps;
 
-            MotorData md;
-            md.configure(&config, param);
-            md.update(r, torque);
             xAxis.append(r);
-            updateData(md, table, yAxes, names);
-
-            if (md.rpm_motor_shaft >= param.maxRpm) {
-                break;
-            }
+            points.append(MotorSweepPoint(r, torque));
         }
 
-        ui->plot->xAxis->setLabel("RPM");
-        updateGraphs(xAxis, yAxes, names);
+        runSweep(table, config, param, xAxis, points,
+                 MOTOR_SWEEP_RPM_TORQUE, false, "RPM");
     };
 
-    auto plotPropSweep = [this, updateData, updateGraphs, plotPoints](QTableWidget *table,
+    auto plotPropSweep = [this, runSweep, plotPoints](QTableWidget *table,
             ConfigParams &config, MotorDataParams param) {
         double rpm = ui->testRpmBox->value();
         double power = ui->testPowerBox->value();
@@ -998,8 +1137,7 @@ void PageMotorComparison::on_testRunButton_clicked()
         double p_max_const = power / pow(rpm - rpm_start, prop_exp);
 
         QVector<double> xAxis;
-        QVector<QVector<double> > yAxes;
-        QVector<QString> names;
+        QVector<MotorSweepPoint> points;
 
         for (double r = rpm / plotPoints;r < rpm;r += (rpm / plotPoints)) {
             double rps = r * 2.0 * M_PI / 60.0;
@@ -1007,29 +1145,21 @@ void PageMotorComparison::on_testRunButton_clicked()
             double torque = power / rps;
             torque += baseTorque;
 
-            MotorData md;
-            md.configure(&config, param);
-            md.update(r, torque);
             xAxis.append(r);
-            updateData(md, table, yAxes, names);
-
-            if (md.rpm_motor_shaft >= param.maxRpm) {
-                break;
-            }
+            points.append(MotorSweepPoint(r, torque));
         }
 
-        ui->plot->xAxis->setLabel("RPM");
-        updateGraphs(xAxis, yAxes, names);
+        runSweep(table, config, param, xAxis, points,
+                 MOTOR_SWEEP_RPM_TORQUE, false, "RPM");
     };
 
-    auto plotVbusSweep = [this, updateData, updateGraphs, plotPoints](QTableWidget *table,
+    auto plotVbusSweep = [this, runSweep, plotPoints](QTableWidget *table,
             ConfigParams &config, MotorDataParams param) {
         double torque = fabs(ui->testTorqueBox->value());
         double vbus = ui->testVbusBox->value();
 
         QVector<double> xAxis;
-        QVector<QVector<double> > yAxes;
-        QVector<QString> names;
+        QVector<MotorSweepPoint> points;
 
         double torque_start = -torque;
         if (!ui->testNegativeBox->isChecked()) {
@@ -1037,31 +1167,22 @@ void PageMotorComparison::on_testRunButton_clicked()
         }
 
         for (double t = torque_start;t < torque;t += (torque / plotPoints)) {
-            MotorData md;
-            md.configure(&config, param);
-            md.updateTorqueVBus(t, vbus);
             xAxis.append(t);
-            updateData(md, table, yAxes, names);
-
-            if (md.rpm_motor_shaft >= param.maxRpm) {
-                mVesc->emitMessageDialog("Max RPM", "Maximum motor shaft RPM exceeded", false);
-                break;
-            }
+            points.append(MotorSweepPoint(0.0, t, vbus));
         }
 
-        ui->plot->xAxis->setLabel("Torque (Nm)");
-        updateGraphs(xAxis, yAxes, names);
+        runSweep(table, config, param, xAxis, points,
+                 MOTOR_SWEEP_TORQUE_VBUS, true, "Torque (Nm)");
     };
 
-    auto plotVBFWSweep = [this, updateData, updateGraphs, plotPoints](QTableWidget *table,
+    auto plotVBFWSweep = [this, runSweep, plotPoints](QTableWidget *table,
             ConfigParams &config, MotorDataParams param) {
         double torque = fabs(ui->testTorqueBox->value());
         double vbus = ui->testVbusBox->value();
         double rpm = ui->testRpmBox->value();
 
         QVector<double> xAxis;
-        QVector<QVector<double> > yAxes;
-        QVector<QString> names;
+        QVector<MotorSweepPoint> points;
 
         double torque_start = -torque;
         if (!ui->testNegativeBox->isChecked()) {
@@ -1069,31 +1190,22 @@ void PageMotorComparison::on_testRunButton_clicked()
         }
 
         for (double t = torque_start;t < torque;t += (torque / plotPoints)) {
-            MotorData md;
-            md.configure(&config, param);
-            md.updateTorqueVBusFW(t, rpm, vbus);
             xAxis.append(t);
-            updateData(md, table, yAxes, names);
-
-            if (md.rpm_motor_shaft >= param.maxRpm) {
-                mVesc->emitMessageDialog("Max RPM", "Maximum motor shaft RPM exceeded", false);
-                break;
-            }
+            points.append(MotorSweepPoint(rpm, t, vbus));
         }
 
-        ui->plot->xAxis->setLabel("Torque (Nm)");
-        updateGraphs(xAxis, yAxes, names);
+        runSweep(table, config, param, xAxis, points,
+                 MOTOR_SWEEP_TORQUE_VBUS_FW, true, "Torque (Nm)");
     };
 
-    auto plotVBRPMSweep = [this, updateData, updateGraphs, plotPoints](QTableWidget *table,
+    auto plotVBRPMSweep = [this, runSweep, plotPoints](QTableWidget *table,
             ConfigParams &config, MotorDataParams param) {
         double torque = fabs(ui->testTorqueBox->value());
         double vbus = ui->testVbusBox->value();
         double rpm = ui->testRpmBox->value();
 
         QVector<double> xAxis;
-        QVector<QVector<double> > yAxes;
-        QVector<QString> names;
+        QVector<MotorSweepPoint> points;
 
         double rpm_start = -rpm;
         if (!ui->testNegativeBox->isChecked()) {
@@ -1101,67 +1213,119 @@ void PageMotorComparison::on_testRunButton_clicked()
         }
 
         for (double r = rpm_start;r < rpm;r += (rpm / plotPoints)) {
-            MotorData md;
-            md.configure(&config, param);
-            md.updateRpmVBusFW(torque, r, vbus);
             xAxis.append(r);
-            updateData(md, table, yAxes, names);
-
-            if (md.rpm_motor_shaft >= param.maxRpm) {
-                mVesc->emitMessageDialog("Max RPM", "Maximum motor shaft RPM exceeded", false);
-                break;
-            }
+            points.append(MotorSweepPoint(r, torque, vbus));
         }
 
-        ui->plot->xAxis->setLabel("RPM");
-        updateGraphs(xAxis, yAxes, names);
+        runSweep(table, config, param, xAxis, points,
+                 MOTOR_SWEEP_RPM_VBUS_FW, true, "RPM");
     };
 
-    auto plotQmlSweep = [this, updateData, updateGraphs, plotPoints](QTableWidget *table,
-            ConfigParams &config, MotorDataParams param, int motor) {
+    // The script has to run on this thread, so the operating points of both
+    // motors are collected first and only the motor model runs in parallel.
+    auto plotQmlSweep = [plotResults](QTableWidget *table,
+            ConfigParams &config, MotorDataParams param, int motor,
+            const QVector<double> &xAxis, const QVector<QmlParams> &qmlParams,
+            QString xName) {
 
-        QVector<double> xAxis;
-        QVector<QVector<double> > yAxes;
-        QVector<QString> names;
-        double min = getQmlXMin();
-        double max = getQmlXMax();
+        QVector<MotorSweepPoint> points;
+        points.reserve(qmlParams.size());
 
-        for (double p = min; p < max; p += (max - min) / plotPoints) {
-            auto rpmTorque = getQmlParam(p);
+        for (const auto &rpmTorque: qmlParams) {
+            if (motor == 1) {
+                points.append(MotorSweepPoint(rpmTorque.rpmM1, rpmTorque.torqueM1));
+            } else {
+                points.append(MotorSweepPoint(rpmTorque.rpmM2, rpmTorque.torqueM2));
+            }
+        }
 
-            MotorData md;
-            md.configure(&config, param);
+        MotorData base;
+        base.configure(&config, param);
+        auto res = MotorData::updateBatch(base, points, MOTOR_SWEEP_RPM_TORQUE);
+
+        for (int i = 0;i < res.size();i++) {
+            MotorData &md = res[i];
+            const QmlParams &rpmTorque = qmlParams.at(i);
 
             if (motor == 1) {
-                md.update(rpmTorque.rpmM1, rpmTorque.torqueM1);
                 md.extraVal = rpmTorque.extraM1;
                 md.extraVal2 = rpmTorque.extraM1_2;
                 md.extraVal3 = rpmTorque.extraM1_3;
                 md.extraVal4 = rpmTorque.extraM1_4;
             } else {
-                md.update(rpmTorque.rpmM2, rpmTorque.torqueM2);
                 md.extraVal = rpmTorque.extraM2;
                 md.extraVal2 = rpmTorque.extraM2_2;
                 md.extraVal3 = rpmTorque.extraM2_3;
                 md.extraVal4 = rpmTorque.extraM2_4;
             }
+        }
 
-            xAxis.append(p);
-            updateData(md, table, yAxes, names);
+        plotResults(table, param, xAxis, res, false, xName);
+    };
 
-            if (md.rpm_motor_shaft >= param.maxRpm) {
+    // Plots the selected quantity of both motors over the drive cycle
+    auto plotCycle = [this, updateGraphs]() {
+        QVector<double> xAxis = mCycleProfile->time;
+        QVector<QVector<double> > yAxes;
+        QVector<QString> names;
+
+        auto addResult = [this, &yAxes, &names](const DriveCycle::Result &res, QString name) {
+            switch (ui->cycleShowBox->currentIndex()) {
+            case 0:
+                yAxes.append(res.powerIn);
+                names.append(name + " Power In (W)"); break;
+            case 1:
+                yAxes.append(res.lossMotor);
+                names.append(name + " Motor Losses (W)"); break;
+            case 2:
+                yAxes.append(res.tempRise);
+                names.append(name + " Temperature Rise (K)"); break;
+            case 3:
+                yAxes.append(res.current);
+                names.append(name + " Motor Current (A)"); break;
+            case 4:
+                yAxes.append(res.batteryCurrent);
+                names.append(name + " Battery Current (A)"); break;
+            case 5:
+                yAxes.append(res.torque);
+                names.append(name + " Wheel Torque (Nm)"); break;
+            default:
                 break;
             }
+        };
+
+        addResult(*mCycleResA, ui->compAEdit->text());
+        addResult(*mCycleResB, ui->compBEdit->text());
+
+        if (ui->cycleShowBox->currentIndex() == 5) {
+            yAxes.append(mCycleResA->torqueDemand);
+            names.append("Torque Demand (Nm)");
         }
 
-        ui->plot->xAxis->setLabel(getQmlXName());
+        ui->plot->xAxis->setLabel("Seconds (s)");
         updateGraphs(xAxis, yAxes, names);
     };
 
     if (ui->tabWidget->currentIndex() == 1) {
+        QVector<double> xAxis;
+        double min = getQmlXMin();
+        double max = getQmlXMax();
+        QString xName = getQmlXName();
+
+        for (double p = min; p < max; p += (max - min) / plotPoints) {
+            xAxis.append(p);
+        }
+
+        auto qmlParams = getQmlParams(xAxis);
+
+        ui->plot->clearGraphs();
+        plotQmlSweep(ui->m1PlotTable, mM1Config, getParamsUi(1), 1, xAxis, qmlParams, xName);
+        plotQmlSweep(ui->m2PlotTable, mM2Config, getParamsUi(2), 2, xAxis, qmlParams, xName);
+    } else if (ui->tabWidget->currentIndex() == cycleTabIndex) {
         ui->plot->clearGraphs();
-        plotQmlSweep(ui->m1PlotTable, mM1Config, getParamsUi(1), 1);
-        plotQmlSweep(ui->m2PlotTable, mM2Config, getParamsUi(2), 2);
+        if (runCycle()) {
+            plotCycle();
+        }
     } else {
         if (ui->testModeTorqueButton->isChecked()) {
             ui->plot->clearGraphs();
@@ -1249,6 +1413,7 @@ void PageMotorComparison::on_qmlRunButton_clicked()
     mQmlProgressOk = true;
     mQmlMotorParamsOk = true;
     mQmlReadNamesDone = false;
+    mQmlBatchOk = true;
 }
 
 void PageMotorComparison::on_qmlStopButton_clicked()
@@ -1277,17 +1442,144 @@ PageMotorComparison::QmlParams PageMotorComparison::getQmlParam(double progress)
                                         "progressToParams",
                                         Q_RETURN_ARG(QVariant, returnedValue), Q_ARG(QVariant, QVariant(progress)));
 
-    QmlParams res;
-
     if (ok) {
         ok = returnedValue.canConvert(QMetaType::QVariantList);
     }
 
     if (!ok) {
-        return res;
+        return QmlParams();
     }
 
-    auto list = returnedValue.toList();
+    if (!mQmlReadNamesDone) {
+        mQmlReadNamesDone = true;
+        qmlUpdateNames();
+    }
+
+    return qmlParamsFromList(returnedValue.toList());
+}
+
+/**
+ * @brief PageMotorComparison::getQmlParams
+ * Get the parameters for all points of a sweep from the script.
+ *
+ * If the script implements progressToParamsBatch it is called once with all
+ * progress values. It can either return one list per point in the same format
+ * as progressToParams, or an object with one array per column:
+ *
+ * {rpmM1: [...], torqueM1: [...], extraM1: [...], extraM1_2: [...], ...}
+ *
+ * Columns for motor 2 that are missing are taken from motor 1, like for
+ * progressToParams. Scripts that only implement progressToParams are called
+ * once per point.
+ *
+ * @param progress
+ * The progress values of the sweep.
+ *
+ * @return
+ * One set of parameters for each progress value.
+ */
+QVector<PageMotorComparison::QmlParams> PageMotorComparison::getQmlParams(const QVector<double> &progress)
+{
+    QVector<QmlParams> res;
+    QObject *comp = ui->qmlWidget->rootObject() ?
+                ui->qmlWidget->rootObject()->findChild<QObject*>("idComp") : nullptr;
+
+    if (mQmlBatchOk && comp &&
+            comp->metaObject()->indexOfMethod("progressToParamsBatch(QVariant)") >= 0) {
+        QVariantList progList;
+        progList.reserve(progress.size());
+        for (auto p: progress) {
+            progList.append(p);
+        }
+
+        QVariant returnedValue;
+        bool ok = QMetaObject::invokeMethod(comp, "progressToParamsBatch",
+                                            Q_RETURN_ARG(QVariant, returnedValue),
+                                            Q_ARG(QVariant, QVariant(progList)));
+
+        // JS objects and arrays arrive wrapped in a QJSValue
+        if (ok && returnedValue.userType() == qMetaTypeId<QJSValue>()) {
+            returnedValue = returnedValue.value<QJSValue>().toVariant();
+        }
+
+        if (ok && returnedValue.type() == QVariant::Map) {
+            auto map = returnedValue.toMap();
+
+            auto column = [&map, &progress](QString name, QString fallback) {
+                QVariantList list = map.value(name, map.value(fallback)).toList();
+                QVector<double> col(progress.size(), 0.0);
+                for (int i = 0;i < qMin(list.size(), col.size());i++) {
+                    col[i] = list.at(i).toDouble();
+                }
+                return col;
+            };
+
+            auto rpmM1 = column("rpmM1", "");
+            auto torqueM1 = column("torqueM1", "");
+            auto extraM1 = column("extraM1", "");
+            auto extraM1_2 = column("extraM1_2", "");
+            auto extraM1_3 = column("extraM1_3", "");
+            auto extraM1_4 = column("extraM1_4", "");
+            auto rpmM2 = column("rpmM2", "rpmM1");
+            auto torqueM2 = column("torqueM2", "torqueM1");
+            auto extraM2 = column("extraM2", "extraM1");
+            auto extraM2_2 = column("extraM2_2", "extraM1_2");
+            auto extraM2_3 = column("extraM2_3", "extraM1_3");
+            auto extraM2_4 = column("extraM2_4", "extraM1_4");
+
+            res.resize(progress.size());
+            for (int i = 0;i < res.size();i++) {
+                QmlParams &p = res[i];
+                p.rpmM1 = rpmM1.at(i);
+                p.torqueM1 = torqueM1.at(i);
+                p.extraM1 = extraM1.at(i);
+                p.extraM1_2 = extraM1_2.at(i);
+                p.extraM1_3 = extraM1_3.at(i);
+                p.extraM1_4 = extraM1_4.at(i);
+                p.rpmM2 = rpmM2.at(i);
+                p.torqueM2 = torqueM2.at(i);
+                p.extraM2 = extraM2.at(i);
+                p.extraM2_2 = extraM2_2.at(i);
+                p.extraM2_3 = extraM2_3.at(i);
+                p.extraM2_4 = extraM2_4.at(i);
+            }
+        } else if (ok && returnedValue.canConvert(QMetaType::QVariantList)) {
+            auto list = returnedValue.toList();
+            res.reserve(progress.size());
+            for (int i = 0;i < progress.size();i++) {
+                res.append(i < list.size() ? qmlParamsFromList(list.at(i).toList()) : QmlParams());
+            }
+        } else {
+            // Do not try again until the script is reloaded
+            mQmlBatchOk = false;
+        }
+
+        if (mQmlBatchOk) {
+            if (!mQmlReadNamesDone) {
+                mQmlReadNamesDone = true;
+                qmlUpdateNames();
+            }
+
+            return res;
+        }
+    }
+
+    res.reserve(progress.size());
+    for (auto p: progress) {
+        res.append(getQmlParam(p));
+    }
+
+    return res;
+}
+
+/**
+ * @brief PageMotorComparison::qmlParamsFromList
+ * Convert the list returned by progressToParams to parameters. Motor 2 uses
+ * the parameters of motor 1 if the list only has those.
+ */
+PageMotorComparison::QmlParams PageMotorComparison::qmlParamsFromList(const QVariantList &list)
+{
+    QmlParams res;
 
     if (list.size() >= 2) {
         res.rpmM1 = list.at(0).toDouble();
@@ -1326,11 +1618,6 @@ PageMotorComparison::QmlParams PageMotorComparison::getQmlParam(double progress)
         res.extraM2_4 = res.extraM1_4;
     }
 
-    if (!mQmlReadNamesDone) {
-        mQmlReadNamesDone = true;
-        qmlUpdateNames();
-    }
-
     return res;
 }
 
@@ -1479,3 +1766,290 @@ void PageMotorComparison::setQmlMotorParams()
                                                   Q_ARG(QVariant, QVariant::fromValue(MotorData(&mM1Config, getParamsUi(1)))),
                                                   Q_ARG(QVariant, QVariant::fromValue(MotorData(&mM2Config, getParamsUi(2)))));
 }
+
+/**
+ * @brief MotorData::updateBatch
+ * Evaluate the motor model at many operating points in parallel.
+ *
+ * @param base
+ * Configured MotorData that is copied for each point.
+ *
+ * @param points
+ * The operating points.
+ *
+ * @param mode
+ * Which update function to run for each point.
+ *
+ * @return
+ * One updated MotorData for each point, in the same order as points.
+ */
+QVector<MotorData> MotorData::updateBatch(const MotorData &base,
+                                          const QVector<MotorSweepPoint> &points,
+                                          MotorSweepMode mode)
+{
+    QVector<MotorData> res(points.size(), base);
+    MotorData *out = res.data();
+
+    // Each point only takes a few microseconds, so they are evaluated in
+    // chunks to keep the scheduling overhead low.
+    const int pointsPerTask = 64;
+    const int tasks = (points.size() + pointsPerTask - 1) / pointsPerTask;
+
+    Utility::runParallel(tasks, [&](int task) {
+        int end = qMin((task + 1) * pointsPerTask, points.size());
+        for (int i = task * pointsPerTask;i < end;i++) {
+            const MotorSweepPoint &p = points.at(i);
+            MotorData &md = out[i];
+
+            switch (mode) {
+            case MOTOR_SWEEP_RPM_TORQUE:
+                md.update(p.rpm, p.torque);
+                break;
+            case MOTOR_SWEEP_TORQUE_VBUS:
+                md.updateTorqueVBus(p.torque, p.vbus);
+                break;
+            case MOTOR_SWEEP_TORQUE_VBUS_FW:
+                md.updateTorqueVBusFW(p.torque, p.rpm, p.vbus);
+                break;
+            case MOTOR_SWEEP_RPM_VBUS_FW:
+                md.updateRpmVBusFW(p.torque, p.rpm, p.vbus);
+                break;
+            }
+        }
+    });
+
+    return res;
+}
+
+/**
+ * @brief PageMotorComparison::plotMap
+ * Generate the torque x RPM maps of both motors and show the selected one, or
+ * the difference between them, in the plot. The maps are cached, so this is
+ * cheap when only the shown quantity changes.
+ */
+void PageMotorComparison::plotMap()
+{
+    MotorMap::Grid grid;
+    grid.rpmPoints = ui->mapPointsBox->value();
+    grid.torquePoints = ui->mapPointsBox->value();
+    grid.rpmMax = ui->mapRpmBox->value();
+    grid.rpmMin = grid.rpmMax / double(grid.rpmPoints);
+    grid.torqueMax = ui->mapTorqueBox->value();
+    grid.torqueMin = grid.torqueMax / double(grid.torquePoints);
+    grid.vbus = ui->mapVbusBox->value();
+
+    MotorData md;
+    md.configure(&mM1Config, getParamsUi(1));
+    mMapA = MotorMap::generate(md, grid);
+    md.configure(&mM2Config, getParamsUi(2));
+    mMapB = MotorMap::generate(md, grid);
+
+    ui->mapTimeLabel->setText(QString("Generated in %1 s + %2 s").
+                              arg(mMapA->generationTime(), 0, 'f', 2).
+                              arg(mMapB->generationTime(), 0, 'f', 2));
+
+    auto q = MotorMap::Quantity(ui->mapQuantityBox->currentIndex());
+
+    ui->plot->clearGraphs();
+    ui->plot->legend->setVisible(false);
+    mVerticalLine->setVisible(false);
+
+    if (!mMapPlot) {
+        mMapPlot = Utility::plotAddColorMap(ui->plot);
+    }
+
+    QString name;
+    if (ui->mapShowBox->currentIndex() == 0) {
+        mMapA->render(mMapPlot, q);
+        name = ui->compAEdit->text();
+    } else if (ui->mapShowBox->currentIndex() == 1) {
+        mMapB->render(mMapPlot, q);
+        name = ui->compBEdit->text();
+    } else {
+        MotorMap::renderDifference(mMapPlot, *mMapA, *mMapB, q);
+        name = ui->compBEdit->text() + " - " + ui->compAEdit->text();
+    }
+
+    if (mMapPlot->colorScale()) {
+        mMapPlot->colorScale()->axis()->setLabel(QString("%1 %2 (%3)").
+                                                 arg(name).
+                                                 arg(MotorMap::quantityName(q)).
+                                                 arg(MotorMap::quantityUnit(q)));
+    }
+
+    ui->plot->xAxis->setLabel("RPM");
+    ui->plot->yAxis->setLabel("Torque (Nm)");
+
+    if (ui->autoscaleButton->isChecked()) {
+        ui->plot->xAxis->setRange(0.0, grid.rpmMax);
+        ui->plot->yAxis->setRange(0.0, grid.torqueMax);
+    }
+
+    ui->plot->replotWhenVisible();
+}
+
+/**
+ * @brief PageMotorComparison::updateMapPoint
+ * Show the values of both motors at a point of the map in the tables.
+ */
+void PageMotorComparison::updateMapPoint(double rpm, double torque)
+{
+    if (!reloadConfigs()) {
+        return;
+    }
+
+    double vbus = ui->mapVbusBox->value();
+
+    MotorData md;
+    md.configure(&mM1Config, getParamsUi(1));
+    MotorMap::evaluate(md, rpm, torque, vbus);
+    updateTable(md, ui->m1PlotTable);
+
+    md.configure(&mM2Config, getParamsUi(2));
+    MotorMap::evaluate(md, rpm, torque, vbus);
+    updateTable(md, ui->m2PlotTable);
+}
+
+/**
+ * @brief PageMotorComparison::runCycle
+ * Simulate both motors over the selected speed profile. The profile is only
+ * read again when the file name changes.
+ *
+ * @return
+ * True if both simulations ran.
+ */
+bool PageMotorComparison::runCycle()
+{
+    QString path = ui->cycleFileEdit->text();
+
+    if (path.isEmpty()) {
+        ui->cycleTimeLabel->setText("No speed profile selected");
+        return false;
+    }
+
+    if (mCycleProfile.isNull() || path != mCycleProfilePath) {
+        QSharedPointer<DriveCycle::Profile> profile(new DriveCycle::Profile);
+        QString error;
+
+        if (!DriveCycle::loadProfile(path, *profile, &error)) {
+            mCycleProfile.clear();
+            mCycleProfilePath.clear();
+            ui->cycleTimeLabel->setText("Could not load the speed profile: " + error);
+            mVesc->emitStatusMessage("Could not load the speed profile", false);
+            return false;
+        }
+
+        mCycleProfile = profile;
+        mCycleProfilePath = path;
+    }
+
+    DriveCycle::Vehicle vehicle;
+    vehicle.mass = ui->cycleMassBox->value();
+    vehicle.vbus = ui->cycleVbusBox->value();
+    vehicle.dragArea = ui->cycleDragBox->value();
+    vehicle.rollingResistance = ui->cycleRollBox->value();
+    vehicle.thermalResistance = ui->cycleRthBox->value();
+    vehicle.thermalTimeConstant = ui->cycleTauBox->value();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    MotorData md;
+    md.configure(&mM1Config, getParamsUi(1));
+    QSharedPointer<DriveCycle::Result> resA(
+                new DriveCycle::Result(DriveCycle::simulate(md, vehicle, *mCycleProfile)));
+    md.configure(&mM2Config, getParamsUi(2));
+    QSharedPointer<DriveCycle::Result> resB(
+                new DriveCycle::Result(DriveCycle::simulate(md, vehicle, *mCycleProfile)));
+
+    if (!resA->valid || !resB->valid) {
+        mCycleResA.clear();
+        mCycleResB.clear();
+        updateCycleTable();
+        mVesc->emitMessageDialog("Drive Cycle",
+                                 "Simulation failed: " + (resA->valid ? resB->error : resA->error),
+                                 false);
+        return false;
+    }
+
+    mCycleResA = resA;
+    mCycleResB = resB;
+
+    ui->cycleTimeLabel->setText(QString("%1 steps simulated in %2 ms").
+                                arg(mCycleProfile->size()).
+                                arg(timer.elapsed()));
+    updateCycleTable();
+
+    return true;
+}
+
+/**
+ * @brief PageMotorComparison::updateCyclePoint
+ * Show the state of both motors at a time of the drive cycle in the tables.
+ */
+void PageMotorComparison::updateCyclePoint(double time)
+{
+    if (mCycleProfile.isNull() || mCycleResA.isNull() || mCycleResB.isNull()) {
+        return;
+    }
+
+    const QVector<double> &t = mCycleProfile->time;
+    int i = int(std::lower_bound(t.constBegin(), t.constEnd(), time) - t.constBegin());
+    i = qBound(0, i, t.size() - 1);
+
+    double vbus = ui->cycleVbusBox->value();
+
+    auto update = [this, i, vbus](ConfigParams *config, int motor,
+            const DriveCycle::Result &res, QTableWidget *table) {
+        MotorDataParams param = getParamsUi(motor);
+        param.tempInc += res.tempRise.at(i);
+
+        MotorData md;
+        md.configure(config, param);
+        MotorMap::evaluate(md, res.rpm.at(i), res.torque.at(i), vbus);
+        updateTable(md, table);
+    };
+
+    update(&mM1Config, 1, *mCycleResA, ui->m1PlotTable);
+    update(&mM2Config, 2, *mCycleResB, ui->m2PlotTable);
+}
+
+/**
+ * @brief PageMotorComparison::updateCycleTable
+ * Fill the drive cycle result table with the totals of both motors.
+ */
+void PageMotorComparison::updateCycleTable()
+{
+    QTableWidget *table = ui->cycleResultTable;
+    table->setRowCount(0);
+
+    if (mCycleResA.isNull() || mCycleResB.isNull()) {
+        return;
+    }
+
+    table->horizontalHeaderItem(1)->setText(ui->compAEdit->text());
+    table->horizontalHeaderItem(2)->setText(ui->compBEdit->text());
+
+    auto addRow = [table](QString name, double a, double b, int decimals, QString unit) {
+        int row = table->rowCount();
+        table->insertRow(row);
+        table->setItem(row, 0, new QTableWidgetItem(name));
+        table->setItem(row, 1, new QTableWidgetItem(QString::number(a, 'f', decimals) + unit));
+        table->setItem(row, 2, new QTableWidgetItem(QString::number(b, 'f', decimals) + unit));
+    };
+
+    const DriveCycle::Result &a = *mCycleResA;
+    const DriveCycle::Result &b = *mCycleResB;
+
+    addRow("Distance", a.distance / 1000.0, b.distance / 1000.0, 2, " km");
+    addRow("Duration", a.duration, b.duration, 0, " s");
+    addRow("Energy In", a.energyIn, b.energyIn, 1, " Wh");
+    addRow("Energy Regen", a.energyRegen, b.energyRegen, 1, " Wh");
+    addRow("Losses", a.energyLoss, b.energyLoss, 1, " Wh");
+    addRow("Consumption", a.whKm, b.whKm, 1, " Wh/km");
+    addRow("Max Temp Rise", a.tempRiseMax, b.tempRiseMax, 1, " K");
+    addRow("Max Motor Current", a.currentMax, b.currentMax, 1, " A");
+    addRow("Max Battery Current", a.batteryCurrentMax, b.batteryCurrentMax, 1, " A");
+    addRow("Current Limited", a.timeLimited, b.timeLimited, 1, " s");
+    addRow("Speed Unreachable", a.timeUnreachable, b.timeUnreachable, 1, " s");
+}
@@ -48,6 +48,90 @@ struct MotorDataParams {
     bool mtpa;
 };
 
+/*
+ * Motor parameters resolved from a configuration, so that the model can be
+ * evaluated without looking up the parameters by name each time. Plain data,
+ * so it can be shared between threads.
+ */
+struct MotorModel {
+    MotorModel() {
+        valid = false;
+        r = 0.0;
+        ld_lq_diff = 0.0;
+        lq = 0.0;
+        ld = 0.0;
+        lambda = 0.0;
+        i_nl = 0.0;
+        pole_pairs = 0.0;
+        wheel_diam = 0.0;
+        current_max = 0.0;
+        current_min = 0.0;
+        in_current_max = 0.0;
+        in_current_min = 0.0;
+    }
+
+    void load(ConfigParams *config) {
+        if (config == nullptr) {
+            *this = MotorModel();
+            return;
+        }
+
+        double l = config->getParamDouble("foc_motor_l");
+        r = config->getParamDouble("foc_motor_r");
+        ld_lq_diff = config->getParamDouble("foc_motor_ld_lq_diff");
+        lq = l + ld_lq_diff / 2.0;
+        ld = l - ld_lq_diff / 2.0;
+        lambda = config->getParamDouble("foc_motor_flux_linkage");
+        i_nl = config->getParamDouble("si_motor_nl_current");
+        pole_pairs = double(config->getParamInt("si_motor_poles")) / 2.0;
+        wheel_diam = config->getParamDouble("si_wheel_diameter");
+        current_max = config->getParamDouble("l_current_max");
+        current_min = config->getParamDouble("l_current_min");
+        in_current_max = config->getParamDouble("l_in_current_max");
+        in_current_min = config->getParamDouble("l_in_current_min");
+        valid = true;
+    }
+
+    bool valid;
+    double r;
+    double ld_lq_diff;
+    double lq;
+    double ld;
+    double lambda;
+    double i_nl;
+    double pole_pairs;
+    double wheel_diam;
+
+    // Limits, only used by the drive cycle simulation
+    double current_max;
+    double current_min;
+    double in_current_max;
+    double in_current_min;
+};
+
+/*
+ * Operating point for MotorData::updateBatch. Which of the values are used
+ * depends on the MotorSweepMode.
+ */
+struct MotorSweepPoint {
+    MotorSweepPoint(double rpm = 0.0, double torque = 0.0, double vbus = 0.0) {
+        this->rpm = rpm;
+        this->torque = torque;
+        this->vbus = vbus;
+    }
+
+    double rpm;
+    double torque;
+    double vbus;
+};
+
+typedef enum {
+    MOTOR_SWEEP_RPM_TORQUE = 0, // update(rpm, torque)
+    MOTOR_SWEEP_TORQUE_VBUS,    // updateTorqueVBus(torque, vbus)
+    MOTOR_SWEEP_TORQUE_VBUS_FW, // updateTorqueVBusFW(torque, rpm, vbus)
+    MOTOR_SWEEP_RPM_VBUS_FW     // updateRpmVBusFW(torque, rpm, vbus)
+} MotorSweepMode;
+
 struct MotorData {
     Q_GADGET
 
@@ -132,11 +216,18 @@ public:
         return !(*this == other);
     }
 
+    // The motor parameters are read from cfg here. Call configure again if
+    // cfg changes.
     void configure(ConfigParams *cfg, MotorDataParams prm) {
         config = cfg;
         params = prm;
+        model.load(cfg);
     }
 
+    static QVector<MotorData> updateBatch(const MotorData &base,
+                                          const QVector<MotorSweepPoint> &points,
+                                          MotorSweepMode mode);
+
     Q_INVOKABLE bool updateRpmVBusFW(double torque, double rpm, double vbus) {
         double fw_max = params.fwCurrent;
         params.fwCurrent = 0.0;
@@ -254,23 +345,22 @@ public:
     }
 
     Q_INVOKABLE bool update(double rpm, double torque) {
-        if (config == nullptr) {
+        if (!model.valid) {
             return false;
         }
 
         // See https://www.mathworks.com/help/physmod/sps/ref/pmsm.html
         // for the motor equations
 
-        double r = config->getParamDouble("foc_motor_r");
-        double l = config->getParamDouble("foc_motor_l");
-        double ld_lq_diff = config->getParamDouble("foc_motor_ld_lq_diff");
-        double lq = l + ld_lq_diff / 2.0;
-        double ld = l - ld_lq_diff / 2.0;
-        double lambda = config->getParamDouble("foc_motor_flux_linkage");
-        double i_nl = config->getParamDouble("si_motor_nl_current");
-        double pole_pairs = double(config->getParamInt("si_motor_poles")) / 2.0;
-        double wheel_diam = config->getParamDouble("si_wheel_diameter");
+        const double ld_lq_diff = model.ld_lq_diff;
+        const double lq = model.lq;
+        const double ld = model.ld;
+        const double lambda = model.lambda;
+        const double i_nl = model.i_nl;
+        const double pole_pairs = model.pole_pairs;
+        const double wheel_diam = model.wheel_diam;
 
+        double r = model.r;
         r += r * 0.00386 * (params.tempInc);
 
         torque_out = torque;
@@ -348,6 +438,7 @@ public:
 
     ConfigParams *config;
     MotorDataParams params;
+    MotorModel model;
 
     double torque_out;
     double torque_motor_shaft;
@@ -384,6 +475,13 @@ public:
 
 Q_DECLARE_METATYPE(MotorData)
 
+class MotorMap;
+
+namespace DriveCycle {
+struct Profile;
+struct Result;
+}
+
 namespace Ui {
 class PageMotorComparison;
 }
@@ -452,12 +550,19 @@ private:
     void updateDataAndPlot(double posx, double yMin, double yMax);
     MotorDataParams getParamsUi(int motor);
     QmlParams getQmlParam(double progress);
+    QVector<QmlParams> getQmlParams(const QVector<double> &progress);
+    static QmlParams qmlParamsFromList(const QVariantList &list);
     bool qmlUpdateNames();
     QString getQmlXName();
     double getQmlXMin();
     double getQmlXMax();
     void setQmlProgressSelected(double progress);
     void setQmlMotorParams();
+    void plotMap();
+    void updateMapPoint(double rpm, double torque);
+    bool runCycle();
+    void updateCyclePoint(double time);
+    void updateCycleTable();
 
     ConfigParams mM1Config;
     ConfigParams mM2Config;
@@ -477,6 +582,16 @@ private:
     bool mQmlProgressOk;
     bool mQmlMotorParamsOk;
     bool mQmlReadNamesDone;
+    bool mQmlBatchOk;
+
+    QSharedPointer<const MotorMap> mMapA;
+    QSharedPointer<const MotorMap> mMapB;
+    QPointer<QCPColorMap> mMapPlot;
+
+    QSharedPointer<DriveCycle::Profile> mCycleProfile;
+    QString mCycleProfilePath;
+    QSharedPointer<DriveCycle::Result> mCycleResA;
+    QSharedPointer<DriveCycle::Result> mCycleResB;
 };
 
 #endif // PAGEMOTORCOMPARISON_H
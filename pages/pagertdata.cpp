@@ -22,10 +22,19 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include "utility.h"
+#include "framescheduler.h"
 
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
 
+namespace {
+// Number of samples kept for the value plots and the position plot. Appending
+// and plotting is O(1) per sample, so this is only limited by memory and by the
+// range and autoscale calculations.
+const int valueHistoryLen = 5000;
+const int positionHistoryLen = 1500;
+}
+
 PageRtData::PageRtData(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::PageRtData)
@@ -56,10 +65,8 @@ PageRtData::PageRtData(QWidget *parent) :
     mycon.addPixmap(Utility::getIcon("icons/rt_off.png"), QIcon::Normal, QIcon::Off);
     ui->logRtButton->setIcon(mycon);
 
-    mTimer = new QTimer(this);
-    mTimer->start(20);
-
     mSecondCounter = 0.0;
+    mPositionCounter = 0.0;
     mLastUpdateTime = 0;
 
     mUpdateValPlot = false;
@@ -120,6 +127,57 @@ PageRtData::PageRtData(QWidget *parent) :
     ui->focPlot->graph(graphIndex)->setName("Q Voltage");
     graphIndex++;
 
+    // Temperature
+    mTempMosGraph = ui->tempPlot->addGraph();
+    mTempMosGraph->setPen(QPen(Utility::getAppQColor("plot_graph1")));
+    mTempMosGraph->setName("Temperature MOSFET");
+
+    mTempMos1Graph = ui->tempPlot->addGraph();
+    mTempMos1Graph->setPen(QPen(Utility::getAppQColor("plot_graph2")));
+    mTempMos1Graph->setName("Temperature MOSFET 1");
+
+    mTempMos2Graph = ui->tempPlot->addGraph();
+    mTempMos2Graph->setPen(QPen(Utility::getAppQColor("plot_graph3")));
+    mTempMos2Graph->setName("Temperature MOSFET 2");
+
+    mTempMos3Graph = ui->tempPlot->addGraph();
+    mTempMos3Graph->setPen(QPen(Utility::getAppQColor("plot_graph4")));
+    mTempMos3Graph->setName("Temperature MOSFET 3");
+
+    mTempMotorGraph = ui->tempPlot->addGraph(ui->tempPlot->xAxis, ui->tempPlot->yAxis2);
+    mTempMotorGraph->setPen(QPen(Utility::getAppQColor("plot_graph5")));
+    mTempMotorGraph->setName("Temperature Motor");
+
+    // The individual MOSFET temperatures are only shown when the hardware reports them
+    mTempMosMultiShown = false;
+    mTempMos1Graph->removeFromLegend();
+    mTempMos2Graph->removeFromLegend();
+    mTempMos3Graph->removeFromLegend();
+    updateTempGraphVisibility();
+
+    RtPlotSeries *valueSeries[] = {
+        &mTempMosVec, &mTempMos1Vec, &mTempMos2Vec, &mTempMos3Vec, &mTempMotorVec,
+        &mCurrInVec, &mCurrMotorVec, &mIdVec, &mIqVec, &mDutyVec, &mRpmVec,
+        &mVdVec, &mVqVec};
+    for (auto series: valueSeries) {
+        series->setCapacity(valueHistoryLen);
+    }
+    mPositionVec.setCapacity(positionHistoryLen);
+
+    mCurrInVec.attach(ui->currentPlot->graph(0));
+    mCurrMotorVec.attach(ui->currentPlot->graph(1));
+    mDutyVec.attach(ui->currentPlot->graph(2));
+    mRpmVec.attach(ui->rpmPlot->graph(0));
+    mIdVec.attach(ui->focPlot->graph(0));
+    mIqVec.attach(ui->focPlot->graph(1));
+    mVdVec.attach(ui->focPlot->graph(2));
+    mVqVec.attach(ui->focPlot->graph(3));
+    mTempMosVec.attach(mTempMosGraph);
+    mTempMos1Vec.attach(mTempMos1Graph);
+    mTempMos2Vec.attach(mTempMos2Graph);
+    mTempMos3Vec.attach(mTempMos3Graph);
+    mTempMotorVec.attach(mTempMotorGraph);
+
     QFont legendFont = font();
     legendFont.setPointSize(9);
 
@@ -164,6 +222,7 @@ PageRtData::PageRtData(QWidget *parent) :
     ui->posPlot->addGraph();
     ui->posPlot->graph(0)->setPen(QPen(Utility::getAppQColor("plot_graph1")));
     ui->posPlot->graph(0)->setName("Position");
+    mPositionVec.attach(ui->posPlot->graph(0));
 
     ui->posPlot->legend->setVisible(true);
     ui->posPlot->legend->setFont(legendFont);
@@ -171,8 +230,8 @@ PageRtData::PageRtData(QWidget *parent) :
     ui->posPlot->xAxis->setLabel("Sample");
     ui->posPlot->yAxis->setLabel("Degrees");
 
-    connect(mTimer, SIGNAL(timeout()),
-            this, SLOT(timerSlot()));
+    FrameScheduler::instance()->addClient(this, [this]() { timerSlot(); });
+    FrameScheduler::instance()->addStreamConsumer(this, FrameScheduler::StreamRtData);
 }
 
 PageRtData::~PageRtData()
@@ -206,76 +265,34 @@ void PageRtData::timerSlot()
     }
 
     if (mUpdateValPlot) {
-        int dataSize = mTempMosVec.size();
-
-        QVector<double> xAxis(dataSize);
-        for (int i = 0;i < mSeconds.size();i++) {
-            xAxis[i] = mSeconds[i];
-        }
-
-        // Current and duty-plot
-        int graphIndex = 0;
-        ui->currentPlot->graph(graphIndex++)->setData(xAxis, mCurrInVec);
-        ui->currentPlot->graph(graphIndex++)->setData(xAxis, mCurrMotorVec);
-        ui->currentPlot->graph(graphIndex++)->setData(xAxis, mDutyVec);
-
-        // Temperature plot
-        ui->tempPlot->clearGraphs();
-
-        graphIndex = 0;
-
-        ui->tempPlot->addGraph();
-        ui->tempPlot->graph(graphIndex)->setPen(QPen(Utility::getAppQColor("plot_graph1")));
-        ui->tempPlot->graph(graphIndex)->setName("Temperature MOSFET");
-        ui->tempPlot->graph(graphIndex)->setData(xAxis, mTempMosVec);
-        ui->tempPlot->graph(graphIndex)->setVisible(ui->tempShowMosfetBox->isChecked());
-
-        graphIndex++;
-
-        if (!mTempMos1Vec.isEmpty() && mTempMos1Vec.last() != 0.0) {
-            ui->tempPlot->addGraph();
-            ui->tempPlot->graph(graphIndex)->setPen(QPen(Utility::getAppQColor("plot_graph2")));
-            ui->tempPlot->graph(graphIndex)->setName("Temperature MOSFET 1");
-            ui->tempPlot->graph(graphIndex)->setData(xAxis, mTempMos1Vec);
-            ui->tempPlot->graph(graphIndex)->setVisible(ui->tempShowMosfetBox->isChecked());
-            graphIndex++;
-
-            ui->tempPlot->addGraph();
-            ui->tempPlot->graph(graphIndex)->setPen(QPen(Utility::getAppQColor("plot_graph3")));
-            ui->tempPlot->graph(graphIndex)->setName("Temperature MOSFET 2");
-            ui->tempPlot->graph(graphIndex)->setData(xAxis, mTempMos2Vec);
-            ui->tempPlot->graph(graphIndex)->setVisible(ui->tempShowMosfetBox->isChecked());
-            graphIndex++;
-
-            ui->tempPlot->addGraph();
-            ui->tempPlot->graph(graphIndex)->setPen(QPen(Utility::getAppQColor("plot_graph4")));
-            ui->tempPlot->graph(graphIndex)->setName("Temperature MOSFET 3");
-            ui->tempPlot->graph(graphIndex)->setData(xAxis, mTempMos3Vec);
-            ui->tempPlot->graph(graphIndex)->setVisible(ui->tempShowMosfetBox->isChecked());
-            graphIndex++;
+        // Only the samples received since the last tick are added to the graphs
+        RtPlotSeries *valueSeries[] = {
+            &mCurrInVec, &mCurrMotorVec, &mDutyVec, &mRpmVec,
+            &mIdVec, &mIqVec, &mVdVec, &mVqVec,
+            &mTempMosVec, &mTempMos1Vec, &mTempMos2Vec, &mTempMos3Vec, &mTempMotorVec};
+        for (auto series: valueSeries) {
+            series->flush();
         }
 
-        ui->tempPlot->addGraph(ui->tempPlot->xAxis, ui->tempPlot->yAxis2);
-        ui->tempPlot->graph(graphIndex)->setPen(QPen(Utility::getAppQColor("plot_graph5")));
-        ui->tempPlot->graph(graphIndex)->setName("Temperature Motor");
-        ui->tempPlot->graph(graphIndex)->setData(xAxis, mTempMotorVec);
-        ui->tempPlot->graph(graphIndex)->setVisible(ui->tempShowMotorBox->isChecked());
-        graphIndex++;
+        bool mosMulti = !mTempMos1Vec.isEmpty() && mTempMos1Vec.lastValue() != 0.0;
+        if (mosMulti != mTempMosMultiShown) {
+            mTempMosMultiShown = mosMulti;
 
-        // RPM plot
-        graphIndex = 0;
-        ui->rpmPlot->graph(graphIndex++)->setData(xAxis, mRpmVec);
+            QCPGraph *mosGraphs[] = {mTempMos1Graph, mTempMos2Graph, mTempMos3Graph};
+            for (auto g: mosGraphs) {
+                if (mosMulti) {
+                    g->addToLegend();
+                } else {
+                    g->removeFromLegend();
+                }
+            }
 
-        // FOC plot
-        graphIndex = 0;
-        ui->focPlot->graph(graphIndex++)->setData(xAxis, mIdVec);
-        ui->focPlot->graph(graphIndex++)->setData(xAxis, mIqVec);
-        ui->focPlot->graph(graphIndex++)->setData(xAxis, mVdVec);
-        ui->focPlot->graph(graphIndex++)->setData(xAxis, mVqVec);
+            updateTempGraphVisibility();
+        }
 
         if (ui->autoscaleButton->isChecked()) {
             ui->currentPlot->rescaleAxes();
-            ui->tempPlot->rescaleAxes();
+            ui->tempPlot->rescaleAxes(true);
             ui->rpmPlot->rescaleAxes();
             ui->focPlot->rescaleAxes();
         }
@@ -289,13 +306,8 @@ void PageRtData::timerSlot()
     }
 
     if (mUpdatePosPlot) {
-        QVector<double> xAxis(mPositionVec.size());
-        for (int i = 0;i < mPositionVec.size();i++) {
-            xAxis[i] = double(i);
-        }
-
-        ui->posBar->setValue(int(fabs(mPositionVec.last())));
-        ui->posPlot->graph(0)->setData(xAxis, mPositionVec);
+        ui->posBar->setValue(int(fabs(mPositionVec.lastValue())));
+        mPositionVec.flush();
 
         if (ui->autoscaleButton->isChecked()) {
             ui->posPlot->rescaleAxes();
@@ -312,22 +324,6 @@ void PageRtData::valuesReceived(MC_VALUES values, unsigned int mask)
     (void)mask;
     ui->rtText->setValues(values);
 
-    const int maxS = 500;
-
-    appendDoubleAndTrunc(&mTempMosVec, values.temp_mos, maxS);
-    appendDoubleAndTrunc(&mTempMos1Vec, values.temp_mos_1, maxS);
-    appendDoubleAndTrunc(&mTempMos2Vec, values.temp_mos_2, maxS);
-    appendDoubleAndTrunc(&mTempMos3Vec, values.temp_mos_3, maxS);
-    appendDoubleAndTrunc(&mTempMotorVec, values.temp_motor, maxS);
-    appendDoubleAndTrunc(&mCurrInVec, values.current_in, maxS);
-    appendDoubleAndTrunc(&mCurrMotorVec, values.current_motor, maxS);
-    appendDoubleAndTrunc(&mIdVec, values.id, maxS);
-    appendDoubleAndTrunc(&mIqVec, values.iq, maxS);
-    appendDoubleAndTrunc(&mDutyVec, values.duty_now, maxS);
-    appendDoubleAndTrunc(&mRpmVec, values.rpm, maxS);
-    appendDoubleAndTrunc(&mVdVec, values.vd, maxS);
-    appendDoubleAndTrunc(&mVqVec, values.vq, maxS);
-
     qint64 tNow = QDateTime::currentMSecsSinceEpoch();
 
     double elapsed = double((tNow - mLastUpdateTime)) / 1000.0;
@@ -336,29 +332,34 @@ void PageRtData::valuesReceived(MC_VALUES values, unsigned int mask)
     }
 
     mSecondCounter += elapsed;
-
-    appendDoubleAndTrunc(&mSeconds, mSecondCounter, maxS);
-
     mLastUpdateTime = tNow;
 
+    const double t = mSecondCounter;
+
+    mTempMosVec.append(t, values.temp_mos);
+    mTempMos1Vec.append(t, values.temp_mos_1);
+    mTempMos2Vec.append(t, values.temp_mos_2);
+    mTempMos3Vec.append(t, values.temp_mos_3);
+    mTempMotorVec.append(t, values.temp_motor);
+    mCurrInVec.append(t, values.current_in);
+    mCurrMotorVec.append(t, values.current_motor);
+    mIdVec.append(t, values.id);
+    mIqVec.append(t, values.iq);
+    mDutyVec.append(t, values.duty_now);
+    mRpmVec.append(t, values.rpm);
+    mVdVec.append(t, values.vd);
+    mVqVec.append(t, values.vq);
+
     mUpdateValPlot = true;
 }
 
 void PageRtData::rotorPosReceived(double pos)
 {
-    appendDoubleAndTrunc(&mPositionVec, pos, 1500);
+    mPositionVec.append(mPositionCounter, pos);
+    mPositionCounter += 1.0;
     mUpdatePosPlot = true;
 }
 
-void PageRtData::appendDoubleAndTrunc(QVector<double> *vec, double num, int maxSize)
-{
-    vec->append(num);
-
-    if(vec->size() > maxSize) {
-        vec->remove(0, vec->size() - maxSize);
-    }
-}
-
 void PageRtData::updateZoom()
 {
     Qt::Orientations plotOrientations = Qt::Orientations(
@@ -372,6 +373,16 @@ void PageRtData::updateZoom()
     ui->posPlot->axisRect()->setRangeZoom(plotOrientations);
 }
 
+void PageRtData::updateTempGraphVisibility()
+{
+    bool showMos = ui->tempShowMosfetBox->isChecked();
+    mTempMosGraph->setVisible(showMos);
+    mTempMos1Graph->setVisible(showMos && mTempMosMultiShown);
+    mTempMos2Graph->setVisible(showMos && mTempMosMultiShown);
+    mTempMos3Graph->setVisible(showMos && mTempMosMultiShown);
+    mTempMotorGraph->setVisible(ui->tempShowMotorBox->isChecked());
+}
+
 void PageRtData::on_zoomHButton_toggled(bool checked)
 {
     (void)checked;
@@ -450,16 +461,16 @@ void PageRtData::on_posStopButton_clicked()
 
 void PageRtData::on_tempShowMosfetBox_toggled(bool checked)
 {
-    if (ui->tempPlot->graphCount() > 0) {
-        ui->tempPlot->graph(0)->setVisible(checked);
-    }
+    (void)checked;
+    updateTempGraphVisibility();
+    ui->tempPlot->replotWhenVisible();
 }
 
 void PageRtData::on_tempShowMotorBox_toggled(bool checked)
 {
-    if (ui->tempPlot->graphCount() > 1) {
-        ui->tempPlot->graph(1)->setVisible(checked);
-    }
+    (void)checked;
+    updateTempGraphVisibility();
+    ui->tempPlot->replotWhenVisible();
 }
 
 void PageRtData::on_logRtButton_toggled(bool checked)
@@ -24,6 +24,7 @@
 #include <QVector>
 #include <QTimer>
 #include "vescinterface.h"
+#include "widgets/rtplotseries.h"
 
 namespace Ui {
 class PageRtData;
@@ -63,32 +64,38 @@ private slots:
 private:
     Ui::PageRtData *ui;
     VescInterface *mVesc;
-    QTimer *mTimer;
-
-    QVector<double> mTempMosVec;
-    QVector<double> mTempMos1Vec;
-    QVector<double> mTempMos2Vec;
-    QVector<double> mTempMos3Vec;
-    QVector<double> mTempMotorVec;
-    QVector<double> mCurrInVec;
-    QVector<double> mCurrMotorVec;
-    QVector<double> mIdVec;
-    QVector<double> mIqVec;
-    QVector<double> mDutyVec;
-    QVector<double> mRpmVec;
-    QVector<double> mPositionVec;
-    QVector<double> mSeconds;
-    QVector<double> mVdVec;
-    QVector<double> mVqVec;
+
+    RtPlotSeries mTempMosVec;
+    RtPlotSeries mTempMos1Vec;
+    RtPlotSeries mTempMos2Vec;
+    RtPlotSeries mTempMos3Vec;
+    RtPlotSeries mTempMotorVec;
+    RtPlotSeries mCurrInVec;
+    RtPlotSeries mCurrMotorVec;
+    RtPlotSeries mIdVec;
+    RtPlotSeries mIqVec;
+    RtPlotSeries mDutyVec;
+    RtPlotSeries mRpmVec;
+    RtPlotSeries mPositionVec;
+    RtPlotSeries mVdVec;
+    RtPlotSeries mVqVec;
+
+    QCPGraph *mTempMosGraph;
+    QCPGraph *mTempMos1Graph;
+    QCPGraph *mTempMos2Graph;
+    QCPGraph *mTempMos3Graph;
+    QCPGraph *mTempMotorGraph;
+    bool mTempMosMultiShown;
 
     double mSecondCounter;
+    double mPositionCounter;
     qint64 mLastUpdateTime;
 
     bool mUpdateValPlot;
     bool mUpdatePosPlot;
 
-    void appendDoubleAndTrunc(QVector<double> *vec, double num, int maxSize);
     void updateZoom();
+    void updateTempGraphVisibility();
 
 };
 
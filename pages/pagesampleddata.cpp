@@ -21,6 +21,7 @@
 #include "ui_pagesampleddata.h"
 #include "digitalfiltering.h"
 #include "utility.h"
+#include "framescheduler.h"
 #include <QFileDialog>
 #include <QMessageBox>
 
@@ -68,8 +69,6 @@ PageSampledData::PageSampledData(QWidget *parent) :
     tmpSampleRetryCnt = 0;
 
     mSampleGetTimer = new QTimer(this);
-    mTimer = new QTimer(this);
-    mTimer->start(20);
 
     QCustomPlot *plots[4] = {ui->currentPlot, ui->voltagePlot,ui->filterPlot, ui->filterResponsePlot};
     for(int i = 0; i<4; i++)
@@ -78,7 +77,7 @@ PageSampledData::PageSampledData(QWidget *parent) :
         plots[i]->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
     }
 
-    connect(mTimer, SIGNAL(timeout()), this, SLOT(timerSlot()));
+    FrameScheduler::instance()->addClient(this, [this]() { timerSlot(); });
     connect(mSampleGetTimer, SIGNAL(timeout()), this, SLOT(sampleGetTimerSlot()));
 
     connect(ui->compDelayBox, SIGNAL(toggled(bool)), this, SLOT(replotAll()));
@@ -101,6 +100,10 @@ PageSampledData::PageSampledData(QWidget *parent) :
     connect(ui->showPhaseBox, SIGNAL(toggled(bool)), this, SLOT(replotAll()));
     connect(ui->showPhaseVoltageBox, SIGNAL(toggled(bool)), this, SLOT(replotAll()));
     connect(ui->truncateBox, SIGNAL(toggled(bool)), this, SLOT(replotAll()));
+    connect(ui->stftWindowBox, SIGNAL(currentIndexChanged(int)), this, SLOT(replotAll()));
+    connect(ui->stftOverlapBox, SIGNAL(valueChanged(int)), this, SLOT(replotAll()));
+    connect(ui->stftWindowTypeBox, SIGNAL(currentIndexChanged(int)), this, SLOT(replotAll()));
+    connect(ui->stftLogBox, SIGNAL(toggled(bool)), this, SLOT(replotAll()));
 
     replotAll();
 }
@@ -261,9 +264,46 @@ void PageSampledData::timerSlot()
 
             // Filter currents
             if (ui->filterBox->currentIndex() > 0) {
-                curr1 = DigitalFiltering::filterSignal(curr1, filter, ui->compDelayBox->isChecked());
-                curr2 = DigitalFiltering::filterSignal(curr2, filter, ui->compDelayBox->isChecked());
-                curr3 = DigitalFiltering::filterSignal(curr3, filter, ui->compDelayBox->isChecked());
+                QVector<QVector<double> > sig;
+                sig << curr1 << curr2 << curr3;
+                sig = DigitalFiltering::filterSignalBatch(sig, filter, ui->compDelayBox->isChecked());
+
+                curr1 = sig.at(0);
+                curr2 = sig.at(1);
+                curr3 = sig.at(2);
+            }
+
+            if (ui->plotModeBox->currentIndex() == 3) {
+                // Spectrogram of the first selected current and voltage
+                QVector<double> specCurr = totCurrentMc;
+                if (ui->showCurrent1Box->isChecked()) {
+                    specCurr = curr1;
+                } else if (ui->showCurrent2Box->isChecked()) {
+                    specCurr = curr2;
+                } else if (ui->showCurrent3Box->isChecked()) {
+                    specCurr = curr3;
+                }
+
+                QVector<double> specVolt = vZero;
+                if (ui->showPh1Box->isChecked()) {
+                    specVolt = ph1;
+                } else if (ui->showPh2Box->isChecked()) {
+                    specVolt = ph2;
+                } else if (ui->showPh3Box->isChecked()) {
+                    specVolt = ph3;
+                }
+
+                updateSpectrograms(specCurr, specVolt, f_samp);
+
+                mDoReplot = false;
+                mDoRescale = false;
+                return;
+            }
+
+            if (mCurrentSpecMap || mVoltageSpecMap) {
+                Spectrogram::removeFromPlot(ui->currentPlot);
+                Spectrogram::removeFromPlot(ui->voltagePlot);
+                mDoRescale = true;
             }
 
             bool showFft = ui->plotModeBox->currentIndex() == 1;
@@ -281,10 +321,14 @@ void PageSampledData::timerSlot()
             if (showFft) {
                 int fftBits = 16;
 
-                curr1 = DigitalFiltering::fftWithShift(curr1, fftBits, true);
-                curr2 = DigitalFiltering::fftWithShift(curr2, fftBits, true);
-                curr3 = DigitalFiltering::fftWithShift(curr3, fftBits, true);
-                totCurrentMc = DigitalFiltering::fftWithShift(totCurrentMc, fftBits, true);
+                QVector<QVector<double> > sig;
+                sig << curr1 << curr2 << curr3 << totCurrentMc;
+                sig = DigitalFiltering::fftWithShiftBatch(sig, fftBits, true);
+
+                curr1 = sig.at(0);
+                curr2 = sig.at(1);
+                curr3 = sig.at(2);
+                totCurrentMc = sig.at(3);
 
                 curr1.resize(curr1.size() / 2);
                 curr2.resize(curr2.size() / 2);
@@ -495,6 +539,49 @@ void PageSampledData::timerSlot()
     }
 }
 
+void PageSampledData::updateSpectrograms(const QVector<double> &current,
+                                         const QVector<double> &voltage, double f_samp)
+{
+    auto params = Spectrogram::paramsFromOverlap(
+                ui->stftWindowBox->currentIndex() + 6,
+                ui->stftOverlapBox->value(),
+                DigitalFiltering::WindowType(ui->stftWindowTypeBox->currentIndex()));
+
+    bool rescale = mDoRescale;
+
+    ui->currentPlot->clearGraphs();
+    ui->voltagePlot->clearGraphs();
+    ui->currentPlot->yAxis2->setVisible(false);
+    ui->voltagePlot->yAxis2->setVisible(false);
+
+    if (!mCurrentSpecMap) {
+        mCurrentSpecMap = Spectrogram::setupPlot(ui->currentPlot);
+        rescale = true;
+    }
+
+    if (!mVoltageSpecMap) {
+        mVoltageSpecMap = Spectrogram::setupPlot(ui->voltagePlot);
+        rescale = true;
+    }
+
+    // The transforms are only recalculated when the signal or parameters change
+    mCurrentSpec.setSignal(current, f_samp);
+    mVoltageSpec.setSignal(voltage, f_samp);
+    bool log = ui->stftLogBox->isChecked();
+    mCurrentSpec.render(mCurrentSpecMap, params, log);
+    mVoltageSpec.render(mVoltageSpecMap, params, log);
+    mCurrentSpecMap->colorScale()->axis()->setLabel(log ? "Current (dBA)" : "Current (A)");
+    mVoltageSpecMap->colorScale()->axis()->setLabel(log ? "Voltage (dBV)" : "Voltage (V)");
+
+    if (rescale) {
+        ui->currentPlot->rescaleAxes();
+        ui->voltagePlot->rescaleAxes();
+    }
+
+    ui->currentPlot->replotWhenVisible();
+    ui->voltagePlot->replotWhenVisible();
+}
+
 void PageSampledData::sampleGetTimerSlot()
 {
     tmpSampleRetryCnt++;
@@ -24,6 +24,7 @@
 #include <QVector>
 #include <QTimer>
 #include "vescinterface.h"
+#include "widgets/spectrogram.h"
 
 namespace Ui {
 class PageSampledData;
@@ -65,7 +66,6 @@ private slots:
 private:
     Ui::PageSampledData *ui;
     VescInterface *mVesc;
-    QTimer *mTimer;
     QTimer *mSampleGetTimer;
 
     QVector<double> curr1Vector;
@@ -100,8 +100,15 @@ private:
     bool mDoFilterReplot;
     int mSamplesToWait;
 
+    Spectrogram mCurrentSpec;
+    Spectrogram mVoltageSpec;
+    QPointer<QCPColorMap> mCurrentSpecMap;
+    QPointer<QCPColorMap> mVoltageSpecMap;
+
     void clearBuffers();
     void updateZoom();
+    void updateSpectrograms(const QVector<double> &current, const QVector<double> &voltage,
+                            double f_samp);
 
 };
 
@@ -20,6 +20,7 @@
 #include "pagescripting.h"
 #include "ui_pagescripting.h"
 #include "widgets/helpdialog.h"
+#include "framescheduler.h"
 
 #include <QQmlEngine>
 #include <QQmlContext>
@@ -197,6 +198,13 @@ void PageScripting::setVesc(VescInterface *vesc)
     ui->qmlWidget->engine()->rootContext()->setContextProperty("VescIf", mVesc);
     ui->qmlWidget->engine()->rootContext()->setContextProperty("QmlUi", this);
     ui->qmlWidget->engine()->rootContext()->setContextProperty("Utility", &mUtil);
+
+    // Scripts can use any of the telemetry streams
+    for (int i = 0;i < FrameScheduler::StreamNum;i++) {
+        FrameScheduler::instance()->addStreamConsumer(this, FrameScheduler::Stream(i), [this]() {
+            return FrameScheduler::isWidgetShown(this) || mQmlUi.isCustomGuiRunning();
+        });
+    }
 }
 
 void PageScripting::reloadParams()
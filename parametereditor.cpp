@@ -202,9 +202,7 @@ void ParameterEditor::on_paramOpenButton_clicked()
     if (p) {
         setEditorValues(selected, *p);
 
-        if (ui->previewTable->rowCount() > 0) {
-            ui->previewTable->removeRow(0);
-        }
+        ui->previewTable->clearParams();
 
         if (p->type != CFG_T_UNDEFINED) {
             ui->previewTable->addParamRow(&mParams, selected);
@@ -258,9 +256,7 @@ void ParameterEditor::on_paramSaveButton_clicked()
         showStatusInfo(tr("New parameter added: %1").arg(name), true);
     }
 
-    if (ui->previewTable->rowCount() > 0) {
-        ui->previewTable->removeRow(0);
-    }
+    ui->previewTable->clearParams();
 
     if (p.type != CFG_T_UNDEFINED) {
         ui->previewTable->addParamRow(&mParams, name);
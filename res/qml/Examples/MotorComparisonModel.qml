@@ -52,6 +52,27 @@ Item {
         return [rpmNow, torqueNow, 0, 0, 0, 0, rpmNow, torqueNow, 0, 0, 0, 0]
     }
     
+    // Optional faster version of progressToParams. If it exists it is called once
+    // with an array of all progress values in the plot instead of calling
+    // progressToParams for every point. It can return either one list per
+    // progress value in the same format as progressToParams, or an object with
+    // one array per column:
+    //
+    // {rpmM1: [...], torqueM1: [...], extraM1: [...], extraM1_2: [...], extraM1_3: [...], extraM1_4: [...],
+    //  rpmM2: [...], torqueM2: [...], extraM2: [...], extraM2_2: [...], extraM2_3: [...], extraM2_4: [...]}
+    //
+    // Missing columns are 0, and missing motor 2 columns are taken from motor 1.
+    function progressToParamsBatch(progress) {
+        var rpm = []
+        for (var i = 0; i < progress.length; i++) {
+            rpm.push(rpmNow)
+        }
+        if (progress.length > 0) {
+            torqueNow = progress[progress.length - 1]
+        }
+        return {rpmM1: rpm, torqueM1: progress}
+    }
+    
     // Name for the x-axis in the plot
     function xAxisName() {
         return xName
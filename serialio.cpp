@@ -0,0 +1,396 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "serialio.h"
+#include "packet.h"
+#include "datatypes.h"
+
+#include <QSerialPortInfo>
+
+namespace {
+const size_t txQueueSize = 1024;
+const size_t rxQueueSize = 4096;
+
+void updateMax(std::atomic<qint64> &max, qint64 value)
+{
+    qint64 now = max.load();
+    while (value > now && !max.compare_exchange_weak(now, value)) {
+    }
+}
+}
+
+SerialIoWorker::SerialIoWorker(SerialIo *io) : QObject(nullptr)
+{
+    mIo = io;
+    mPort = nullptr;
+    mPacket = nullptr;
+}
+
+bool SerialIoWorker::open(QString port, int baudrate)
+{
+    if (!mPort) {
+        mPort = new QSerialPort(this);
+        mPacket = new Packet(this);
+
+        connect(mPort, SIGNAL(readyRead()), this, SLOT(readyRead()));
+        connect(mPort, SIGNAL(error(QSerialPort::SerialPortError)),
+                this, SLOT(portError(QSerialPort::SerialPortError)));
+        connect(mPacket, &Packet::packetReceived, [this](QByteArray &packet) {
+            packetDecoded(packet);
+        });
+    }
+
+    if (mPort->isOpen()) {
+        close();
+    }
+
+    mPort->setPortName(port);
+    if (!mPort->open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    mPort->setBaudRate(baudrate);
+    mPort->setDataBits(QSerialPort::Data8);
+    mPort->setParity(QSerialPort::NoParity);
+    mPort->setStopBits(QSerialPort::OneStop);
+    mPort->setFlowControl(QSerialPort::NoFlowControl);
+
+    mPacket->resetState();
+    mIo->mOpen = true;
+    return true;
+}
+
+void SerialIoWorker::close()
+{
+    flushTx();
+
+    if (mPort && mPort->isOpen()) {
+        mPort->flush();
+        mPort->close();
+    }
+
+    mIo->mOpen = false;
+}
+
+void SerialIoWorker::flushTx()
+{
+    // Cleared before popping, so that a packet pushed after the last pop
+    // always posts a new flush.
+    mIo->mTxPosted = false;
+
+    SerialIo::TxItem item;
+    bool written = false;
+
+    while (mIo->mTxQueue.pop(item)) {
+        if (mPort && mPort->isOpen()) {
+            mPort->write(item.data);
+            written = true;
+
+            qint64 latency = mIo->mClock.nsecsElapsed() - item.timeNs;
+            mIo->mTxPackets++;
+            mIo->mTxLatencySumNs += latency;
+            updateMax(mIo->mTxLatencyMaxNs, latency);
+        }
+    }
+
+    if (written) {
+        mPort->flush();
+    }
+}
+
+void SerialIoWorker::readyRead()
+{
+    while (mPort->bytesAvailable() > 0) {
+        mPacket->processData(mPort->readAll());
+    }
+}
+
+void SerialIoWorker::portError(QSerialPort::SerialPortError error)
+{
+    if (error == QSerialPort::NoError) {
+        return;
+    }
+
+    QString message = "Serial port error: " + mPort->errorString();
+
+    if (mPort->isOpen()) {
+        mPort->close();
+    }
+
+    mIo->mOpen = false;
+    QMetaObject::invokeMethod(mIo, "workerError", Qt::QueuedConnection, Q_ARG(QString, message));
+}
+
+void SerialIoWorker::packetDecoded(QByteArray &packet)
+{
+    SerialIo::RxItem item;
+    item.data = packet;
+    item.timeNs = mIo->mClock.nsecsElapsed();
+
+    int slot = mIo->mCoalesce ? SerialIo::telemetrySlot(packet) : -1;
+
+    if (slot >= 0) {
+        SerialIo::RxItem *old = mIo->mLatest[slot].exchange(new SerialIo::RxItem(item));
+        if (old) {
+            delete old;
+            mIo->mRxCoalesced++;
+        }
+    } else {
+        // Replies must not be lost, so wait for the receiving thread if it is
+        // far behind. Give up if the port is being closed.
+        while (!mIo->mRxQueue.push(item)) {
+            if (!mIo->mOpen) {
+                return;
+            }
+            QThread::msleep(1);
+        }
+    }
+
+    if (!mIo->mRxPosted.exchange(true)) {
+        QMetaObject::invokeMethod(mIo, "drainRx", Qt::QueuedConnection);
+    }
+}
+
+SerialIo::SerialIo(QObject *parent) : QObject(parent),
+    mTxQueue(txQueueSize), mRxQueue(rxQueueSize)
+{
+    for (int i = 0;i < telemetrySlots;i++) {
+        mLatest[i] = nullptr;
+    }
+
+    mOpen = false;
+    mCoalesce = true;
+    mTxPosted = false;
+    mRxPosted = false;
+    resetStats();
+    mClock.start();
+
+    mWorker = new SerialIoWorker(this);
+    mWorker->moveToThread(&mThread);
+    connect(&mThread, SIGNAL(finished()), mWorker, SLOT(deleteLater()));
+    mThread.setObjectName("SerialIo");
+    mThread.start(QThread::HighPriority);
+}
+
+SerialIo::~SerialIo()
+{
+    close();
+    mThread.quit();
+    mThread.wait();
+
+    for (int i = 0;i < telemetrySlots;i++) {
+        delete mLatest[i].exchange(nullptr);
+    }
+}
+
+/**
+ * @brief SerialIo::open
+ * Open a serial port in the I/O thread. Blocks until the port is open or
+ * has failed to open.
+ *
+ * @param port
+ * System path of the port.
+ *
+ * @param baudrate
+ * The baudrate.
+ *
+ * @return
+ * True on success.
+ */
+bool SerialIo::open(QString port, int baudrate)
+{
+    bool ok = false;
+    QMetaObject::invokeMethod(mWorker, "open", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(bool, ok),
+                              Q_ARG(QString, port), Q_ARG(int, baudrate));
+
+    if (ok) {
+        mPortName = QSerialPortInfo(port).portName();
+        resetStats();
+    }
+
+    return ok;
+}
+
+/**
+ * @brief SerialIo::close
+ * Send what is left in the queue and close the port. Packets that have been
+ * received but not emitted yet are dropped.
+ */
+void SerialIo::close()
+{
+    mOpen = false;
+    QMetaObject::invokeMethod(mWorker, "close", Qt::BlockingQueuedConnection);
+
+    RxItem item;
+    while (mRxQueue.pop(item)) {
+    }
+
+    for (int i = 0;i < telemetrySlots;i++) {
+        delete mLatest[i].exchange(nullptr);
+    }
+}
+
+bool SerialIo::isOpen() const
+{
+    return mOpen;
+}
+
+QString SerialIo::portName() const
+{
+    return mPortName;
+}
+
+/**
+ * @brief SerialIo::write
+ * Queue data for the port. Only call this from the thread SerialIo lives in.
+ */
+void SerialIo::write(const QByteArray &data)
+{
+    if (!mOpen) {
+        return;
+    }
+
+    TxItem item;
+    item.data = data;
+    item.timeNs = mClock.nsecsElapsed();
+
+    while (!mTxQueue.push(item)) {
+        if (!mOpen) {
+            return;
+        }
+        QThread::yieldCurrentThread();
+    }
+
+    if (!mTxPosted.exchange(true)) {
+        QMetaObject::invokeMethod(mWorker, "flushTx", Qt::QueuedConnection);
+    }
+}
+
+/**
+ * @brief SerialIo::setCoalesceTelemetry
+ * Keep only the latest telemetry sample when the receiving thread falls
+ * behind. This should be off when the replies are forwarded to someone else,
+ * as each request then needs its own reply.
+ */
+void SerialIo::setCoalesceTelemetry(bool coalesce)
+{
+    mCoalesce = coalesce;
+}
+
+SerialIo::Stats SerialIo::stats() const
+{
+    Stats s;
+    s.txPackets = mTxPackets;
+    s.txLatencyAvgUs = s.txPackets > 0 ? double(mTxLatencySumNs) / double(s.txPackets) / 1000.0 : 0.0;
+    s.txLatencyMaxUs = double(mTxLatencyMaxNs) / 1000.0;
+    s.rxPackets = mRxPackets;
+    s.rxCoalesced = mRxCoalesced;
+    s.rxDelayAvgUs = s.rxPackets > 0 ? double(mRxDelaySumNs) / double(s.rxPackets) / 1000.0 : 0.0;
+    s.rxDelayMaxUs = double(mRxDelayMaxNs) / 1000.0;
+    s.rxJitterUs = mRxJitterNs / 1000.0;
+    return s;
+}
+
+void SerialIo::resetStats()
+{
+    mTxPackets = 0;
+    mTxLatencySumNs = 0;
+    mTxLatencyMaxNs = 0;
+    mRxCoalesced = 0;
+    mRxPackets = 0;
+    mRxDelaySumNs = 0;
+    mRxDelayMaxNs = 0;
+    mRxDelayLastNs = 0;
+    mRxJitterNs = 0.0;
+}
+
+QString SerialIo::report() const
+{
+    Stats s = stats();
+    return QString("TX: %1 packets, queue latency avg %2 us, max %3 us\n"
+                   "RX: %4 packets, %5 coalesced, delivery delay avg %6 us, max %7 us, jitter %8 us\n").
+            arg(s.txPackets).arg(s.txLatencyAvgUs, 0, 'f', 1).arg(s.txLatencyMaxUs, 0, 'f', 1).
+            arg(s.rxPackets).arg(s.rxCoalesced).arg(s.rxDelayAvgUs, 0, 'f', 1).
+            arg(s.rxDelayMaxUs, 0, 'f', 1).arg(s.rxJitterUs, 0, 'f', 1);
+}
+
+void SerialIo::drainRx()
+{
+    mRxPosted = false;
+
+    RxItem item;
+    while (mRxQueue.pop(item)) {
+        deliver(item);
+    }
+
+    for (int i = 0;i < telemetrySlots;i++) {
+        RxItem *latest = mLatest[i].exchange(nullptr);
+        if (latest) {
+            deliver(*latest);
+            delete latest;
+        }
+    }
+}
+
+void SerialIo::workerError(QString message)
+{
+    emit errorOccurred(message);
+}
+
+/**
+ * @brief SerialIo::telemetrySlot
+ * Packets that are periodic samples where only the latest one is of interest.
+ * Requests that take a mask, such as the selective values and the IMU data,
+ * are not included as different users can ask for different fields.
+ *
+ * @return
+ * The mailbox of the packet, or -1 if it has to be delivered in order.
+ */
+int SerialIo::telemetrySlot(const QByteArray &packet)
+{
+    if (packet.isEmpty()) {
+        return -1;
+    }
+
+    switch (quint8(packet.at(0))) {
+    case COMM_GET_VALUES: return 0;
+    case COMM_GET_VALUES_SETUP: return 1;
+    case COMM_ROTOR_POSITION: return 2;
+    case COMM_BMS_GET_VALUES: return 3;
+    default: return -1;
+    }
+}
+
+void SerialIo::deliver(SerialIo::RxItem &item)
+{
+    qint64 delay = mClock.nsecsElapsed() - item.timeNs;
+
+    mRxPackets++;
+    mRxDelaySumNs += delay;
+    mRxDelayMaxNs = qMax(mRxDelayMaxNs, delay);
+
+    // Interarrival jitter estimator from RFC 3550
+    if (mRxPackets > 1) {
+        mRxJitterNs += (double(qAbs(delay - mRxDelayLastNs)) - mRxJitterNs) / 16.0;
+    }
+    mRxDelayLastNs = delay;
+
+    emit packetReceived(item.data);
+}
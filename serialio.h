@@ -0,0 +1,166 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef SERIALIO_H
+#define SERIALIO_H
+
+#include <QObject>
+#include <QThread>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QSerialPort>
+#include <atomic>
+#include "spscqueue.h"
+
+class Packet;
+class SerialIo;
+
+/**
+ * @brief The SerialIoWorker class
+ *
+ * The part of SerialIo that lives in the I/O thread. It owns the serial port
+ * and the packet decoder, and is only used through queued calls.
+ */
+class SerialIoWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SerialIoWorker(SerialIo *io);
+
+public slots:
+    bool open(QString port, int baudrate);
+    void close();
+    void flushTx();
+
+private slots:
+    void readyRead();
+    void portError(QSerialPort::SerialPortError error);
+
+private:
+    SerialIo *mIo;
+    QSerialPort *mPort;
+    Packet *mPacket;
+
+    void packetDecoded(QByteArray &packet);
+
+};
+
+/**
+ * @brief The SerialIo class
+ *
+ * Serial link that runs the port and the packet framing in a separate thread,
+ * so that a busy GUI thread does not delay reading the port or sending
+ * packets. The threads only share two lock-free single-producer queues, one in
+ * each direction.
+ *
+ * Decoded packets are emitted with packetReceived() on the thread SerialIo
+ * lives in, in the order they arrived. The exception is telemetry such as
+ * COMM_GET_VALUES: if the receiving thread has not caught up when a new sample
+ * arrives, only the latest sample is kept.
+ *
+ * The time from write() until the data is handed to the port, and the time
+ * from decoding a packet until it is emitted, are measured and available from
+ * stats() and report().
+ */
+class SerialIo : public QObject
+{
+    Q_OBJECT
+public:
+    struct Stats {
+        quint64 txPackets;
+        double txLatencyAvgUs;
+        double txLatencyMaxUs;
+        quint64 rxPackets;
+        quint64 rxCoalesced;
+        double rxDelayAvgUs;
+        double rxDelayMaxUs;
+        double rxJitterUs;
+    };
+
+    explicit SerialIo(QObject *parent = nullptr);
+    ~SerialIo();
+
+    bool open(QString port, int baudrate);
+    void close();
+    bool isOpen() const;
+    QString portName() const;
+
+    void write(const QByteArray &data);
+    void setCoalesceTelemetry(bool coalesce);
+
+    Stats stats() const;
+    void resetStats();
+    QString report() const;
+
+signals:
+    void packetReceived(QByteArray &packet);
+    void errorOccurred(QString message);
+
+private slots:
+    void drainRx();
+    void workerError(QString message);
+
+private:
+    friend class SerialIoWorker;
+
+    struct TxItem {
+        QByteArray data;
+        qint64 timeNs;
+    };
+
+    struct RxItem {
+        QByteArray data;
+        qint64 timeNs;
+    };
+
+    static const int telemetrySlots = 4;
+
+    QThread mThread;
+    SerialIoWorker *mWorker;
+    QElapsedTimer mClock;
+    QString mPortName;
+
+    SpscQueue<TxItem> mTxQueue;
+    SpscQueue<RxItem> mRxQueue;
+    std::atomic<RxItem*> mLatest[telemetrySlots];
+
+    std::atomic<bool> mOpen;
+    std::atomic<bool> mCoalesce;
+    std::atomic<bool> mTxPosted;
+    std::atomic<bool> mRxPosted;
+
+    // Written by the I/O thread
+    std::atomic<quint64> mTxPackets;
+    std::atomic<qint64> mTxLatencySumNs;
+    std::atomic<qint64> mTxLatencyMaxNs;
+    std::atomic<quint64> mRxCoalesced;
+
+    // Only used on the receiving thread
+    quint64 mRxPackets;
+    qint64 mRxDelaySumNs;
+    qint64 mRxDelayMaxNs;
+    qint64 mRxDelayLastNs;
+    double mRxJitterNs;
+
+    static int telemetrySlot(const QByteArray &packet);
+    void deliver(RxItem &item);
+
+};
+
+#endif // SERIALIO_H
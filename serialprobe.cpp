@@ -0,0 +1,257 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "serialprobe.h"
+#include "packet.h"
+#include "commands.h"
+#include "utility.h"
+
+#include <QTimer>
+#include <QFileInfo>
+
+SerialProbe::SerialProbe(QObject *parent) : QObject(parent)
+{
+    mBaudrate = 115200;
+    mSettleMs = 100;
+    mReplyMs = 500;
+    mLoop = nullptr;
+}
+
+SerialProbe::~SerialProbe()
+{
+    closeAll();
+}
+
+void SerialProbe::setBaudrate(int baudrate)
+{
+    mBaudrate = baudrate;
+}
+
+int SerialProbe::baudrate() const
+{
+    return mBaudrate;
+}
+
+/**
+ * @brief SerialProbe::setTimeouts
+ * Set the probe timing. These are the same delays autoconnect has always used
+ * per port, but they are now only spent once for all ports.
+ *
+ * @param settleMs
+ * Time to wait after opening the ports before asking for the firmware
+ * version. Some adapters send garbage right after being opened.
+ *
+ * @param replyMs
+ * Time to wait for the replies.
+ */
+void SerialProbe::setTimeouts(int settleMs, int replyMs)
+{
+    mSettleMs = settleMs;
+    mReplyMs = replyMs;
+}
+
+/**
+ * @brief SerialProbe::probe
+ * Ask for the firmware version on all ports at the same time and wait until
+ * every port has answered or the reply timeout has passed. Ports that cannot
+ * be opened, e.g. because they are busy or not writable, are skipped.
+ *
+ * @param ports
+ * System paths of the ports to probe.
+ *
+ * @return
+ * The devices that answered, in the order their replies arrived.
+ */
+QVector<SerialProbe::Device> SerialProbe::probe(const QStringList &ports)
+{
+    closeAll();
+    mDevices.clear();
+
+    for (const auto &p: ports) {
+        openPort(p);
+    }
+
+    if (mPorts.isEmpty()) {
+        return mDevices;
+    }
+
+    Utility::sleepWithEventLoop(mSettleMs);
+
+    for (auto &p: mPorts) {
+        p.serial->clear();
+        p.packet->resetState();
+    }
+
+    mTime.start();
+
+    for (auto &p: mPorts) {
+        p.commands->getFwVersion();
+    }
+
+    QEventLoop loop;
+    QTimer timeoutTimer;
+    timeoutTimer.setSingleShot(true);
+    connect(&timeoutTimer, SIGNAL(timeout()), &loop, SLOT(quit()));
+    timeoutTimer.start(mReplyMs);
+
+    mLoop = &loop;
+    loop.exec();
+    mLoop = nullptr;
+
+    closeAll();
+    emit progress(1.0);
+
+    return mDevices;
+}
+
+QVector<SerialProbe::Device> SerialProbe::devices() const
+{
+    return mDevices;
+}
+
+/**
+ * @brief SerialProbe::bestIndex
+ * Pick the device to connect to from the last probe. Motor controllers are
+ * preferred over BMSs and custom modules, and among those the first one that
+ * answered is used.
+ *
+ * @return
+ * Index in devices(), or -1 if nothing answered.
+ */
+int SerialProbe::bestIndex() const
+{
+    for (int i = 0;i < mDevices.size();i++) {
+        if (mDevices.at(i).fw.hwType == HW_TYPE_VESC) {
+            return i;
+        }
+    }
+
+    return mDevices.isEmpty() ? -1 : 0;
+}
+
+QString SerialProbe::report() const
+{
+    QString res;
+
+    for (const auto &d: mDevices) {
+        FW_RX_PARAMS fw = d.fw;
+        res += QString("%1: %2 %3, FW %4.%5, UUID %6 (%7 ms)\n").
+                arg(d.port).arg(fw.hwTypeStr()).arg(fw.hw).
+                arg(fw.major).arg(fw.minor, 2, 10, QLatin1Char('0')).
+                arg(QString(fw.uuid.toHex()).toUpper()).arg(d.timeMs);
+    }
+
+    return res;
+}
+
+void SerialProbe::abort()
+{
+    if (mLoop) {
+        mLoop->quit();
+    }
+}
+
+bool SerialProbe::openPort(const QString &path)
+{
+#ifdef Q_OS_UNIX
+    QFileInfo fi(path);
+    if (fi.exists() && !fi.isWritable()) {
+        return false;
+    }
+#endif
+
+    Port p;
+    p.path = path;
+    p.serial = new QSerialPort(this);
+    p.serial->setPortName(path);
+
+    if (!p.serial->open(QIODevice::ReadWrite)) {
+        p.serial->deleteLater();
+        return false;
+    }
+
+    p.serial->setBaudRate(mBaudrate);
+    p.serial->setDataBits(QSerialPort::Data8);
+    p.serial->setParity(QSerialPort::NoParity);
+    p.serial->setStopBits(QSerialPort::OneStop);
+    p.serial->setFlowControl(QSerialPort::NoFlowControl);
+
+    p.packet = new Packet(this);
+    p.commands = new Commands(this);
+    p.replied = false;
+
+    int index = mPorts.size();
+    QSerialPort *serial = p.serial;
+    Packet *packet = p.packet;
+    Commands *commands = p.commands;
+
+    connect(serial, &QSerialPort::readyRead, [serial, packet]() {
+        packet->processData(serial->readAll());
+    });
+    connect(packet, &Packet::dataToSend, [serial](QByteArray &data) {
+        serial->write(data);
+    });
+    connect(commands, &Commands::dataToSend, [packet](QByteArray &data) {
+        packet->sendPacket(data);
+    });
+    connect(packet, &Packet::packetReceived, [commands](QByteArray &data) {
+        commands->processPacket(data);
+    });
+    connect(commands, &Commands::fwVersionReceived, this, [this, index](FW_RX_PARAMS fw) {
+        portReplied(index, fw);
+    });
+
+    mPorts.append(p);
+    return true;
+}
+
+void SerialProbe::portReplied(int index, const FW_RX_PARAMS &fw)
+{
+    if (index >= mPorts.size() || mPorts.at(index).replied) {
+        return;
+    }
+
+    mPorts[index].replied = true;
+
+    Device d;
+    d.port = mPorts.at(index).path;
+    d.fw = fw;
+    d.timeMs = mTime.elapsed();
+    mDevices.append(d);
+
+    emit deviceFound(d.port, d.fw);
+    emit progress(double(mDevices.size()) / double(mPorts.size()));
+
+    if (mDevices.size() == mPorts.size() && mLoop) {
+        mLoop->quit();
+    }
+}
+
+void SerialProbe::closeAll()
+{
+    for (auto &p: mPorts) {
+        disconnect(p.commands, nullptr, this, nullptr);
+        p.serial->close();
+        p.serial->deleteLater();
+        p.packet->deleteLater();
+        p.commands->deleteLater();
+    }
+
+    mPorts.clear();
+}
@@ -0,0 +1,99 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef SERIALPROBE_H
+#define SERIALPROBE_H
+
+#include <QObject>
+#include <QVector>
+#include <QStringList>
+#include <QSerialPort>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include "datatypes.h"
+
+class Packet;
+class Commands;
+
+/**
+ * @brief The SerialProbe class
+ *
+ * Looks for VESC devices on a set of serial ports. All ports are opened at the
+ * same time, each with its own Packet decoder and Commands parser, and the
+ * firmware version is requested on all of them at once. The probe therefore
+ * takes one reply timeout in total instead of one per port.
+ *
+ * Every port that answers is reported with its firmware info, so that setups
+ * with several devices connected over USB can be listed. bestIndex() picks
+ * the device to connect to. The ports are closed again when the probe is
+ * done, so that the chosen one can be opened by VescInterface.
+ */
+class SerialProbe : public QObject
+{
+    Q_OBJECT
+public:
+    struct Device {
+        QString port;
+        FW_RX_PARAMS fw;
+        qint64 timeMs;
+    };
+
+    explicit SerialProbe(QObject *parent = nullptr);
+    ~SerialProbe();
+
+    void setBaudrate(int baudrate);
+    int baudrate() const;
+    void setTimeouts(int settleMs, int replyMs);
+
+    QVector<Device> probe(const QStringList &ports);
+    QVector<Device> devices() const;
+    int bestIndex() const;
+    QString report() const;
+
+signals:
+    void deviceFound(QString port, FW_RX_PARAMS fw);
+    void progress(double progress);
+
+public slots:
+    void abort();
+
+private:
+    struct Port {
+        QString path;
+        QSerialPort *serial;
+        Packet *packet;
+        Commands *commands;
+        bool replied;
+    };
+
+    QVector<Port> mPorts;
+    QVector<Device> mDevices;
+    int mBaudrate;
+    int mSettleMs;
+    int mReplyMs;
+    QElapsedTimer mTime;
+    QEventLoop *mLoop;
+
+    bool openPort(const QString &path);
+    void portReplied(int index, const FW_RX_PARAMS &fw);
+    void closeAll();
+
+};
+
+#endif // SERIALPROBE_H
@@ -0,0 +1,96 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+/**
+ * @brief The SpscQueue class
+ *
+ * Bounded lock-free queue for exactly one producer thread and one consumer
+ * thread. push() may only be called from the producer and pop() only from the
+ * consumer. The capacity is rounded up to a power of two.
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity) : mHead(0), mTail(0) {
+        size_t cap = 2;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+
+        mBuffer.resize(cap);
+        mMask = cap - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue &operator=(const SpscQueue&) = delete;
+
+    bool push(T item) {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        if ((tail - mHead.load(std::memory_order_acquire)) > mMask) {
+            return false;
+        }
+
+        mBuffer[tail & mMask] = std::move(item);
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item) {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mTail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        // Leave a default value behind, so that e.g. a QByteArray does not
+        // keep its data alive until the slot is reused.
+        item = std::move(mBuffer[head & mMask]);
+        mBuffer[head & mMask] = T();
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const {
+        return mHead.load(std::memory_order_acquire) ==
+                mTail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return mMask + 1;
+    }
+
+private:
+    std::vector<T> mBuffer;
+    size_t mMask;
+
+    // On separate cache lines, as they are written by different threads
+    alignas(64) std::atomic<size_t> mHead;
+    alignas(64) std::atomic<size_t> mTail;
+
+};
+
+#endif // SPSCQUEUE_H
@@ -37,9 +37,14 @@
 #include <QNetworkInterface>
 #include <QDirIterator>
 #include <QPixmapCache>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QAtomicInt>
 
 #include "maddy/parser.h"
 #include "heatshrink/heatshrinkif.h"
+#include "canfanout.h"
 
 #ifdef Q_OS_ANDROID
 #include <QtAndroid>
@@ -47,6 +52,23 @@
 #include <QAndroidJniEnvironment>
 #endif
 
+namespace {
+class FuncRunnable : public QRunnable
+{
+public:
+    FuncRunnable(std::function<void()> func) : mFunc(func) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        mFunc();
+    }
+
+private:
+    std::function<void()> mFunc;
+};
+}
+
 QMap<QString, QColor> Utility::mAppColors = {
     {"lightestBackground", QColor(80,80,80)},
     {"lightBackground", QColor(66,66,66)},
@@ -883,70 +905,60 @@ bool Utility::setMcParamsFromCurrentConfigAllCan(VescInterface *vesc, QVector<in
     bool res = true;
 
     ConfigParams *config = vesc->mcConfig();
-    QVector<QPair<QString, ConfigParam>> paramVec;
+    QVector<QPair<int, ConfigParam>> paramVec;
 
     for (auto s: params) {
-        paramVec.append(qMakePair(s, config->getParamCopy(s)));
+        paramVec.append(qMakePair(config->paramId(s), config->getParamCopy(s)));
     }
 
-    auto updateConf = [&vesc, &config, &paramVec]() {
-        if (!checkFwCompatibility(vesc)) {
-            vesc->emitMessageDialog("FW Versions",
-                                    "All VESCs must have the latest firmware to perform this operation.",
-                                    false, false);
-            return false;
-        }
+    CanFanout fanout(vesc);
+    fanout.probe(canIds, true);
 
+    if (!fanout.allOk()) {
+        vesc->emitMessageDialog("FW Versions",
+                                "All VESCs must respond and have the latest firmware to perform this operation.\n\n" +
+                                fanout.report(),
+                                false, false);
+        return false;
+    }
+
+    // The configurations are read one VESC at a time, as the replies do not
+    // say where they come from. They are written to all VESCs at once.
+    QHash<int, ConfigParams*> nodeConfs;
+
+    res = fanout.forEach([&vesc, &config, &paramVec, &nodeConfs](CanFanout::Node &node) {
         vesc->commands()->getMcconf();
 
         if (!waitSignal(config, SIGNAL(updated()), 4000)) {
-            vesc->emitMessageDialog("Read Motor Configuration",
-                                    "Could not read motor configuration.",
-                                    false, false);
-
+            node.error = "Could not read motor configuration";
             return false;
         }
 
+        ConfigParams *c = new ConfigParams;
+        *c = *config;
         for (auto p: paramVec) {
-            config->updateParamFromOther(p.first, p.second, nullptr);
-        }
-
-        vesc->commands()->setMcconf(false);
-
-        if (!waitSignal(vesc->commands(), SIGNAL(ackReceived(QString)), 4000)) {
-            vesc->emitMessageDialog("Write Motor Configuration",
-                                    "Could not write motor configuration.",
-                                    false, false);
-
-            return false;
+            c->updateParamFromOther(p.first, p.second, nullptr);
         }
+        nodeConfs.insert(node.canId, c);
 
         return true;
-    };
-
-    // Start with local VESC
-    vesc->canTmpOverride(false, 0);
+    });
 
-    if (isConnectedToHwVesc(vesc)) {
-        res = updateConf();
+    if (res) {
+        res = fanout.writeAll([&vesc, &nodeConfs](const CanFanout::Node &node) {
+            vesc->commands()->setMcconfFrom(nodeConfs.value(node.canId));
+        }, "Motor config write OK");
     }
 
-    // Now every VESC on the CAN-bus
-    if (res) {
-        for (int id: canIds) {
-            vesc->canTmpOverride(true, id);
+    qDeleteAll(nodeConfs);
+    fanout.restoreCan();
 
-            if (isConnectedToHwVesc(vesc)) {
-                res = updateConf();
-                if (!res) {
-                    break;
-                }
-            }
-        }
+    if (!res) {
+        vesc->emitMessageDialog("Write Motor Configuration",
+                                "Could not update the motor configuration on all VESCs.\n\n" + fanout.report(),
+                                false, false);
     }
 
-    vesc->canTmpOverrideEnd();
-
     vesc->commands()->getMcconf();
     if (!waitSignal(config, SIGNAL(updated()), 4000)) {
         res = false;
@@ -1106,70 +1118,76 @@ bool Utility::restoreConfAll(VescInterface *vesc, bool can, bool mc, bool app)
 {
     bool res = true;
 
-    bool canLastFwd = vesc->commands()->getSendCan();
-    int canLastId = vesc->commands()->getCanSendId();
+    QVector<int> canDevs;
+    if (can) {
+        canDevs = vesc->scanCan();
+    }
 
-    vesc->ignoreCanChange(true);
-    vesc->commands()->setSendCan(false);
+    CanFanout fanout(vesc);
+    fanout.probe(canDevs, true);
 
-    auto update = [mc, app, vesc]() {
-        bool res = true;
-        if (!isConnectedToHwVesc(vesc)) {
-            return true;
-        }
+    if (!fanout.allOk()) {
+        vesc->emitMessageDialog("FW Versions",
+                                "All VESCs must respond and have the latest firmware to perform this operation.\n\n" +
+                                fanout.report(),
+                                false, false);
+        return false;
+    }
 
-        if (!checkFwCompatibility(vesc)) {
-            vesc->emitMessageDialog("FW Versions",
-                                    "All VESCs must have the latest firmware to perform this operation.",
-                                    false, false);
-            return false;
-        }
+    QHash<int, ConfigParams*> mcConfs;
+    QHash<int, ConfigParams*> appConfs;
 
+    res = fanout.forEach([mc, app, vesc, &mcConfs, &appConfs](CanFanout::Node &node) {
         if (mc) {
             ConfigParams *p = vesc->mcConfig();
             vesc->commands()->getMcconfDefault();
-            res = waitSignal(p, SIGNAL(updated()), 4000);
-
-            if (res) {
-                vesc->commands()->setMcconf(false);
-                res = waitSignal(vesc->commands(), SIGNAL(ackReceived(QString)), 4000);
-            } else {
+            if (!waitSignal(p, SIGNAL(updated()), 4000)) {
+                node.error = "Could not read default motor configuration";
                 return false;
             }
+
+            ConfigParams *c = new ConfigParams;
+            *c = *p;
+            mcConfs.insert(node.canId, c);
         }
 
         if (app) {
             ConfigParams *p = vesc->appConfig();
             vesc->commands()->getAppConfDefault();
-            res = waitSignal(p, SIGNAL(updated()), 4000);
-
-            if (res) {
-                vesc->commands()->setAppConf();
-                res = waitSignal(vesc->commands(), SIGNAL(ackReceived(QString)), 4000);
-            } else {
+            if (!waitSignal(p, SIGNAL(updated()), 4000)) {
+                node.error = "Could not read default app configuration";
                 return false;
             }
-        }
 
-        return res;
-    };
+            ConfigParams *c = new ConfigParams;
+            *c = *p;
+            appConfs.insert(node.canId, c);
+        }
 
-    res = update();
+        return true;
+    });
 
-    if (res && can) {
-        QVector<int> canDevs = Utility::scanCanVescOnly(vesc);
+    if (res && mc) {
+        res = fanout.writeAll([vesc, &mcConfs](const CanFanout::Node &node) {
+            vesc->commands()->setMcconfFrom(mcConfs.value(node.canId));
+        }, "Motor config write OK");
+    }
 
-        for (int d: canDevs) {
-            vesc->commands()->setSendCan(true, d);
-            res = update();
-            if (!res) {
-                break;
-            }
-        }
+    if (res && app) {
+        res = fanout.writeAll([vesc, &appConfs](const CanFanout::Node &node) {
+            vesc->commands()->setAppConfFrom(appConfs.value(node.canId));
+        }, "App config write OK");
     }
 
-    vesc->commands()->setSendCan(canLastFwd, canLastId);
-    vesc->ignoreCanChange(false);
+    qDeleteAll(mcConfs);
+    qDeleteAll(appConfs);
+    fanout.restoreCan();
+
+    if (!res) {
+        vesc->emitMessageDialog("Restore Configuration",
+                                "Could not restore the configuration on all VESCs.\n\n" + fanout.report(),
+                                false, false);
+    }
 
     if (can) {
         if (!isConnectedToHwVesc(vesc)) {
@@ -1808,14 +1826,18 @@ bool Utility::configLoad(VescInterface *vesc, int fwMajor, int fwMinor)
                     int major = parts.at(0).toInt();
                     int minor = parts.at(1).toInt();
                     if (major == fwMajor && minor == fwMinor) {
-                        QFileInfo fMc(Utility::configPath(it.fileName() + "/parameters_mcconf.xml"));
-                        QFileInfo fApp(Utility::configPath(it.fileName() + "/parameters_appconf.xml"));
-                        QFileInfo fInfo(Utility::configPath(it.fileName() + "/info.xml"));
-
-                        if (fMc.exists() && fApp.exists() && fInfo.exists()) {
-                            vesc->mcConfig()->loadParamsXml(fMc.absoluteFilePath());
-                            vesc->appConfig()->loadParamsXml(fApp.absoluteFilePath());
-                            vesc->infoConfig()->loadParamsXml(fInfo.absoluteFilePath());
+                        // Precompiled binary versions of the files are used when
+                        // available, see ConfigParams::loadParams
+                        QString fMc = Utility::configPath(it.fileName() + "/parameters_mcconf.xml");
+                        QString fApp = Utility::configPath(it.fileName() + "/parameters_appconf.xml");
+                        QString fInfo = Utility::configPath(it.fileName() + "/info.xml");
+
+                        if (ConfigParams::paramsExist(fMc) &&
+                                ConfigParams::paramsExist(fApp) &&
+                                ConfigParams::paramsExist(fInfo)) {
+                            vesc->mcConfig()->loadParams(fMc);
+                            vesc->appConfig()->loadParams(fApp);
+                            vesc->infoConfig()->loadParams(fInfo);
                             vesc->emitConfigurationChanged();
                             return true;
                         } else {
@@ -1912,20 +1934,82 @@ bool Utility::configLoadCompatible(VescInterface *vesc, QString &uuidRx)
     return res;
 }
 
-QVector<int> Utility::scanCanVescOnly(VescInterface *vesc)
+/**
+ * @brief Utility::configCompileBinary
+ * Compile all XML parameter files in dir and its subdirectories to the binary
+ * format, see ConfigParams::getParamsBinary. The binary files are stored next
+ * to the XML files and a resource file, res_config_bin.qrc, that includes them
+ * instead of the XML files is written to dir.
+ *
+ * @param dir
+ * The configuration directory, e.g. res/config.
+ *
+ * @param compiled
+ * Set to the number of compiled files.
+ *
+ * @return
+ * True if all files were compiled.
+ */
+bool Utility::configCompileBinary(QString dir, int *compiled)
 {
-    auto canDevs = vesc->scanCan();
-    QVector<int> res;
+    QDir root(dir);
+    QStringList files;
+    bool ok = true;
+    int cnt = 0;
+
+    QDirIterator it(dir, QStringList() << "*.xml", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString xmlPath = it.next();
+        ConfigParams params;
 
-    for (auto d: canDevs) {
-        FW_RX_PARAMS params;
-        getFwVersionBlockingCan(vesc, &params, d);
-        if (params.hwType == HW_TYPE_VESC) {
-            res.append(d);
+        if (!params.loadParamsXml(xmlPath)) {
+            qWarning() << "Could not parse" << xmlPath;
+            ok = false;
+            continue;
+        }
+
+        QString binPath = ConfigParams::binaryFileName(xmlPath);
+        if (!params.saveParamsBinary(binPath)) {
+            ok = false;
+            continue;
         }
+
+        files.append(root.relativeFilePath(binPath));
+        cnt++;
     }
 
-    return res;
+    if (compiled) {
+        *compiled = cnt;
+    }
+
+    files.sort();
+
+    QFile qrc(root.filePath("res_config_bin.qrc"));
+    if (!qrc.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not write" << qrc.fileName();
+        return false;
+    }
+
+    QTextStream out(&qrc);
+    out << "<RCC>\n";
+    out << "    <qresource prefix=\"/res/config/\">\n";
+    for (const auto &f: files) {
+        out << "        <file>" << f << "</file>\n";
+    }
+    out << "    </qresource>\n";
+    out << "</RCC>\n";
+    qrc.close();
+
+    return ok;
+}
+
+QVector<int> Utility::scanCanVescOnly(VescInterface *vesc)
+{
+    auto canDevs = vesc->scanCan();
+
+    CanFanout fanout(vesc);
+    fanout.probe(canDevs, false, false);
+    return fanout.targets();
 }
 
 bool Utility::calculateSerializedLength(ConfigParams *params, uint32_t &length) {
@@ -2376,6 +2460,71 @@ void Utility::plotSavePng(QCustomPlot *plot, int width, int height, QString titl
     }
 }
 
+/**
+ * @brief Utility::plotAddColorMap
+ * Replace the color maps and color scales of a plot with a new color map and
+ * scale to the right of the axis rect. Use plotRemoveColorMaps to go back to
+ * normal graphs.
+ *
+ * @param plot
+ * The plot.
+ *
+ * @param scaleLabel
+ * Label of the color scale.
+ *
+ * @return
+ * The new color map.
+ */
+QCPColorMap *Utility::plotAddColorMap(QCustomPlot *plot, QString scaleLabel)
+{
+    plotRemoveColorMaps(plot);
+
+    QCPColorMap *map = new QCPColorMap(plot->xAxis, plot->yAxis);
+    map->setGradient(QCPColorGradient::gpJet);
+    map->removeFromLegend();
+
+    QCPColorScale *scale = new QCPColorScale(plot);
+    plot->plotLayout()->addElement(0, 1, scale);
+    scale->setType(QCPAxis::atRight);
+    scale->axis()->setLabel(scaleLabel);
+    scale->axis()->setLabelColor(plot->xAxis->labelColor());
+    scale->axis()->setTickLabelColor(plot->xAxis->tickLabelColor());
+    scale->axis()->setBasePen(plot->xAxis->basePen());
+    scale->axis()->setTickPen(plot->xAxis->tickPen());
+    scale->axis()->setSubTickPen(plot->xAxis->subTickPen());
+    map->setColorScale(scale);
+
+    // Keep the axis rect and the scale aligned vertically
+    QCPMarginGroup *group = new QCPMarginGroup(plot);
+    plot->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop, group);
+    scale->setMarginGroup(QCP::msBottom | QCP::msTop, group);
+
+    return map;
+}
+
+void Utility::plotRemoveColorMaps(QCustomPlot *plot)
+{
+    for (int i = plot->plottableCount() - 1;i >= 0;i--) {
+        if (qobject_cast<QCPColorMap*>(plot->plottable(i))) {
+            plot->removePlottable(i);
+        }
+    }
+
+    bool removed = false;
+    for (int i = plot->plotLayout()->elementCount() - 1;i >= 0;i--) {
+        if (auto scale = qobject_cast<QCPColorScale*>(plot->plotLayout()->elementAt(i))) {
+            plot->plotLayout()->remove(scale);
+            removed = true;
+        }
+    }
+
+    if (removed) {
+        // Deleting the group also removes it from the axis rect
+        delete plot->axisRect()->marginGroup(QCP::msBottom);
+        plot->plotLayout()->simplify();
+    }
+}
+
 QString Utility::waitForLine(QTcpSocket *socket, int timeoutMs)
 {
     QEventLoop loop;
@@ -2535,7 +2684,11 @@ QString Utility::configPath(QString subPath)
     QString pathDl = QString("://res/config_download/") + subPath;
 
     if (QDir("://res/config_download/").exists()) {
+        // The built-in resources might only have the binary version of the file
         QFileInfo file(path);
+        if (!file.exists()) {
+            file.setFile(ConfigParams::binaryFileName(path));
+        }
         QFileInfo fileDl(pathDl);
 
         auto date = file.lastModified();
@@ -2637,3 +2790,40 @@ QVariantMap Utility::getSafeAreaMargins(QQuickWindow *window)
 #endif
     return map;
 }
+
+/**
+ * @brief Utility::runParallel
+ * Run func(0) to func(count - 1) on the calling thread and the free threads of
+ * the global thread pool, and wait until all of them are done. func must be
+ * safe to call from several threads at the same time.
+ */
+void Utility::runParallel(int count, std::function<void(int)> func)
+{
+    QAtomicInt next(0);
+    QSemaphore done;
+    int helpers = 0;
+
+    auto work = [&next, &func, count]() {
+        int i;
+        while ((i = next.fetchAndAddRelaxed(1)) < count) {
+            func(i);
+        }
+    };
+
+    for (int i = 1;i < count;i++) {
+        FuncRunnable *r = new FuncRunnable([&work, &done]() {
+            work();
+            done.release();
+        });
+
+        // The pool is often full, e.g. when this is called from pool work
+        if (!QThreadPool::globalInstance()->tryStart(r)) {
+            delete r;
+            break;
+        }
+        helpers++;
+    }
+
+    work();
+    done.acquire(helpers);
+}
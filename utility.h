@@ -23,6 +23,7 @@
 #include <QObject>
 #include <QMetaEnum>
 #include <cstdint>
+#include <functional>
 #include <QQuickWindow>
 #include <QtGui/qpa/qplatformwindow.h>
 #include "vescinterface.h"
@@ -125,6 +126,7 @@ public:
     static bool configLoadLatest(VescInterface *vesc);
     static QVector<QPair<int, int>> configSupportedFws();
     static bool configLoadCompatible(VescInterface *vesc, QString &uuidRx);
+    static bool configCompileBinary(QString dir, int *compiled = nullptr);
 
     Q_INVOKABLE static QVector<int> scanCanVescOnly(VescInterface *vesc);
     Q_INVOKABLE static void setAppQColor(QString colorName, QColor color);
@@ -138,6 +140,8 @@ public:
     static void setPlotColors(QCustomPlot* plot);
     static void plotSavePdf(QCustomPlot* plot, int width = 1280, int height = 720, QString title = "");
     static void plotSavePng(QCustomPlot* plot, int width = 1280, int height = 720, QString title = "");
+    static QCPColorMap *plotAddColorMap(QCustomPlot *plot, QString scaleLabel = "");
+    static void plotRemoveColorMaps(QCustomPlot *plot);
 
     template<typename QEnum>
     static QString QEnumToQString (const QEnum value) {
@@ -168,6 +172,8 @@ public:
 
     Q_INVOKABLE static QString configPath(QString subPath);
 
+    static void runParallel(int count, std::function<void(int)> func);
+
 signals:
 
 public slots:
@@ -52,6 +52,11 @@ android: {
 # Exclude built-in firmwares
 CONFIG += exclude_fw
 
+# Use the binary parameter files instead of the XML files. They are committed
+# and have to be regenerated with ./build_config_bin (or vesc_tool
+# --compileConfigs res/config) when the XML files change.
+CONFIG += config_bin
+
 ios: {
     CONFIG    += build_mobile
     DEFINES   += QT_NO_PRINTER
@@ -233,7 +238,15 @@ SOURCES += main.cpp\
     startupwizard.cpp \
     utility.cpp \
     tcpserversimple.cpp \
-    hexfile.cpp
+    hexfile.cpp \
+    cancapture.cpp \
+    motormap.cpp \
+    drivecycle.cpp \
+    framescheduler.cpp \
+    configbackupstore.cpp \
+    canfanout.cpp \
+    chunkfetch.cpp \
+    hotplugmonitor.cpp
 
 HEADERS  += mainwindow.h \
     bleuartdummy.h \
@@ -256,7 +269,16 @@ HEADERS  += mainwindow.h \
     startupwizard.h \
     utility.h \
     tcpserversimple.h \
-    hexfile.h
+    hexfile.h \
+    cancapture.h \
+    motormap.h \
+    drivecycle.h \
+    framescheduler.h \
+    configbackupstore.h \
+    canfanout.h \
+    chunkfetch.h \
+    hotplugmonitor.h \
+    spscqueue.h
 
 unix: {
 !ios: {
@@ -274,6 +296,13 @@ contains(DEFINES, HAS_BLUETOOTH) {
     HEADERS += bleuart.h
 }
 
+contains(DEFINES, HAS_SERIALPORT) {
+    SOURCES += serialprobe.cpp \
+        serialio.cpp
+    HEADERS += serialprobe.h \
+        serialio.h
+}
+
 include(pages/pages.pri)
 include(widgets/widgets.pri)
 include(mobile/mobile.pri)
@@ -291,7 +320,14 @@ RESOURCES += res.qrc \
     res_custom_module.qrc \
     res_lisp.qrc \
     res_qml.qrc
-RESOURCES += res/config/res_config.qrc
+config_bin {
+    !exists($$PWD/res/config/res_config_bin.qrc) {
+        error("res/config/res_config_bin.qrc is missing, run ./build_config_bin")
+    }
+    RESOURCES += res/config/res_config_bin.qrc
+} else {
+    RESOURCES += res/config/res_config.qrc
+}
 
 RESOURCES += res_fw_bms.qrc
 
@@ -32,9 +32,12 @@
 #include "vescinterface.h"
 #include "utility.h"
 #include "heatshrink/heatshrinkif.h"
+#include "canfanout.h"
+#include "chunkfetch.h"
 
 #ifdef HAS_SERIALPORT
 #include <QSerialPortInfo>
+#include "serialprobe.h"
 #endif
 
 #include <QNetworkAccessManager>
@@ -51,6 +54,13 @@
 #define VT_INTRO_VERSION 1
 #endif
 
+namespace {
+// The timer drives the firmware version polling and the connection state, and
+// received data is handled when it arrives, so it only runs fast while connected.
+const int timerIntervalConnected = 20;
+const int timerIntervalIdle = 250;
+}
+
 VescInterface::VescInterface(QObject *parent) : QObject(parent)
 {
     mMcConfig = new ConfigParams(this);
@@ -68,6 +78,7 @@ VescInterface::VescInterface(QObject *parent) : QObject(parent)
     mFwVersionReceived = false;
     mFwRetries = 0;
     mFwPollCnt = 0;
+    mConnectTimingActive = false;
     mFwTxt = "x.x";
     mFwPair = qMakePair(-1, -1);
     mIsUploadingFw = false;
@@ -81,9 +92,11 @@ VescInterface::VescInterface(QObject *parent) : QObject(parent)
     mFwIsBootloader = false;
 
     mTimer = new QTimer(this);
-    mTimer->setInterval(20);
+    mTimer->setInterval(timerIntervalIdle);
     mTimer->start();
 
+    mRxScheduled = false;
+
     mLastConnType = static_cast<conn_t>(mSettings.value("connection_type", CONN_NONE).toInt());
     mLastTcpServer = mSettings.value("tcp_server", "127.0.0.1").toString();
     mLastTcpPort = mSettings.value("tcp_port", 65102).toInt();
@@ -136,14 +149,14 @@ VescInterface::VescInterface(QObject *parent) : QObject(parent)
 
     // Serial
 #ifdef HAS_SERIALPORT
-    mSerialPort = new QSerialPort(this);
+    mSerialIo = new SerialIo(this);
     mLastSerialPort = mSettings.value("serial_port", "").toString();
     mLastSerialBaud = mSettings.value("serial_baud", 115200).toInt();
 
-    connect(mSerialPort, SIGNAL(readyRead()),
-            this, SLOT(serialDataAvailable()));
-    connect(mSerialPort, SIGNAL(error(QSerialPort::SerialPortError)),
-            this, SLOT(serialPortError(QSerialPort::SerialPortError)));
+    connect(mSerialIo, SIGNAL(packetReceived(QByteArray&)),
+            this, SLOT(packetReceived(QByteArray&)));
+    connect(mSerialIo, SIGNAL(errorOccurred(QString)),
+            this, SLOT(serialPortError(QString)));
 #endif
 
     // CANbus
@@ -154,6 +167,26 @@ VescInterface::VescInterface(QObject *parent) : QObject(parent)
     mLastCanBackend = mSettings.value("CANbusBackend", "socketcan").toString();
     mLastCanDeviceID = mSettings.value("CANbusLastDeviceID", 0).toInt();
     mCANbusScanning = false;
+    mCanRxScheduled = false;
+#endif
+
+    // Hotplug
+    mHotplug = new HotplugMonitor(this);
+#ifdef HAS_SERIALPORT
+    mHotplug->watch(HotplugMonitor::SourceSerial, []() {
+        QStringList res;
+        for (const auto &p: QSerialPortInfo::availablePorts()) {
+            res.append(p.systemLocation());
+        }
+        return res;
+    });
+    connect(mHotplug, SIGNAL(serialPortsChanged()), this, SIGNAL(serialPortListUpdated()));
+#endif
+#ifdef HAS_CANBUS
+    mHotplug->watch(HotplugMonitor::SourceCan, [this]() {
+        return QStringList(listCANbusInterfaces());
+    });
+    connect(mHotplug, SIGNAL(canInterfacesChanged()), this, SIGNAL(CANbusInterfaceListUpdated()));
 #endif
 
 #ifdef HAS_POS
@@ -220,8 +253,8 @@ VescInterface::VescInterface(QObject *parent) : QObject(parent)
     connect(mTcpServer->packet(), &Packet::packetReceived, [this](QByteArray &packet) {
         mPacket->sendPacket(packet);
     });
-    connect(mPacket, &Packet::packetReceived, [this](QByteArray &packet) {
-        mTcpServer->packet()->sendPacket(packet);
+    connect(mTcpServer, &TcpServerSimple::connectionChanged, [this]() {
+        updateTelemetryCoalescing();
     });
 
     mTimerBroadcast = new QTimer(this);
@@ -256,9 +289,6 @@ VescInterface::VescInterface(QObject *parent) : QObject(parent)
     connect(mUdpServer->packet(), &Packet::packetReceived, [this](QByteArray &packet) {
         mPacket->sendPacket(packet);
     });
-    connect(mPacket, &Packet::packetReceived, [this](QByteArray &packet) {
-        mUdpServer->packet()->sendPacket(packet);
-    });
 
     {
         int size = mSettings.beginReadArray("profiles");
@@ -303,20 +333,42 @@ VescInterface::VescInterface(QObject *parent) : QObject(parent)
         mSettings.endArray();
     }
 
-    {
+    mConfigBackups.open(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+                        "/config_backups");
+
+    // Backups used to be stored in the settings
+    if (mSettings.contains("configurationBackups/size")) {
+        int failed = 0;
         int size = mSettings.beginReadArray("configurationBackups");
         for (int i = 0; i < size; ++i) {
-            CONFIG_BACKUP cfg;
             mSettings.setArrayIndex(i);
             QString uuid = mSettings.value("uuid").toString();
-            cfg.vesc_uuid = uuid;
-            cfg.mcconf_xml_compressed = mSettings.value("mcconf").toString();
-            cfg.appconf_xml_compressed = mSettings.value("appconf").toString();
-            cfg.customconf_xml_compressed = mSettings.value("customconf").toString();
-            cfg.name = mSettings.value("name", QString("")).toString();
-            mConfigurationBackups.insert(uuid, cfg);
+
+            // Migrated on an earlier start where some other backup failed
+            if (mConfigBackups.hasBackup(uuid)) {
+                continue;
+            }
+
+            if (!mConfigBackups.addBackup(
+                        uuid,
+                        mSettings.value("name", QString("")).toString(),
+                        ConfigBackupStore::xmlFromLegacy(mSettings.value("mcconf").toString()),
+                        ConfigBackupStore::xmlFromLegacy(mSettings.value("appconf").toString()),
+                        ConfigBackupStore::xmlFromLegacy(mSettings.value("customconf").toString()))) {
+                qWarning() << "Could not migrate configuration backup for" << uuid;
+                failed++;
+            }
         }
         mSettings.endArray();
+
+        // Keep the old backups until all of them are in the store, so that
+        // the migration is retried on the next start.
+        if (failed == 0 && mConfigBackups.isOpen()) {
+            mSettings.remove("configurationBackups");
+        } else {
+            qWarning() << failed << "of" << size << "configuration backups could not be "
+                                                     "migrated, keeping them in the settings";
+        }
     }
 
     {
@@ -759,24 +811,6 @@ void VescInterface::storeSettings()
     }
     mSettings.endArray();
 
-    mSettings.remove("configurationBackups");
-    {
-        mSettings.beginWriteArray("configurationBackups");
-        QHashIterator<QString, CONFIG_BACKUP> i(mConfigurationBackups);
-        int ind = 0;
-        while (i.hasNext()) {
-            i.next();
-            mSettings.setArrayIndex(ind);
-            mSettings.setValue("uuid", i.key());
-            mSettings.setValue("mcconf", i.value().mcconf_xml_compressed);
-            mSettings.setValue("appconf", i.value().appconf_xml_compressed);
-            mSettings.setValue("customconf", i.value().customconf_xml_compressed);
-            mSettings.setValue("name", i.value().name);
-            ind++;
-        }
-        mSettings.endArray();
-    }
-
     mSettings.remove("lastFwUuids");
     {
         mSettings.beginWriteArray("lastFwUuids");
@@ -2211,7 +2245,7 @@ bool VescInterface::isPortConnected()
     bool res = false;
 
 #ifdef HAS_SERIALPORT
-    if (mSerialPort->isOpen()) {
+    if (mSerialIo->isOpen()) {
         res = true;
     }
 #endif
@@ -2242,9 +2276,8 @@ bool VescInterface::isPortConnected()
 void VescInterface::disconnectPort()
 {
 #ifdef HAS_SERIALPORT
-    if(mSerialPort->isOpen()) {
-        mSerialPort->flush();
-        mSerialPort->close();
+    if(mSerialIo->isOpen()) {
+        mSerialIo->close();
         updateFwRx(false);
     }
 #endif
@@ -2351,46 +2384,37 @@ bool VescInterface::autoconnect()
     bool res = false;
 
 #ifdef HAS_SERIALPORT
-    auto ports = listSerialPorts();
     mAutoconnectOngoing = true;
     mAutoconnectProgress = 0.0;
+    mAutoconnectReport.clear();
 
     disconnectPort();
-    disconnect(mCommands, SIGNAL(fwVersionReceived(FW_RX_PARAMS)),
-               this, SLOT(fwVersionReceived(FW_RX_PARAMS)));
 
-    for (int i = 0;i < ports.size();i++) {
-        VSerialInfo_t serial = ports[i].value<VSerialInfo_t>();
+    QStringList ports;
+    for (auto p: listSerialPorts()) {
+        ports.append(p.value<VSerialInfo_t>().systemPath);
+    }
 
-        if (!connectSerial(serial.systemPath)) {
-            continue;
-        }
+    // All ports are probed at the same time on their own decoders, and only the
+    // chosen one is connected through mSerialIo afterwards.
+    SerialProbe probe;
+    connect(&probe, &SerialProbe::progress, [this](double progress) {
+        mAutoconnectProgress = progress;
+        emit autoConnectProgressUpdated(mAutoconnectProgress, true);
+    });
 
-        mSerialPort->flush();
-        Utility::sleepWithEventLoop(100);
-        mPacket->resetState();
+    auto devices = probe.probe(ports);
+    int best = probe.bestIndex();
+    mAutoconnectReport = probe.report();
 
-        QEventLoop loop;
-        QTimer timeoutTimer;
-        timeoutTimer.setSingleShot(true);
-        timeoutTimer.start(500);
-        connect(mCommands, SIGNAL(fwVersionReceived(FW_RX_PARAMS)), &loop, SLOT(quit()));
-        connect(&timeoutTimer, SIGNAL(timeout()), &loop, SLOT(quit()));
-        loop.exec();
+    if (best >= 0) {
+        res = connectSerial(devices.at(best).port);
 
-        if (timeoutTimer.isActive()) {
-            // If the timer is still running, a firmware version was received.
-            res = true;
-            break;
-        } else {
-            mAutoconnectProgress = double(i) / double(ports.size());
-            emit autoConnectProgressUpdated(mAutoconnectProgress, false);
-            disconnectPort();
+        if (res && devices.size() > 1) {
+            emit statusMessage(tr("Found %1 devices, connected to %2").
+                               arg(devices.size()).arg(devices.at(best).port), true);
         }
     }
-
-    connect(mCommands, SIGNAL(fwVersionReceived(FW_RX_PARAMS)),
-            this, SLOT(fwVersionReceived(FW_RX_PARAMS)));
 #endif
 
     emit autoConnectProgressUpdated(1.0, true);
@@ -2405,8 +2429,8 @@ QString VescInterface::getConnectedPortName()
     bool connected = false;
 
 #ifdef HAS_SERIALPORT
-    if (mSerialPort->isOpen()) {
-        res = tr("Connected (serial) to %1").arg(mSerialPort->portName());
+    if (mSerialIo->isOpen()) {
+        res = tr("Connected (serial) to %1").arg(mSerialIo->portName());
         connected = true;
     }
 #endif
@@ -2468,7 +2492,7 @@ bool VescInterface::connectSerial(QString port, int baudrate)
         return false;
     }
 
-    if(!mSerialPort->isOpen()) {
+    if(!mSerialIo->isOpen()) {
         // TODO: Maybe this test works on other OSes as well
 #ifdef Q_OS_UNIX
         QFileInfo fi(port);
@@ -2481,18 +2505,9 @@ bool VescInterface::connectSerial(QString port, int baudrate)
         }
 #endif
 
-        mSerialPort->setPortName(port);
-        mSerialPort->open(QIODevice::ReadWrite);
-
-        if(!mSerialPort->isOpen()) {
+        if (!mSerialIo->open(port, baudrate)) {
             return false;
         }
-
-        mSerialPort->setBaudRate(baudrate);
-        mSerialPort->setDataBits(QSerialPort::Data8);
-        mSerialPort->setParity(QSerialPort::NoParity);
-        mSerialPort->setStopBits(QSerialPort::OneStop);
-        mSerialPort->setFlowControl(QSerialPort::NoFlowControl);
     }
 
     mLastSerialPort = port;
@@ -2743,6 +2758,30 @@ double VescInterface::getAutoconnectProgress() const
     return mAutoconnectProgress;
 }
 
+/**
+ * @brief VescInterface::getAutoconnectReport
+ * Every device that answered during the last autoconnect, one per line with
+ * the port, hardware type, firmware version and UUID.
+ */
+QString VescInterface::getAutoconnectReport() const
+{
+    return mAutoconnectReport;
+}
+
+/**
+ * @brief VescInterface::serialIoReport
+ * Send latency and receive delay and jitter of the serial I/O thread for the
+ * current connection. Empty when not connected over a serial port.
+ */
+QString VescInterface::serialIoReport() const
+{
+#ifdef HAS_SERIALPORT
+    return mSerialIo->isOpen() ? mSerialIo->report() : QString();
+#else
+    return QString();
+#endif
+}
+
 void VescInterface::scanCANbus()
 {
 #ifdef HAS_CANBUS
@@ -2881,6 +2920,7 @@ void VescInterface::canTmpOverrideEnd()
 bool VescInterface::tcpServerStart(int port)
 {
     bool res = mTcpServer->startServer(port);
+    updateTelemetryCoalescing();
 
     if (!res) {
         emitMessageDialog("Start TCP Server",
@@ -2894,6 +2934,7 @@ bool VescInterface::tcpServerStart(int port)
 void VescInterface::tcpServerStop()
 {
     mTcpServer->stopServer();
+    updateTelemetryCoalescing();
 }
 
 bool VescInterface::tcpServerIsRunning()
@@ -2914,6 +2955,7 @@ QString VescInterface::tcpServerClientIp()
 bool VescInterface::tcpServerConnectToHub(QString server, int port, QString id, QString pass)
 {
     bool res = mTcpServer->connectToHub(server, port, id, pass);
+    updateTelemetryCoalescing();
 
     if (res) {
         mLastTcpHubServer = server;
@@ -2932,6 +2974,7 @@ bool VescInterface::tcpServerConnectToHub(QString server, int port, QString id,
 bool VescInterface::udpServerStart(int port)
 {
     bool res = mUdpServer->startServer(port);
+    updateTelemetryCoalescing();
 
     if (!res) {
         emitMessageDialog("Start UDP Server",
@@ -2945,6 +2988,7 @@ bool VescInterface::udpServerStart(int port)
 void VescInterface::udpServerStop()
 {
     mUdpServer->stopServer();
+    updateTelemetryCoalescing();
 }
 
 bool VescInterface::udpServerIsRunning()
@@ -2968,128 +3012,168 @@ void VescInterface::emitConfigurationChanged()
 }
 
 #ifdef HAS_SERIALPORT
-void VescInterface::serialDataAvailable()
+void VescInterface::serialPortError(QString message)
 {
-    while (mSerialPort->bytesAvailable() > 0) {
-        mPacket->processData(mSerialPort->readAll());
-    }
+    // The I/O thread has already closed the port
+    emit statusMessage(message, false);
+    updateFwRx(false);
 }
+#endif
 
-void VescInterface::serialPortError(QSerialPort::SerialPortError error)
+/**
+ * @brief VescInterface::processCanFrame
+ * Decode a CAN frame from a VESC-based device and pass the packets it completes
+ * to the packet decoder. This is used for frames from the native CAN-bus
+ * interface, and can also be used to replay captured frames.
+ *
+ * @param payload
+ * The frame payload.
+ *
+ * @param id
+ * The frame ID.
+ *
+ * @param isExtended
+ * True if the frame has an extended ID.
+ */
+void VescInterface::processCanFrame(QByteArray payload, quint32 id, bool isExtended)
 {
-    QString message;
-    switch (error) {
-    case QSerialPort::NoError:
-        break;
+    (void)isExtended;
 
-    default:
-        message = "Serial port error: " + mSerialPort->errorString();
-        break;
-    }
+    unsigned short rxbuf_len = 0;
+    unsigned short crc;
+    char commands_send;
 
-    if(!message.isEmpty()) {
-        emit statusMessage(message, false);
+    int packet_type = id >> 8;
 
-        if (mSerialPort->isOpen()) {
-            mSerialPort->close();
+    switch(packet_type) {
+    case CAN_PACKET_PONG:
+        if (payload.size() < 1) {
+            break;
         }
 
-       updateFwRx(false);
-    }
-}
+#ifdef HAS_CANBUS
+        mCanNodesID.append(payload[0]);
 #endif
+        emit CANbusNewNode(payload[0]);
+        break;
 
-#ifdef HAS_CANBUS
-void VescInterface::CANbusDataAvailable()
-{
-    QCanBusFrame frame;
-    QByteArray payload;
-    unsigned short rxbuf_len = 0;
-    unsigned short crc;
-    char commands_send;
+    case CAN_PACKET_PROCESS_SHORT_BUFFER:
+        // Sender ID, send flag and at least one byte of data. The length has
+        // to fit in the one byte length field of the packet.
+        if (payload.size() < 3 || payload.size() > 257) {
+            break;
+        }
 
-    while (mCanDevice->framesAvailable() > 0) {
-        frame = mCanDevice->readFrame();
-        if (frame.isValid() && (frame.frameType() == QCanBusFrame::DataFrame)) {
-            int packet_type = frame.frameId() >> 8;
-            payload = frame.payload();
+        payload.remove(0,2);
 
-            switch(packet_type) {
-            case CAN_PACKET_PONG:
-                mCanNodesID.append(payload[0]);
-                emit CANbusNewNode(payload[0]);
-                break;
+        rxbuf_len = payload.size();
+        crc = Packet::crc16((const unsigned char*)payload.data(), rxbuf_len);
 
-            case CAN_PACKET_PROCESS_SHORT_BUFFER:
-                payload.remove(0,2);
+        // add stop, start, length and crc for the packet decoder
+        payload.prepend((unsigned char) rxbuf_len);
+        payload.prepend(2);
+        payload.append((unsigned char)(crc>>8));
+        payload.append((unsigned char)(crc & 0xFF));
+        payload.append(3);
+        mPacket->processData(payload);
+        break;
 
-                rxbuf_len = payload.size();
-                crc = Packet::crc16((const unsigned char*)payload.data(), rxbuf_len);
+    case CAN_PACKET_FILL_RX_BUFFER:
+        payload.remove(0,1);    // discard index
+        mCanRxBuffer.append(payload);
+        break;
 
-                // add stop, start, length and crc for the packet decoder
-                payload.prepend((unsigned char) rxbuf_len);
-                payload.prepend(2);
-                payload.append((unsigned char)(crc>>8));
-                payload.append((unsigned char)(crc & 0xFF));
-                payload.append(3);
-                mPacket->processData(payload);
-                break;
+    case CAN_PACKET_FILL_RX_BUFFER_LONG:
+        payload.remove(0,2);    // discard the 2 byte index
+        mCanRxBuffer.append(payload);
+        break;
 
-            case CAN_PACKET_FILL_RX_BUFFER:
-                payload.remove(0,1);    // discard index
-                mCanRxBuffer.append(payload);
-                break;
+    case CAN_PACKET_PROCESS_RX_BUFFER: {
+        if (payload.size() < 6) {
+            return;
+        }
 
-            case CAN_PACKET_FILL_RX_BUFFER_LONG:
-                payload.remove(0,2);    // discard the 2 byte index
-                mCanRxBuffer.append(payload);
-                break;
+        commands_send = payload[1];
+        rxbuf_len = (unsigned short)(quint8)payload[2] << 8 | (quint8)payload[3];
 
-            case CAN_PACKET_PROCESS_RX_BUFFER:
-                commands_send = payload[1];
-                rxbuf_len = (unsigned short)payload[2] << 8 | (unsigned char)payload[3];
+        // Frames can come from capture files, so do not trust the length.
+        // The buffer is dropped if it does not hold the whole packet.
+        if (rxbuf_len > 512 || rxbuf_len > mCanRxBuffer.size()) {
+            mCanRxBuffer.clear();
+            return;
+        }
 
-                if (rxbuf_len > 512) {
-                    return;
-                }
-                unsigned char len_high = payload[2];
-                unsigned char len_low = payload[3];
-
-                unsigned char crc_high = payload[4];
-                unsigned char crc_low = payload[5];
-
-                if (Packet::crc16((const unsigned char*)mCanRxBuffer.data(), rxbuf_len) ==
-                        ((unsigned short) crc_high << 8 | (unsigned short) crc_low)) {
-                    switch (commands_send) {
-                        case 0:
-                            break;
-                        case 1:
-                            // add stop, start, length and crc for the packet decoder
-                            if (len_high == 0) {
-                                mCanRxBuffer.prepend(len_low);
-                                mCanRxBuffer.prepend(2);
-                            } else {
-                                mCanRxBuffer.prepend(len_low);
-                                mCanRxBuffer.prepend(len_high);
-                                mCanRxBuffer.prepend(3); // size is 16 bit long
-                            }
-
-                            mCanRxBuffer.append(crc_high);
-                            mCanRxBuffer.append(crc_low);
-                            mCanRxBuffer.append(3);
-                            mPacket->processData(mCanRxBuffer);
-                            break;
-                        case 2:
-                            //commands_process_packet(rx_buffer, rxbuf_len, 0);
-                            break;
-                        default:
-                            break;
+        mCanRxBuffer.truncate(rxbuf_len);
+        unsigned char len_high = payload[2];
+        unsigned char len_low = payload[3];
+
+        unsigned char crc_high = payload[4];
+        unsigned char crc_low = payload[5];
+
+        if (Packet::crc16((const unsigned char*)mCanRxBuffer.data(), rxbuf_len) ==
+                ((unsigned short) crc_high << 8 | (unsigned short) crc_low)) {
+            switch (commands_send) {
+                case 0:
+                    break;
+                case 1:
+                    // add stop, start, length and crc for the packet decoder
+                    if (len_high == 0) {
+                        mCanRxBuffer.prepend(len_low);
+                        mCanRxBuffer.prepend(2);
+                    } else {
+                        mCanRxBuffer.prepend(len_low);
+                        mCanRxBuffer.prepend(len_high);
+                        mCanRxBuffer.prepend(3); // size is 16 bit long
                     }
-                }
-                mCanRxBuffer.clear();
-                break;
+
+                    mCanRxBuffer.append(crc_high);
+                    mCanRxBuffer.append(crc_low);
+                    mCanRxBuffer.append(3);
+                    mPacket->processData(mCanRxBuffer);
+                    break;
+                case 2:
+                    //commands_process_packet(rx_buffer, rxbuf_len, 0);
+                    break;
+                default:
+                    break;
             }
         }
+        mCanRxBuffer.clear();
+    } break;
+
+    default:
+        break;
+    }
+}
+
+#ifdef HAS_CANBUS
+void VescInterface::CANbusDataAvailable()
+{
+    // Same as queueRxData, the frames are read and processed once this
+    // signal has returned.
+    if (!mCanRxScheduled) {
+        mCanRxScheduled = true;
+        QTimer::singleShot(0, this, [this]() {
+            mCanRxScheduled = false;
+            CANbusReadFrames();
+        });
+    }
+}
+
+void VescInterface::CANbusReadFrames()
+{
+    if (!mCanDevice) {
+        return;
+    }
+
+    QCanBusFrame frame;
+
+    while (mCanDevice->framesAvailable() > 0) {
+        frame = mCanDevice->readFrame();
+        if (frame.isValid() && (frame.frameType() == QCanBusFrame::DataFrame)) {
+            emit CANbusFrameRx(frame.payload(), frame.frameId(), frame.hasExtendedFrameFormat());
+            processCanFrame(frame.payload(), frame.frameId(), frame.hasExtendedFrameFormat());
+        }
     }
 }
 
@@ -3166,7 +3250,7 @@ void VescInterface::tcpInputDisconnected()
 void VescInterface::tcpInputDataAvailable()
 {
     while (mTcpSocket->bytesAvailable() > 0) {
-        mPacket->processData(mTcpSocket->readAll());
+        queueRxData(mTcpSocket->readAll());
     }
 }
 
@@ -3174,7 +3258,7 @@ void VescInterface::udpInputDataAvailable()
 {
     while (mUdpSocket->hasPendingDatagrams()) {
         QNetworkDatagram datagram = mUdpSocket->receiveDatagram();
-        mPacket->processData(datagram.data());
+        queueRxData(datagram.data());
     }
 }
 
@@ -3213,26 +3297,6 @@ void VescInterface::bleUnintentionalDisconnect()
 
 void VescInterface::timerSlot()
 {
-    // Poll the serial port as well since readyRead is not emitted recursively. This
-    // can be a problem when waiting for input with an additional event loop, such as
-    // when using QMessageBox.
-#ifdef HAS_SERIALPORT
-    serialDataAvailable();
-#endif
-#ifdef HAS_CANBUS
-    if (mCanDevice != nullptr) {
-        CANbusDataAvailable();
-    }
-#endif
-    tcpInputDataAvailable();
-
-#ifdef HAS_CANBUS
-    if (mCanDeviceInterfaces != listCANbusInterfaces()) {
-        mCanDeviceInterfaces = listCANbusInterfaces();
-        emit CANbusInterfaceListUpdated();
-    }
-#endif
-
     if (!mIgnoreCanChange) {
         if (isPortConnected()) {
             if (mSendCanBefore != mCommands->getSendCan() ||
@@ -3242,10 +3306,17 @@ void VescInterface::timerSlot()
                 mFwRetries = 0;
             }
 
+            // The first request is sent right away, retries every 4th tick
             mFwPollCnt++;
-            if (mFwPollCnt >= 4) {
+            if (mFwPollCnt >= 4 || (mFwRetries == 0 && !mFwVersionReceived)) {
                 mFwPollCnt = 0;
                 if (!mFwVersionReceived) {
+                    if (mFwRetries == 0 && !mConnectTimingActive) {
+                        mConnectTimer.start();
+                        mConnectTimingActive = true;
+                        mConnectPhases.clear();
+                    }
+
                     mCommands->getFwVersion();
                     mFwRetries++;
 
@@ -3266,6 +3337,7 @@ void VescInterface::timerSlot()
         } else {
             updateFwRx(false);
             mFwRetries = 0;
+            mConnectTimingActive = false;
         }
         mSendCanBefore = mCommands->getSendCan();
         mCanIdBefore = mCommands->getCanSendId();
@@ -3312,19 +3384,52 @@ void VescInterface::timerSlot()
             }
 
             mDeserialFailedMessageShown = false;
+            mRxPending.clear();
             mPacket->resetState();
             mFwSwapDone = false;
         }
 
         emit portConnectedChanged();
     }
+
+    // Nothing here needs a fast tick while disconnected. The connection
+    // paths speed it up again in setLastConnectionType.
+    int interval = isPortConnected() ? timerIntervalConnected : timerIntervalIdle;
+    if (mTimer->interval() != interval) {
+        mTimer->setInterval(interval);
+    }
+}
+
+/**
+ * @brief VescInterface::queueRxData
+ * Queue received bytes for the packet decoder. The decoding is done right after
+ * the readyRead signal has returned instead of inside it. Qt does not emit
+ * readyRead again while a slot connected to it is running, so processing the
+ * packets there would stall the link whenever a packet handler starts another
+ * event loop, e.g. in a message box or in Utility::waitSignal.
+ */
+void VescInterface::queueRxData(const QByteArray &data)
+{
+    mRxPending.append(data);
+
+    if (!mRxScheduled) {
+        mRxScheduled = true;
+        QTimer::singleShot(0, this, [this]() {
+            mRxScheduled = false;
+            QByteArray data;
+            data.swap(mRxPending);
+            if (!data.isEmpty()) {
+                mPacket->processData(data);
+            }
+        });
+    }
 }
 
 void VescInterface::packetDataToSend(QByteArray &data)
 {
 #ifdef HAS_SERIALPORT
-    if (mSerialPort->isOpen()) {
-        mSerialPort->write(data);
+    if (mSerialIo->isOpen()) {
+        mSerialIo->write(data);
     }
 #endif
 
@@ -3451,6 +3556,9 @@ void VescInterface::packetDataToSend(QByteArray &data)
 
 void VescInterface::packetReceived(QByteArray &data)
 {
+    // Packets come from mPacket, or already decoded from the serial I/O thread
+    mTcpServer->packet()->sendPacket(data);
+    mUdpServer->packet()->sendPacket(data);
     mCommands->processPacket(data);
 }
 
@@ -3467,6 +3575,7 @@ void VescInterface::fwVersionReceived(FW_RX_PARAMS params)
     }
 
     mLastFwParams = params;
+    connectPhaseDone("Firmware version");
 
     QString uuidStr = Utility::uuid2Str(params.uuid, true);
     mUuidStr = uuidStr.toUpper();
@@ -3485,6 +3594,7 @@ void VescInterface::fwVersionReceived(FW_RX_PARAMS params)
         if (pair.second >= 0 && pair.first != mUuidStr && !mFwSwapDone && !mBlockFwSwap) {
             FW_RX_PARAMS pRx;
             bool ok = Utility::getFwVersionBlockingCan(this, &pRx, pair.second, 1500);
+            connectPhaseDone("Reconnect last CAN device");
             if (ok && Utility::uuid2Str(pRx.uuid, false) == pair.first) {
                 mCommands->setSendCan(true, pair.second);
                 return;
@@ -3766,6 +3876,7 @@ void VescInterface::fwVersionReceived(FW_RX_PARAMS params)
     }
 
     mCommands->setLimitedCompatibilityCommands(compCommands);
+    connectPhaseDone("Configuration parser");
 
     bool wasReceived = mFwVersionReceived;
     mCommands->setLimitedMode(false);
@@ -3884,273 +3995,212 @@ void VescInterface::fwVersionReceived(FW_RX_PARAMS params)
         mCustomConfigs.removeLast();
     }
 
-    // Read custom configs
-    if (!mIgnoreCustomConfigs && params.customConfigNum > 0) {
-        bool readConfigsOk = true;
-        for (int i = 0;i < params.customConfigNum;i++) {
-            QString confCacheFile;
-            if (!confCacheDir.isEmpty()) {
-                confCacheFile = confCacheDir + "/conf_custom_" + QString::number(i) + ".bin";
-            }
-
-            if (!confCacheFile.isEmpty()) {
-                QFile f(confCacheFile);
-                if (f.exists() && f.open(QIODevice::ReadOnly)) {
-                    mCustomConfigs.append(new ConfigParams(this));
-                    connect(mCustomConfigs.last(), &ConfigParams::updateRequested, [this]() {
-                        mCommands->customConfigGet(mCustomConfigs.size() - 1, false);
-                    });
-                    connect(mCustomConfigs.last(), &ConfigParams::updateRequestDefault, [this]() {
-                        mCommands->customConfigGet(mCustomConfigs.size() - 1, true);
-                    });
-
-                    auto confData = f.readAll();
-                    f.close();
+    auto addCustomConfig = [this](ConfigParams *conf) {
+        mCustomConfigs.append(conf);
+        connect(mCustomConfigs.last(), &ConfigParams::updateRequested, [this]() {
+            mCommands->customConfigGet(mCustomConfigs.size() - 1, false);
+        });
+        connect(mCustomConfigs.last(), &ConfigParams::updateRequestDefault, [this]() {
+            mCommands->customConfigGet(mCustomConfigs.size() - 1, true);
+        });
+    };
 
-                    if (mCustomConfigs.last()->loadCompressedParamsXml(confData)) {
-                        emitStatusMessage(QString("Got cached %1").arg(mCustomConfigs.last()->getLongName("hw_name")), true);
-                        continue;
-                    } else {
-                        mCustomConfigs.last()->deleteLater();
-                        mCustomConfigs.removeLast();
-                    }
-                }
+    auto cacheWrite = [this](QString fileName, const QByteArray &data) {
+        if (!fileName.isEmpty()) {
+            QFile f(fileName);
+            if (f.open(QIODevice::WriteOnly)) {
+                f.write(data);
+                f.close();
+                emitStatusMessage(QString("Cached %1").arg(fileName), true);
             }
+        }
+    };
 
-            QByteArray configData;
-            int confIndLast = 0;
-            int lenConfLast = -1;
-            auto conn = connect(mCommands, &Commands::customConfigChunkRx,
-                    [&](int confInd, int lenConf, int ofsConf, QByteArray data) {
-                if (configData.size() <= ofsConf) {
-                    configData.append(data);
-                }
-                confIndLast = confInd;
-                lenConfLast = lenConf;
-            });
+    // Everything that is not in the cache is fetched at the same time. The
+    // custom configs and the QML UIs have separate replies, so the chunks
+    // cannot get mixed up.
+    QVector<ChunkFetch*> fetches;
 
-            auto getChunk = [&](int size, int offset, int tries, int timeout) {
-                bool res = false;
+    bool readCustomConfigs = !mIgnoreCustomConfigs && params.customConfigNum > 0;
+    QVector<ConfigParams*> cachedConfigs;
+    QVector<ChunkFetch*> configFetches;
 
-                for (int j = 0;j < tries;j++) {
-                    mCommands->customConfigGetChunk(i, size, offset);
-                    res = Utility::waitSignal(mCommands, SIGNAL(customConfigChunkRx(int,int,int,QByteArray)), timeout);
-                    if (res) {
-                        break;
-                    }
-                }
-                return res;
-            };
+    if (readCustomConfigs) {
+        for (int i = 0;i < params.customConfigNum;i++) {
+            ConfigParams *cached = nullptr;
 
-            if (getChunk(10, 0, 5, 1500)) {
-                while (configData.size() < lenConfLast) {
-                    int dataLeft = lenConfLast - configData.size();
-                    if (!getChunk(dataLeft > 400 ? 400 : dataLeft, configData.size(), 5, 1500)) {
-                        break;
+            if (!confCacheDir.isEmpty()) {
+                QFile f(confCacheDir + "/conf_custom_" + QString::number(i) + ".bin");
+                if (f.exists() && f.open(QIODevice::ReadOnly)) {
+                    cached = new ConfigParams(this);
+                    if (!cached->loadCompressedParamsXml(f.readAll())) {
+                        cached->deleteLater();
+                        cached = nullptr;
                     }
+                    f.close();
                 }
+            }
 
-                if (configData.size() == lenConfLast) {
-                    mCustomConfigs.append(new ConfigParams(this));
-                    connect(mCustomConfigs.last(), &ConfigParams::updateRequested, [this]() {
-                        mCommands->customConfigGet(mCustomConfigs.size() - 1, false);
-                    });
-                    connect(mCustomConfigs.last(), &ConfigParams::updateRequestDefault, [this]() {
-                        mCommands->customConfigGet(mCustomConfigs.size() - 1, true);
-                    });
-
-                    if (!mCustomConfigs.last()->loadCompressedParamsXml(configData)) {
-                        readConfigsOk = false;
-                        disconnect(conn);
-                        break;
-                    }
-
-                    emitStatusMessage(QString("Got %1").arg(mCustomConfigs.last()->getLongName("hw_name")), true);
-
-                    if (!confCacheFile.isEmpty()) {
-                        QFile f(confCacheFile);
-                        if (f.open(QIODevice::WriteOnly)) {
-                            f.write(configData);
-                            f.close();
-                            emitStatusMessage(QString("Cached %1").arg(confCacheFile), true);
-                        }
+            ChunkFetch *fetch = nullptr;
+            if (!cached) {
+                fetch = new ChunkFetch([this, i](int len, int offset) {
+                    mCommands->customConfigGetChunk(i, len, offset);
+                }, this);
+                connect(mCommands, &Commands::customConfigChunkRx, fetch,
+                        [fetch, i](int confInd, int lenConf, int ofsConf, QByteArray data) {
+                    if (confInd == i) {
+                        fetch->chunkReceived(lenConf, ofsConf, data);
                     }
-                } else {
-                    emitMessageDialog("Get Custom Config",
-                                      "Could not read custom config from hardware",
-                                      false, false);
-                    readConfigsOk = false;
-                    disconnect(conn);
-                    break;
-                }
+                });
+                fetches.append(fetch);
             }
 
-            disconnect(conn);
+            cachedConfigs.append(cached);
+            configFetches.append(fetch);
         }
-
-        mCustomConfigsLoaded = readConfigsOk;
     }
 
-    // Read qmlui HW
-    if (mLoadQmlUiOnConnect && params.hasQmlHw) {
-        bool cacheLoadOk = false;
-
-        QString confCacheFile;
+    auto readQmlCache = [&confCacheDir](QString name, QByteArray &data) {
         if (!confCacheDir.isEmpty()) {
-            confCacheFile = confCacheDir + "/qml_hw.bin";
-        }
-
-        if (!confCacheFile.isEmpty()) {
-            QFile f(confCacheFile);
+            QFile f(confCacheDir + "/" + name);
             if (f.exists() && f.open(QIODevice::ReadOnly)) {
-                auto qmlData = f.readAll();
+                data = f.readAll();
                 f.close();
-
-                mQmlHw = QString::fromUtf8(qUncompress(qmlData));
-                mQmlHwLoaded = true;
-                emitStatusMessage("Got cached qmlui HW", true);
-                cacheLoadOk = true;
+                return true;
             }
         }
+        return false;
+    };
 
-        if (!cacheLoadOk) {
-            QByteArray qmlData;
-            int lenQmlLast = -1;
-            auto conn = connect(mCommands, &Commands::qmluiHwRx,
-                                [&](int lenQml, int ofsQml, QByteArray data) {
-                if (qmlData.size() <= ofsQml) {
-                    qmlData.append(data);
-                }
-                lenQmlLast = lenQml;
-            });
+    QByteArray qmlHwCached;
+    ChunkFetch *qmlHwFetch = nullptr;
+    bool readQmlHw = mLoadQmlUiOnConnect && params.hasQmlHw;
+    if (readQmlHw && !readQmlCache("qml_hw.bin", qmlHwCached)) {
+        qmlHwFetch = new ChunkFetch([this](int len, int offset) {
+            mCommands->qmlUiHwGet(len, offset);
+        }, this);
+        connect(mCommands, &Commands::qmluiHwRx, qmlHwFetch, &ChunkFetch::chunkReceived);
+        fetches.append(qmlHwFetch);
+    }
 
-            auto getQmlChunk = [&](int size, int offset, int tries, int timeout) {
-                bool res = false;
+    QByteArray qmlAppCached;
+    ChunkFetch *qmlAppFetch = nullptr;
+    bool readQmlApp = mLoadQmlUiOnConnect && params.hasQmlApp;
+    if (readQmlApp && !readQmlCache("qml_app.bin", qmlAppCached)) {
+        qmlAppFetch = new ChunkFetch([this](int len, int offset) {
+            mCommands->qmlUiAppGet(len, offset);
+        }, this);
+        connect(mCommands, &Commands::qmluiAppRx, qmlAppFetch, &ChunkFetch::chunkReceived);
+        fetches.append(qmlAppFetch);
+    }
 
-                for (int j = 0;j < tries;j++) {
-                    mCommands->qmlUiHwGet(size, offset);
-                    res = Utility::waitSignal(mCommands, SIGNAL(qmluiHwRx(int,int,QByteArray)), timeout);
-                    if (res) {
-                        break;
-                    }
-                }
-                return res;
-            };
+    if (!fetches.isEmpty()) {
+        ChunkFetch::fetchAll(fetches);
+        connectPhaseDone("Fetch custom configs and QML");
+    }
 
-            if (getQmlChunk(10, 0, 5, 1500)) {
-                while (qmlData.size() < lenQmlLast) {
-                    int dataLeft = lenQmlLast - qmlData.size();
-                    if (!getQmlChunk(dataLeft > 400 ? 400 : dataLeft, qmlData.size(), 5, 1500)) {
-                        break;
-                    }
-                }
+    // Custom configs
+    if (readCustomConfigs) {
+        bool readConfigsOk = true;
+        for (int i = 0;i < params.customConfigNum;i++) {
+            if (cachedConfigs.at(i)) {
+                addCustomConfig(cachedConfigs.at(i));
+                cachedConfigs[i] = nullptr;
+                emitStatusMessage(QString("Got cached %1").arg(mCustomConfigs.last()->getLongName("hw_name")), true);
+                continue;
+            }
 
-                if (qmlData.size() == lenQmlLast) {
-                    mQmlHw = QString::fromUtf8(qUncompress(qmlData));
-                    mQmlHwLoaded = true;
-                    emitStatusMessage("Got qmlui HW", true);
-
-                    if (!confCacheFile.isEmpty()) {
-                        QFile f(confCacheFile);
-                        if (f.open(QIODevice::WriteOnly)) {
-                            f.write(qmlData);
-                            f.close();
-                            emitStatusMessage(QString("Cached %1").arg(confCacheFile), true);
-                        }
-                    }
-                } else {
-                    mQmlHwLoaded = false;
-                    emitMessageDialog("Get qmlui HW",
-                                      "Could not read qmlui HW from hardware",
-                                      false, false);
-                    disconnect(conn);
-                }
+            ChunkFetch *fetch = configFetches.at(i);
+
+            // No reply at all means that there is nothing to read
+            if (fetch->totalSize() < 0) {
+                continue;
             }
 
-            disconnect(conn);
-        }
-    }
+            if (fetch->isOk()) {
+                QByteArray configData = fetch->data();
+                addCustomConfig(new ConfigParams(this));
 
-    // Read qmlui APP
-    if (mLoadQmlUiOnConnect && params.hasQmlApp) {
-        bool cacheLoadOk = false;
+                if (!mCustomConfigs.last()->loadCompressedParamsXml(configData)) {
+                    readConfigsOk = false;
+                    break;
+                }
 
-        QString confCacheFile;
-        if (!confCacheDir.isEmpty()) {
-            confCacheFile = confCacheDir + "/qml_app.bin";
-        }
+                emitStatusMessage(QString("Got %1").arg(mCustomConfigs.last()->getLongName("hw_name")), true);
 
-        if (!confCacheFile.isEmpty()) {
-            QFile f(confCacheFile);
-            if (f.exists() && f.open(QIODevice::ReadOnly)) {
-                auto qmlData = f.readAll();
-                f.close();
+                if (!confCacheDir.isEmpty()) {
+                    cacheWrite(confCacheDir + "/conf_custom_" + QString::number(i) + ".bin", configData);
+                }
+            } else {
+                emitMessageDialog("Get Custom Config",
+                                  "Could not read custom config from hardware",
+                                  false, false);
+                readConfigsOk = false;
+                break;
+            }
+        }
 
-                mQmlApp = QString::fromUtf8(qUncompress(qmlData));
-                mQmlAppLoaded = true;
-                emitStatusMessage("Got cached qmlui App", true);
-                cacheLoadOk = true;
+        for (auto c: cachedConfigs) {
+            if (c) {
+                c->deleteLater();
             }
         }
 
-        if (!cacheLoadOk) {
-            QByteArray qmlData;
-            int lenQmlLast = -1;
-            auto conn = connect(mCommands, &Commands::qmluiAppRx,
-                                [&](int lenQml, int ofsQml, QByteArray data) {
-                if (qmlData.size() <= ofsQml) {
-                    qmlData.append(data);
-                }
-                lenQmlLast = lenQml;
-            });
+        mCustomConfigsLoaded = readConfigsOk;
+    }
 
-            auto getQmlChunk = [&](int size, int offset, int tries, int timeout) {
-                bool res = false;
+    // qmlui HW
+    if (readQmlHw) {
+        if (!qmlHwFetch) {
+            mQmlHw = QString::fromUtf8(qUncompress(qmlHwCached));
+            mQmlHwLoaded = true;
+            emitStatusMessage("Got cached qmlui HW", true);
+        } else if (qmlHwFetch->totalSize() >= 0) {
+            if (qmlHwFetch->isOk()) {
+                QByteArray qmlData = qmlHwFetch->data();
+                mQmlHw = QString::fromUtf8(qUncompress(qmlData));
+                mQmlHwLoaded = true;
+                emitStatusMessage("Got qmlui HW", true);
 
-                for (int j = 0;j < tries;j++) {
-                    mCommands->qmlUiAppGet(size, offset);
-                    res = Utility::waitSignal(mCommands, SIGNAL(qmluiAppRx(int,int,QByteArray)), timeout);
-                    if (res) {
-                        break;
-                    }
+                if (!confCacheDir.isEmpty()) {
+                    cacheWrite(confCacheDir + "/qml_hw.bin", qmlData);
                 }
-                return res;
-            };
+            } else {
+                mQmlHwLoaded = false;
+                emitMessageDialog("Get qmlui HW",
+                                  "Could not read qmlui HW from hardware",
+                                  false, false);
+            }
+        }
+    }
 
-            if (getQmlChunk(10, 0, 5, 1500)) {
-                while (qmlData.size() < lenQmlLast) {
-                    int dataLeft = lenQmlLast - qmlData.size();
-                    if (!getQmlChunk(dataLeft > 400 ? 400 : dataLeft, qmlData.size(), 5, 1500)) {
-                        break;
-                    }
-                }
+    // qmlui App
+    if (readQmlApp) {
+        if (!qmlAppFetch) {
+            mQmlApp = QString::fromUtf8(qUncompress(qmlAppCached));
+            mQmlAppLoaded = true;
+            emitStatusMessage("Got cached qmlui App", true);
+        } else if (qmlAppFetch->totalSize() >= 0) {
+            if (qmlAppFetch->isOk()) {
+                QByteArray qmlData = qmlAppFetch->data();
+                mQmlApp = QString::fromUtf8(qUncompress(qmlData));
+                mQmlAppLoaded = true;
+                emitStatusMessage("Got qmlui App", true);
 
-                if (qmlData.size() == lenQmlLast) {
-                    mQmlApp = QString::fromUtf8(qUncompress(qmlData));
-                    mQmlAppLoaded = true;
-                    emitStatusMessage("Got qmlui App", true);
-
-                    if (!confCacheFile.isEmpty()) {
-                        QFile f(confCacheFile);
-                        if (f.open(QIODevice::WriteOnly)) {
-                            f.write(qmlData);
-                            f.close();
-                            emitStatusMessage(QString("Cached %1").arg(confCacheFile), true);
-                        }
-                    }
-                } else {
-                    mQmlAppLoaded = false;
-                    emitMessageDialog("Get qmlui App",
-                                      "Could not read qmlui App from hardware",
-                                      false, false);
-                    disconnect(conn);
+                if (!confCacheDir.isEmpty()) {
+                    cacheWrite(confCacheDir + "/qml_app.bin", qmlData);
                 }
+            } else {
+                mQmlAppLoaded = false;
+                emitMessageDialog("Get qmlui App",
+                                  "Could not read qmlui App from hardware",
+                                  false, false);
             }
-
-            disconnect(conn);
         }
     }
 
+    qDeleteAll(fetches);
+
     if (params.hasQmlApp || params.hasQmlHw) {
         emit qmlLoadDone();
     }
@@ -4160,17 +4210,20 @@ void VescInterface::fwVersionReceived(FW_RX_PARAMS params)
     }
 
     mCustomConfigRxDone = true;
+    connectPhaseDone("Ready");
     emit customConfigLoadDone();
 }
 
 void VescInterface::appconfUpdated()
 {
     emit statusMessage(tr("App config updated"), true);
+    connectPhaseDone("App configuration");
 }
 
 void VescInterface::mcconfUpdated()
 {
     emit statusMessage(tr("Motor config updated"), true);
+    connectPhaseDone("Motor configuration");
 
     if (isPortConnected() && fwRx()) {
         QPair<int, int> fw_connected = qMakePair(mLastFwParams.major, mLastFwParams.minor);
@@ -4552,17 +4605,13 @@ bool VescInterface::confStoreBackup(bool can, QString name)
         }
 
         if (rxMc && rxApp) {
-            CONFIG_BACKUP cfg;
-            cfg.name = name;
-            cfg.vesc_uuid = uuid;
-            cfg.mcconf_xml_compressed = pMc->saveCompressed("mcconf");
-            cfg.appconf_xml_compressed = pApp->saveCompressed("appconf");
-
-            if (rxCustom) {
-                cfg.customconf_xml_compressed = pCustom->saveCompressed("customconf");
+            if (!mConfigBackups.addBackup(uuid, name,
+                                          pMc->getXmlData("mcconf"),
+                                          pApp->getXmlData("appconf"),
+                                          rxCustom ? pCustom->getXmlData("customconf") : QByteArray())) {
+                emitMessageDialog("Backup Configuration", "Could not write backup.", false, false);
+                return false;
             }
-
-            mConfigurationBackups.insert(uuid, cfg);
             return true;
         } else {
             emitMessageDialog("Backup Configuration", "Reading configuration timed out.", false, false);
@@ -4570,45 +4619,27 @@ bool VescInterface::confStoreBackup(bool can, QString name)
         }
     };
 
-    bool res = true;
-
-    bool canLastFwd = commands()->getSendCan();
-    int canLastId = commands()->getCanSendId();
     auto fwLast = getFirmwareNowPair();
-
     QVector<int> canDevs;
 
     if (can) {
         canDevs = scanCan();
-        ignoreCanChange(true);
-        commands()->setSendCan(false);
     }
 
-    FW_RX_PARAMS fwp;
-    Utility::getFwVersionBlocking(this, &fwp);
-
-    if (fwp.hwType == HW_TYPE_VESC) {
-        res = storeConf();
-    }
-
-    if (res && can) {
-        foreach (int d, canDevs) {
-            commands()->setSendCan(true, d);
-
-            Utility::getFwVersionBlocking(this, &fwp);
-
-            if (fwp.hwType == HW_TYPE_VESC) {
-                res = storeConf();
-            }
+    // The configurations are read one VESC at a time, as the replies do
+    // not say where they come from.
+    CanFanout fanout(this);
+    fanout.probe(canDevs, true, false);
+    bool res = fanout.forEach([&storeConf](CanFanout::Node &) {
+        return storeConf();
+    });
+    fanout.restoreCan();
 
-            if (!res) {
-                break;
-            }
-        }
+    if (!res) {
+        emitMessageDialog("Backup Configuration",
+                          "Not all VESCs could be backed up:\n\n" + fanout.report(),
+                          false, false);
     }
-
-    commands()->setSendCan(canLastFwd, canLastId);
-    ignoreCanChange(false);
     if (!getSupportedFirmwarePairs().contains(fwLast)) {
         Utility::configLoad(this, fwLast.first, fwLast.second);
     }
@@ -4674,12 +4705,13 @@ bool VescInterface::confRestoreBackup(bool can)
         }
 
         if (rxMc && rxApp) {
-            if (mConfigurationBackups.contains(uuid)) {
-                pMc->loadCompressed(mConfigurationBackups[uuid].mcconf_xml_compressed, "mcconf");
-                pApp->loadCompressed(mConfigurationBackups[uuid].appconf_xml_compressed, "appconf");
+            if (mConfigBackups.hasBackup(uuid)) {
+                auto backup = mConfigBackups.latest(uuid);
+                pMc->setXmlData(mConfigBackups.readConf(backup, ConfigBackupStore::ConfMc), "mcconf");
+                pApp->setXmlData(mConfigBackups.readConf(backup, ConfigBackupStore::ConfApp), "appconf");
 
                 if (rxCustom) {
-                    pCustom->loadCompressed(mConfigurationBackups[uuid].customconf_xml_compressed, "customconf");
+                    pCustom->setXmlData(mConfigBackups.readConf(backup, ConfigBackupStore::ConfCustom), "customconf");
                 }
 
                 // Try a few times, as BLE seems to drop the response sometimes.
@@ -4728,44 +4760,27 @@ bool VescInterface::confRestoreBackup(bool can)
         }
     };
 
-    bool res = true;
-
-    bool canLastFwd = commands()->getSendCan();
-    int canLastId = commands()->getCanSendId();
     auto fwLast = getFirmwareNowPair();
     QVector<int> canDevs;
 
     if (can) {
         canDevs = scanCan();
-        ignoreCanChange(true);
-        commands()->setSendCan(false);
-    }
-
-    FW_RX_PARAMS fwp;
-    Utility::getFwVersionBlocking(this, &fwp);
-
-    if (fwp.hwType == HW_TYPE_VESC) {
-        res = restoreConf();
     }
 
-    if (res && can) {
-        foreach (int d, canDevs) {
-            commands()->setSendCan(true, d);
-
-            Utility::getFwVersionBlocking(this, &fwp);
-
-            if (fwp.hwType == HW_TYPE_VESC) {
-                res = restoreConf();
-            }
+    // The configurations are read one VESC at a time, as the replies do
+    // not say where they come from.
+    CanFanout fanout(this);
+    fanout.probe(canDevs, true, false);
+    bool res = fanout.forEach([&restoreConf](CanFanout::Node &) {
+        return restoreConf();
+    });
+    fanout.restoreCan();
 
-            if (!res) {
-                break;
-            }
-        }
+    if (!res) {
+        emitMessageDialog("Restore Configuration",
+                          "Not all VESCs could be restored:\n\n" + fanout.report(),
+                          false, false);
     }
-
-    commands()->setSendCan(canLastFwd, canLastId);
-    ignoreCanChange(false);
     if (!getSupportedFirmwarePairs().contains(fwLast)) {
         Utility::configLoad(this, fwLast.first, fwLast.second);
     }
@@ -4809,9 +4824,10 @@ bool VescInterface::confRestoreBackup(bool can)
 
 bool VescInterface::confLoadBackup(QString uuid)
 {
-    if (mConfigurationBackups.contains(uuid)) {
-        mMcConfig->loadCompressed(mConfigurationBackups[uuid].mcconf_xml_compressed, "mcconf");
-        mAppConfig->loadCompressed(mConfigurationBackups[uuid].appconf_xml_compressed, "appconf");
+    if (mConfigBackups.hasBackup(uuid)) {
+        auto backup = mConfigBackups.latest(uuid);
+        mMcConfig->setXmlData(mConfigBackups.readConf(backup, ConfigBackupStore::ConfMc), "mcconf");
+        mAppConfig->setXmlData(mConfigBackups.readConf(backup, ConfigBackupStore::ConfApp), "appconf");
         return true;
     } else {
         return false;
@@ -4820,30 +4836,18 @@ bool VescInterface::confLoadBackup(QString uuid)
 
 QStringList VescInterface::confListBackups()
 {
-    QStringList res;
-    QHashIterator<QString, CONFIG_BACKUP> i(mConfigurationBackups);
-    while (i.hasNext()) {
-        i.next();
-        res.append(i.key());
-    }
-
-    return res;
+    return mConfigBackups.uuids();
 }
 
 void VescInterface::confClearBackups()
 {
-    mConfigurationBackups.clear();
-    storeSettings();
+    mConfigBackups.clear();
     emit configurationBackupsChanged();
 }
 
 QString VescInterface::confBackupName(QString uuid)
 {
-    QString res;
-    if (mConfigurationBackups.contains(uuid)) {
-        res = mConfigurationBackups[uuid].name;
-    }
-    return res;
+    return mConfigBackups.latest(uuid).name;
 }
 
 bool VescInterface::deserializeFailedSinceConnected()
@@ -4875,6 +4879,37 @@ bool VescInterface::customConfigRxDone()
     return mCustomConfigRxDone;
 }
 
+/**
+ * @brief VescInterface::connectTimingReport
+ * The phases of the last connection bring-up, one per line with the time of
+ * the phase and the time since the first firmware version request.
+ */
+QString VescInterface::connectTimingReport()
+{
+    QString res;
+    qint64 last = 0;
+    for (const auto &p: mConnectPhases) {
+        res += QString("%1: %2 ms (%3 ms)\n").arg(p.first).arg(p.second - last).arg(p.second);
+        last = p.second;
+    }
+    return res;
+}
+
+/**
+ * @brief VescInterface::connectTimeMs
+ * Time from the first firmware version request until the connection was
+ * ready, or -1 if it is not ready yet.
+ */
+qint64 VescInterface::connectTimeMs()
+{
+    for (const auto &p: mConnectPhases) {
+        if (p.first == "Ready") {
+            return p.second;
+        }
+    }
+    return -1;
+}
+
 ConfigParams *VescInterface::customConfig(int configNum)
 {
     if (customConfigsLoaded() && configNum < mCustomConfigs.size()) {
@@ -4904,6 +4939,23 @@ QString VescInterface::qmlApp()
     return mQmlAppLoaded ? mQmlApp : "";
 }
 
+void VescInterface::connectPhaseDone(QString name)
+{
+    if (!mConnectTimingActive) {
+        return;
+    }
+
+    // Phases such as reading the configurations happen again later
+    for (const auto &p: mConnectPhases) {
+        if (p.first == name) {
+            return;
+        }
+    }
+
+    mConnectPhases.append(qMakePair(name, mConnectTimer.elapsed()));
+    emit connectTimingsUpdated();
+}
+
 void VescInterface::updateFwRx(bool fwRx)
 {
     bool change = mFwVersionReceived != fwRx;
@@ -4924,4 +4976,25 @@ void VescInterface::setLastConnectionType(conn_t type)
 {
     mLastConnType = type;
     mSettings.setValue("connection_type", type);
+
+    // Called when a connection has been made, so start polling the firmware
+    // version right away instead of on the next idle tick.
+    if (mTimer->interval() != timerIntervalConnected) {
+        mTimer->start(timerIntervalConnected);
+    }
+}
+
+/**
+ * @brief VescInterface::updateTelemetryCoalescing
+ * Clients of the TCP and UDP bridges need a reply to every request, so only
+ * keep the latest telemetry reply when no bridge is active. Called when a
+ * bridge is started or stopped, before any client can send a request.
+ */
+void VescInterface::updateTelemetryCoalescing()
+{
+#ifdef HAS_SERIALPORT
+    mSerialIo->setCoalesceTelemetry(!mTcpServer->isServerRunning() &&
+                                    !mTcpServer->isClientConnected() &&
+                                    !mUdpServer->isServerRunning());
+#endif
 }
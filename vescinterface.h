@@ -31,9 +31,10 @@
 #include <QSettings>
 #include <QHash>
 #include <QFile>
+#include <QElapsedTimer>
 
 #ifdef HAS_SERIALPORT
-#include <QSerialPort>
+#include "serialio.h"
 #endif
 
 #ifdef HAS_CANBUS
@@ -44,6 +45,8 @@
 #include "configparams.h"
 #include "commands.h"
 #include "packet.h"
+#include "configbackupstore.h"
+#include "hotplugmonitor.h"
 #include "tcpserversimple.h"
 #include "udpserversimple.h"
 
@@ -195,6 +198,7 @@ public:
     Q_INVOKABLE bool isCANbusConnected();
     Q_INVOKABLE void setCANbusReceiverID(int node_ID);
     Q_INVOKABLE void scanCANbus();
+    void processCanFrame(QByteArray payload, quint32 id, bool isExtended);
 
     Q_INVOKABLE void connectTcp(QString server, int port);
     Q_INVOKABLE void connectTcpHub(QString server, int port, QString id, QString pass);
@@ -202,6 +206,8 @@ public:
     Q_INVOKABLE void connectBle(QString address);
     Q_INVOKABLE bool isAutoconnectOngoing() const;
     Q_INVOKABLE double getAutoconnectProgress() const;
+    Q_INVOKABLE QString getAutoconnectReport() const;
+    Q_INVOKABLE QString serialIoReport() const;
     Q_INVOKABLE QVector<int> scanCan();
     Q_INVOKABLE QVector<int> getCanDevsLast() const;
     Q_INVOKABLE void ignoreCanChange(bool ignore);
@@ -241,6 +247,8 @@ public:
     Q_INVOKABLE int customConfigNum();
     Q_INVOKABLE bool customConfigsLoaded();
     Q_INVOKABLE bool customConfigRxDone();
+    Q_INVOKABLE QString connectTimingReport();
+    Q_INVOKABLE qint64 connectTimeMs();
     Q_INVOKABLE ConfigParams *customConfig(int configNum);
 
     Q_INVOKABLE bool qmlHwLoaded();
@@ -299,19 +307,21 @@ signals:
     void unintentionalBleDisconnect();
     void CANbusNewNode(int node);
     void CANbusInterfaceListUpdated();
+    void serialPortListUpdated();
+    void CANbusFrameRx(QByteArray data, quint32 id, bool isExtended);
     void useImperialUnitsChanged(bool useImperialUnits);
     void configurationChanged();
     void configurationBackupsChanged();
     void customConfigLoadDone();
     void qmlLoadDone();
+    void connectTimingsUpdated();
     void fwArchiveDlProgress(QString msg, double prog);
 
 public slots:
 
 private slots:
 #ifdef HAS_SERIALPORT
-    void serialDataAvailable();
-    void serialPortError(QSerialPort::SerialPortError error);
+    void serialPortError(QString message);
 #endif
 
 #ifdef HAS_CANBUS
@@ -356,7 +366,7 @@ private:
     QSettings mSettings;
     QHash<QString, QString> mBleNames;
     QHash<QString, bool> mBlePreferred;
-    QHash<QString, CONFIG_BACKUP> mConfigurationBackups;
+    ConfigBackupStore mConfigBackups;
     QVariantList mProfiles;
     QStringList mPairedUuids;
     TcpServerSimple *mTcpServer;
@@ -379,12 +389,21 @@ private:
     QString mQmlApp;
 
     QTimer *mTimer;
+    HotplugMonitor *mHotplug;
+    QByteArray mRxPending;
+    bool mRxScheduled;
     Packet *mPacket;
     Commands *mCommands;
     bool mFwVersionReceived;
     bool mDeserialFailedMessageShown;
     int mFwRetries;
     int mFwPollCnt;
+
+    // Time of each connection bring-up phase, measured from the first
+    // firmware version request
+    QElapsedTimer mConnectTimer;
+    bool mConnectTimingActive;
+    QVector<QPair<QString, qint64> > mConnectPhases;
     QString mFwTxt;
     QPair<int, int> mFwPair;
     QString mHwTxt;
@@ -405,7 +424,7 @@ private:
     conn_t mLastConnType;
 
 #ifdef HAS_SERIALPORT
-    QSerialPort *mSerialPort;
+    SerialIo *mSerialIo;
     QString mLastSerialPort;
     int mLastSerialBaud;
 #endif
@@ -416,12 +435,13 @@ private:
     int mLastCanDeviceBitrate;
     QString mLastCanBackend;
     int mLastCanDeviceID;
-    QByteArray mCanRxBuffer;
     QVector<int> mCanNodesID;
-    QList<QString> mCanDeviceInterfaces;
     bool mCANbusScanning;
+    bool mCanRxScheduled;
 #endif
 
+    QByteArray mCanRxBuffer;
+
     QTcpSocket *mTcpSocket;
     bool mTcpConnected;
     QString mLastTcpServer;
@@ -466,6 +486,7 @@ private:
     bool mWasConnected;
     bool mAutoconnectOngoing;
     double mAutoconnectProgress;
+    QString mAutoconnectReport;
     bool mIgnoreCanChange;
 
     bool mCanTmpFwdActive;
@@ -491,7 +512,13 @@ private:
     bool mIgnoreTestVersion;
 
     void updateFwRx(bool fwRx);
+    void connectPhaseDone(QString name);
+    void queueRxData(const QByteArray &data);
+#ifdef HAS_CANBUS
+    void CANbusReadFrames();
+#endif
     void setLastConnectionType(conn_t type);
+    void updateTelemetryCoalescing();
 
 };
 
@@ -21,6 +21,7 @@
 #include "ui_adcmap.h"
 #include "helpdialog.h"
 #include "utility.h"
+#include "framescheduler.h"
 #include <QMessageBox>
 
 AdcMap::AdcMap(QWidget *parent) :
@@ -57,6 +58,7 @@ void AdcMap::setVesc(VescInterface *vesc)
     if (mVesc) {
         connect(mVesc->commands(), SIGNAL(decodedAdcReceived(double,double,double,double)),
                 this, SLOT(decodedAdcReceived(double,double,double,double)));
+        FrameScheduler::instance()->addStreamConsumer(this, FrameScheduler::StreamAppData);
     }
 }
 
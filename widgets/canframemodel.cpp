@@ -0,0 +1,492 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "canframemodel.h"
+
+#include <cstring>
+
+namespace {
+enum {
+    ColTime = 0,
+    ColExt,
+    ColId,
+    ColLen,
+    ColData,
+    ColNum = ColData + 8
+};
+
+enum {
+    ColIdExt = 0,
+    ColIdId,
+    ColIdCount,
+    ColIdRate,
+    ColIdLen,
+    ColIdData,
+    ColIdNum = ColIdData + 8
+};
+
+// Queued frames are flushed without waiting for the next tick when this many
+// are pending, e.g. while the view is hidden and no tick flushes the model.
+const int maxPending = 4096;
+}
+
+CanFrameModel::CanFrameModel(QObject *parent) : QAbstractTableModel(parent)
+{
+    mFirstSeq = 0;
+    mNextSeq = 0;
+    mViewStart = 0;
+    mMode = ModeFrames;
+    mFilterId = 0;
+    mFilterMask = 0;
+    mFramesReceived = 0;
+    mFramesLastRate = 0;
+    mFrameRate = 0.0;
+
+    mFrames.resize(100000);
+    mTime.start();
+    mRateTimer.start();
+}
+
+int CanFrameModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+
+    if (mMode == ModeById) {
+        return mIds.size();
+    } else {
+        return mView.size() - mViewStart;
+    }
+}
+
+int CanFrameModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+
+    return mMode == ModeById ? ColIdNum : ColNum;
+}
+
+QVariant CanFrameModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    int col = index.column();
+
+    const CanFrame *f = nullptr;
+    int dataCol = 0;
+
+    if (mMode == ModeById) {
+        if (index.row() >= mIds.size()) {
+            return QVariant();
+        }
+
+        const IdStats &s = mIds.at(index.row());
+        f = &s.last;
+        dataCol = col - ColIdData;
+
+        switch (col) {
+        case ColIdExt: return QString(s.isExtended ? "Yes" : "No");
+        case ColIdId: return QString("0x%1").arg(s.id, 8, 16, QLatin1Char('0'));
+        case ColIdCount: return QString::number(s.count);
+        case ColIdRate: return QString::number(s.rate, 'f', 1);
+        case ColIdLen: return QString::number(s.last.len);
+        default: break;
+        }
+    } else {
+        int ind = mViewStart + index.row();
+        if (ind >= mView.size()) {
+            return QVariant();
+        }
+
+        f = &frameAtSeq(mView.at(ind));
+        dataCol = col - ColData;
+
+        switch (col) {
+        case ColTime: return QString::number(double(f->timeUs) / 1e6, 'f', 4);
+        case ColExt: return QString(f->isExtended ? "Yes" : "No");
+        case ColId: return QString("0x%1").arg(f->id, 8, 16, QLatin1Char('0'));
+        case ColLen: return QString::number(f->len);
+        default: break;
+        }
+    }
+
+    if (dataCol >= 0 && dataCol < f->len) {
+        return QString("0x%1").arg(f->data[dataCol], 2, 16, QLatin1Char('0'));
+    }
+
+    return QVariant();
+}
+
+QVariant CanFrameModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    if (mMode == ModeById) {
+        switch (section) {
+        case ColIdExt: return tr("Ext");
+        case ColIdId: return tr("ID");
+        case ColIdCount: return tr("Count");
+        case ColIdRate: return tr("Rate (Hz)");
+        case ColIdLen: return tr("Len");
+        default: return QString("D%1").arg(section - ColIdData);
+        }
+    } else {
+        switch (section) {
+        case ColTime: return tr("Time (s)");
+        case ColExt: return tr("Ext");
+        case ColId: return tr("ID");
+        case ColLen: return tr("Len");
+        default: return QString("D%1").arg(section - ColData);
+        }
+    }
+}
+
+void CanFrameModel::addFrame(const QByteArray &data, quint32 id, bool isExtended)
+{
+    CanFrame f;
+    f.timeUs = timeUs();
+    f.id = id;
+    f.isExtended = isExtended;
+    f.len = quint8(qMin(data.size(), 8));
+    memset(f.data, 0, sizeof(f.data));
+    memcpy(f.data, data.constData(), f.len);
+    addFrame(f);
+}
+
+/**
+ * @brief CanFrameModel::addFrame
+ * Queue a frame. It shows up in the model on the next flush().
+ *
+ * @param frame
+ * The frame to add.
+ */
+void CanFrameModel::addFrame(const CanFrame &frame)
+{
+    mPending.append(frame);
+    mFramesReceived++;
+
+    if (mPending.size() >= maxPending) {
+        flush();
+    }
+}
+
+/**
+ * @brief CanFrameModel::flush
+ * Move the queued frames to the ring buffer and notify the views about the
+ * added and evicted rows in one batch. Also updates the frame rates.
+ *
+ * @return
+ * The number of rows that were added.
+ */
+int CanFrameModel::flush()
+{
+    updateRates();
+
+    if (mPending.isEmpty()) {
+        return 0;
+    }
+
+    const quint64 cap = quint64(mFrames.size());
+
+    if (quint64(mPending.size()) > cap) {
+        mPending.remove(0, mPending.size() - int(cap));
+    }
+
+    quint64 newNext = mNextSeq + quint64(mPending.size());
+    quint64 newFirst = newNext > cap ? newNext - cap : 0;
+    newFirst = qMax(newFirst, mFirstSeq);
+
+    // Drop the rows of frames that are going to be overwritten
+    int evicted = 0;
+    while ((mViewStart + evicted) < mView.size() &&
+           mView.at(mViewStart + evicted) < newFirst) {
+        evicted++;
+    }
+
+    if (evicted > 0) {
+        if (mMode == ModeFrames) {
+            beginRemoveRows(QModelIndex(), 0, evicted - 1);
+        }
+
+        mViewStart += evicted;
+
+        if (mMode == ModeFrames) {
+            endRemoveRows();
+        }
+    }
+
+    mFirstSeq = newFirst;
+
+    QVector<quint64> added;
+    added.reserve(mPending.size());
+    int idsChanged = 0;
+
+    for (const auto &f: mPending) {
+        quint64 seq = mNextSeq++;
+        mFrames[int(seq % cap)] = f;
+
+        if (matchesFilter(f)) {
+            added.append(seq);
+            addToIdStats(f, true);
+            idsChanged++;
+        }
+    }
+
+    mPending.clear();
+
+    if (!added.isEmpty()) {
+        if (mMode == ModeFrames) {
+            int rows = rowCount();
+            beginInsertRows(QModelIndex(), rows, rows + added.size() - 1);
+            mView.append(added);
+            endInsertRows();
+        } else {
+            mView.append(added);
+        }
+    }
+
+    if (mMode == ModeById && idsChanged > 0) {
+        emit dataChanged(index(0, 0), index(mIds.size() - 1, ColIdNum - 1));
+    }
+
+    // The row numbers do not change when compacting, so the views are not affected
+    if (mViewStart > maxPending && mViewStart > mView.size() / 2) {
+        mView.remove(0, mViewStart);
+        mViewStart = 0;
+    }
+
+    return mMode == ModeFrames ? added.size() : idsChanged;
+}
+
+void CanFrameModel::clear()
+{
+    beginResetModel();
+    mFirstSeq = 0;
+    mNextSeq = 0;
+    mPending.clear();
+    mView.clear();
+    mViewStart = 0;
+    mIds.clear();
+    mIdRows.clear();
+    mFramesReceived = 0;
+    mFramesLastRate = 0;
+    mFrameRate = 0.0;
+    mTime.restart();
+    mRateTimer.restart();
+    endResetModel();
+}
+
+/**
+ * @brief CanFrameModel::setCapacity
+ * Set the number of frames that are kept. The newest frames are preserved.
+ *
+ * @param capacity
+ * The maximum number of frames.
+ */
+void CanFrameModel::setCapacity(int capacity)
+{
+    capacity = qMax(capacity, 1);
+
+    if (capacity == mFrames.size()) {
+        return;
+    }
+
+    flush();
+
+    QVector<CanFrame> frames(capacity);
+    quint64 first = qMax(mFirstSeq, mNextSeq > quint64(capacity) ?
+                             mNextSeq - quint64(capacity) : 0);
+
+    for (quint64 seq = first;seq < mNextSeq;seq++) {
+        frames[int(seq % quint64(capacity))] = frameAtSeq(seq);
+    }
+
+    mFrames = frames;
+    mFirstSeq = first;
+    rebuildViews();
+}
+
+int CanFrameModel::capacity() const
+{
+    return mFrames.size();
+}
+
+void CanFrameModel::setMode(CanFrameModel::Mode mode)
+{
+    if (mode == mMode) {
+        return;
+    }
+
+    beginResetModel();
+    mMode = mode;
+    endResetModel();
+}
+
+CanFrameModel::Mode CanFrameModel::mode() const
+{
+    return mMode;
+}
+
+/**
+ * @brief CanFrameModel::setFilter
+ * Only show frames where (frameId & mask) == (id & mask). A mask of 0 shows
+ * all frames. All frames are still captured, so the filter can be changed
+ * afterwards.
+ *
+ * @param id
+ * The ID to compare with.
+ *
+ * @param mask
+ * The bits of the ID to compare.
+ */
+void CanFrameModel::setFilter(quint32 id, quint32 mask)
+{
+    if (id == mFilterId && mask == mFilterMask) {
+        return;
+    }
+
+    flush();
+
+    mFilterId = id;
+    mFilterMask = mask;
+    rebuildViews();
+}
+
+quint32 CanFrameModel::filterId() const
+{
+    return mFilterId;
+}
+
+quint32 CanFrameModel::filterMask() const
+{
+    return mFilterMask;
+}
+
+qint64 CanFrameModel::timeUs() const
+{
+    return mTime.nsecsElapsed() / 1000;
+}
+
+quint64 CanFrameModel::framesReceived() const
+{
+    return mFramesReceived;
+}
+
+double CanFrameModel::frameRate() const
+{
+    return mFrameRate;
+}
+
+bool CanFrameModel::matchesFilter(const CanFrameModel::CanFrame &frame) const
+{
+    return (frame.id & mFilterMask) == (mFilterId & mFilterMask);
+}
+
+const CanFrameModel::CanFrame &CanFrameModel::frameAtSeq(quint64 seq) const
+{
+    return mFrames.at(int(seq % quint64(mFrames.size())));
+}
+
+void CanFrameModel::addToIdStats(const CanFrameModel::CanFrame &frame, bool notify)
+{
+    quint64 key = quint64(frame.id) | (quint64(frame.isExtended) << 32);
+    int row = mIdRows.value(key, -1);
+
+    if (row < 0) {
+        IdStats s;
+        s.id = frame.id;
+        s.isExtended = frame.isExtended;
+        s.count = 0;
+        s.countLastRate = 0;
+        s.rate = 0.0;
+
+        row = mIds.size();
+        notify = notify && mMode == ModeById;
+
+        if (notify) {
+            beginInsertRows(QModelIndex(), row, row);
+        }
+
+        mIds.append(s);
+        mIdRows.insert(key, row);
+
+        if (notify) {
+            endInsertRows();
+        }
+    }
+
+    IdStats &s = mIds[row];
+    s.count++;
+    s.last = frame;
+}
+
+void CanFrameModel::updateRates()
+{
+    qint64 ms = mRateTimer.elapsed();
+
+    if (ms < 1000) {
+        return;
+    }
+
+    mRateTimer.restart();
+
+    mFrameRate = double(mFramesReceived - mFramesLastRate) * 1000.0 / double(ms);
+    mFramesLastRate = mFramesReceived;
+
+    for (auto &s: mIds) {
+        s.rate = double(s.count - s.countLastRate) * 1000.0 / double(ms);
+        s.countLastRate = s.count;
+    }
+
+    if (mMode == ModeById && !mIds.isEmpty()) {
+        emit dataChanged(index(0, ColIdRate), index(mIds.size() - 1, ColIdRate));
+    }
+}
+
+void CanFrameModel::rebuildViews()
+{
+    beginResetModel();
+
+    mView.clear();
+    mViewStart = 0;
+    mIds.clear();
+    mIdRows.clear();
+
+    for (quint64 seq = mFirstSeq;seq < mNextSeq;seq++) {
+        const CanFrame &f = frameAtSeq(seq);
+        if (matchesFilter(f)) {
+            mView.append(seq);
+            addToIdStats(f, false);
+        }
+    }
+
+    // Rates start over from the rebuilt counts
+    for (auto &s: mIds) {
+        s.countLastRate = s.count;
+    }
+
+    endResetModel();
+}
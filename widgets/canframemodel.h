@@ -0,0 +1,123 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef CANFRAMEMODEL_H
+#define CANFRAMEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QHash>
+#include <QElapsedTimer>
+
+/**
+ * @brief The CanFrameModel class
+ *
+ * Table model for captured CAN frames. The frames are stored in a fixed-capacity
+ * ring buffer and the cells are only formatted when a view asks for them, so the
+ * cost of a received frame does not depend on the number of captured frames.
+ *
+ * Received frames are queued with addFrame() and handed to the views in batches
+ * on flush(), which is meant to be called once per frame tick.
+ *
+ * The model can either show every frame that matches the ID/mask filter, or one
+ * row per ID with the frame count, the frame rate and the last payload.
+ */
+class CanFrameModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    typedef enum {
+        ModeFrames = 0,
+        ModeById
+    } Mode;
+
+    struct CanFrame {
+        qint64 timeUs;
+        quint32 id;
+        bool isExtended;
+        quint8 len;
+        quint8 data[8];
+    };
+
+    explicit CanFrameModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    void addFrame(const QByteArray &data, quint32 id, bool isExtended);
+    void addFrame(const CanFrame &frame);
+    int flush();
+    void clear();
+
+    void setCapacity(int capacity);
+    int capacity() const;
+    void setMode(Mode mode);
+    Mode mode() const;
+    void setFilter(quint32 id, quint32 mask);
+    quint32 filterId() const;
+    quint32 filterMask() const;
+
+    qint64 timeUs() const;
+    quint64 framesReceived() const;
+    double frameRate() const;
+
+private:
+    struct IdStats {
+        quint32 id;
+        bool isExtended;
+        quint64 count;
+        quint64 countLastRate;
+        double rate;
+        CanFrame last;
+    };
+
+    QVector<CanFrame> mFrames;
+    quint64 mFirstSeq;
+    quint64 mNextSeq;
+    QVector<CanFrame> mPending;
+
+    // Sequence numbers of the frames that pass the filter
+    QVector<quint64> mView;
+    int mViewStart;
+
+    QVector<IdStats> mIds;
+    QHash<quint64, int> mIdRows;
+
+    Mode mMode;
+    quint32 mFilterId;
+    quint32 mFilterMask;
+
+    QElapsedTimer mTime;
+    QElapsedTimer mRateTimer;
+    quint64 mFramesReceived;
+    quint64 mFramesLastRate;
+    double mFrameRate;
+
+    bool matchesFilter(const CanFrame &frame) const;
+    const CanFrame &frameAtSeq(quint64 seq) const;
+    void addToIdStats(const CanFrame &frame, bool notify);
+    void updateRates();
+    void rebuildViews();
+
+};
+
+#endif // CANFRAMEMODEL_H
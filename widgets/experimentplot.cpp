@@ -22,6 +22,7 @@
 #include "experimentplot.h"
 #include "ui_experimentplot.h"
 #include "utility.h"
+#include "framescheduler.h"
 
 ExperimentPlot::ExperimentPlot(QWidget *parent) :
     QWidget(parent),
@@ -96,13 +97,10 @@ ExperimentPlot::ExperimentPlot(QWidget *parent) :
     mExperimentReplot = false;
     mExperimentPlotNow = 0;
 
-    mTimer = new QTimer(this);
-    mTimer->start(20);
-
     Utility::setPlotColors(ui->experimentPlot);
     ui->experimentPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
 
-    connect(mTimer, &QTimer::timeout, [=]() {
+    FrameScheduler::instance()->addClient(this, [=]() {
         if (mExperimentReplot) {
             ui->experimentPlot->clearGraphs();
 
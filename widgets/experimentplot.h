@@ -66,7 +66,6 @@ private:
 
     Ui::ExperimentPlot *ui;
     VescInterface *mVesc;
-    QTimer *mTimer;
 
 };
 
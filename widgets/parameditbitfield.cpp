@@ -20,6 +20,7 @@
 #include "parameditbitfield.h"
 #include "ui_parameditbitfield.h"
 #include "utility.h"
+#include <algorithm>
 #include "helpdialog.h"
 
 ParamEditBitfield::ParamEditBitfield(QWidget *parent) :
@@ -32,12 +33,15 @@ ParamEditBitfield::ParamEditBitfield(QWidget *parent) :
     ui->readButton->setIcon(Utility::getIcon("icons/Upload-96.png"));
     ui->readDefaultButton->setIcon(Utility::getIcon("icons/Data Backup-96.png"));
 
+    mConfig = 0;
+    mParamId = -1;
+
     auto updateFun = [this]() {
         if (mConfig) {
             if (mConfig->getUpdateOnly() != mName) {
                 mConfig->setUpdateOnly("");
             }
-            mConfig->updateParamInt(mName, getNum(), this);
+            mConfig->updateParamInt(mParamId, getNum(), this);
         }
     };
 
@@ -55,21 +59,22 @@ void ParamEditBitfield::setConfig(ConfigParams *config)
 {
     mConfig = config;
 
-    ConfigParam *param = mConfig->getParam(mName);
+    mParamId = mConfig->paramId(mName);
+    if (mConfig->hasParam(mName)) {
+        ConfigParam param = mConfig->getParamCopy(mName);
 
-    if (param) {
-        ui->readButton->setVisible(param->transmittable);
-        ui->readDefaultButton->setVisible(param->transmittable);
-        setBits(param->valInt);
+        ui->readButton->setVisible(param.transmittable);
+        ui->readDefaultButton->setVisible(param.transmittable);
+        setBits(param.valInt);
 
-        if (param->enumNames.size() > 0) ui->b0Box->setText(param->enumNames.at(0));
-        if (param->enumNames.size() > 1) ui->b1Box->setText(param->enumNames.at(1));
-        if (param->enumNames.size() > 2) ui->b2Box->setText(param->enumNames.at(2));
-        if (param->enumNames.size() > 3) ui->b3Box->setText(param->enumNames.at(3));
-        if (param->enumNames.size() > 4) ui->b4Box->setText(param->enumNames.at(4));
-        if (param->enumNames.size() > 5) ui->b5Box->setText(param->enumNames.at(5));
-        if (param->enumNames.size() > 6) ui->b6Box->setText(param->enumNames.at(6));
-        if (param->enumNames.size() > 7) ui->b7Box->setText(param->enumNames.at(7));
+        if (param.enumNames.size() > 0) ui->b0Box->setText(param.enumNames.at(0));
+        if (param.enumNames.size() > 1) ui->b1Box->setText(param.enumNames.at(1));
+        if (param.enumNames.size() > 2) ui->b2Box->setText(param.enumNames.at(2));
+        if (param.enumNames.size() > 3) ui->b3Box->setText(param.enumNames.at(3));
+        if (param.enumNames.size() > 4) ui->b4Box->setText(param.enumNames.at(4));
+        if (param.enumNames.size() > 5) ui->b5Box->setText(param.enumNames.at(5));
+        if (param.enumNames.size() > 6) ui->b6Box->setText(param.enumNames.at(6));
+        if (param.enumNames.size() > 7) ui->b7Box->setText(param.enumNames.at(7));
 
         ui->b0Box->setVisible(ui->b0Box->text().toLower() != "unused");
         ui->b1Box->setVisible(ui->b1Box->text().toLower() != "unused");
@@ -81,8 +86,8 @@ void ParamEditBitfield::setConfig(ConfigParams *config)
         ui->b7Box->setVisible(ui->b7Box->text().toLower() != "unused");
     }
 
-    connect(mConfig, SIGNAL(paramChangedInt(QObject*,QString,int)),
-            this, SLOT(paramChangedInt(QObject*,QString,int)));
+    connect(mConfig, SIGNAL(paramChangeSet(QObject*,QVector<int>)),
+            this, SLOT(paramChangeSet(QObject*,QVector<int>)));
 }
 
 QString ParamEditBitfield::name() const
@@ -102,6 +107,13 @@ void ParamEditBitfield::paramChangedInt(QObject *src, QString name, int newParam
     }
 }
 
+void ParamEditBitfield::paramChangeSet(QObject *src, QVector<int> ids)
+{
+    if (std::binary_search(ids.constBegin(), ids.constEnd(), mParamId)) {
+        paramChangedInt(src, mName, mConfig->getParamInt(mParamId));
+    }
+}
+
 ParamEditBitfield::~ParamEditBitfield()
 {
     delete ui;
@@ -41,6 +41,7 @@ public:
 
 private slots:
     void paramChangedInt(QObject *src, QString name, int newParam);
+    void paramChangeSet(QObject *src, QVector<int> ids);
 
     void on_readButton_clicked();
     void on_readDefaultButton_clicked();
@@ -50,6 +51,7 @@ private:
     Ui::ParamEditBitfield *ui;
     ConfigParams *mConfig;
     QString mName;
+    int mParamId;
 
     void setBits(int num);
     int getNum();
@@ -22,6 +22,7 @@
 #include <QMessageBox>
 #include "helpdialog.h"
 #include "utility.h"
+#include <algorithm>
 
 ParamEditBool::ParamEditBool(QWidget *parent) :
     QWidget(parent),
@@ -32,6 +33,9 @@ ParamEditBool::ParamEditBool(QWidget *parent) :
     ui->helpButton->setIcon(Utility::getIcon("icons/Help-96.png"));
     ui->readButton->setIcon(Utility::getIcon("icons/Upload-96.png"));
     ui->readDefaultButton->setIcon(Utility::getIcon("icons/Data Backup-96.png"));
+
+    mConfig = 0;
+    mParamId = -1;
 }
 
 ParamEditBool::~ParamEditBool()
@@ -43,16 +47,17 @@ void ParamEditBool::setConfig(ConfigParams *config)
 {
     mConfig = config;
 
-    ConfigParam *param = mConfig->getParam(mName);
+    mParamId = mConfig->paramId(mName);
+    if (mConfig->hasParam(mName)) {
+        ConfigParam param = mConfig->getParamCopy(mName);
 
-    if (param) {
-        ui->readButton->setVisible(param->transmittable);
-        ui->readDefaultButton->setVisible(param->transmittable);
-        ui->valueBox->setCurrentIndex(param->valInt ? 1 : 0);
+        ui->readButton->setVisible(param.transmittable);
+        ui->readDefaultButton->setVisible(param.transmittable);
+        ui->valueBox->setCurrentIndex(param.valInt ? 1 : 0);
     }
 
-    connect(mConfig, SIGNAL(paramChangedBool(QObject*,QString,bool)),
-            this, SLOT(paramChangedBool(QObject*,QString,bool)));
+    connect(mConfig, SIGNAL(paramChangeSet(QObject*,QVector<int>)),
+            this, SLOT(paramChangeSet(QObject*,QVector<int>)));
 }
 
 QString ParamEditBool::name() const
@@ -72,6 +77,13 @@ void ParamEditBool::paramChangedBool(QObject *src, QString name, bool newParam)
     }
 }
 
+void ParamEditBool::paramChangeSet(QObject *src, QVector<int> ids)
+{
+    if (std::binary_search(ids.constBegin(), ids.constEnd(), mParamId)) {
+        paramChangedBool(src, mName, mConfig->getParamBool(mParamId));
+    }
+}
+
 void ParamEditBool::on_readButton_clicked()
 {
     if (mConfig) {
@@ -101,6 +113,6 @@ void ParamEditBool::on_valueBox_currentIndexChanged(int index)
         if (mConfig->getUpdateOnly() != mName) {
             mConfig->setUpdateOnly("");
         }
-        mConfig->updateParamBool(mName, index, this);
+        mConfig->updateParamBool(mParamId, index, this);
     }
 }
@@ -23,6 +23,7 @@
 #include "helpdialog.h"
 #include <cmath>
 #include "utility.h"
+#include <algorithm>
 
 ParamEditDouble::ParamEditDouble(QWidget *parent) :
     QWidget(parent),
@@ -35,6 +36,7 @@ ParamEditDouble::ParamEditDouble(QWidget *parent) :
     ui->readDefaultButton->setIcon(Utility::getIcon("icons/Data Backup-96.png"));
 
     mConfig = 0;
+    mParamId = -1;
     mMaxVal = 1.0;
 
     mDisplay = new DisplayPercentage(this);
@@ -69,13 +71,14 @@ void ParamEditDouble::setConfig(ConfigParams *config)
 {
     mConfig = config;
 
-    ConfigParam *param = mConfig->getParam(mName);
+    mParamId = mConfig->paramId(mName);
+    if (mConfig->hasParam(mName)) {
+        ConfigParam param = mConfig->getParamCopy(mName);
 
-    if (param) {
-        ui->readButton->setVisible(param->transmittable);
-        ui->readDefaultButton->setVisible(param->transmittable);
+        ui->readButton->setVisible(param.transmittable);
+        ui->readDefaultButton->setVisible(param.transmittable);
 
-        mParam = *param;
+        mParam = param;
 
         mMaxVal = fabs(mParam.maxDouble) > fabs(mParam.minDouble) ?
                     fabs(mParam.maxDouble) : fabs(mParam.minDouble);
@@ -97,8 +100,8 @@ void ParamEditDouble::setConfig(ConfigParams *config)
         }
     }
 
-    connect(mConfig, SIGNAL(paramChangedDouble(QObject*,QString,double)),
-            this, SLOT(paramChangedDouble(QObject*,QString,double)));
+    connect(mConfig, SIGNAL(paramChangeSet(QObject*,QVector<int>)),
+            this, SLOT(paramChangeSet(QObject*,QVector<int>)));
 }
 
 QString ParamEditDouble::name() const
@@ -141,6 +144,13 @@ void ParamEditDouble::paramChangedDouble(QObject *src, QString name, double newP
     }
 }
 
+void ParamEditDouble::paramChangeSet(QObject *src, QVector<int> ids)
+{
+    if (std::binary_search(ids.constBegin(), ids.constEnd(), mParamId)) {
+        paramChangedDouble(src, mName, mConfig->getParamDouble(mParamId));
+    }
+}
+
 void ParamEditDouble::percentageChanged(int p)
 {
     if (mParam.editAsPercentage) {
@@ -150,7 +160,7 @@ void ParamEditDouble::percentageChanged(int p)
             if (mConfig->getUpdateOnly() != mName) {
                 mConfig->setUpdateOnly("");
             }
-            mConfig->updateParamDouble(mName, val, this);
+            mConfig->updateParamDouble(mParamId, val, this);
         }
 
         updateDisplay(val);
@@ -166,7 +176,7 @@ void ParamEditDouble::doubleChanged(double d)
             if (mConfig->getUpdateOnly() != mName) {
                 mConfig->setUpdateOnly("");
             }
-            mConfig->updateParamDouble(mName, val, this);
+            mConfig->updateParamDouble(mParamId, val, this);
         }
 
         updateDisplay(val);
@@ -48,6 +48,7 @@ public:
 
 private slots:
     void paramChangedDouble(QObject *src, QString name, double newParam);
+    void paramChangeSet(QObject *src, QVector<int> ids);
     void percentageChanged(int p);
     void doubleChanged(double d);
 
@@ -60,6 +61,7 @@ private:
     ConfigParams *mConfig;
     ConfigParam mParam;
     QString mName;
+    int mParamId;
     double mMaxVal;
 
     DisplayPercentage *mDisplay;
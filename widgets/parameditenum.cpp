@@ -22,6 +22,7 @@
 #include <QDebug>
 #include "helpdialog.h"
 #include "utility.h"
+#include <algorithm>
 
 ParamEditEnum::ParamEditEnum(QWidget *parent) :
     QWidget(parent),
@@ -29,6 +30,7 @@ ParamEditEnum::ParamEditEnum(QWidget *parent) :
 {
     ui->setupUi(this);
     mConfig = 0;
+    mParamId = -1;
 
     ui->helpButton->setIcon(Utility::getIcon("icons/Help-96.png"));
     ui->readButton->setIcon(Utility::getIcon("icons/Upload-96.png"));
@@ -44,21 +46,22 @@ void ParamEditEnum::setConfig(ConfigParams *config)
 {
     mConfig = config;
 
-    ConfigParam *param = mConfig->getParam(mName);
+    mParamId = mConfig->paramId(mName);
+    if (mConfig->hasParam(mName)) {
+        ConfigParam param = mConfig->getParamCopy(mName);
 
-    if (param) {
-        ui->readButton->setVisible(param->transmittable);
-        ui->readDefaultButton->setVisible(param->transmittable);
+        ui->readButton->setVisible(param.transmittable);
+        ui->readDefaultButton->setVisible(param.transmittable);
 
-        int val = param->valInt;
-        ui->valueBox->insertItems(0, param->enumNames);
-        if (val >= 0 && val < param->enumNames.size()) {
+        int val = param.valInt;
+        ui->valueBox->insertItems(0, param.enumNames);
+        if (val >= 0 && val < param.enumNames.size()) {
             ui->valueBox->setCurrentIndex(val);
         }
     }
 
-    connect(mConfig, SIGNAL(paramChangedEnum(QObject*,QString,int)),
-            this, SLOT(paramChangedEnum(QObject*,QString,int)));
+    connect(mConfig, SIGNAL(paramChangeSet(QObject*,QVector<int>)),
+            this, SLOT(paramChangeSet(QObject*,QVector<int>)));
 }
 
 QString ParamEditEnum::name() const
@@ -78,6 +81,13 @@ void ParamEditEnum::paramChangedEnum(QObject *src, QString name, int newParam)
     }
 }
 
+void ParamEditEnum::paramChangeSet(QObject *src, QVector<int> ids)
+{
+    if (std::binary_search(ids.constBegin(), ids.constEnd(), mParamId)) {
+        paramChangedEnum(src, mName, mConfig->getParamEnum(mParamId));
+    }
+}
+
 void ParamEditEnum::on_readButton_clicked()
 {
     if (mConfig) {
@@ -107,6 +117,6 @@ void ParamEditEnum::on_valueBox_currentIndexChanged(int index)
         if (mConfig->getUpdateOnly() != mName) {
             mConfig->setUpdateOnly("");
         }
-        mConfig->updateParamEnum(mName, index, this);
+        mConfig->updateParamEnum(mParamId, index, this);
     }
 }
@@ -40,6 +40,7 @@ public:
 
 private slots:
     void paramChangedEnum(QObject *src, QString name, int newParam);
+    void paramChangeSet(QObject *src, QVector<int> ids);
 
     void on_readButton_clicked();
     void on_readDefaultButton_clicked();
@@ -50,6 +51,7 @@ private:
     Ui::ParamEditEnum *ui;
     ConfigParams *mConfig;
     QString mName;
+    int mParamId;
 
 };
 
@@ -23,6 +23,7 @@
 #include <cstdlib>
 #include "helpdialog.h"
 #include "utility.h"
+#include <algorithm>
 
 ParamEditInt::ParamEditInt(QWidget *parent) :
     QWidget(parent),
@@ -30,6 +31,7 @@ ParamEditInt::ParamEditInt(QWidget *parent) :
 {
     ui->setupUi(this);
     mConfig = 0;
+    mParamId = -1;
     mMaxVal = 1;
 
     ui->helpButton->setIcon(Utility::getIcon("icons/Help-96.png"));
@@ -68,13 +70,14 @@ void ParamEditInt::setConfig(ConfigParams *config)
 {
     mConfig = config;
 
-    ConfigParam *param = mConfig->getParam(mName);
+    mParamId = mConfig->paramId(mName);
+    if (mConfig->hasParam(mName)) {
+        ConfigParam param = mConfig->getParamCopy(mName);
 
-    if (param) {
-        ui->readButton->setVisible(param->transmittable);
-        ui->readDefaultButton->setVisible(param->transmittable);
+        ui->readButton->setVisible(param.transmittable);
+        ui->readDefaultButton->setVisible(param.transmittable);
 
-        mParam = *param;
+        mParam = param;
 
         mMaxVal = abs(mParam.maxInt) > abs(mParam.minInt) ?
                     abs(mParam.maxInt) : abs(mParam.minInt);
@@ -96,8 +99,8 @@ void ParamEditInt::setConfig(ConfigParams *config)
         }
     }
 
-    connect(mConfig, SIGNAL(paramChangedInt(QObject*,QString,int)),
-            this, SLOT(paramChangedInt(QObject*,QString,int)));
+    connect(mConfig, SIGNAL(paramChangeSet(QObject*,QVector<int>)),
+            this, SLOT(paramChangeSet(QObject*,QVector<int>)));
 }
 
 QString ParamEditInt::name() const
@@ -133,6 +136,13 @@ void ParamEditInt::paramChangedInt(QObject *src, QString name, int newParam)
     }
 }
 
+void ParamEditInt::paramChangeSet(QObject *src, QVector<int> ids)
+{
+    if (std::binary_search(ids.constBegin(), ids.constEnd(), mParamId)) {
+        paramChangedInt(src, mName, mConfig->getParamInt(mParamId));
+    }
+}
+
 void ParamEditInt::percentageChanged(int p)
 {
     if (mParam.editAsPercentage) {
@@ -142,7 +152,7 @@ void ParamEditInt::percentageChanged(int p)
             if (mConfig->getUpdateOnly() != mName) {
                 mConfig->setUpdateOnly("");
             }
-            mConfig->updateParamInt(mName, val, this);
+            mConfig->updateParamInt(mParamId, val, this);
         }
 
         updateDisplay(val);
@@ -158,7 +168,7 @@ void ParamEditInt::intChanged(int i)
             if (mConfig->getUpdateOnly() != mName) {
                 mConfig->setUpdateOnly("");
             }
-            mConfig->updateParamInt(mName, val, this);
+            mConfig->updateParamInt(mParamId, val, this);
         }
 
         updateDisplay(val);
@@ -46,6 +46,7 @@ public:
 
 private slots:
     void paramChangedInt(QObject *src, QString name, int newParam);
+    void paramChangeSet(QObject *src, QVector<int> ids);
     void percentageChanged(int p);
     void intChanged(int i);
 
@@ -58,6 +59,7 @@ private:
     ConfigParams *mConfig;
     ConfigParam mParam;
     QString mName;
+    int mParamId;
     int mMaxVal;
 
     DisplayPercentage *mDisplay;
@@ -21,6 +21,7 @@
 #include "ui_parameditstring.h"
 #include "helpdialog.h"
 #include "utility.h"
+#include <algorithm>
 
 ParamEditString::ParamEditString(QWidget *parent) :
     QWidget(parent),
@@ -31,6 +32,9 @@ ParamEditString::ParamEditString(QWidget *parent) :
     ui->helpButton->setIcon(Utility::getIcon("icons/Help-96.png"));
     ui->readButton->setIcon(Utility::getIcon("icons/Upload-96.png"));
     ui->readDefaultButton->setIcon(Utility::getIcon("icons/Data Backup-96.png"));
+
+    mConfig = 0;
+    mParamId = -1;
 }
 
 ParamEditString::~ParamEditString()
@@ -42,19 +46,20 @@ void ParamEditString::setConfig(ConfigParams *config)
 {
     mConfig = config;
 
-    ConfigParam *param = mConfig->getParam(mName);
+    mParamId = mConfig->paramId(mName);
+    if (mConfig->hasParam(mName)) {
+        ConfigParam param = mConfig->getParamCopy(mName);
 
-    if (param) {
-        ui->readButton->setVisible(param->transmittable);
-        ui->readDefaultButton->setVisible(param->transmittable);
-        ui->valueEdit->setText(param->valString);
-        if (param->maxLen > 0) {
-            ui->valueEdit->setMaxLength(param->maxLen);
+        ui->readButton->setVisible(param.transmittable);
+        ui->readDefaultButton->setVisible(param.transmittable);
+        ui->valueEdit->setText(param.valString);
+        if (param.maxLen > 0) {
+            ui->valueEdit->setMaxLength(param.maxLen);
         }
     }
 
-    connect(mConfig, SIGNAL(paramChangedQString(QObject*,QString,QString)),
-            this, SLOT(paramChangedQString(QObject*,QString,QString)));
+    connect(mConfig, SIGNAL(paramChangeSet(QObject*,QVector<int>)),
+            this, SLOT(paramChangeSet(QObject*,QVector<int>)));
 }
 
 QString ParamEditString::name() const
@@ -74,6 +79,13 @@ void ParamEditString::paramChangedQString(QObject *src, QString name, QString ne
     }
 }
 
+void ParamEditString::paramChangeSet(QObject *src, QVector<int> ids)
+{
+    if (std::binary_search(ids.constBegin(), ids.constEnd(), mParamId)) {
+        paramChangedQString(src, mName, mConfig->getParamQString(mParamId));
+    }
+}
+
 void ParamEditString::on_helpButton_clicked()
 {
     if (mConfig) {
@@ -87,7 +99,7 @@ void ParamEditString::on_valueEdit_textChanged(const QString &arg1)
         if (mConfig->getUpdateOnly() != mName) {
             mConfig->setUpdateOnly("");
         }
-        mConfig->updateParamString(mName, arg1, this);
+        mConfig->updateParamString(mParamId, arg1, this);
     }
 }
 
@@ -40,6 +40,7 @@ public:
 
 private slots:
     void paramChangedQString(QObject *src, QString name, QString newParam);
+    void paramChangeSet(QObject *src, QVector<int> ids);
 
     void on_helpButton_clicked();
     void on_valueEdit_textChanged(const QString &arg1);
@@ -50,6 +51,7 @@ private:
     Ui::ParamEditString *ui;
     ConfigParams *mConfig;
     QString mName;
+    int mParamId;
 
 };
 
@@ -22,6 +22,46 @@
 #include <QDebug>
 #include <QHeaderView>
 #include <QLabel>
+#include <QScrollBar>
+#include <cmath>
+
+namespace {
+// Rows above and below the visible area that also get editors, so that
+// scrolling a bit does not show the placeholders.
+const int editorMarginRows = 5;
+
+QString valueText(ConfigParams *params, const QString &name)
+{
+    ConfigParam p = params->getParamCopy(name);
+
+    switch (p.type) {
+    case CFG_T_DOUBLE:
+        if (p.editAsPercentage) {
+            double maxVal = qMax(fabs(p.maxDouble), fabs(p.minDouble));
+            return QString("%1 %").arg(qRound((100.0 * p.valDouble) / maxVal));
+        }
+        return QString::number(p.valDouble * p.editorScale, 'f', p.editorDecimalsDouble) + p.suffix;
+
+    case CFG_T_INT:
+        return QString::number(int(p.valInt * p.editorScale)) + p.suffix;
+
+    case CFG_T_QSTRING:
+        return p.valString;
+
+    case CFG_T_ENUM:
+        return p.enumNames.value(p.valInt);
+
+    case CFG_T_BOOL:
+        return p.valInt ? "True" : "False";
+
+    case CFG_T_BITFIELD:
+        return QString("0b%1").arg(p.valInt, 8, 2, QLatin1Char('0'));
+
+    default:
+        return QString();
+    }
+}
+}
 
 ParamTable::ParamTable(QWidget *parent) : QTableWidget(parent)
 {
@@ -37,28 +77,86 @@ ParamTable::ParamTable(QWidget *parent) : QTableWidget(parent)
     horizontalHeader()->setStretchLastSection(true);
     horizontalHeader()->setVisible(false);
     verticalHeader()->setVisible(false);
+
+    mEditorRowHeight = -1;
+    mResizeNameColumn = false;
+
+    mEditorTimer = new QTimer(this);
+    mEditorTimer->setSingleShot(true);
+    mEditorTimer->setInterval(0);
+    connect(mEditorTimer, &QTimer::timeout, [this]() {
+        updateEditors();
+    });
+
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, [this]() {
+        scheduleEditorUpdate();
+    });
+
+    // Keep mRows in sync when rows are added or removed with the
+    // QTableWidget functions, e.g. removeRow or setRowCount.
+    connect(model(), &QAbstractItemModel::rowsInserted, [this](const QModelIndex &, int first, int last) {
+        ParamRow r;
+        r.hasEditor = false;
+        mRows.insert(first, last - first + 1, r);
+
+        for (auto &row: mEditorRows) {
+            if (row >= first) {
+                row += last - first + 1;
+            }
+        }
+    });
+
+    connect(model(), &QAbstractItemModel::rowsRemoved, [this](const QModelIndex &, int first, int last) {
+        mRows.remove(first, last - first + 1);
+
+        for (int i = mEditorRows.size() - 1;i >= 0;i--) {
+            int &row = mEditorRows[i];
+            if (row > last) {
+                row -= last - first + 1;
+            } else if (row >= first) {
+                mEditorRows.removeAt(i);
+            }
+        }
+
+        scheduleEditorUpdate();
+    });
 }
 
 bool ParamTable::addParamRow(ConfigParams *params, QString paramName)
 {
-    bool res = false;
-    QWidget *editor = params->getEditor(paramName);
-    QString name = params->getLongName(paramName);
-
-    if (editor) {
-        int row = rowCount();
-        setRowCount(row + 1);
-        QTableWidgetItem *item = new QTableWidgetItem(name);
-        item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-        setItem(row, 0, item);
-        setCellWidget(row, 1, editor);
-        res = true;
+    if (!params->hasParam(paramName)) {
+        qWarning() << paramName << "not found";
+        return false;
+    }
 
-        resizeColumnToContents(0);
-        resizeRowsToContents();
+    if (params->getParamCopy(paramName).type == CFG_T_UNDEFINED) {
+        qWarning() << "no editor for" << paramName << "could be created";
+        return false;
+    }
+
+    int row = rowCount();
+    setRowCount(row + 1);
+
+    QTableWidgetItem *item = new QTableWidgetItem(params->getLongName(paramName));
+    item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+    setItem(row, 0, item);
+
+    QTableWidgetItem *valueItem = new QTableWidgetItem(valueText(params, paramName));
+    valueItem->setFlags(valueItem->flags() & ~Qt::ItemIsEditable);
+    setItem(row, 1, valueItem);
+
+    if (mEditorRowHeight > 0) {
+        setRowHeight(row, mEditorRowHeight);
     }
 
-    return res;
+    ParamRow &r = mRows[row];
+    r.params = params;
+    r.name = paramName;
+
+    mResizeNameColumn = true;
+    scheduleEditorUpdate();
+
+    return true;
 }
 
 void ParamTable::addRowSeparator(QString text)
@@ -81,9 +179,7 @@ void ParamTable::addRowSeparator(QString text)
 
     setCellWidget(row, 0, label);
     setSpan(row, 0, 1, 2);
-
-    resizeColumnToContents(0);
-    resizeRowsToContents();
+    resizeRowToContents(row);
 }
 
 void ParamTable::addParamSubgroup(ConfigParams *params, QString groupName, QString subgroupName)
@@ -103,5 +199,122 @@ void ParamTable::addParamSubgroup(ConfigParams *params, QString groupName, QStri
 
 void ParamTable::clearParams()
 {
+    // Also clears mRows and mEditorRows, see the constructor
     setRowCount(0);
 }
+
+void ParamTable::showEvent(QShowEvent *event)
+{
+    QTableWidget::showEvent(event);
+    scheduleEditorUpdate();
+}
+
+void ParamTable::resizeEvent(QResizeEvent *event)
+{
+    QTableWidget::resizeEvent(event);
+    scheduleEditorUpdate();
+}
+
+void ParamTable::scheduleEditorUpdate()
+{
+    if (!mEditorTimer->isActive()) {
+        mEditorTimer->start();
+    }
+}
+
+/**
+ * @brief ParamTable::updateEditors
+ * Create editors for the rows around the visible area and delete the editors
+ * of the other rows. Nothing is done while the table is hidden, so tables on
+ * pages that are never opened do not create any editors.
+ */
+void ParamTable::updateEditors()
+{
+    if (mResizeNameColumn) {
+        resizeColumnToContents(0);
+        mResizeNameColumn = false;
+    }
+
+    if (!isVisible() || mRows.isEmpty()) {
+        return;
+    }
+
+    int first = rowAt(0);
+    int last = rowAt(viewport()->height() - 1);
+
+    if (first < 0) {
+        first = 0;
+    }
+
+    if (last < 0) {
+        last = mRows.size() - 1;
+    }
+
+    first = qMax(0, first - editorMarginRows);
+    last = qMin(mRows.size() - 1, last + editorMarginRows);
+
+    for (int i = mEditorRows.size() - 1;i >= 0;i--) {
+        int row = mEditorRows.at(i);
+        if (row < first || row > last) {
+            releaseEditor(row);
+        }
+    }
+
+    int heightBefore = mEditorRowHeight;
+
+    for (int row = first;row <= last;row++) {
+        if (mRows.at(row).params && !mRows.at(row).hasEditor) {
+            createEditor(row);
+        }
+    }
+
+    // The first editor decides the row height, which changes which rows
+    // are visible.
+    if (heightBefore < 0 && mEditorRowHeight > 0) {
+        scheduleEditorUpdate();
+    }
+}
+
+void ParamTable::createEditor(int row)
+{
+    ParamRow &r = mRows[row];
+    QWidget *editor = r.params->getEditor(r.name);
+
+    if (!editor) {
+        return;
+    }
+
+    // The value text would show through the editor
+    if (item(row, 1)) {
+        item(row, 1)->setText("");
+    }
+
+    setCellWidget(row, 1, editor);
+    r.hasEditor = true;
+    mEditorRows.append(row);
+
+    if (mEditorRowHeight < 0) {
+        mEditorRowHeight = editor->sizeHint().height();
+
+        for (int i = 0;i < mRows.size();i++) {
+            if (mRows.at(i).params) {
+                setRowHeight(i, mEditorRowHeight);
+            }
+        }
+    } else {
+        setRowHeight(row, qMax(mEditorRowHeight, editor->sizeHint().height()));
+    }
+}
+
+void ParamTable::releaseEditor(int row)
+{
+    ParamRow &r = mRows[row];
+
+    removeCellWidget(row, 1);
+    r.hasEditor = false;
+    mEditorRows.removeOne(row);
+
+    if (r.params && item(row, 1)) {
+        item(row, 1)->setText(valueText(r.params, r.name));
+    }
+}
@@ -22,8 +22,16 @@
 
 #include <QWidget>
 #include <QTableWidget>
+#include <QPointer>
+#include <QTimer>
 #include "configparams.h"
 
+/*
+ * The editor widgets are only created for the rows in and around the visible
+ * area, and are deleted again when their rows are scrolled far away. Rows
+ * without an editor show the value as text. This way the cost of a table
+ * depends on its height rather than on the number of parameters.
+ */
 class ParamTable : public QTableWidget
 {
 public:
@@ -33,6 +41,29 @@ public:
     void addParamSubgroup(ConfigParams *params, QString groupName, QString subgroupName);
     void clearParams();
 
+protected:
+    void showEvent(QShowEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    struct ParamRow {
+        QPointer<ConfigParams> params;
+        QString name;
+        bool hasEditor;
+    };
+
+    // One entry per table row. Separators have no params.
+    QVector<ParamRow> mRows;
+    QVector<int> mEditorRows;
+    int mEditorRowHeight;
+    bool mResizeNameColumn;
+    QTimer *mEditorTimer;
+
+    void scheduleEditorUpdate();
+    void updateEditors();
+    void createEditor(int row);
+    void releaseEditor(int row);
+
 };
 
 #endif // PARAMTABLE_H
@@ -21,6 +21,7 @@
 #include "ui_ppmmap.h"
 #include "helpdialog.h"
 #include "utility.h"
+#include "framescheduler.h"
 #include <QMessageBox>
 
 PpmMap::PpmMap(QWidget *parent) :
@@ -57,6 +58,7 @@ void PpmMap::setVesc(VescInterface *vesc)
     if (mVesc) {
         connect(mVesc->commands(), SIGNAL(decodedPpmReceived(double,double)),
                 this, SLOT(decodedPpmReceived(double,double)));
+        FrameScheduler::instance()->addStreamConsumer(this, FrameScheduler::StreamAppData);
     }
 }
 
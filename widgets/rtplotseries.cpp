@@ -0,0 +1,161 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "rtplotseries.h"
+
+RtPlotSeries::RtPlotSeries(int capacity)
+{
+    mHead = 0;
+    mSize = 0;
+    mPending = 0;
+    setCapacity(capacity);
+}
+
+void RtPlotSeries::setCapacity(int capacity)
+{
+    if (capacity < 1) {
+        capacity = 1;
+    }
+
+    // Keep the newest samples when resizing
+    QVector<double> keys(capacity);
+    QVector<double> values(capacity);
+    int keep = qMin(mSize, capacity);
+    for (int i = 0;i < keep;i++) {
+        keys[i] = keyAt(mSize - keep + i);
+        values[i] = valueAt(mSize - keep + i);
+    }
+
+    mKeys = keys;
+    mValues = values;
+    mHead = 0;
+    mSize = keep;
+    mPending = qMin(mPending, keep);
+
+    if (mGraph && mSize > 0) {
+        mGraph->data()->removeBefore(keyAt(0));
+    }
+}
+
+int RtPlotSeries::capacity() const
+{
+    return mKeys.size();
+}
+
+int RtPlotSeries::size() const
+{
+    return mSize;
+}
+
+bool RtPlotSeries::isEmpty() const
+{
+    return mSize == 0;
+}
+
+void RtPlotSeries::clear()
+{
+    mHead = 0;
+    mSize = 0;
+    mPending = 0;
+
+    if (mGraph) {
+        mGraph->data()->clear();
+    }
+}
+
+void RtPlotSeries::append(double key, double value)
+{
+    int ind = (mHead + mSize) % mKeys.size();
+    mKeys[ind] = key;
+    mValues[ind] = value;
+
+    if (mSize < mKeys.size()) {
+        mSize++;
+    } else {
+        mHead = (mHead + 1) % mKeys.size();
+    }
+
+    if (mPending < mSize) {
+        mPending++;
+    }
+}
+
+double RtPlotSeries::keyAt(int ind) const
+{
+    return mKeys.at(index(ind));
+}
+
+double RtPlotSeries::valueAt(int ind) const
+{
+    return mValues.at(index(ind));
+}
+
+double RtPlotSeries::lastKey() const
+{
+    return mSize > 0 ? keyAt(mSize - 1) : 0.0;
+}
+
+double RtPlotSeries::lastValue() const
+{
+    return mSize > 0 ? valueAt(mSize - 1) : 0.0;
+}
+
+/**
+ * @brief RtPlotSeries::attach
+ * Attach a graph that is fed by flush(). The graph data is replaced by the
+ * samples that currently are in the buffer.
+ *
+ * @param graph
+ * The graph, or nullptr to detach.
+ */
+void RtPlotSeries::attach(QCPGraph *graph)
+{
+    mGraph = graph;
+    mPending = mSize;
+
+    if (mGraph) {
+        mGraph->data()->clear();
+        flush();
+    }
+}
+
+void RtPlotSeries::flush()
+{
+    if (!mGraph) {
+        mPending = 0;
+        return;
+    }
+
+    if (mPending > 0) {
+        auto data = mGraph->data();
+        for (int i = mSize - mPending;i < mSize;i++) {
+            data->add(QCPGraphData(keyAt(i), valueAt(i)));
+        }
+
+        // Drop what fell out of the window. This only moves the start of the
+        // container, the memory is reclaimed by its auto squeeze.
+        data->removeBefore(keyAt(0));
+        mPending = 0;
+    }
+}
+
+int RtPlotSeries::index(int ind) const
+{
+    return (mHead + ind) % mKeys.size();
+}
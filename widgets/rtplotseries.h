@@ -0,0 +1,70 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef RTPLOTSERIES_H
+#define RTPLOTSERIES_H
+
+#include <QVector>
+#include <QPointer>
+#include "widgets/qcustomplot.h"
+
+/**
+ * @brief The RtPlotSeries class
+ *
+ * Fixed-capacity ring buffer of (key, value) samples for realtime plots. Samples
+ * are appended without moving the existing ones and pending samples are pushed
+ * to the attached graph on flush(), where keys that fell out of the window are
+ * dropped from the front of the graph data container. The cost of append() and
+ * flush() only depends on the number of new samples, not on the capacity.
+ *
+ * Keys must be appended in non-decreasing order.
+ */
+class RtPlotSeries
+{
+public:
+    RtPlotSeries(int capacity = 500);
+
+    void setCapacity(int capacity);
+    int capacity() const;
+    int size() const;
+    bool isEmpty() const;
+    void clear();
+
+    void append(double key, double value);
+    double keyAt(int ind) const;
+    double valueAt(int ind) const;
+    double lastKey() const;
+    double lastValue() const;
+
+    void attach(QCPGraph *graph);
+    void flush();
+
+private:
+    QVector<double> mKeys;
+    QVector<double> mValues;
+    int mHead;
+    int mSize;
+    int mPending;
+    QPointer<QCPGraph> mGraph;
+
+    int index(int ind) const;
+
+};
+
+#endif // RTPLOTSERIES_H
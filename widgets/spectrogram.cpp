@@ -0,0 +1,189 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#include "spectrogram.h"
+#include "utility.h"
+#include <cmath>
+
+namespace {
+const int maxCacheEntries = 8;
+
+// Range shown in the logarithmic scale, below the strongest component
+const double logRangeDb = 80.0;
+}
+
+Spectrogram::Spectrogram()
+{
+    mSampleRate = 1.0;
+    mStartTime = 0.0;
+}
+
+/**
+ * @brief Spectrogram::setSignal
+ * Set the signal to analyse. The cache is kept if the signal and sample rate
+ * are the same as before.
+ *
+ * @param signal
+ * The samples.
+ *
+ * @param sampleRate
+ * Sample rate in Hz.
+ *
+ * @param startTime
+ * Time of the first sample in seconds.
+ */
+void Spectrogram::setSignal(const QVector<double> &signal, double sampleRate, double startTime)
+{
+    if (sampleRate == mSampleRate && startTime == mStartTime && signal == mSignal) {
+        return;
+    }
+
+    mSignal = signal;
+    mSampleRate = sampleRate;
+    mStartTime = startTime;
+    mCache.clear();
+}
+
+bool Spectrogram::hasSignal() const
+{
+    return !mSignal.isEmpty();
+}
+
+const QVector<QVector<double> > &Spectrogram::frames(const Spectrogram::Params &params)
+{
+    for (int i = 0;i < mCache.size();i++) {
+        if (mCache.at(i).params == params) {
+            if (i != 0) {
+                mCache.move(i, 0);
+            }
+            return mCache.first().frames;
+        }
+    }
+
+    CacheEntry e;
+    e.params = params;
+    e.frames = DigitalFiltering::stft(mSignal, params.windowBits, params.hop, params.window);
+    mCache.prepend(e);
+
+    while (mCache.size() > maxCacheEntries) {
+        mCache.removeLast();
+    }
+
+    return mCache.first().frames;
+}
+
+/**
+ * @brief Spectrogram::render
+ * Draw the spectrogram in a color map, with time in seconds on the key axis
+ * and frequency in Hz on the value axis.
+ *
+ * @param map
+ * The color map to draw in.
+ *
+ * @param params
+ * STFT parameters.
+ *
+ * @param logScale
+ * Show the amplitude in dB.
+ */
+void Spectrogram::render(QCPColorMap *map, const Spectrogram::Params &params, bool logScale)
+{
+    const QVector<QVector<double> > &fr = frames(params);
+    QCPColorMapData *d = map->data();
+
+    if (fr.isEmpty()) {
+        d->clear();
+        return;
+    }
+
+    const int len = 1 << params.windowBits;
+    const int bins = fr.first().size();
+
+    // Each column is placed at the center of its frame
+    double t0 = mStartTime + 0.5 * double(len) / mSampleRate;
+    double t1 = t0 + double(qMax(fr.size() - 1, 1) * params.hop) / mSampleRate;
+
+    d->setSize(fr.size(), bins);
+    d->setRange(QCPRange(t0, t1), QCPRange(0.0, mSampleRate / 2.0));
+
+    double max = logScale ? -1e9 : 0.0;
+    for (int k = 0;k < fr.size();k++) {
+        const QVector<double> &f = fr.at(k);
+        for (int v = 0;v < bins;v++) {
+            double z = f.at(v);
+            if (logScale) {
+                z = 20.0 * log10(qMax(z, 1e-9));
+            }
+            max = qMax(max, z);
+            d->setCell(k, v, z);
+        }
+    }
+
+    if (logScale) {
+        map->setDataRange(QCPRange(max - logRangeDb, max));
+    } else {
+        map->rescaleDataRange(true);
+    }
+}
+
+void Spectrogram::clearCache()
+{
+    mCache.clear();
+}
+
+/**
+ * @brief Spectrogram::setupPlot
+ * Replace the color maps of a plot with a new color map for a spectrogram.
+ * Call removeFromPlot to go back to normal graphs.
+ *
+ * @param plot
+ * The plot.
+ *
+ * @param valueLabel
+ * Label of the color scale.
+ *
+ * @return
+ * The new color map.
+ */
+QCPColorMap *Spectrogram::setupPlot(QCustomPlot *plot, QString valueLabel)
+{
+    QCPColorMap *map = Utility::plotAddColorMap(plot, valueLabel);
+    plot->xAxis->setLabel("Seconds (s)");
+    plot->yAxis->setLabel("Frequency (Hz)");
+    return map;
+}
+
+void Spectrogram::removeFromPlot(QCustomPlot *plot)
+{
+    Utility::plotRemoveColorMaps(plot);
+}
+
+/**
+ * @brief Spectrogram::paramsFromOverlap
+ * Create parameters where the hop is given by the overlap between frames.
+ */
+Spectrogram::Params Spectrogram::paramsFromOverlap(int windowBits, double overlapPercent,
+                                                  DigitalFiltering::WindowType window)
+{
+    Params p;
+    p.windowBits = windowBits;
+    p.hop = qMax(1, int(round(double(1 << windowBits) * (1.0 - overlapPercent / 100.0))));
+    p.window = window;
+    return p;
+}
@@ -0,0 +1,77 @@
+/*
+    Copyright 2026 Benjamin Vedder	benjamin@vedder.se
+
+    This file is part of VESC Tool.
+
+    VESC Tool is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    VESC Tool is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include <QVector>
+#include <QList>
+#include "digitalfiltering.h"
+#include "widgets/qcustomplot.h"
+
+/**
+ * @brief The Spectrogram class
+ *
+ * STFT spectrogram of a uniformly sampled signal, drawn in a QCPColorMap. The
+ * transforms are cached per parameter set, so switching between parameters or
+ * redrawing the same signal does not recompute them. The cache is dropped
+ * when the signal changes.
+ */
+class Spectrogram
+{
+public:
+    struct Params {
+        int windowBits;
+        int hop;
+        DigitalFiltering::WindowType window;
+
+        bool operator==(const Params &other) const {
+            return windowBits == other.windowBits &&
+                    hop == other.hop &&
+                    window == other.window;
+        }
+    };
+
+    Spectrogram();
+
+    void setSignal(const QVector<double> &signal, double sampleRate, double startTime = 0.0);
+    bool hasSignal() const;
+    const QVector<QVector<double> > &frames(const Params &params);
+    void render(QCPColorMap *map, const Params &params, bool logScale = true);
+    void clearCache();
+
+    static QCPColorMap *setupPlot(QCustomPlot *plot, QString valueLabel = "Amplitude");
+    static void removeFromPlot(QCustomPlot *plot);
+    static Params paramsFromOverlap(int windowBits, double overlapPercent,
+                                    DigitalFiltering::WindowType window);
+
+private:
+    struct CacheEntry {
+        Params params;
+        QVector<QVector<double> > frames;
+    };
+
+    QVector<double> mSignal;
+    double mSampleRate;
+    double mStartTime;
+    QList<CacheEntry> mCache;
+
+};
+
+#endif // SPECTROGRAM_H
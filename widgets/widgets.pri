@@ -57,7 +57,10 @@ HEADERS += \
     $$PWD/detectallfocdialog.h \
     $$PWD/dirsetup.h \
     $$PWD/vesc3dview.h \
-    $$PWD/superslider.h
+    $$PWD/superslider.h \
+    $$PWD/rtplotseries.h \
+    $$PWD/canframemodel.h \
+    $$PWD/spectrogram.h
 
 SOURCES += \
     $$PWD/batttempplot.cpp \
@@ -95,5 +98,8 @@ SOURCES += \
     $$PWD/detectallfocdialog.cpp \
     $$PWD/dirsetup.cpp \
     $$PWD/vesc3dview.cpp \
-    $$PWD/superslider.cpp
+    $$PWD/superslider.cpp \
+    $$PWD/rtplotseries.cpp \
+    $$PWD/canframemodel.cpp \
+    $$PWD/spectrogram.cpp
 